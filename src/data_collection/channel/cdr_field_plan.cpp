@@ -0,0 +1,432 @@
+//
+// Created by xucong on 25-9-29.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "cdr_field_plan.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace dcp::channel {
+
+namespace {
+
+constexpr size_t kEncapsulationSize = 4;
+
+inline size_t AlignUp(size_t pos, size_t align) {
+    return (pos + align - 1) & ~(align - 1);
+}
+
+// 基本类型在CDR中的长度和对齐，string/wstring/message返回0
+bool PrimitiveSize(FieldLayout::Type type, uint32_t& size, uint32_t& align) {
+    using Type = FieldLayout::Type;
+    switch (type) {
+        case Type::Bool: case Type::Char: case Type::Octet: case Type::Int8: case Type::UInt8:
+            size = align = 1;
+            return true;
+        case Type::Int16: case Type::UInt16:
+            size = align = 2;
+            return true;
+        case Type::Int32: case Type::UInt32: case Type::Float:
+            size = align = 4;
+            return true;
+        case Type::Int64: case Type::UInt64: case Type::Double:
+            size = align = 8;
+            return true;
+        case Type::LongDouble:
+            size = 16;
+            align = 8;
+            return true;
+        default:
+            size = align = 0;
+            return false;
+    }
+}
+
+// 不含string/sequence的类型，跳过时长度只取决于起始对齐
+bool IsFixed(const FieldLayout& field) {
+    if (field.container == FieldLayout::Container::Sequence ||
+        field.type == FieldLayout::Type::String || field.type == FieldLayout::Type::WString) {
+        return false;
+    }
+    if (field.type == FieldLayout::Type::Message) {
+        for (const auto& member : field.members) {
+            if (!IsFixed(member)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+FieldLayout Element(const FieldLayout& field) {
+    FieldLayout element = field;
+    element.container = FieldLayout::Container::None;
+    element.arraySize = 0;
+    return element;
+}
+
+template <typename T>
+T Load(const uint8_t* p, bool swap) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    if (swap && sizeof(T) > 1) {
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    return value;
+}
+
+bool ReadCount(const uint8_t* data, size_t length, bool swap, size_t& cursor, uint32_t& count) {
+    cursor = AlignUp(cursor, 4);
+    if (cursor + 4 > length) {
+        return false;
+    }
+    count = Load<uint32_t>(data + cursor, swap);
+    cursor += 4;
+    return true;
+}
+
+}
+
+class CdrFieldPlan::Builder {
+public:
+    Builder(CdrFieldPlan& plan, std::vector<Step>& out, bool trackStatic)
+        : plan_(plan), out_(out), static_(trackStatic) {}
+
+    bool Resolve(const FieldLayout& root, const std::string& path) {
+        const FieldLayout* message = &root;
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            const size_t end = std::min(path.find('.', begin), path.size());
+            std::string component = path.substr(begin, end - begin);
+            const bool last = end == path.size();
+            begin = end + 1;
+
+            long index = -1;
+            const size_t bracket = component.find('[');
+            if (bracket != std::string::npos) {
+                char* tail = nullptr;
+                index = std::strtol(component.c_str() + bracket + 1, &tail, 10);
+                if (index < 0 || tail == nullptr || *tail != ']' || tail[1] != '\0') {
+                    return Fail("bad index in '" + component + "'");
+                }
+                component.resize(bracket);
+            }
+
+            const FieldLayout* member = nullptr;
+            for (const auto& candidate : message->members) {
+                if (candidate.name == component) {
+                    member = &candidate;
+                    break;
+                }
+                if (!SkipField(candidate)) {
+                    return false;
+                }
+            }
+            if (!member) {
+                return Fail("no field '" + component + "'");
+            }
+
+            FieldLayout element;
+            if (member->container != FieldLayout::Container::None) {
+                if (index < 0) {
+                    return Fail("'" + component + "' is an array, index required");
+                }
+                element = Element(*member);
+                if (!SkipToElement(*member, element, static_cast<uint32_t>(index))) {
+                    return false;
+                }
+            } else {
+                if (index >= 0) {
+                    return Fail("'" + component + "' is not an array");
+                }
+                element = *member;
+            }
+
+            if (last) {
+                return EmitRead(element);
+            }
+            if (element.type != FieldLayout::Type::Message) {
+                return Fail("'" + component + "' is not a message");
+            }
+            // 后续路径指向element内部，需保证element在本函数内有效
+            nested_.push_back(std::move(element));
+            message = &nested_.back();
+        }
+        return Fail("empty path");
+    }
+
+    bool SkipField(const FieldLayout& field) {
+        uint32_t size = 0, align = 0;
+        const bool primitive = PrimitiveSize(field.type, size, align);
+        if (field.type == FieldLayout::Type::WString) {
+            // wchar在不同rmw中的宽度不一致，无法可靠跳过
+            return Fail("wstring field '" + field.name + "' before target is not supported");
+        }
+        switch (field.container) {
+            case FieldLayout::Container::None:
+                if (primitive) {
+                    Skip(size, align);
+                } else if (field.type == FieldLayout::Type::String) {
+                    Dynamic(Step{Kind::SkipString});
+                } else {
+                    for (const auto& member : field.members) {
+                        if (!SkipField(member)) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            case FieldLayout::Container::Array:
+                if (primitive) {
+                    Skip(size * field.arraySize, align);
+                    return true;
+                }
+                return SkipElements(Element(field), field.arraySize);
+            case FieldLayout::Container::Sequence:
+                if (primitive) {
+                    Step step{Kind::SkipSeq};
+                    step.size = size;
+                    step.align = align;
+                    Dynamic(step);
+                    return true;
+                }
+                return SkipElements(Element(field), 0);
+        }
+        return true;
+    }
+
+private:
+    bool Fail(const std::string& message) {
+        if (plan_.last_error_.empty()) {
+            plan_.last_error_ = message;
+        }
+        return false;
+    }
+
+    void Skip(uint32_t size, uint32_t align) {
+        if (static_) {
+            pos_ = AlignUp(pos_, align) + size;
+            return;
+        }
+        Step step{Kind::Skip};
+        step.size = size;
+        step.align = align;
+        out_.push_back(step);
+    }
+
+    // 偏移从这里开始依赖数据：先把已知的固定偏移落成一次Seek
+    void Dynamic(const Step& step) {
+        if (static_) {
+            static_ = false;
+            if (pos_ > 0) {
+                Step seek{Kind::Seek};
+                seek.offset = pos_;
+                out_.push_back(seek);
+            }
+        }
+        out_.push_back(step);
+    }
+
+    // 跳过count个非基本类型元素；count为0表示从数据读取个数（sequence）
+    bool SkipElements(const FieldLayout& element, uint32_t count) {
+        if (count > 0 && static_ && IsFixed(element)) {
+            for (uint32_t i = 0; i < count; ++i) {
+                if (!SkipField(element)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        const int32_t sub = SubPlan(element);
+        if (sub < 0) {
+            return false;
+        }
+        Step step{Kind::SkipLoop};
+        step.count = count;
+        step.sub = sub;
+        Dynamic(step);
+        return true;
+    }
+
+    // 定位到数组/序列的第index个元素起点
+    bool SkipToElement(const FieldLayout& field, const FieldLayout& element, uint32_t index) {
+        uint32_t size = 0, align = 0;
+        const bool primitive = PrimitiveSize(element.type, size, align);
+        if (field.container == FieldLayout::Container::Array) {
+            if (index >= field.arraySize) {
+                return Fail("index " + std::to_string(index) + " out of array '" + field.name + "'");
+            }
+            if (primitive) {
+                Skip(size * index, align);
+                return true;
+            }
+            return index == 0 || SkipElements(element, index);
+        }
+        Step step{primitive ? Kind::SeqIndex : Kind::LoopIndex};
+        step.count = index;
+        if (primitive) {
+            step.size = size;
+            step.align = align;
+        } else {
+            step.sub = SubPlan(element);
+            if (step.sub < 0) {
+                return false;
+            }
+        }
+        Dynamic(step);
+        return true;
+    }
+
+    int32_t SubPlan(const FieldLayout& element) {
+        std::vector<Step> steps;
+        Builder child(plan_, steps, false);
+        if (!child.SkipField(element)) {
+            return -1;
+        }
+        plan_.subplans_.push_back(std::move(steps));
+        return static_cast<int32_t>(plan_.subplans_.size() - 1);
+    }
+
+    bool EmitRead(const FieldLayout& field) {
+        uint32_t size = 0, align = 0;
+        if (field.container != FieldLayout::Container::None || !PrimitiveSize(field.type, size, align) ||
+            field.type == FieldLayout::Type::LongDouble) {
+            return Fail("field '" + field.name + "' is not a numeric scalar");
+        }
+        Step step{Kind::Read};
+        step.type = field.type;
+        step.size = size;
+        step.align = align;
+        if (static_) {
+            step.fixed = true;
+            step.offset = AlignUp(pos_, align);
+        }
+        out_.push_back(step);
+        return true;
+    }
+
+    CdrFieldPlan& plan_;
+    std::vector<Step>& out_;
+    bool static_;
+    size_t pos_ = 0;
+    std::vector<FieldLayout> nested_;
+};
+
+bool CdrFieldPlan::Compile(const FieldLayout& root, const std::string& path) {
+    steps_.clear();
+    subplans_.clear();
+    last_error_.clear();
+    if (root.type != FieldLayout::Type::Message) {
+        last_error_ = "root is not a message";
+        return false;
+    }
+    Builder builder(*this, steps_, true);
+    if (!builder.Resolve(root, path)) {
+        steps_.clear();
+        subplans_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CdrFieldPlan::Read(const uint8_t* data, size_t length, double& value) const {
+    if (steps_.empty() || data == nullptr || length < kEncapsulationSize) {
+        return false;
+    }
+    // 封装头第二字节：0 CDR大端，1 CDR小端；参数列表编码不支持
+    const uint8_t encoding = data[1];
+    if (data[0] != 0 || encoding > 1) {
+        return false;
+    }
+    constexpr bool kHostLittle = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    const bool swap = (encoding == 1) != kHostLittle;
+    size_t cursor = 0;
+    return Execute(subplans_, steps_, data + kEncapsulationSize, length - kEncapsulationSize, swap, cursor, &value);
+}
+
+bool CdrFieldPlan::Execute(const std::vector<std::vector<Step>>& subplans, const std::vector<Step>& steps,
+                           const uint8_t* data, size_t length, bool swap, size_t& cursor, double* value) {
+    using Type = FieldLayout::Type;
+    for (const Step& step : steps) {
+        switch (step.kind) {
+            case Kind::Skip:
+                cursor = AlignUp(cursor, step.align) + step.size;
+                break;
+            case Kind::Seek:
+                cursor = step.offset;
+                break;
+            case Kind::SkipString: {
+                uint32_t len = 0;
+                if (!ReadCount(data, length, swap, cursor, len)) return false;
+                cursor += len;
+                break;
+            }
+            case Kind::SkipSeq: {
+                uint32_t count = 0;
+                if (!ReadCount(data, length, swap, cursor, count)) return false;
+                if (count > 0) {
+                    cursor = AlignUp(cursor, step.align) + static_cast<size_t>(count) * step.size;
+                }
+                break;
+            }
+            case Kind::SkipLoop: {
+                uint32_t count = step.count;
+                if (count == 0 && !ReadCount(data, length, swap, cursor, count)) return false;
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!Execute(subplans, subplans[step.sub], data, length, swap, cursor, nullptr)) return false;
+                }
+                break;
+            }
+            case Kind::SeqIndex: {
+                uint32_t count = 0;
+                if (!ReadCount(data, length, swap, cursor, count) || step.count >= count) return false;
+                cursor = AlignUp(cursor, step.align) + static_cast<size_t>(step.count) * step.size;
+                break;
+            }
+            case Kind::LoopIndex: {
+                uint32_t count = 0;
+                if (!ReadCount(data, length, swap, cursor, count) || step.count >= count) return false;
+                for (uint32_t i = 0; i < step.count; ++i) {
+                    if (!Execute(subplans, subplans[step.sub], data, length, swap, cursor, nullptr)) return false;
+                }
+                break;
+            }
+            case Kind::Read: {
+                const size_t pos = step.fixed ? step.offset : AlignUp(cursor, step.align);
+                if (pos + step.size > length || value == nullptr) return false;
+                const uint8_t* p = data + pos;
+                switch (step.type) {
+                    case Type::Bool: *value = *p != 0 ? 1.0 : 0.0; break;
+                    case Type::Char: *value = static_cast<char>(*p); break;
+                    case Type::Int8: *value = static_cast<int8_t>(*p); break;
+                    case Type::Octet: case Type::UInt8: *value = *p; break;
+                    case Type::Int16: *value = Load<int16_t>(p, swap); break;
+                    case Type::UInt16: *value = Load<uint16_t>(p, swap); break;
+                    case Type::Int32: *value = Load<int32_t>(p, swap); break;
+                    case Type::UInt32: *value = Load<uint32_t>(p, swap); break;
+                    case Type::Int64: *value = static_cast<double>(Load<int64_t>(p, swap)); break;
+                    case Type::UInt64: *value = static_cast<double>(Load<uint64_t>(p, swap)); break;
+                    case Type::Float: *value = Load<float>(p, swap); break;
+                    case Type::Double: *value = Load<double>(p, swap); break;
+                    default: return false;
+                }
+                cursor = pos + step.size;
+                return true;
+            }
+        }
+        if (cursor > length) {
+            return false;
+        }
+    }
+    return value == nullptr;
+}
+
+}
@@ -0,0 +1,87 @@
+//
+// Created by xucong on 25-9-29.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CDR_FIELD_PLAN_H
+#define CDR_FIELD_PLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dcp::channel {
+
+/**
+ * @brief 与中间件无关的消息布局描述，由rosidl introspection信息转换而来。
+ */
+struct FieldLayout {
+    enum class Type : uint8_t {
+        Bool, Char, Octet, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64,
+        Float, Double, LongDouble, String, WString, Message,
+    };
+    enum class Container : uint8_t { None, Array, Sequence };
+
+    std::string name;
+    Type type = Type::Message;
+    Container container = Container::None;
+    uint32_t arraySize = 0;               // 定长数组长度
+    std::vector<FieldLayout> members;     // type为Message时的成员
+};
+
+/**
+ * @brief 从CDR序列化字节中直接读取单个数值字段的执行计划。
+ *
+ * 编译时沿字段路径（如 "chassis.speed_mps"、"position[0]"、"objects[2].pose.x"）
+ * 计算读取步骤：目标之前全是定长字段时折叠为一个固定偏移；遇到string/sequence后
+ * 偏移依赖数据，按步骤跳过。读取时不反序列化整条消息，只做对齐、跳过和一次取值，
+ * 并对每一步做越界检查。支持XCDR1的小端和大端编码。
+ */
+class CdrFieldPlan {
+public:
+    bool Compile(const FieldLayout& root, const std::string& path);
+    // data为完整序列化消息（含4字节封装头）；字段越界、序列下标超出时返回false
+    bool Read(const uint8_t* data, size_t length, double& value) const;
+
+    const std::string& LastError() const { return last_error_; }
+    // 目标字段是否在固定偏移上（不需要逐步跳过）
+    bool IsFixedOffset() const { return steps_.size() == 1 && steps_[0].fixed; }
+
+private:
+    enum class Kind : uint8_t {
+        Skip,        // 对齐到align后前进size
+        SkipString,  // uint32长度 + 字节
+        SkipSeq,     // uint32个数 + 个数×size的定长元素
+        SkipLoop,    // 重复执行子计划count次；count为0时从数据读取uint32个数
+        SeqIndex,    // uint32个数，检查下标后跳到第index个定长元素
+        LoopIndex,   // uint32个数，检查下标后重复执行子计划index次
+        Seek,        // 游标设为固定偏移
+        Read,        // 对齐并读取type类型的值；游标固定时offset有效
+    };
+
+    struct Step {
+        Kind kind;
+        FieldLayout::Type type = FieldLayout::Type::Octet;
+        uint32_t size = 0;
+        uint32_t align = 1;
+        uint32_t count = 0;
+        int32_t sub = -1;
+        size_t offset = 0;
+        bool fixed = false;  // Read：offset为固定偏移，不依赖游标
+    };
+
+    static bool Execute(const std::vector<std::vector<Step>>& subplans, const std::vector<Step>& steps,
+                        const uint8_t* data, size_t length, bool swap, size_t& cursor, double* value);
+
+    class Builder;
+
+    std::vector<Step> steps_;
+    std::vector<std::vector<Step>> subplans_;
+    std::string last_error_;
+};
+
+}
+
+#endif // CDR_FIELD_PLAN_H
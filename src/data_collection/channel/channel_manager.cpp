@@ -1,60 +1,108 @@
 #include "channel_manager.h"
+#include "channel/channel_subscription.h"
 #include "common/log/logger.h"
+#include "common/metrics/metrics_registry.h"
 
 namespace dcp::channel{
 
 bool ChannelManager::Init(const std::shared_ptr<rclcpp::Node>& node,
                           const dcp::trigger::StrategyConfig& config,
-                          const std::shared_ptr<dcp::trigger::TriggerManager>& trigger_manager)
+                          const std::shared_ptr<dcp::trigger::TriggerManager>& trigger_manager,
+                          const std::shared_ptr<ExecutorTopology>& executor_topology)
 {
 
     node_ = node;
+    executor_topology_ = executor_topology;
     strategy_config_ = config;
     trigger_manager_ = trigger_manager;
     // rscl_recorder_ = rscl_recorder;
 
     message_subject_ = std::make_unique<Subject>();
+    analysis_ = trigger::StrategyAnalyzer::Analyze(strategy_config_);
 
-    bool ret = InitSubscribers();
-    CHECK_AND_RETURN(ret, ChannelManager, "InitSubscribers failed", false);
-
-    ret = InitObservers();
+    // 先建好观察者和信号读取计划，订阅回调开始时分发目标已就绪
+    bool ret = InitObservers();
     CHECK_AND_RETURN(ret, ChannelManager, "InitObservers failed", false);
 
+    ret = InitSubscribers();
+    CHECK_AND_RETURN(ret, ChannelManager, "InitSubscribers failed", false);
+
     return ret;
 }
 
 bool ChannelManager::InitSubscribers() {
-    for (const auto& strategy : strategy_config_.strategies) {
-        if (!strategy.trigger.enabled)  continue;
-        for (const auto& channel : strategy.dds.channels) {
-            std::string topic = channel.topic;
-            if (subscribers_.find(topic) != subscribers_.end()) {
-                continue;
-            }
-
-            std::string message_type;
-            auto callback = [this, topic](const std::shared_ptr<rclcpp::SerializedMessage>& msg) {
-                this->Notify(topic, *msg);
-            };
-
-            auto subscriber = node_->create_generic_subscription(
-                topic,
-                message_type,
-                rclcpp::QoS(10),
-                callback
-            );
-
-            if (!subscriber) {
-                AD_ERROR(ChannelManager, "Create subscriber failed for topic: %s", topic.c_str());
-                return false;
-            }
-            AD_INFO(ChannelManager, "Init subscriber for topic: %s, node: %p, subscriber: %p", topic.c_str(), node_.get(), subscriber.get());
-            subscribers_[topic] = subscriber;
+    for (const auto& strategy : analysis_.strategies) {
+        AD_INFO(ChannelManager, "Strategy %s: record %d topics, signal %d topics%s",
+                strategy.triggerId.c_str(), static_cast<int>(strategy.recordTopics.size()),
+                static_cast<int>(strategy.signalTopics.size()), strategy.conditionValid ? "" : ", invalid condition");
+        for (const auto& variable : strategy.unresolvedVariables) {
+            AD_INFO(ChannelManager, "Strategy %s: variable %s has no signal source, expects a getter",
+                    strategy.triggerId.c_str(), variable.c_str());
         }
     }
-    return true;
+    return ApplySubscriptions();
+}
 
+bool ChannelManager::ApplySubscriptions() {
+    bool ret = true;
+    for (const auto& [topic, requirement] : analysis_.topics) {
+        auto it = subscribers_.find(topic);
+        if (it != subscribers_.end() && it->second.depth == requirement.qosDepth) {
+            // 深度不变只切换分发路径，不重建订阅
+            it->second.record->store(requirement.record, std::memory_order_relaxed);
+            continue;
+        }
+        if (!SubscribeTopic(requirement)) {
+            ret = false;
+        }
+    }
+    for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+        if (analysis_.topics.find(it->first) == analysis_.topics.end()) {
+            AD_INFO(ChannelManager, "Removed subscriber for topic: %s", it->first.c_str());
+            it = subscribers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return ret;
+}
+
+bool ChannelManager::SubscribeTopic(const trigger::TopicRequirement& requirement) {
+    const std::string topic = requirement.topic;
+    auto record = std::make_shared<std::atomic<bool>>(requirement.record);
+    // 回调耗时包含录制缓存拷贝或信号解析，按channel阶段统计
+    const auto* stage = &common::MetricsRegistry::getInstance().GetStage("channel");
+    auto callback = [this, topic, record, stage](const std::shared_ptr<rclcpp::SerializedMessage>& msg) {
+        common::ScopedLatency latency(stage->duration);
+        stage->total->Add();
+        stage->bytes->Add(msg->get_rcl_serialized_message().buffer_length);
+        if (record->load(std::memory_order_relaxed)) {
+            this->Notify(topic, *msg);
+        } else {
+            this->NotifySignal(topic, *msg);
+        }
+    };
+
+    // 按topic分组放入独立线程的回调组，关键信号不与相机等大流量topic共用线程
+    rclcpp::SubscriptionOptions options;
+    if (executor_topology_) {
+        options.callback_group = executor_topology_->CallbackGroupFor(topic);
+    }
+
+    // 接收缓冲区从内存池分配（未启用时为默认分配器），回调前做topic实测统计
+    auto probe = TopicProfiler::getInstance().Register(topic, requirement.rateHz);
+    rclcpp::GenericSubscription::SharedPtr subscriber = ChannelSubscription::Create(
+        node_, topic, requirement.type, rclcpp::QoS(requirement.qosDepth), callback, probe, options);
+
+    if (!subscriber) {
+        AD_ERROR(ChannelManager, "Create subscriber failed for topic: %s", topic.c_str());
+        return false;
+    }
+    AD_INFO(ChannelManager, "Init subscriber for topic: %s, %s, depth %d, rate %dHz, subscriber: %p",
+            topic.c_str(), requirement.record ? "record" : "signal only", static_cast<int>(requirement.qosDepth),
+            requirement.rateHz, subscriber.get());
+    subscribers_[topic] = Subscription{subscriber, requirement.qosDepth, record};
+    return true;
 }
 
 bool ChannelManager::InitObservers() {
@@ -63,23 +111,73 @@ bool ChannelManager::InitObservers() {
     //     AD_INFO(ChannelManager, "Added RsclRecorder as observer");
     // }
 
+    // 解析信号写入trigger槽位，事件驱动时信号变化即唤醒依赖的trigger
     if (trigger_manager_) {
-        for (const auto& strategy : strategy_config_.strategies) {
-            if (auto trigger = trigger_manager_->getTrigger(strategy.trigger.triggerId)) {
-                AddObserver(trigger);
-                AD_INFO(ChannelManager, "Added %s as observer", strategy.trigger.triggerId.c_str());
-            }
-
+        message_provider_ = std::make_shared<MessageProvider>(node_);
+        message_provider_->setSignalSink(trigger_manager_->signalSlots(), trigger_manager_->evaluator());
+        if (!message_provider_->configureSignals(analysis_.signals)) {
+            AD_WARN(ChannelManager, "Some signals failed to resolve, see SignalExtractor errors");
         }
+        AddObserver(message_provider_);
+        AD_INFO(ChannelManager, "Added MessageProvider as observer");
     }
 
+    SyncTriggerObservers();
+
     AD_INFO(ChannelManager, "InitObservers ok");
     return true;
 }
 
+void ChannelManager::SyncTriggerObservers() {
+    if (!trigger_manager_) {
+        return;
+    }
+    std::unordered_map<std::string, std::shared_ptr<Observer>> observers;
+    for (const auto& strategy : strategy_config_.strategies) {
+        if (auto trigger = trigger_manager_->getTrigger(strategy.trigger.triggerId)) {
+            observers[strategy.trigger.triggerId] = trigger;
+        }
+    }
+
+    // 对象未变的trigger保持注册，重建的trigger先加新对象再移除旧对象
+    for (const auto& [id, observer] : observers) {
+        auto it = trigger_observers_.find(id);
+        if (it != trigger_observers_.end() && it->second == observer) {
+            continue;
+        }
+        AddObserver(observer);
+        if (it != trigger_observers_.end()) {
+            RemoveObserver(it->second);
+        }
+        AD_INFO(ChannelManager, "Added %s as observer", id.c_str());
+    }
+    for (const auto& [id, observer] : trigger_observers_) {
+        if (observers.find(id) == observers.end()) {
+            RemoveObserver(observer);
+            AD_INFO(ChannelManager, "Removed %s from observers", id.c_str());
+        }
+    }
+    trigger_observers_ = std::move(observers);
+}
+
+bool ChannelManager::Reload(const dcp::trigger::StrategyConfig& config, const dcp::trigger::StrategyDiff& diff) {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    strategy_config_ = config;
+    analysis_ = trigger::StrategyAnalyzer::Analyze(strategy_config_);
+
+    // 先更新信号读取计划和观察者，再按分析结果增删订阅
+    if (diff.signalsChanged && message_provider_ && !message_provider_->configureSignals(analysis_.signals)) {
+        AD_WARN(ChannelManager, "Some signals failed to resolve after reload");
+    }
+    SyncTriggerObservers();
+    const bool ret = ApplySubscriptions();
+    AD_INFO(ChannelManager, "Reload done, subscribers: %d", static_cast<int>(subscribers_.size()));
+    return ret;
+}
+
 void ChannelManager::OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg) {
     // 实现消息处理逻辑
-    AD_WARN(ChannelManager, "Received message on topic: %s", topic.c_str());
+    AD_WARN_EVERY_MS(ChannelManager, 1000, "Received message on topic: %s", topic.c_str());
 }
 
 void ChannelManager::AddObserver(const std::shared_ptr<Observer>& observer) const
@@ -103,5 +201,12 @@ void ChannelManager::Notify(const std::string& topic, const rclcpp::SerializedMe
     }
 }
 
+void ChannelManager::NotifySignal(const std::string& topic, const rclcpp::SerializedMessage& msg) const
+{
+    if (message_provider_) {
+        message_provider_->OnMessageReceived(topic, msg);
+    }
+}
+
 
 }
\ No newline at end of file
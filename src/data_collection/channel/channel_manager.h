@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include <memory>
@@ -7,8 +9,10 @@
 #include <mutex>
 
 #include "observer.h"
+#include "executor_topology.h"
 #include "recorder/data_storage.h"
 #include "trigger/trigger_manager.h"
+#include "trigger/strategy_parser/strategy_analyzer.h"
 // #include "../uploader/data_reporter.h"
 
 namespace dcp::channel {
@@ -21,9 +25,20 @@ public:
     //           const dcp::trigger::StrategyConfig& config,
     //           const std::shared_ptr<dcp::trigger::TriggerManager>& trigger_manager,
     //           const std::shared_ptr<dcp::recorder::RsclRecorder>& rscl_recorder);
+    /**
+     * @param executor_topology 订阅按topic分组放入对应的回调组（可选，默认使用节点默认回调组）
+     */
     bool Init(const std::shared_ptr<rclcpp::Node>& node,
               const dcp::trigger::StrategyConfig& config,
-              const std::shared_ptr<dcp::trigger::TriggerManager>& trigger_manager);
+              const std::shared_ptr<dcp::trigger::TriggerManager>& trigger_manager,
+              const std::shared_ptr<ExecutorTopology>& executor_topology = nullptr);
+
+    /**
+     * @brief 策略热更新，按新配置的静态分析结果增删订阅、调整队列深度和分发路径，
+     *        并把trigger观察者替换为TriggerManager中的新对象；未变化的订阅保持不动，不丢消息
+     * @note 需在TriggerManager::reload之后调用
+     */
+    bool Reload(const dcp::trigger::StrategyConfig& config, const dcp::trigger::StrategyDiff& diff);
 
     void AddObserver(const std::shared_ptr<Observer>& observer) const;
     void RemoveObserver(const std::shared_ptr<Observer>& observer) const;
@@ -31,16 +46,33 @@ public:
     // void Notify(const std::string& topic, const TRawMessagePtr& idl);
 
 private:
+    // 只订阅enabled策略需要的topic：录制topic分发给全部观察者，
+    // 仅用于条件求值的topic只交给MessageProvider，不进入录制
+    struct Subscription {
+        rclcpp::GenericSubscription::SharedPtr subscriber;
+        size_t depth = 0;
+        std::shared_ptr<std::atomic<bool>> record;
+    };
+
     bool InitSubscribers();
     bool InitObservers();
+    bool ApplySubscriptions();
+    bool SubscribeTopic(const trigger::TopicRequirement& requirement);
+    void NotifySignal(const std::string& topic, const rclcpp::SerializedMessage& msg) const;
+    void SyncTriggerObservers();
     void OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg) override;
     // void OnMessageReceived(const std::string& topic, const TRawMessagePtr& idl) override;
 
     std::shared_ptr<rclcpp::Node> node_;
-    std::map<std::string, rclcpp::GenericSubscription::SharedPtr> subscribers_;
+    std::shared_ptr<ExecutorTopology> executor_topology_;
+    std::map<std::string, Subscription> subscribers_;
+    trigger::StrategyAnalysis analysis_;
+    std::unordered_map<std::string, std::shared_ptr<Observer>> trigger_observers_;
+    std::mutex reload_mutex_;
     trigger::StrategyConfig strategy_config_;
     std::shared_ptr<trigger::TriggerManager> trigger_manager_{nullptr};
     std::unique_ptr<Subject> message_subject_;
+    std::shared_ptr<MessageProvider> message_provider_{nullptr};
 
     // std::shared_ptr<senseAD::rscl::comm::Node> node_{nullptr};
     // senseAD::rscl::comm::SubscriberBase::Ptr suber_;
@@ -0,0 +1,69 @@
+//
+// Created by xucong on 25-10-2.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "channel/channel_subscription.h"
+
+#include <rclcpp/typesupport_helpers.hpp>
+
+#include "common/memory/message_pool.h"
+
+namespace dcp::channel {
+
+namespace {
+
+// publisher gid的FNV-1a哈希，用作序号统计的key
+uint64_t PublisherKey(const rmw_gid_t& gid) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (auto byte : gid.data) {
+        hash = (hash ^ static_cast<uint8_t>(byte)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+}
+
+std::shared_ptr<ChannelSubscription> ChannelSubscription::Create(
+    const std::shared_ptr<rclcpp::Node>& node, const std::string& topic, const std::string& type,
+    const rclcpp::QoS& qos, Callback callback, const std::shared_ptr<TopicProfiler::Probe>& probe,
+    const rclcpp::SubscriptionOptions& options) {
+    auto ts_lib = rclcpp::get_typesupport_library(type, "rosidl_typesupport_cpp");
+    // 回调中记录消息大小，下一条消息按此预留
+    auto size_hint = std::make_shared<std::atomic<size_t>>(0);
+    auto hinted = [size_hint, callback = std::move(callback)](std::shared_ptr<rclcpp::SerializedMessage> msg) {
+        size_hint->store(msg->get_rcl_serialized_message().buffer_length, std::memory_order_relaxed);
+        callback(std::move(msg));
+    };
+    auto topics = node->get_node_topics_interface();
+    auto subscription = std::make_shared<ChannelSubscription>(
+        topics->get_node_base_interface(), ts_lib, topic, type, qos, size_hint, std::move(hinted), probe, options);
+    topics->add_subscription(subscription, options.callback_group);
+    return subscription;
+}
+
+ChannelSubscription::ChannelSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface* node_base, const std::shared_ptr<rcpputils::SharedLibrary>& ts_lib,
+    const std::string& topic, const std::string& type, const rclcpp::QoS& qos,
+    const std::shared_ptr<std::atomic<size_t>>& size_hint, Callback callback,
+    const std::shared_ptr<TopicProfiler::Probe>& probe, const rclcpp::SubscriptionOptions& options)
+    : rclcpp::GenericSubscription(node_base, ts_lib, topic, type, qos, std::move(callback), options),
+      size_hint_(size_hint), probe_(probe) {}
+
+std::shared_ptr<rclcpp::SerializedMessage> ChannelSubscription::create_serialized_message() {
+    return std::make_shared<rclcpp::SerializedMessage>(size_hint_->load(std::memory_order_relaxed),
+                                                       common::MessagePool::getInstance().Allocator());
+}
+
+void ChannelSubscription::handle_serialized_message(
+    const std::shared_ptr<rclcpp::SerializedMessage>& serialized_message, const rclcpp::MessageInfo& message_info) {
+    if (probe_) {
+        const auto& info = message_info.get_rmw_message_info();
+        probe_->Record(serialized_message->get_rcl_serialized_message().buffer_length, info.source_timestamp,
+                       info.received_timestamp, PublisherKey(info.publisher_gid), info.publication_sequence_number);
+    }
+    rclcpp::GenericSubscription::handle_serialized_message(serialized_message, message_info);
+}
+
+}
@@ -0,0 +1,60 @@
+//
+// Created by xucong on 25-10-2.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CHANNEL_SUBSCRIPTION_H
+#define CHANNEL_SUBSCRIPTION_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/generic_subscription.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "channel/topic_profiler.h"
+
+namespace dcp::channel {
+
+/**
+ * @brief ChannelManager使用的GenericSubscription，接收缓冲区从MessagePool分配，并在回调前做topic统计。
+ *
+ * rclcpp的create_generic_subscription总是用默认分配器创建SerializedMessage，
+ * 这里重写create_serialized_message，改用MessagePool的rcutils分配器（未启用时为默认分配器），
+ * 并按上一条消息的大小预留容量，rmw取消息时通常不必再扩容。
+ * 重写handle_serialized_message，把消息大小和rmw_message_info中的时间戳、publisher序号
+ * 交给TopicProfiler::Probe。创建流程与rclcpp::create_generic_subscription一致。
+ */
+class ChannelSubscription : public rclcpp::GenericSubscription {
+public:
+    using Callback = std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)>;
+
+    // probe为空时不做统计
+    static std::shared_ptr<ChannelSubscription> Create(
+        const std::shared_ptr<rclcpp::Node>& node, const std::string& topic, const std::string& type,
+        const rclcpp::QoS& qos, Callback callback, const std::shared_ptr<TopicProfiler::Probe>& probe,
+        const rclcpp::SubscriptionOptions& options = rclcpp::SubscriptionOptions());
+
+    ChannelSubscription(rclcpp::node_interfaces::NodeBaseInterface* node_base,
+                        const std::shared_ptr<rcpputils::SharedLibrary>& ts_lib,
+                        const std::string& topic, const std::string& type, const rclcpp::QoS& qos,
+                        const std::shared_ptr<std::atomic<size_t>>& size_hint, Callback callback,
+                        const std::shared_ptr<TopicProfiler::Probe>& probe,
+                        const rclcpp::SubscriptionOptions& options);
+
+    std::shared_ptr<rclcpp::SerializedMessage> create_serialized_message() override;
+
+    void handle_serialized_message(const std::shared_ptr<rclcpp::SerializedMessage>& serialized_message,
+                                   const rclcpp::MessageInfo& message_info) override;
+
+private:
+    std::shared_ptr<std::atomic<size_t>> size_hint_;
+    std::shared_ptr<TopicProfiler::Probe> probe_;
+};
+
+}
+
+#endif // CHANNEL_SUBSCRIPTION_H
@@ -0,0 +1,31 @@
+//
+// Created by xucong on 25-9-30.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "channel/decode_cache.h"
+
+namespace dcp::channel {
+
+namespace {
+thread_local DecodeCache* current_cache = nullptr;
+}
+
+std::atomic<uint64_t> DecodeCache::decodes_{0};
+std::atomic<uint64_t> DecodeCache::hits_{0};
+
+DecodeCache* DecodeCache::Current() {
+    return current_cache;
+}
+
+DecodeCache::Scope::Scope(const rclcpp::SerializedMessage& msg)
+    : cache_(msg), previous_(current_cache) {
+    current_cache = &cache_;
+}
+
+DecodeCache::Scope::~Scope() {
+    current_cache = previous_;
+}
+
+}
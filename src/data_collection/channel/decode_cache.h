@@ -0,0 +1,96 @@
+//
+// Created by xucong on 25-9-30.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+namespace dcp::channel {
+
+/**
+ * @brief 单条消息的反序列化缓存，同一类型只解码一次。
+ *
+ * Subject::notifyAll分发消息时在当前线程上建立Scope，观察者通过
+ * DecodeCache::Get<T>(msg) 取得解码结果：第一个调用者反序列化并存入，
+ * 后续观察者共享同一个const对象。Scope结束（消息分发完毕）时缓存释放，
+ * 观察者若需跨线程持有，保留返回的shared_ptr即可。
+ * 不在分发过程中（如录制线程异步处理）调用时退化为直接解码，不做缓存。
+ */
+class DecodeCache {
+public:
+    class Scope;
+
+    template <typename T>
+    static std::shared_ptr<const T> Get(const rclcpp::SerializedMessage& msg) {
+        DecodeCache* cache = Current();
+        if (cache && cache->msg_ == &msg) {
+            const std::type_index key(typeid(T));
+            for (const auto& entry : cache->entries_) {
+                if (entry.first == key) {
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return std::static_pointer_cast<const T>(entry.second);
+                }
+            }
+            auto decoded = Decode<T>(msg);
+            cache->entries_.emplace_back(key, decoded);
+            return decoded;
+        }
+        return Decode<T>(msg);
+    }
+
+    // 累计解码次数和命中缓存次数
+    static uint64_t Decodes() { return decodes_.load(std::memory_order_relaxed); }
+    static uint64_t Hits() { return hits_.load(std::memory_order_relaxed); }
+
+private:
+    explicit DecodeCache(const rclcpp::SerializedMessage& msg) : msg_(&msg) {}
+
+    template <typename T>
+    static std::shared_ptr<const T> Decode(const rclcpp::SerializedMessage& msg) {
+        static const rclcpp::Serialization<T> serialization;
+        auto decoded = std::make_shared<T>();
+        serialization.deserialize_message(&msg, decoded.get());
+        decodes_.fetch_add(1, std::memory_order_relaxed);
+        return decoded;
+    }
+
+    static DecodeCache* Current();
+
+    const rclcpp::SerializedMessage* msg_;
+    // 一条消息通常只被解码成一两种类型，线性查找即可
+    std::vector<std::pair<std::type_index, std::shared_ptr<const void>>> entries_;
+
+    static std::atomic<uint64_t> decodes_;
+    static std::atomic<uint64_t> hits_;
+};
+
+// 在栈上持有本条消息的缓存，并设为当前线程的活动缓存；可嵌套
+class DecodeCache::Scope {
+public:
+    explicit Scope(const rclcpp::SerializedMessage& msg);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    DecodeCache cache_;
+    DecodeCache* previous_;
+};
+
+}
+
+#endif // DECODE_CACHE_H
@@ -0,0 +1,168 @@
+//
+// Created by xucong on 25-10-3.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "channel/executor_topology.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <sched.h>
+#include <cstring>
+
+#include "common/log/logger.h"
+
+namespace dcp::channel {
+
+ExecutorTopology::~ExecutorTopology() {
+    Stop();
+    groups_.clear();
+}
+
+bool ExecutorTopology::Init(const std::shared_ptr<rclcpp::Node>& node, const common::AppConfigData::Executor& config) {
+    node_ = node;
+    config_ = config;
+    groups_.clear();
+    assigned_.clear();
+    // 随节点加入主executor
+    ungrouped_ = node_->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+    for (const auto& group_config : config.groups) {
+        if (group_config.threads <= 0 || group_config.topics.empty()) {
+            AD_WARN(ExecutorTopology, "Group %s has no threads or topics, skipped.", group_config.name.c_str());
+            continue;
+        }
+        Group group;
+        group.config = group_config;
+        if (!group.config.cores.empty() &&
+            group.config.cores.size() != static_cast<size_t>(group.config.threads)) {
+            AD_WARN(ExecutorTopology, "Group %s: %d cores for %d threads, affinity ignored.",
+                    group_config.name.c_str(), static_cast<int>(group.config.cores.size()), group.config.threads);
+            group.config.cores.clear();
+        }
+        try {
+            for (const auto& pattern : group_config.topics) {
+                group.patterns.emplace_back(pattern);
+            }
+        } catch (const std::regex_error& e) {
+            AD_ERROR(ExecutorTopology, "Group %s: invalid topic pattern: %s", group_config.name.c_str(), e.what());
+            return false;
+        }
+        for (int i = 0; i < group_config.threads; ++i) {
+            Lane lane;
+            // 不随节点加入主executor，只由本线程的executor服务
+            lane.callback_group = node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive, false);
+            lane.executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+            lane.executor->add_callback_group(lane.callback_group, node_->get_node_base_interface());
+            group.lanes.push_back(std::move(lane));
+        }
+        AD_INFO(ExecutorTopology, "Group %s: %d threads, %d patterns, priority %d", group_config.name.c_str(),
+                group_config.threads, static_cast<int>(group.patterns.size()), group_config.priority);
+        groups_.push_back(std::move(group));
+    }
+    return true;
+}
+
+rclcpp::CallbackGroup::SharedPtr ExecutorTopology::CallbackGroupFor(const std::string& topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assigned_.find(topic);
+    if (it != assigned_.end()) {
+        return it->second;
+    }
+    rclcpp::CallbackGroup::SharedPtr callback_group = ungrouped_;
+    for (auto& group : groups_) {
+        bool matched = false;
+        for (const auto& pattern : group.patterns) {
+            if (std::regex_search(topic, pattern)) {
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            continue;
+        }
+        const size_t lane = group.next_lane++ % group.lanes.size();
+        callback_group = group.lanes[lane].callback_group;
+        AD_INFO(ExecutorTopology, "Topic %s -> group %s, thread %d", topic.c_str(), group.config.name.c_str(),
+                static_cast<int>(lane));
+        break;
+    }
+    assigned_[topic] = callback_group;
+    return callback_group;
+}
+
+void ExecutorTopology::ApplyPriority(const std::string& group, int priority) {
+    if (priority <= 0) {
+        return;
+    }
+    sched_param param{};
+    param.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        // 需要CAP_SYS_NICE或rtprio限制允许，失败时以普通调度运行
+        AD_WARN(ExecutorTopology, "Group %s: set SCHED_FIFO %d failed: %s", group.c_str(), priority,
+                strerror(ret));
+    }
+}
+
+void ExecutorTopology::Spin() {
+    if (!node_ || spinning_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& group : groups_) {
+            group.threads = std::make_unique<ThreadPool>(group.lanes.size());
+            if (!group.config.cores.empty() && !group.threads->bind_core(group.config.cores)) {
+                AD_WARN(ExecutorTopology, "Group %s: bind cores failed.", group.config.name.c_str());
+            }
+            for (const auto& lane : group.lanes) {
+                group.threads->enqueue([name = group.config.name, priority = group.config.priority,
+                                        executor = lane.executor] {
+                    ApplyPriority(name, priority);
+                    executor->spin();
+                });
+            }
+        }
+        if (config_.type == "multiThreaded") {
+            multi_executor_ = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+                rclcpp::ExecutorOptions(), static_cast<size_t>(std::max(config_.threads, 0)));
+            multi_executor_->add_node(node_);
+        } else {
+            single_executor_ = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+            single_executor_->add_node(node_);
+        }
+    }
+    AD_INFO(ExecutorTopology, "Spin %s executor with %d groups", config_.type.c_str(),
+            static_cast<int>(groups_.size()));
+    if (multi_executor_) {
+        multi_executor_->spin();
+    } else {
+        single_executor_->spin();
+    }
+
+    Stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& group : groups_) {
+        group.threads.reset();
+    }
+    spinning_ = false;
+}
+
+void ExecutorTopology::Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (multi_executor_) {
+        multi_executor_->cancel();
+    }
+    if (single_executor_) {
+        single_executor_->cancel();
+    }
+    for (auto& group : groups_) {
+        for (auto& lane : group.lanes) {
+            lane.executor->cancel();
+        }
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+//
+// Created by xucong on 25-10-3.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef EXECUTOR_TOPOLOGY_H
+#define EXECUTOR_TOPOLOGY_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ThreadPool/ThreadPool.h"
+#include "common/config/app_config.h"
+
+namespace dcp::channel {
+
+/**
+ * @brief ROS回调的线程拓扑：不属于任何分组的topic和定时器放在一个Reentrant回调组里，
+ *        与节点默认回调组一起由主executor（single/multi threaded）服务；
+ *        每个配置的topic分组（sensors、signals、commands...）有独立的线程和executor。
+ *
+ * 分组内每个线程对应一个MutuallyExclusive回调组和一个SingleThreadedExecutor，
+ * 线程来自一个ThreadPool，用bind_core逐个绑核，并可设置SCHED_FIFO优先级。
+ * 分组内的topic轮流分配到各线程，同一topic的回调始终在同一线程上串行执行。
+ * 这样关键信号的接收不会排在相机等大流量topic或落盘等重负载回调之后。
+ * 节点默认回调组是MutuallyExclusive，multiThreaded主executor的多个线程也只能逐个执行
+ * 其中的回调，所以未分组的回调不放在默认组。Reentrant组内同一topic的回调可能并发、
+ * 不保证按到达顺序执行，对顺序敏感的topic应配置到分组里。
+ */
+class ExecutorTopology {
+public:
+    ExecutorTopology() = default;
+    ~ExecutorTopology();
+
+    // 创建各分组的回调组，需在创建订阅之前调用
+    bool Init(const std::shared_ptr<rclcpp::Node>& node, const common::AppConfigData::Executor& config);
+
+    // topic所属分组的回调组；不属于任何分组时返回UngroupedCallbackGroup()
+    rclcpp::CallbackGroup::SharedPtr CallbackGroupFor(const std::string& topic);
+
+    // 主executor上的Reentrant回调组，供未分组的订阅和定时器使用；Init之前为nullptr
+    rclcpp::CallbackGroup::SharedPtr UngroupedCallbackGroup() const { return ungrouped_; }
+
+    // 启动分组线程并在当前线程上运行主executor，直到Stop或rclcpp shutdown
+    void Spin();
+
+    void Stop();
+
+private:
+    struct Lane {
+        rclcpp::CallbackGroup::SharedPtr callback_group;
+        std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> executor;
+    };
+
+    struct Group {
+        common::AppConfigData::Executor::Group config;
+        std::vector<std::regex> patterns;
+        std::vector<Lane> lanes;
+        size_t next_lane = 0;
+        std::unique_ptr<ThreadPool> threads;
+    };
+
+    static void ApplyPriority(const std::string& group, int priority);
+
+    std::shared_ptr<rclcpp::Node> node_;
+    common::AppConfigData::Executor config_;
+    std::vector<Group> groups_;
+    rclcpp::CallbackGroup::SharedPtr ungrouped_;
+    std::unordered_map<std::string, rclcpp::CallbackGroup::SharedPtr> assigned_;  // topic -> 回调组，重订阅时保持不变
+    std::mutex mutex_;
+    std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> single_executor_;
+    std::shared_ptr<rclcpp::executors::MultiThreadedExecutor> multi_executor_;
+    std::atomic<bool> spinning_{false};
+};
+
+}
+
+#endif // EXECUTOR_TOPOLOGY_H
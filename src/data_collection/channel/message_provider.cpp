@@ -1,41 +1,83 @@
 #include "channel/message_provider.h"
 #include "common/log/logger.h"
 #include "common/base.h"
+#include "trigger/common/condition_evaluator.h"
 
 namespace dcp::channel{
 
 void MessageProvider::OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg)
 {
+    // 配置了signals的topic按CDR偏移直接读取字段，下面的固定解析只作为未配置时的兜底
+    if (signal_slots_ && signal_extractor_.Extract(topic, msg, *signal_slots_, evaluator_.get())) {
+        AD_INFO_FIRST(MessageProvider, topic, "Observed topic: %s", topic.c_str());
+        return;
+    }
+
     ///TODO
     if(topic == "/canbus/vehicle_report")
     {
         updateVehicleInfo(topic, msg);
-        AD_INFO(MessageProvider, "Observed topic: %s", topic.c_str());
+        AD_INFO_FIRST(MessageProvider, topic, "Observed topic: %s", topic.c_str());
     } else if (topic == "/decision_planning/planning_state") {
         // updatePlanningState(topic, idl);
-        AD_INFO(MessageProvider, "Observed topic: %s", topic.c_str());
+        AD_INFO_FIRST(MessageProvider, topic, "Observed topic: %s", topic.c_str());
     }
     else if (topic == "/mcu/vehicle_processing") {
         // updateAebDecelReq(idl);
-        AD_INFO(MessageProvider, "Observed topic: %s", topic.c_str());
+        AD_INFO_FIRST(MessageProvider, topic, "Observed topic: %s", topic.c_str());
     }
     else if (topic == "/mcu/state_machine") {
         // updateMcuDrvOverride(idl);
-        AD_INFO(MessageProvider, "Observed topic: %s", topic.c_str());
+        AD_INFO_FIRST(MessageProvider, topic, "Observed topic: %s", topic.c_str());
     }
 }
 
+void MessageProvider::setSignalSink(const std::shared_ptr<trigger::SignalSlots>& slots,
+                                    const std::shared_ptr<trigger::ConditionEvaluator>& evaluator)
+{
+    signal_slots_ = evaluator ? evaluator->slots() : slots;
+    evaluator_ = evaluator;
+}
+
+bool MessageProvider::configureSignals(const std::vector<trigger::SignalSource>& signals)
+{
+    return signal_extractor_.Configure(signals, signal_slots_);
+}
+
 void MessageProvider::updateVehicleInfo(const std::string& topic, const rclcpp::SerializedMessage& msg)
 {
-    data_collection::msg::JointCommand joint_cmd;
-    rclcpp::Serialization<data_collection::msg::JointCommand> serialization;
-    serialization.deserialize_message(&msg, &joint_cmd);
-    updateJointCmd(joint_cmd);
+    // 同一条消息的其他观察者复用这次解码结果
+    const auto joint_cmd = DecodeCache::Get<data_collection::msg::JointCommand>(msg);
+    updateJointCmd(*joint_cmd);
 }
 
 void MessageProvider::updateJointCmd(const data_collection::msg::JointCommand& joint_cmd)
 {
-    AD_INFO(MessageProvider, "joint_cmd : %d", joint_cmd.position[0]);
+    AD_INFO_EVERY_N(MessageProvider, 100, "joint_cmd : %d", joint_cmd.position[0]);
+    publishSignals("joint_position_", joint_cmd.position, joint_position_slots_);
+    publishSignals("joint_velocity_", joint_cmd.velocity, joint_velocity_slots_);
+    publishSignals("joint_effort_", joint_cmd.effort, joint_effort_slots_);
+}
+
+void MessageProvider::publishSignals(const std::string& prefix, const std::vector<double>& values,
+                                     std::vector<uint32_t>& slots)
+{
+    if (!signal_slots_) {
+        return;
+    }
+    while (slots.size() < values.size()) {
+        slots.push_back(signal_slots_->intern(prefix + std::to_string(slots.size())));
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (slots[i] == trigger::SignalSlots::kInvalidSlot) {
+            continue;
+        }
+        if (evaluator_) {
+            evaluator_->update(slots[i], values[i]);
+        } else {
+            signal_slots_->set(slots[i], values[i]);
+        }
+    }
 }
 //
 // void MessageProvider::updateGear(const senseAD::idl::vehicle::VehicleReport::Reader& report)
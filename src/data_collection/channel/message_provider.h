@@ -3,6 +3,7 @@
 #include <atomic>
 #include "common/base.h"
 #include "channel/observer.h"
+#include "channel/signal_extractor.h"
 // #include "ad_rscl/common/message_print.h"
 // #include "ad_rscl/ad_rscl.h"
 //
@@ -10,6 +11,11 @@
 // #include "ad_msg_idl/ad_planning/planning.capnp.h"
 #include "data_collection/msg/joint_command.hpp"
 
+namespace dcp::trigger {
+class SignalSlots;
+class ConditionEvaluator;
+}
+
 namespace dcp::channel{
 
 class MessageProvider : public Observer {
@@ -19,6 +25,20 @@ public:
     virtual ~MessageProvider() = default;
 
     void OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg) override;
+
+    /**
+     * @brief 设置信号输出：解析出的信号按名字intern为槽位后写入。
+     *        evaluator非空时经它写入，值变化才唤醒依赖该信号的trigger；否则直接写槽位
+     */
+    void setSignalSink(const std::shared_ptr<trigger::SignalSlots>& slots,
+                       const std::shared_ptr<trigger::ConditionEvaluator>& evaluator);
+
+    /**
+     * @brief 重建字段读取计划，需在setSignalSink之后调用
+     * @param signals enabled策略条件实际引用的信号（StrategyAnalysis::signals）
+     * @return 所有信号都解析成功返回true
+     */
+    bool configureSignals(const std::vector<trigger::SignalSource>& signals);
     // dcp::any getGear(){return static_cast<int32_t>(gear_.load());}
     // dcp::any getVehicleState(){return static_cast<int32_t>(vehicle_state_.load());}
     // dcp::any getAutoModeEnable() {return autoModeEnable_.load();}
@@ -36,6 +56,10 @@ private:
                            const rclcpp::SerializedMessage& msg);
 
     void updateJointCmd(const data_collection::msg::JointCommand& msg);
+
+    // 数组信号按 prefix+下标 命名，槽位首次出现时intern并缓存
+    void publishSignals(const std::string& prefix, const std::vector<double>& values,
+                        std::vector<uint32_t>& slots);
     //
     // void updateGear(const senseAD::idl::vehicle::VehicleReport::Reader& report);
     // void updateAutoModeEnable(const senseAD::idl::vehicle::VehicleReport::Reader& report);
@@ -52,6 +76,12 @@ private:
 
 private:
     std::shared_ptr<rclcpp::Node> node_{nullptr};
+    std::shared_ptr<trigger::SignalSlots> signal_slots_{nullptr};
+    std::shared_ptr<trigger::ConditionEvaluator> evaluator_{nullptr};
+    std::vector<uint32_t> joint_position_slots_;
+    std::vector<uint32_t> joint_velocity_slots_;
+    std::vector<uint32_t> joint_effort_slots_;
+    SignalExtractor signal_extractor_;
     /// signals
     // std::atomic<senseAD::idl::vehicle::GearCommand> gear_{senseAD::idl::vehicle::GearCommand::GEAR_NONE};
     // std::atomic<senseAD::idl::planning::PlanningState::VehicleState> vehicle_state_{senseAD::idl::planning::PlanningState::VehicleState::DISACTIVE};
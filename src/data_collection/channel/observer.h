@@ -7,6 +7,7 @@
 #ifndef OBSERVER_H
 #define OBSERVER_H
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 #include <memory>
@@ -24,6 +25,8 @@
 using TRawMessagePtr = std::shared_ptr<ReceivedMsg<senseAD::rscl::comm::RawMessage>>;
 #endif
 
+#include "channel/decode_cache.h"
+
 namespace dcp::channel
 {
 
@@ -35,19 +38,26 @@ public:
     virtual void OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& subject) = 0;
 };
 
+// 观察者列表写时复制：策略热更新时增删观察者，订阅回调线程中的notifyAll不加锁
 class Subject {
 public:
     virtual~Subject() = default;
 
     void addObserver(std::shared_ptr<Observer> observer) {
-        observers_.emplace_back(observer);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto observers = std::make_shared<ObserverList>(*std::atomic_load(&observers_));
+        observers->emplace_back(std::move(observer));
+        std::atomic_store(&observers_, std::shared_ptr<const ObserverList>(std::move(observers)));
     }
 
 
     void removeObserver(const std::shared_ptr<Observer>& observer) {
-        auto iter = std::find(observers_.begin(), observers_.end(), observer);
-        if (iter != observers_.end()) {
-            observers_.erase(iter);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto observers = std::make_shared<ObserverList>(*std::atomic_load(&observers_));
+        auto iter = std::find(observers->begin(), observers->end(), observer);
+        if (iter != observers->end()) {
+            observers->erase(iter);
+            std::atomic_store(&observers_, std::shared_ptr<const ObserverList>(std::move(observers)));
         }
     }
 
@@ -60,15 +70,20 @@ public:
 
     void notifyAll(const std::string& topic, const rclcpp::SerializedMessage& subject) const
     {
-        for (const auto& observer : observers_) {
+        // 本次分发期间各观察者共享同一份解码结果，分发结束即释放
+        DecodeCache::Scope decode_scope(subject);
+        const auto observers = std::atomic_load(&observers_);
+        for (const auto& observer : *observers) {
             observer->OnMessageReceived(topic, subject);
         }
     }
 
-    const std::vector<std::shared_ptr<Observer>>& getObservers() const { return observers_; }
+    std::vector<std::shared_ptr<Observer>> getObservers() const { return *std::atomic_load(&observers_); }
 
 protected:
-    std::vector<std::shared_ptr<Observer>> observers_;
+    using ObserverList = std::vector<std::shared_ptr<Observer>>;
+    std::shared_ptr<const ObserverList> observers_ = std::make_shared<const ObserverList>();
+    std::mutex write_mutex_;
 };
 
 }
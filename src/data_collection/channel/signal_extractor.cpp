@@ -0,0 +1,253 @@
+//
+// Created by xucong on 25-9-29.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "channel/signal_extractor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <rclcpp/typesupport_helpers.hpp>
+#include <rosidl_typesupport_introspection_cpp/field_types.hpp>
+#include <rosidl_typesupport_introspection_cpp/message_introspection.hpp>
+
+#include "common/log/logger.h"
+#include "trigger/common/condition_evaluator.h"
+
+namespace dcp::channel {
+
+namespace {
+
+namespace introspection = rosidl_typesupport_introspection_cpp;
+
+constexpr const char* kIntrospectionIdentifier = "rosidl_typesupport_introspection_cpp";
+
+bool ConvertType(uint8_t type_id, FieldLayout::Type& type) {
+    using Type = FieldLayout::Type;
+    switch (type_id) {
+        case introspection::ROS_TYPE_FLOAT: type = Type::Float; return true;
+        case introspection::ROS_TYPE_DOUBLE: type = Type::Double; return true;
+        case introspection::ROS_TYPE_LONG_DOUBLE: type = Type::LongDouble; return true;
+        case introspection::ROS_TYPE_CHAR: type = Type::Char; return true;
+        case introspection::ROS_TYPE_WCHAR: type = Type::WString; return true;
+        case introspection::ROS_TYPE_BOOLEAN: type = Type::Bool; return true;
+        case introspection::ROS_TYPE_OCTET: type = Type::Octet; return true;
+        case introspection::ROS_TYPE_UINT8: type = Type::UInt8; return true;
+        case introspection::ROS_TYPE_INT8: type = Type::Int8; return true;
+        case introspection::ROS_TYPE_UINT16: type = Type::UInt16; return true;
+        case introspection::ROS_TYPE_INT16: type = Type::Int16; return true;
+        case introspection::ROS_TYPE_UINT32: type = Type::UInt32; return true;
+        case introspection::ROS_TYPE_INT32: type = Type::Int32; return true;
+        case introspection::ROS_TYPE_UINT64: type = Type::UInt64; return true;
+        case introspection::ROS_TYPE_INT64: type = Type::Int64; return true;
+        case introspection::ROS_TYPE_STRING: type = Type::String; return true;
+        case introspection::ROS_TYPE_WSTRING: type = Type::WString; return true;
+        case introspection::ROS_TYPE_MESSAGE: type = Type::Message; return true;
+        default: return false;
+    }
+}
+
+// introspection成员表转换为FieldLayout；嵌套消息的members_指向同一类型支持下的子表
+bool ConvertMembers(const introspection::MessageMembers* members, FieldLayout& layout, int depth) {
+    if (members == nullptr || depth > 32) {
+        return false;
+    }
+    layout.type = FieldLayout::Type::Message;
+    layout.members.resize(members->member_count_);
+    for (uint32_t i = 0; i < members->member_count_; ++i) {
+        const auto& member = members->members_[i];
+        FieldLayout& field = layout.members[i];
+        field.name = member.name_;
+        if (!ConvertType(member.type_id_, field.type)) {
+            return false;
+        }
+        if (member.is_array_) {
+            const bool fixed = member.array_size_ > 0 && !member.is_upper_bound_;
+            field.container = fixed ? FieldLayout::Container::Array : FieldLayout::Container::Sequence;
+            field.arraySize = fixed ? static_cast<uint32_t>(member.array_size_) : 0;
+        }
+        if (field.type == FieldLayout::Type::Message) {
+            if (member.members_ == nullptr ||
+                !ConvertMembers(static_cast<const introspection::MessageMembers*>(member.members_->data), field,
+                                depth + 1)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+const FieldLayout* SignalExtractor::LoadLayout(const std::string& type) {
+    auto it = layouts_.find(type);
+    if (it != layouts_.end()) {
+        return &it->second;
+    }
+    FieldLayout layout;
+    try {
+        auto library = rclcpp::get_typesupport_library(type, kIntrospectionIdentifier);
+        const auto* handle = rclcpp::get_typesupport_handle(type, kIntrospectionIdentifier, *library);
+        if (!handle || !ConvertMembers(static_cast<const introspection::MessageMembers*>(handle->data),
+                                       layout, 0)) {
+            AD_ERROR(SignalExtractor, "Unsupported introspection layout for type: %s", type.c_str());
+            return nullptr;
+        }
+    } catch (const std::exception& e) {
+        AD_ERROR(SignalExtractor, "Load introspection type support for %s failed: %s", type.c_str(), e.what());
+        return nullptr;
+    }
+    return &(layouts_[type] = std::move(layout));
+}
+
+bool SignalExtractor::MakeFilter(const trigger::SignalSource& signal, common::SignalBank::Options& options,
+                                 bool& median) {
+    using Filter = common::SignalBank::Filter;
+    if (signal.periodMs <= 0 || signal.responseMs <= 0) {
+        return false;
+    }
+    options.samplingPeriodS = signal.periodMs / 1000.0;
+    options.responseTimeS = signal.responseMs / 1000.0;
+    median = false;
+    if (signal.filter == "ema") {
+        options.filter = Filter::Ema;
+    } else if (signal.filter == "sma") {
+        options.filter = Filter::Sma;
+    } else if (signal.filter == "kalman") {
+        options.filter = Filter::Kalman;
+    } else if (signal.filter == "median") {
+        // 只取中值，均值部分用开销最小的Ema
+        options.filter = Filter::Ema;
+        options.medianWindow = std::max<size_t>(1, static_cast<size_t>(std::lround(
+            static_cast<double>(signal.responseMs) / signal.periodMs)));
+        median = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SignalExtractor::Configure(const std::vector<trigger::SignalSource>& signals,
+                                const std::shared_ptr<trigger::SignalSlots>& slots) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    auto table = std::make_shared<Table>();
+    bool ok = true;
+    for (const auto& signal : signals) {
+        if (!slots) {
+            ok = false;
+            break;
+        }
+        if (signal.type.empty()) {
+            AD_ERROR(SignalExtractor, "Signal %s: no message type for topic %s", signal.name.c_str(),
+                     signal.topic.c_str());
+            ok = false;
+            continue;
+        }
+        const FieldLayout* layout = LoadLayout(signal.type);
+        if (!layout) {
+            ok = false;
+            continue;
+        }
+        Binding binding;
+        if (!binding.plan.Compile(*layout, signal.fieldPath)) {
+            AD_ERROR(SignalExtractor, "Signal %s: resolve %s in %s failed: %s", signal.name.c_str(),
+                     signal.fieldPath.c_str(), signal.type.c_str(), binding.plan.LastError().c_str());
+            ok = false;
+            continue;
+        }
+        binding.slot = slots->intern(signal.name);
+        if (binding.slot == trigger::SignalSlots::kInvalidSlot) {
+            AD_ERROR(SignalExtractor, "Signal %s: no free signal slot", signal.name.c_str());
+            ok = false;
+            continue;
+        }
+        binding.name = signal.name;
+        auto& topic = (*table)[signal.topic];
+        if (!signal.filter.empty()) {
+            FilterGroup group;
+            if (!MakeFilter(signal, group.options, group.median)) {
+                AD_ERROR(SignalExtractor, "Signal %s: invalid filter %s, period %d ms, response %d ms",
+                         signal.name.c_str(), signal.filter.c_str(), signal.periodMs, signal.responseMs);
+                ok = false;
+                continue;
+            }
+            group.key = signal.filter + "/" + std::to_string(signal.periodMs) + "/" + std::to_string(signal.responseMs);
+            auto it = std::find_if(topic.groups.begin(), topic.groups.end(),
+                                   [&](const FilterGroup& g) { return g.key == group.key; });
+            if (it == topic.groups.end()) {
+                it = topic.groups.insert(topic.groups.end(), std::move(group));
+            }
+            binding.group = static_cast<int>(it - topic.groups.begin());
+            binding.channel = it->bindings.size();
+            it->bindings.push_back(topic.bindings.size());
+        }
+        AD_INFO(SignalExtractor, "Signal %s <- %s.%s (%s offset%s%s)", signal.name.c_str(), signal.topic.c_str(),
+                signal.fieldPath.c_str(), binding.plan.IsFixedOffset() ? "fixed" : "dynamic",
+                signal.filter.empty() ? "" : ", ", signal.filter.c_str());
+        topic.bindings.push_back(std::move(binding));
+    }
+    for (auto& [name, topic] : *table) {
+        for (auto& group : topic.groups) {
+            group.state = std::make_shared<FilterState>(group.bindings.size(), group.options);
+        }
+    }
+    std::atomic_store(&table_, std::shared_ptr<const Table>(std::move(table)));
+    return ok;
+}
+
+bool SignalExtractor::Extract(const std::string& topic, const rclcpp::SerializedMessage& msg,
+                              trigger::SignalSlots& slots, trigger::ConditionEvaluator* evaluator) const {
+    auto table = std::atomic_load(&table_);
+    if (!table) {
+        return false;
+    }
+    auto it = table->find(topic);
+    if (it == table->end()) {
+        return false;
+    }
+    const auto& plan = it->second;
+    const auto& raw = msg.get_rcl_serialized_message();
+    const auto write = [&](uint32_t slot, double value) {
+        if (evaluator) {
+            evaluator->update(slot, value);
+        } else {
+            slots.set(slot, value);
+        }
+    };
+    const auto read = [&](const Binding& binding, double& value) {
+        if (binding.plan.Read(raw.buffer, raw.buffer_length, value)) {
+            return true;
+        }
+        AD_WARN_FIRST(SignalExtractor, binding.name, "Signal %s: read failed on %s, length %d",
+                      binding.name.c_str(), topic.c_str(), static_cast<int>(raw.buffer_length));
+        return false;
+    };
+    for (const auto& binding : plan.bindings) {
+        double value = 0.0;
+        if (binding.group < 0 && read(binding, value)) {
+            write(binding.slot, value);
+        }
+    }
+    for (const auto& group : plan.groups) {
+        auto& state = *group.state;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        bool complete = true;
+        for (size_t channel = 0; channel < group.bindings.size(); ++channel) {
+            complete = read(plan.bindings[group.bindings[channel]], state.frame[channel]) && complete;
+        }
+        // 有字段读取失败的帧整组跳过，不把缺失值喂进滤波器
+        if (!complete) {
+            continue;
+        }
+        state.bank.update(state.frame);
+        for (size_t channel = 0; channel < group.bindings.size(); ++channel) {
+            write(plan.bindings[group.bindings[channel]].slot,
+                  group.median ? state.bank.median(channel) : state.bank.value(channel));
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,99 @@
+//
+// Created by xucong on 25-9-29.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef SIGNAL_EXTRACTOR_H
+#define SIGNAL_EXTRACTOR_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include "channel/cdr_field_plan.h"
+#include "common/signal/signal_bank.h"
+#include "trigger/strategy_parser/strategy_config.h"
+
+namespace dcp::trigger {
+class SignalSlots;
+class ConditionEvaluator;
+}
+
+namespace dcp::channel {
+
+/**
+ * @brief 按策略中的signals配置，从序列化消息中直接读取trigger变量。
+ *
+ * Configure时通过rosidl_typesupport_introspection_cpp加载消息布局，把每个
+ * "topic.字段路径" 编译为CdrFieldPlan并intern为信号槽位；收到消息时只按计划读取
+ * 这几个字段，不做完整反序列化。读取表整体替换（copy-on-write），热更新时
+ * 回调线程无需加锁。
+ * 配置了filter的信号写入平滑后的值：同一topic上filter和时间参数相同的信号组成一个
+ * SignalBank，每条消息是一帧，一次update完成整组；滤波状态随读取表重建而重置。
+ */
+class SignalExtractor {
+public:
+    SignalExtractor() = default;
+
+    /**
+     * @brief 重建读取表，解析失败的信号记录错误并跳过
+     * @return 所有信号都编译成功返回true
+     */
+    bool Configure(const std::vector<trigger::SignalSource>& signals,
+                   const std::shared_ptr<trigger::SignalSlots>& slots);
+
+    /**
+     * @brief 读取topic上配置的信号并写入槽位
+     * @return topic配置了信号返回true（不论本条消息是否读取成功）
+     */
+    bool Extract(const std::string& topic, const rclcpp::SerializedMessage& msg,
+                 trigger::SignalSlots& slots, trigger::ConditionEvaluator* evaluator) const;
+
+private:
+    struct Binding {
+        CdrFieldPlan plan;
+        uint32_t slot;
+        std::string name;
+        int group = -1;      // 平滑分组，-1写原值
+        size_t channel = 0;  // 在分组中的通道
+    };
+    // 同一topic的回调可能并发，滤波状态单独加锁
+    struct FilterState {
+        FilterState(size_t channels, const common::SignalBank::Options& options)
+            : bank(channels, options), frame(channels, 0.0) {}
+        std::mutex mutex;
+        common::SignalBank bank;
+        std::vector<double> frame;
+    };
+    struct FilterGroup {
+        std::string key;               // filter/periodMs/responseMs
+        bool median = false;
+        common::SignalBank::Options options;
+        std::vector<size_t> bindings;  // 按通道顺序
+        std::shared_ptr<FilterState> state;
+    };
+    struct TopicPlan {
+        std::vector<Binding> bindings;
+        std::vector<FilterGroup> groups;
+    };
+    using Table = std::unordered_map<std::string, TopicPlan>;
+
+    // filter名和时间参数转换为SignalBank配置
+    static bool MakeFilter(const trigger::SignalSource& signal, common::SignalBank::Options& options, bool& median);
+
+    // 布局在加载时整体拷贝出来，之后不再引用类型支持库
+    const FieldLayout* LoadLayout(const std::string& type);
+
+    std::mutex config_mutex_;
+    std::shared_ptr<const Table> table_;
+    std::unordered_map<std::string, FieldLayout> layouts_;
+};
+
+}
+
+#endif // SIGNAL_EXTRACTOR_H
@@ -0,0 +1,226 @@
+//
+// Created by xucong on 25-10-4.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "channel/topic_profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "common/log/logger.h"
+#include "common/metrics/metrics_recorder.h"
+#include "common/metrics/metrics_registry.h"
+
+namespace dcp::channel {
+
+namespace {
+
+constexpr double kPeakDecay = 0.95;
+constexpr double kRateMismatch = 0.5;  // 实测与声明相差超过50%告警
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t SystemNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 序列名只保留字母数字，/camera/front -> topic_camera_front
+std::string SeriesName(const std::string& topic) {
+    std::string name = "topic";
+    for (char c : topic) {
+        name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    name.erase(std::unique(name.begin(), name.end(), [](char a, char b) { return a == '_' && b == '_'; }),
+               name.end());
+    if (name.back() == '_') {
+        name.pop_back();
+    }
+    return name;
+}
+
+}
+
+TopicProfiler::Probe::Probe(const std::string& topic, int configuredRateHz, int64_t windowNs)
+    : topic_(topic), window_ns_(windowNs) {
+    profile_.configuredRateHz = configuredRateHz;
+}
+
+void TopicProfiler::Probe::Record(size_t bytes, int64_t sourceNs, int64_t receivedNs, uint64_t publisher,
+                                  uint64_t sequence) {
+    const int64_t now = SteadyNowNs();
+    const int64_t reference = receivedNs > 0 ? receivedNs : sourceNs;
+    const double lag_ms = reference > 0 ? std::max<int64_t>(SystemNowNs() - reference, 0) / 1e6 : -1.0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Roll(now);
+    ++count_;
+    ++profile_.totalMessages;
+    bytes_ += bytes;
+    if (last_arrival_ns_ > 0) {
+        // Welford增量方差
+        const double interval = (now - last_arrival_ns_) / 1e6;
+        ++intervals_;
+        const double delta = interval - interval_mean_;
+        interval_mean_ += delta / intervals_;
+        interval_m2_ += delta * (interval - interval_mean_);
+    }
+    last_arrival_ns_ = now;
+    if (lag_ms >= 0.0) {
+        ++lag_count_;
+        lag_sum_ms_ += lag_ms;
+        lag_max_ms_ = std::max(lag_max_ms_, lag_ms);
+    }
+    if (sequence != 0) {
+        auto [it, inserted] = last_sequence_.emplace(publisher, sequence);
+        if (!inserted) {
+            if (sequence > it->second + 1) {
+                gaps_ += sequence - it->second - 1;
+            }
+            it->second = sequence;
+        }
+    }
+}
+
+void TopicProfiler::Probe::Roll(int64_t nowNs) {
+    if (window_start_ns_ == 0) {
+        window_start_ns_ = nowNs;
+        return;
+    }
+    const int64_t elapsed_ns = nowNs - window_start_ns_;
+    if (elapsed_ns < window_ns_) {
+        return;
+    }
+    const double elapsed = elapsed_ns / 1e9;
+    profile_.rateHz = count_ / elapsed;
+    profile_.peakRateHz = std::max(profile_.rateHz, profile_.peakRateHz * kPeakDecay);
+    profile_.bytesPerSec = bytes_ / elapsed;
+    profile_.jitterMs = intervals_ > 1 ? std::sqrt(interval_m2_ / (intervals_ - 1)) : 0.0;
+    profile_.lagMsAvg = lag_count_ > 0 ? lag_sum_ms_ / lag_count_ : 0.0;
+    profile_.lagMsMax = lag_max_ms_;
+    profile_.gaps = gaps_;
+    profile_.totalGaps += gaps_;
+
+    const int configured = profile_.configuredRateHz;
+    if (configured > 0 && count_ > 0 && std::fabs(profile_.rateHz - configured) > configured * kRateMismatch) {
+        AD_WARN_FIRST(TopicProfiler, topic_, "Topic %s: measured %.1fHz, configured %dHz", topic_.c_str(),
+                      profile_.rateHz, configured);
+    }
+
+    window_start_ns_ = nowNs;
+    count_ = 0;
+    bytes_ = 0;
+    intervals_ = 0;
+    interval_mean_ = 0.0;
+    interval_m2_ = 0.0;
+    lag_count_ = 0;
+    lag_sum_ms_ = 0.0;
+    lag_max_ms_ = 0.0;
+    gaps_ = 0;
+}
+
+TopicProfile TopicProfiler::Probe::Snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // topic停发时也要结算窗口，频率降为0
+    Roll(SteadyNowNs());
+    return profile_;
+}
+
+TopicProfiler& TopicProfiler::getInstance() {
+    static TopicProfiler instance;
+    return instance;
+}
+
+TopicProfiler::TopicProfiler() {
+    common::MetricsRegistry::getInstance().AddCollector([this] { Collect(); });
+}
+
+void TopicProfiler::Collect() {
+    std::vector<std::shared_ptr<Probe>> probes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [topic, probe] : probes_) {
+            probes.push_back(probe);
+        }
+    }
+    auto& registry = common::MetricsRegistry::getInstance();
+    for (const auto& probe : probes) {
+        const TopicProfile profile = probe->Snapshot();
+        const common::MetricLabels labels = {{"topic", probe->topic()}};
+        registry.GetGauge("dcp_topic_rate_hz", "Measured message rate of the last window.", labels)
+            ->Set(profile.rateHz);
+        registry.GetGauge("dcp_topic_bytes_per_second", "Measured bandwidth of the last window.", labels)
+            ->Set(profile.bytesPerSec);
+        registry.GetGauge("dcp_topic_jitter_seconds", "Inter-arrival standard deviation of the last window.", labels)
+            ->Set(profile.jitterMs / 1e3);
+        registry.GetGauge("dcp_topic_lag_seconds", "Average middleware to callback lag of the last window.", labels)
+            ->Set(profile.lagMsAvg / 1e3);
+        registry.GetGauge("dcp_topic_messages", "Messages received since start.", labels)
+            ->Set(static_cast<double>(profile.totalMessages));
+        registry.GetGauge("dcp_topic_gaps", "Publisher sequence gaps since start.", labels)
+            ->Set(static_cast<double>(profile.totalGaps));
+    }
+}
+
+void TopicProfiler::Configure(bool enabled, int windowMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = enabled;
+    window_ns_ = static_cast<int64_t>(std::max(windowMs, 100)) * 1000000LL;
+}
+
+std::shared_ptr<TopicProfiler::Probe> TopicProfiler::Register(const std::string& topic, int configuredRateHz) {
+    std::shared_ptr<Probe> probe;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!enabled_) {
+            return nullptr;
+        }
+        auto it = probes_.find(topic);
+        if (it != probes_.end()) {
+            return it->second;
+        }
+        probe = std::make_shared<Probe>(topic, configuredRateHz, window_ns_);
+        probes_.emplace(topic, probe);
+    }
+    common::MetricsRecorder::getInstance().RegisterSampler(
+        SeriesName(topic), {"rate_hz", "bytes_per_sec", "jitter_ms", "lag_ms_avg", "lag_ms_max", "gaps"},
+        [probe](double* values) {
+            const TopicProfile profile = probe->Snapshot();
+            values[0] = profile.rateHz;
+            values[1] = profile.bytesPerSec;
+            values[2] = profile.jitterMs;
+            values[3] = profile.lagMsAvg;
+            values[4] = profile.lagMsMax;
+            values[5] = static_cast<double>(profile.gaps);
+        });
+    return probe;
+}
+
+bool TopicProfiler::Get(const std::string& topic, TopicProfile& profile) {
+    std::shared_ptr<Probe> probe;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = probes_.find(topic);
+        if (it == probes_.end()) {
+            return false;
+        }
+        probe = it->second;
+    }
+    profile = probe->Snapshot();
+    return true;
+}
+
+double TopicProfiler::MeasuredRate(const std::string& topic) {
+    TopicProfile profile;
+    return Get(topic, profile) ? profile.peakRateHz : 0.0;
+}
+
+}
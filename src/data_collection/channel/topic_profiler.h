@@ -0,0 +1,113 @@
+//
+// Created by xucong on 25-10-4.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef TOPIC_PROFILER_H
+#define TOPIC_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dcp::channel {
+
+// 一个统计窗口内的实测数据
+struct TopicProfile {
+    double rateHz = 0.0;        // 消息频率
+    double peakRateHz = 0.0;    // 近期窗口频率的峰值，每个窗口衰减5%
+    double bytesPerSec = 0.0;   // 码率
+    double jitterMs = 0.0;      // 到达间隔的标准差
+    double lagMsAvg = 0.0;      // 中间件收到到回调执行的延迟
+    double lagMsMax = 0.0;
+    uint64_t gaps = 0;          // 本窗口内publisher序号缺口（丢失消息数）
+    uint64_t totalMessages = 0;
+    uint64_t totalGaps = 0;
+    int configuredRateHz = 0;   // 策略中声明的originalFrameRate，0为未声明
+};
+
+/**
+ * @brief 订阅topic的实测频率、码率、抖动、丢包和回调延迟。
+ *
+ * ChannelManager为每个订阅Register一个Probe，订阅回调在调用观察者之前Record一次，
+ * 只做窗口内的累加；窗口（windowMs）结束时结算出TopicProfile。各Probe的窗口数据
+ * 通过MetricsRecorder的sampler导出为topic_<name>序列，同时作为dcp_topic_*{topic="..."}
+ * 由MetricsRegistry导出；录制缓冲区按实测峰值频率调整容量。
+ * 实测频率与声明频率相差一半以上时告警一次。
+ */
+class TopicProfiler {
+public:
+    class Probe {
+    public:
+        Probe(const std::string& topic, int configuredRateHz, int64_t windowNs);
+
+        /**
+         * @param bytes 序列化消息大小
+         * @param sourceNs 发布时间（系统时钟），0为未知
+         * @param receivedNs 中间件收到时间（系统时钟），0为未知
+         * @param publisher publisher标识，区分多个publisher的序号
+         * @param sequence publisher序号，0为rmw不支持
+         */
+        void Record(size_t bytes, int64_t sourceNs, int64_t receivedNs, uint64_t publisher, uint64_t sequence);
+
+        TopicProfile Snapshot();
+
+        const std::string& topic() const { return topic_; }
+
+    private:
+        void Roll(int64_t nowNs);
+
+        std::string topic_;
+        int64_t window_ns_;
+        std::mutex mutex_;
+
+        // 当前窗口的累加
+        int64_t window_start_ns_ = 0;
+        int64_t last_arrival_ns_ = 0;
+        uint64_t count_ = 0;
+        uint64_t bytes_ = 0;
+        uint64_t intervals_ = 0;
+        double interval_mean_ = 0.0;
+        double interval_m2_ = 0.0;
+        uint64_t lag_count_ = 0;
+        double lag_sum_ms_ = 0.0;
+        double lag_max_ms_ = 0.0;
+        uint64_t gaps_ = 0;
+        std::unordered_map<uint64_t, uint64_t> last_sequence_;
+
+        TopicProfile profile_;
+    };
+
+    static TopicProfiler& getInstance();
+
+    void Configure(bool enabled, int windowMs);
+
+    // 同一topic返回同一Probe，重订阅后统计连续；未启用时返回nullptr
+    std::shared_ptr<Probe> Register(const std::string& topic, int configuredRateHz);
+
+    bool Get(const std::string& topic, TopicProfile& profile);
+
+    // 近期峰值频率，未订阅或尚无完整窗口时为0
+    double MeasuredRate(const std::string& topic);
+
+private:
+    TopicProfiler();
+
+    void Collect();
+    TopicProfiler(const TopicProfiler&) = delete;
+    TopicProfiler& operator=(const TopicProfiler&) = delete;
+
+    bool enabled_ = true;
+    int64_t window_ns_ = 1000000000LL;
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Probe>> probes_;
+};
+
+}
+
+#endif // TOPIC_PROFILER_H
@@ -11,6 +11,8 @@
 #include <iostream>
 #include <filesystem>
 
+#include "common/log/logger.h"
+
 namespace dcp::common{
 
 AppConfig& AppConfig::getInstance() {
@@ -19,12 +21,23 @@ AppConfig& AppConfig::getInstance() {
 }
 
 bool AppConfig::Init(const std::string& filePath) {
-    if (!checkFileExists(filePath)) {
+    filePath_ = filePath;
+    auto parsed = std::make_shared<AppConfigData>();
+    if (!Load(*parsed)) {
+        return false;
+    }
+    std::cout << "AppConfig CheckValid is true"  << std::endl;
+    Publish(std::move(parsed));
+    return true;
+}
+
+bool AppConfig::Load(AppConfigData& parsed) {
+    if (!checkFileExists(filePath_)) {
         std::cerr << "Error: Configuration file does not exist." << std::endl;
         return false;
     }
 
-    std::ifstream file(filePath);
+    std::ifstream file(filePath_);
     if (!file.is_open()) {
         std::cerr << "Error: Failed to open configuration file." << std::endl;
         return false;
@@ -38,69 +51,229 @@ bool AppConfig::Init(const std::string& filePath) {
         return false;
     }
 
-    std::cout << "AppConfig CheckValid is true"  << std::endl;
+    try {
+        return Parse(nlohmann::json::parse(jsonString), parsed);
+    } catch (const nlohmann::json::exception& e) {
+        // 必需字段类型错误等，整份配置作废
+        std::cerr << "Error: Configuration parse failed: " << e.what() << std::endl;
+        return false;
+    }
+}
 
-    configData = nlohmann::json::parse(jsonString);
+bool AppConfig::Parse(nlohmann::json configData, AppConfigData& parsed) const {
     // DataStorage
-    parsedConfig.dataStorage.rollingDeleteThreshold = (int8_t)configData["dataStorage"]["rollingDeleteThreshold"];
-    parsedConfig.dataStorage.rollInterval = (int8_t)configData["dataStorage"]["rollInterval"];
-    parsedConfig.dataStorage.bagInterval = (int8_t)configData["dataStorage"]["bagInterval"];
-    parsedConfig.dataStorage.capacityMb = (uint64_t)configData["dataStorage"]["capacityMb"];
-    parsedConfig.dataStorage.requriedSpaceMb = (uint64_t)configData["dataStorage"]["requiredSpaceMb"];
-    parsedConfig.dataStorage.storagePaths["bagPath"] = configData["dataStorage"]["storagePaths"]["bagPath"];
-    parsedConfig.dataStorage.storagePaths["encPath"] = configData["dataStorage"]["storagePaths"]["encPath"];
+    parsed.dataStorage.rollingDeleteThreshold = (int8_t)configData["dataStorage"]["rollingDeleteThreshold"];
+    parsed.dataStorage.rollInterval = (int8_t)configData["dataStorage"]["rollInterval"];
+    parsed.dataStorage.bagInterval = (int8_t)configData["dataStorage"]["bagInterval"];
+    parsed.dataStorage.capacityMb = (uint64_t)configData["dataStorage"]["capacityMb"];
+    parsed.dataStorage.requriedSpaceMb = (uint64_t)configData["dataStorage"]["requiredSpaceMb"];
+    parsed.dataStorage.storagePaths["bagPath"] = configData["dataStorage"]["storagePaths"]["bagPath"];
+    parsed.dataStorage.storagePaths["encPath"] = configData["dataStorage"]["storagePaths"]["encPath"];
 
     // DataProto
-    parsedConfig.dataProto.vin = configData["dataProto"]["vin"];
-    parsedConfig.dataProto.software_version = configData["dataProto"]["software_version"];
-    parsedConfig.dataProto.hardware_version = configData["dataProto"]["hardware_version"];
-    parsedConfig.dataProto.device = configData["dataProto"]["device"];
-    parsedConfig.dataProto.device_id = configData["dataProto"]["device_id"];
-    parsedConfig.dataProto.mqtt.broker = configData["dataProto"]["mqtt"]["broker"];
-    parsedConfig.dataProto.mqtt.broker_ssl = configData["dataProto"]["mqtt"]["broker_ssl"];
-    parsedConfig.dataProto.mqtt.username = configData["dataProto"]["mqtt"]["username"];
-    parsedConfig.dataProto.mqtt.password = configData["dataProto"]["mqtt"]["password"];
-    parsedConfig.dataProto.mqtt.upTopic = configData["dataProto"]["mqtt"]["upTopic"];
-    parsedConfig.dataProto.mqtt.downTopic = configData["dataProto"]["mqtt"]["downTopic"];
+    parsed.dataProto.vin = configData["dataProto"]["vin"];
+    parsed.dataProto.software_version = configData["dataProto"]["software_version"];
+    parsed.dataProto.hardware_version = configData["dataProto"]["hardware_version"];
+    parsed.dataProto.device = configData["dataProto"]["device"];
+    parsed.dataProto.device_id = configData["dataProto"]["device_id"];
+    parsed.dataProto.mqtt.broker = configData["dataProto"]["mqtt"]["broker"];
+    parsed.dataProto.mqtt.broker_ssl = configData["dataProto"]["mqtt"]["broker_ssl"];
+    parsed.dataProto.mqtt.username = configData["dataProto"]["mqtt"]["username"];
+    parsed.dataProto.mqtt.password = configData["dataProto"]["mqtt"]["password"];
+    parsed.dataProto.mqtt.upTopic = configData["dataProto"]["mqtt"]["upTopic"];
+    parsed.dataProto.mqtt.downTopic = configData["dataProto"]["mqtt"]["downTopic"];
 
     // DataUpload
-    parsedConfig.dataUpload.retryCount = (int8_t)configData["dataUpload"]["retryCount"];
-    parsedConfig.dataUpload.retryIntervalSec = (int64_t)configData["dataUpload"]["retryIntervalSec"];
-    parsedConfig.dataUpload.uploadFileIntervalMs = (int64_t)configData["dataUpload"]["uploadFileIntervalMs"];
-    parsedConfig.dataUpload.uploadFileSliceIntervalMs = (int64_t)configData["dataUpload"]["uploadFileSliceIntervalMs"];
-    parsedConfig.dataUpload.uploadFileSliceSizeMb = (size_t)configData["dataUpload"]["uploadFileSliceSizeMb"];
-    parsedConfig.dataUpload.clientCertPath = configData["dataUpload"]["clientCertPath"];
-    parsedConfig.dataUpload.clientKeyPath = configData["dataUpload"]["clientKeyPath"];
-    parsedConfig.dataUpload.caCertPath = configData["dataUpload"]["caCertPath"];
-    parsedConfig.dataUpload.gateway = std::string(configData["dataUpload"]["gateway"]);
-    parsedConfig.dataUpload.fileRecordPath = configData["dataUpload"]["fileRecordPath"];
-    parsedConfig.dataUpload.filenameRegex = std::string(configData["dataUpload"]["filenameRegex"]);
-    parsedConfig.dataUpload.uploadPaths.emplace("encPath", configData["dataUpload"]["uploadPaths"]["encPath"]);
-    parsedConfig.dataUpload.rsa_pub_key_path = configData["dataUpload"]["publicKeyPath"];
-    parsedConfig.dataUpload.watch_dir = configData["dataUpload"]["uploadPaths"]["bagPath"];
-    parsedConfig.dataUpload.enc_dir = configData["dataUpload"]["uploadPaths"]["encPath"];
+    parsed.dataUpload.retryCount = (int8_t)configData["dataUpload"]["retryCount"];
+    parsed.dataUpload.retryIntervalSec = (int64_t)configData["dataUpload"]["retryIntervalSec"];
+    parsed.dataUpload.uploadFileIntervalMs = (int64_t)configData["dataUpload"]["uploadFileIntervalMs"];
+    parsed.dataUpload.uploadFileSliceIntervalMs = (int64_t)configData["dataUpload"]["uploadFileSliceIntervalMs"];
+    parsed.dataUpload.uploadFileSliceSizeMb = (size_t)configData["dataUpload"]["uploadFileSliceSizeMb"];
+    parsed.dataUpload.clientCertPath = configData["dataUpload"]["clientCertPath"];
+    parsed.dataUpload.clientKeyPath = configData["dataUpload"]["clientKeyPath"];
+    parsed.dataUpload.caCertPath = configData["dataUpload"]["caCertPath"];
+    parsed.dataUpload.gateway = std::string(configData["dataUpload"]["gateway"]);
+    parsed.dataUpload.fileRecordPath = configData["dataUpload"]["fileRecordPath"];
+    parsed.dataUpload.filenameRegex = std::string(configData["dataUpload"]["filenameRegex"]);
+    parsed.dataUpload.uploadPaths.emplace("encPath", configData["dataUpload"]["uploadPaths"]["encPath"]);
+    parsed.dataUpload.rsa_pub_key_path = configData["dataUpload"]["publicKeyPath"];
+    parsed.dataUpload.watch_dir = configData["dataUpload"]["uploadPaths"]["bagPath"];
+    parsed.dataUpload.enc_dir = configData["dataUpload"]["uploadPaths"]["encPath"];
+    parsed.dataUpload.multipartExpireMinutes = configData["dataUpload"].value("multipartExpireMinutes", 4320);
+    const auto stream_config = configData["dataUpload"].value("stream", nlohmann::json::object());
+    parsed.dataUpload.stream.segmentIntervalMs = stream_config.value("segmentIntervalMs", 1000);
+    parsed.dataUpload.stream.segmentMaxKb = stream_config.value("segmentMaxKb", 8192);
+    parsed.dataUpload.stream.minPartKb = stream_config.value("minPartKb", 5120);
+    parsed.dataUpload.stream.maxParts = stream_config.value("maxParts", 64);
+    const auto two_phase_config = configData["dataUpload"].value("twoPhase", nlohmann::json::object());
+    parsed.dataUpload.twoPhase.enabled = two_phase_config.value("enabled", false);
+    parsed.dataUpload.twoPhase.retentionHours = two_phase_config.value("retentionHours", 72);
+    const auto dedup_config = configData["dataUpload"].value("dedup", nlohmann::json::object());
+    parsed.dataUpload.dedup.enabled = dedup_config.value("enabled", false);
+    parsed.dataUpload.dedup.minChunkKb = dedup_config.value("minChunkKb", 512);
+    parsed.dataUpload.dedup.avgChunkKb = dedup_config.value("avgChunkKb", 2048);
+    parsed.dataUpload.dedup.maxChunkKb = dedup_config.value("maxChunkKb", 8192);
 
     // Log
-    parsedConfig.log.logLevel = configData["log"]["LOG_level"];
-    parsedConfig.log.logPattern = configData["log"]["LOG_pattern"];
-    parsedConfig.log.logPath = configData["log"]["LOG_path"];
-    parsedConfig.log.logBasename = configData["log"]["LOG_basename"];
+    parsed.log.logLevel = configData["log"]["LOG_level"];
+    parsed.log.logPattern = configData["log"]["LOG_pattern"];
+    parsed.log.logPath = configData["log"]["LOG_path"];
+    parsed.log.logBasename = configData["log"]["LOG_basename"];
+    parsed.log.binary = configData["log"].value("LOG_binary", false);
+    parsed.log.rateLimits.clear();
+    const auto rate_limit_config = configData["log"].value("LOG_rateLimit", nlohmann::json::object());
+    for (const auto& [tag, limit] : rate_limit_config.items()) {
+        parsed.log.rateLimits[tag] = {limit.value("everyN", 0), limit.value("intervalMs", 0)};
+    }
+
+    // Metrics
+    const auto metrics_config = configData.value("metrics", nlohmann::json::object());
+    parsed.metrics.enabled = metrics_config.value("enabled", false);
+    parsed.metrics.path = metrics_config.value("path", "/tmp/shadow_mode/metrics/");
+    parsed.metrics.flushIntervalMs = metrics_config.value("flushIntervalMs", 1000);
+    parsed.metrics.capacityRows = metrics_config.value("capacityRows", 1024);
+    parsed.metrics.maxFileMb = metrics_config.value("maxFileMb", 64);
+    const auto exporter_config = metrics_config.value("exporter", nlohmann::json::object());
+    parsed.metrics.exporter.enabled = exporter_config.value("enabled", true);
+    parsed.metrics.exporter.unixSocket = exporter_config.value("unixSocket", "/tmp/shadow_mode/metrics.sock");
+    parsed.metrics.exporter.port = exporter_config.value("port", 0);
+
+    // MessagePool
+    const auto pool_config = configData.value("messagePool", nlohmann::json::object());
+    parsed.messagePool.enabled = pool_config.value("enabled", true);
+    parsed.messagePool.threadCacheKb = pool_config.value("threadCacheKb", 1024);
+    parsed.messagePool.slabKb = pool_config.value("slabKb", 256);
+
+    // Executor
+    const auto executor_config = configData.value("executor", nlohmann::json::object());
+    parsed.executor.type = executor_config.value("type", "singleThreaded");
+    parsed.executor.threads = executor_config.value("threads", 0);
+    parsed.executor.groups.clear();
+    for (const auto& group : executor_config.value("groups", nlohmann::json::array())) {
+        AppConfigData::Executor::Group parsed_group;
+        parsed_group.name = group.value("name", "");
+        parsed_group.topics = group.value("topics", std::vector<std::string>{});
+        parsed_group.threads = group.value("threads", 1);
+        parsed_group.cores = group.value("cores", std::vector<int32_t>{});
+        parsed_group.priority = group.value("priority", 0);
+        parsed.executor.groups.push_back(std::move(parsed_group));
+    }
+
+    // Trace
+    const auto trace_config = configData.value("trace", nlohmann::json::object());
+    parsed.trace.enabled = trace_config.value("enabled", true);
+    parsed.trace.capacity = trace_config.value("capacity", 4096);
+    parsed.trace.dumpPath = trace_config.value("dumpPath", "/tmp/shadow_mode/trace.json");
+
+    // Profiler
+    const auto profiler_config = configData.value("profiler", nlohmann::json::object());
+    parsed.profiler.enabled = profiler_config.value("enabled", true);
+    parsed.profiler.windowMs = profiler_config.value("windowMs", 1000);
+    parsed.profiler.autoSizeBuffers = profiler_config.value("autoSizeBuffers", true);
+    parsed.profiler.rateHeadroom = profiler_config.value("rateHeadroom", 1.2);
+
+    // Trigger
+    const auto trigger_config = configData.value("trigger", nlohmann::json::object());
+    parsed.trigger.eventDriven = trigger_config.value("eventDriven", true);
+    parsed.trigger.evaluationWorkers = trigger_config.value("evaluationWorkers", 2);
+    parsed.trigger.pollIntervalMs = trigger_config.value("pollIntervalMs", 100);
+    parsed.trigger.schedulerWorkers = trigger_config.value("schedulerWorkers", 2);
+    parsed.trigger.tickMs = trigger_config.value("tickMs", 10);
+    parsed.trigger.signalStaleMs = trigger_config.value("signalStaleMs", 0);
 
     // Debug
-    parsedConfig.debug.closeMqttSsl = configData["debug"]["closeMqttSsl"];
-    parsedConfig.debug.closeDataReporter = configData["debug"]["closeDataReporter"];
-    parsedConfig.debug.closeDataStorage = configData["debug"]["closeDataStorage"];
-    parsedConfig.debug.closeDataEnc = configData["debug"]["closeDataEnc"];
-    parsedConfig.debug.closeDataUpload = configData["debug"]["closeDataUpload"];
-    parsedConfig.debug.deleteFileAfterDataUpload = configData["debug"]["deleteFileAfterDataUpload"];
-    parsedConfig.debug.closeLogUpload = configData["debug"]["closeLogUpload"];
-    parsedConfig.debug.cloudtimeOutMs = configData["debug"]["cloudtimeOutMs"];
+    parsed.debug.closeMqttSsl = configData["debug"]["closeMqttSsl"];
+    parsed.debug.closeDataReporter = configData["debug"]["closeDataReporter"];
+    parsed.debug.closeDataStorage = configData["debug"]["closeDataStorage"];
+    parsed.debug.closeDataEnc = configData["debug"]["closeDataEnc"];
+    parsed.debug.closeDataUpload = configData["debug"]["closeDataUpload"];
+    parsed.debug.deleteFileAfterDataUpload = configData["debug"]["deleteFileAfterDataUpload"];
+    parsed.debug.closeLogUpload = configData["debug"]["closeLogUpload"];
+    parsed.debug.cloudtimeOutMs = configData["debug"]["cloudtimeOutMs"];
 
     return true;
 }
 
-AppConfigData AppConfig::GetConfig() const {
-    return parsedConfig;
+AppConfig::AppConfig() : snapshot_(std::make_shared<AppConfigData>()) {}
+
+AppConfig::~AppConfig() {
+    StopWatch();
+}
+
+AppConfigPtr AppConfig::Snapshot() const {
+    // 线程内缓存快照，版本未变时只有一次原子读和引用计数加一
+    thread_local AppConfigPtr cached;
+    thread_local uint64_t cached_version = UINT64_MAX;
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if (version != cached_version) {
+        cached = std::atomic_load(&snapshot_);
+        cached_version = version;
+    }
+    return cached;
+}
+
+void AppConfig::Publish(AppConfigPtr config) {
+    const AppConfigPtr old_config = std::atomic_load(&snapshot_);
+    std::atomic_store(&snapshot_, config);
+    version_.fetch_add(1, std::memory_order_release);
+
+    std::map<int, Listener> listeners;
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        listeners = listeners_;
+    }
+    for (const auto& [id, listener] : listeners) {
+        listener(old_config, config);
+    }
+}
+
+int AppConfig::Subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    const int id = next_listener_id_++;
+    listeners_[id] = std::move(listener);
+    return id;
+}
+
+void AppConfig::Unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    listeners_.erase(id);
+}
+
+bool AppConfig::Reload() {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    auto parsed = std::make_shared<AppConfigData>();
+    if (!Load(*parsed)) {
+        AD_ERROR(AppConfig, "Reload %s failed, keep the current config.", filePath_.c_str());
+        return false;
+    }
+
+    const auto current = Snapshot();
+    if (current->dataStorage.storagePaths != parsed->dataStorage.storagePaths ||
+        current->dataUpload.uploadPaths != parsed->dataUpload.uploadPaths ||
+        current->dataUpload.gateway != parsed->dataUpload.gateway ||
+        current->dataUpload.clientCertPath != parsed->dataUpload.clientCertPath ||
+        current->dataUpload.fileRecordPath != parsed->dataUpload.fileRecordPath ||
+        current->dataProto.mqtt.broker != parsed->dataProto.mqtt.broker ||
+        current->metrics.enabled != parsed->metrics.enabled ||
+        current->messagePool.enabled != parsed->messagePool.enabled ||
+        current->metrics.exporter.enabled != parsed->metrics.exporter.enabled) {
+        AD_WARN(AppConfig, "Paths, gateway, certificates or broker changed, take effect after restart.");
+    }
+    Publish(std::move(parsed));
+    AD_INFO(AppConfig, "Config %s reloaded, version: %llu", filePath_.c_str(),
+            static_cast<unsigned long long>(version_.load()));
+    return true;
+}
+
+bool AppConfig::StartWatch() {
+    if (filePath_.empty()) {
+        return false;
+    }
+    return watcher_.Start(filePath_, [this] { Reload(); });
+}
+
+void AppConfig::StopWatch() {
+    watcher_.Stop();
 }
 
 bool AppConfig::CheckValid(const std::string& jsonString) {
@@ -7,10 +7,18 @@
 #ifndef APP_CONFIG_H
 #define APP_CONFIG_H
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
 
+#include "common/utils/file_watcher.h"
+
 
 namespace dcp::common{
 
@@ -61,6 +69,23 @@ public:
         int64_t uploadFileIntervalMs;
         std::string watch_dir;
         std::string enc_dir;
+        int multipartExpireMinutes; // 分段上传会话有效期，超时后重新申请上传地址
+        struct Stream {
+            int segmentIntervalMs; // 流式上传片段间隔，片段不足minPartKb时继续累积
+            int segmentMaxKb;      // 单个片段上限，超过后立即切片，不小于minPartKb
+            int minPartKb;         // 后端分段上传对非最后分片的下限（S3/OSS为5MB）
+            int maxParts;          // 单个流式会话申请的分片数上限
+        }stream;
+        struct TwoPhase {
+            bool enabled;        // 先上报片段摘要，云端请求后再上传
+            int retentionHours;  // 未被请求的片段保留时长
+        }twoPhase;
+        struct Dedup {
+            bool enabled;    // 按内容分块上传，服务端已有的块不再上传
+            int minChunkKb;  // 内容分块大小下限
+            int avgChunkKb;  // 期望平均块大小
+            int maxChunkKb;  // 内容分块大小上限
+        }dedup;
     }dataUpload;
 
     struct Log {
@@ -68,8 +93,71 @@ public:
         std::string logPattern;
         std::string logPath;
         std::string logBasename;
+        bool binary;  // 日志文件只写格式id和原始参数，不输出控制台，用tools/log_decoder解码；重启生效
+        struct RateLimit {
+            int everyN;      // 每N条输出1条，0不限制
+            int intervalMs;  // 最短输出间隔，0不限制
+        };
+        std::unordered_map<std::string, RateLimit> rateLimits; // 按tag覆盖限频日志宏的默认限制
     }log;
 
+    struct Metrics {
+        bool enabled;          // 内部指标时间序列采样
+        std::string path;      // 每个序列一个csv文件
+        int flushIntervalMs;   // 写盘周期
+        int capacityRows;      // 每个序列的缓冲行数，超出后丢弃
+        int maxFileMb;         // 单个文件上限，超出后滚动为.1
+        struct Exporter {
+            bool enabled;            // Prometheus文本格式导出计数器、直方图，重启生效
+            std::string unixSocket;  // 空为不监听
+            int port;                // 仅绑定127.0.0.1，0为不监听
+        }exporter;
+    }metrics;
+
+    struct MessagePool {
+        bool enabled;        // 订阅接收缓冲区和录制拷贝使用分级slab内存池
+        int threadCacheKb;   // 每个线程缓存的空闲块上限
+        int slabKb;          // 每次向系统申请的slab大小
+    }messagePool;
+
+    // ROS回调的线程拓扑，重启生效
+    struct Executor {
+        std::string type;  // 节点默认回调组的executor：singleThreaded / multiThreaded
+        int threads;       // multiThreaded的线程数，0为CPU核数
+        struct Group {
+            std::string name;                 // sensors / signals / commands ...
+            std::vector<std::string> topics;  // topic正则，先匹配的组生效
+            int threads;                      // 组内线程数，每个线程一个独立executor
+            std::vector<int32_t> cores;       // 与threads一一对应的绑核，空为不绑
+            int priority;                     // SCHED_FIFO优先级1~99，0为普通调度
+        };
+        std::vector<Group> groups;
+    }executor;
+
+    // 每个片段从触发到上传各阶段的span，Chrome trace JSON导出
+    struct Trace {
+        bool enabled;          // 关闭时每个span只有一次原子读
+        int capacity;          // 环形缓冲的span数，写满后覆盖最早的
+        std::string dumpPath;  // 退出时写出，运行中可通过metrics导出端口的/trace获取
+    }trace;
+
+    // 订阅topic的实测统计
+    struct Profiler {
+        bool enabled;          // 统计频率、码率、抖动、丢包和回调延迟，导出到metrics
+        int windowMs;          // 统计窗口
+        bool autoSizeBuffers;  // 录制缓冲区容量按实测频率调整，不再只依赖策略声明的帧率
+        double rateHeadroom;   // 按实测频率估算容量时的余量系数
+    }profiler;
+
+    struct Trigger {
+        bool eventDriven;       // 信号变化时只求值依赖它的条件，关闭则每个trigger轮询
+        int evaluationWorkers;  // 事件驱动求值的工作线程数
+        int pollIntervalMs;     // 依赖getter的条件的求值周期
+        int schedulerWorkers;   // 关闭事件驱动时时间轮调度器的工作线程数
+        int tickMs;             // 时间轮精度
+        int signalStaleMs;      // 条件变量超过此时长未更新视为过期，条件不成立；0不检查
+    }trigger;
+
     struct Debug {
         bool closeMqttSsl;
         bool closeDataReporter;
@@ -83,25 +171,58 @@ public:
 
 };
 
+using AppConfigPtr = std::shared_ptr<const AppConfigData>;
+
+/**
+ * 配置以不可变快照发布：Snapshot()返回当前快照，持有期间内容不会变化。
+ * StartWatch()后用inotify监听配置文件，修改后重新解析校验，通过才发布新快照（RCU），
+ * 读者不加锁也不拷贝配置；Subscribe的回调在发布后由监听线程调用。
+ * 路径、证书、网关等只在各模块Init时读取的项，修改后需重启生效。
+ */
 class AppConfig {
 public:
+    using Listener = std::function<void(const AppConfigPtr& old_config, const AppConfigPtr& new_config)>;
+
     static AppConfig& getInstance();
 
     bool Init(const std::string& filePath);
-    AppConfigData GetConfig() const;
+
+    // 当前配置快照，未Init时为全零的默认配置
+    AppConfigPtr Snapshot() const;
+
+    // 监听配置文件变化并热加载
+    bool StartWatch();
+    void StopWatch();
+
+    // 重新加载配置文件，校验失败时保留当前快照
+    bool Reload();
+
+    int Subscribe(Listener listener);
+    void Unsubscribe(int id);
 
 private:
-    AppConfig() = default;
-    ~AppConfig() = default;
+    AppConfig();
+    ~AppConfig();
     AppConfig(const AppConfig&) = delete;
     AppConfig& operator=(const AppConfig&) = delete;
 
+    bool Load(AppConfigData& parsed);
+    bool Parse(nlohmann::json configData, AppConfigData& parsed) const;
+    void Publish(AppConfigPtr config);
+
     bool CheckValid(const std::string& jsonString);
     bool checkFileExists(const std::string& filePath) const;
     bool checkJsonFormat(const nlohmann::json& jsonData) const;
 
-    nlohmann::json configData;
-    AppConfigData parsedConfig;
+    std::string filePath_;
+    AppConfigPtr snapshot_;                 // 只通过std::atomic_load/atomic_store访问
+    std::atomic<uint64_t> version_{0};      // 每次发布加1，读者据此刷新线程内缓存
+    std::mutex reload_mutex_;
+    std::mutex listener_mutex_;
+    std::map<int, Listener> listeners_;
+    int next_listener_id_ = 0;
+
+    FileWatcher watcher_;
 };
 
 } 
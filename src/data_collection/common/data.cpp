@@ -285,7 +285,9 @@ void to_json(json& j, const FileUploadRecord& r) {
         {"start_chunk", r.start_chunk},
         {"file_uuid", r.file_uuid},
         {"upload_id", r.upload_id},
-        {"upload_url_map", r.upload_url_map}
+        {"upload_url_map", r.upload_url_map},
+        {"uploaded_url_map", r.uploaded_url_map},
+        {"create_time_ms", r.create_time_ms}
     };
 }
 
@@ -305,6 +307,144 @@ void from_json(const json& j, FileUploadRecord& r) {
     if (!j.at("upload_url_map").is_null()) {
         j.at("upload_url_map").get_to(r.upload_url_map);
     }
+    if (j.contains("uploaded_url_map") && !j.at("uploaded_url_map").is_null()) {
+        j.at("uploaded_url_map").get_to(r.uploaded_url_map);
+    }
+    if (j.contains("create_time_ms") && !j.at("create_time_ms").is_null()) {
+        j.at("create_time_ms").get_to(r.create_time_ms);
+    }
+}
+
+void to_json(json& j, const ChunkQueryReq& r) {
+    j = json{
+        {"vin", r.vin},
+        {"chunkHashList", r.chunk_hash_list}
+    };
+}
+
+void to_json(json& j, const ChunkQueryResp::Object& o) {
+    j = json{
+        {"missingChunkUrlMap", o.missing_chunk_url_map}
+    };
+}
+
+void from_json(const json& j, ChunkQueryResp::Object& o) {
+    if (j.contains("missingChunkUrlMap") && !j.at("missingChunkUrlMap").is_null()) {
+        j.at("missingChunkUrlMap").get_to(o.missing_chunk_url_map);
+    }
+}
+
+void to_json(json& j, const ChunkQueryResp& r) {
+    j = json{
+        {"statusCode", r.status_code},
+        {"statusMessage", r.status_message},
+        {"data", r.data}
+    };
+}
+
+void from_json(const json& j, ChunkQueryResp& r) {
+    if (!j.at("statusCode").is_null()) {
+        j.at("statusCode").get_to(r.status_code);
+    }
+    if (j.contains("statusMessage") && !j.at("statusMessage").is_null()) {
+        j.at("statusMessage").get_to(r.status_message);
+    }
+    if (j.contains("data") && !j.at("data").is_null()) {
+        j.at("data").get_to(r.data);
+    }
+}
+
+void to_json(json& j, const ChunkCommitReq& r) {
+    j = json{
+        {"vin", r.vin},
+        {"type", static_cast<int>(r.type)},
+        {"fileName", r.filename},
+        {"fileSize", r.file_size},
+        {"chunkHashList", r.chunk_hash_list}
+    };
+}
+
+void to_json(json& j, const ClipSummary::TopicStat& t) {
+    j = json{
+        {"topic", t.topic},
+        {"count", t.count},
+        {"bytes", t.bytes}
+    };
+}
+
+void from_json(const json& j, ClipSummary::TopicStat& t) {
+    j.at("topic").get_to(t.topic);
+    j.at("count").get_to(t.count);
+    j.at("bytes").get_to(t.bytes);
+}
+
+void to_json(json& j, const ClipSummary::SignalStat& s) {
+    j = json{
+        {"name", s.name},
+        {"min", s.min},
+        {"max", s.max},
+        {"mean", s.mean},
+        {"count", s.count}
+    };
+}
+
+void from_json(const json& j, ClipSummary::SignalStat& s) {
+    j.at("name").get_to(s.name);
+    j.at("min").get_to(s.min);
+    j.at("max").get_to(s.max);
+    j.at("mean").get_to(s.mean);
+    j.at("count").get_to(s.count);
+}
+
+void to_json(json& j, const ClipSummary& r) {
+    j = json{
+        {"clipId", r.clip_id},
+        {"triggerId", r.trigger_id},
+        {"businessType", r.business_type},
+        {"triggerDesc", r.trigger_desc},
+        {"triggerTimestamp", r.trigger_timestamp},
+        {"location", {{"x", r.pos_x}, {"y", r.pos_y}}},
+        {"sizeBytes", r.size_bytes},
+        {"startTimestamp", r.start_timestamp},
+        {"endTimestamp", r.end_timestamp},
+        {"topics", r.topics},
+        {"signals", r.signals},
+        {"published", r.published}
+    };
+}
+
+void from_json(const json& j, ClipSummary& r) {
+    j.at("clipId").get_to(r.clip_id);
+    j.at("triggerId").get_to(r.trigger_id);
+    j.at("businessType").get_to(r.business_type);
+    j.at("triggerDesc").get_to(r.trigger_desc);
+    j.at("triggerTimestamp").get_to(r.trigger_timestamp);
+    if (j.contains("location") && !j.at("location").is_null()) {
+        r.pos_x = j["location"].value("x", 0.0);
+        r.pos_y = j["location"].value("y", 0.0);
+    }
+    j.at("sizeBytes").get_to(r.size_bytes);
+    j.at("startTimestamp").get_to(r.start_timestamp);
+    j.at("endTimestamp").get_to(r.end_timestamp);
+    if (j.contains("topics") && !j.at("topics").is_null()) {
+        j.at("topics").get_to(r.topics);
+    }
+    if (j.contains("signals") && !j.at("signals").is_null()) {
+        j.at("signals").get_to(r.signals);
+    }
+    r.published = j.value("published", false);
+}
+
+void from_json(const json& j, ClipRequest& r) {
+    j.at("clipId").get_to(r.clip_id);
+    if (j.contains("requestId") && !j.at("requestId").is_null()) {
+        j.at("requestId").get_to(r.request_id);
+    }
+    if (j.contains("topics") && !j.at("topics").is_null()) {
+        j.at("topics").get_to(r.topics);
+    }
+    r.start_time = j.value("startTime", static_cast<uint64_t>(0));
+    r.end_time = j.value("endTime", static_cast<uint64_t>(0));
 }
 
 void to_json(json& j, const FileUploadProgress& r) {
@@ -32,6 +32,7 @@ const std::vector<TBussiness> kBussiness{
 
 enum class UploadStatus : uint8_t
 { 
+    Uploading = 1,
     Uploaded = 3, 
     Failed = 4,  
 };
@@ -125,14 +126,39 @@ struct UploadStatusResp {
     Object data;
 };
 
+// 按内容分块上传：查询服务端缺失的块
+struct ChunkQueryReq {
+    std::string vin;
+    std::vector<std::string> chunk_hash_list; // 块内容的sha256
+};
+
+struct ChunkQueryResp {
+    struct Object {
+        std::map<std::string, std::string> missing_chunk_url_map; // 缺失块的hash -> 预签名上传地址
+    };
+    std::string status_code; // 状态码0表示成功
+    std::string status_message; // 状态信息
+    Object data;
+};
+
+// 按块顺序合成文件，响应同CompleteUploadResp
+struct ChunkCommitReq {
+    std::string vin;
+    UploadType type;
+    std::string filename;
+    uint64_t file_size = 0;
+    std::vector<std::string> chunk_hash_list;
+};
+
 // 文件上传记录
 struct FileUploadRecord {
     int8_t start_chunk;
     std::string file_uuid;
     std::map<int, std::string> upload_url_map;
-    std::map<int, std::string> uploaded_url_map;
+    std::map<int, std::string> uploaded_url_map; // 已上传分片序号 -> etag
     std::string upload_id;
     int8_t chunk_count;
+    uint64_t create_time_ms = 0; // 分段上传会话创建时间，用于判断会话是否过期
 };
 
 // 文件上传进度
@@ -253,6 +279,44 @@ struct QueryTaskResp {
     std::vector<Object> data; // 数据集合
 };
 
+// 片段摘要，两阶段上传先通过mqtt上报，云端按需拉取完整数据
+struct ClipSummary {
+    struct TopicStat {
+        std::string topic;
+        uint64_t count = 0; // 消息数
+        uint64_t bytes = 0; // 序列化数据大小
+    };
+    struct SignalStat {
+        std::string name;
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        uint64_t count = 0; // 采样数
+    };
+    std::string clip_id; // 片段id，即录制文件名
+    std::string trigger_id;
+    std::string business_type;
+    std::string trigger_desc;
+    int64_t trigger_timestamp = 0;
+    double pos_x = 0.0; // 触发位置
+    double pos_y = 0.0;
+    uint64_t size_bytes = 0; // 片段落盘大小
+    uint64_t start_timestamp = 0;
+    uint64_t end_timestamp = 0;
+    std::vector<TopicStat> topics;
+    std::vector<SignalStat> signals;
+    bool published = false; // 是否已上报
+};
+
+// 云端下发的片段拉取请求
+struct ClipRequest {
+    std::string request_id;
+    std::string clip_id;
+    std::vector<std::string> topics; // 为空表示全部topic
+    uint64_t start_time = 0; // 与录制时间戳同单位（微秒），0表示不限
+    uint64_t end_time = 0;
+};
+
 struct LogUploadTask {
     std::string vin;
     std::vector<int> log_type;
@@ -296,6 +360,21 @@ void from_json(const json& j, CompleteUploadReq& r);
 void to_json(json& j, const FileUploadRecord& r);
 void from_json(const json& j, FileUploadRecord& r);
 
+// two-phase upload
+void to_json(json& j, const ChunkQueryReq& r);
+void to_json(json& j, const ChunkQueryResp::Object& o);
+void from_json(const json& j, ChunkQueryResp::Object& o);
+void to_json(json& j, const ChunkQueryResp& r);
+void from_json(const json& j, ChunkQueryResp& r);
+void to_json(json& j, const ChunkCommitReq& r);
+void to_json(json& j, const ClipSummary::TopicStat& t);
+void from_json(const json& j, ClipSummary::TopicStat& t);
+void to_json(json& j, const ClipSummary::SignalStat& s);
+void from_json(const json& j, ClipSummary::SignalStat& s);
+void to_json(json& j, const ClipSummary& r);
+void from_json(const json& j, ClipSummary& r);
+void from_json(const json& j, ClipRequest& r);
+
 // data report
 void to_json(json& j, const FileUploadProgress& r);
 void from_json(const json& j, FileUploadProgress& r);
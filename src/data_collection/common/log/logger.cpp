@@ -5,10 +5,124 @@
 #include <string.h>
 #include <time.h>
 #include <string>
+#include <chrono>
 #include <sys/syscall.h>
 #include <unistd.h>
 
 namespace dcp::common {
+
+static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "LOG_RING_CAPACITY must be a power of 2");
+
+/* one log call, filled by the producer and formatted by the writer thread */
+struct LogRecord {
+  int64_t timeNs;       // CLOCK_REALTIME
+  const LogSite* site;  // AD_* call site, msg holds encoded arguments
+  const char* file;     // __FILE__, nullptr for logs without prefix
+  const char* tag;      // #TAG literal
+  int line;
+  int level;
+  uint16_t size;        // encoded argument bytes, only for site records
+  char msg[MAX_LOG_LEN];
+};
+
+/* single producer (owner thread) / single consumer (writer thread) ring */
+struct LogRing {
+  explicit LogRing(pid_t id) : tid(id) {}
+  alignas(64) std::atomic<uint64_t> head{0};  // next record to consume
+  alignas(64) std::atomic<uint64_t> tail{0};  // next slot to produce
+  alignas(64) std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> closed{false};            // owner thread exited
+  pid_t tid;
+  LogRecord slots[LOG_RING_CAPACITY];
+};
+
+/* binary log file frames, values in host byte order */
+static const char kBinaryMagic[] = "DCPBLOG";
+static const uint8_t kBinaryVersion = 1;
+enum BinaryFrame : char {
+  FRAME_HEADER = 'H',  // magic, version; site ids restart after every header
+  FRAME_SITE = 'S',    // id u32, level i8, line u32, tag/file/format as u16 length + bytes
+  FRAME_RECORD = 'R',  // id u32, time i64, tid u32, u16 length + encoded arguments
+  FRAME_TEXT = 'T',    // level i8, time i64, tid u32, line u32, file and text as u16 length + bytes
+};
+
+static std::atomic<uint32_t> g_nextSiteId{0};
+
+LogSite::LogSite(int lvl, const char* t, const char* f, int l, const char* fmt)
+    : level(lvl), tag(t), file(f), line(l), format(fmt),
+      id(g_nextSiteId.fetch_add(1, std::memory_order_relaxed)) {}
+
+std::atomic<LogLimiter*> LogLimiter::s_head{nullptr};
+/* limiters start at generation 0, so the first call always looks up its tag override */
+std::atomic<uint32_t> LogLimiter::s_generation{1};
+
+LogLimiter::LogLimiter(int level, const char* tag, const char* file, int line, uint32_t everyN, uint32_t intervalMs)
+    : m_level(level), m_tag(tag), m_file(file), m_line(line), m_defaultEveryN(everyN),
+      m_defaultIntervalMs(intervalMs), m_everyN(everyN), m_intervalMs(intervalMs) {
+  m_next = s_head.load(std::memory_order_relaxed);
+  while (!s_head.compare_exchange_weak(m_next, this, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+void LogLimiter::Refresh() {
+  const uint32_t generation = s_generation.load(std::memory_order_acquire);
+  if (generation == m_generation.load(std::memory_order_relaxed)) return;
+  uint32_t everyN = m_defaultEveryN;
+  uint32_t intervalMs = m_defaultIntervalMs;
+  Logger::instance()->GetRateLimit(m_tag, everyN, intervalMs);
+  m_everyN.store(everyN, std::memory_order_relaxed);
+  m_intervalMs.store(intervalMs, std::memory_order_relaxed);
+  m_generation.store(generation, std::memory_order_relaxed);
+}
+
+bool LogLimiter::AllowRate() {
+  const uint32_t everyN = m_everyN.load(std::memory_order_relaxed);
+  if (everyN > 1 && m_count.fetch_add(1, std::memory_order_relaxed) % everyN != 0) return false;
+
+  const uint32_t intervalMs = m_intervalMs.load(std::memory_order_relaxed);
+  if (intervalMs > 0) {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    const int64_t now = static_cast<int64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+    int64_t last = m_lastNs.load(std::memory_order_relaxed);
+    if (last != 0 && now - last < static_cast<int64_t>(intervalMs) * 1000000) return false;
+    /* several threads may pass the check at once, only one of them logs */
+    if (!m_lastNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) return false;
+  }
+  return true;
+}
+
+bool LogLimiter::Allow() {
+  Refresh();
+  if (AllowRate()) return true;
+  m_suppressed.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+bool LogLimiter::AllowKey(std::string_view key) {
+  Refresh();
+  const size_t hash = std::hash<std::string_view>{}(key);
+  {
+    std::lock_guard<std::mutex> lock(m_keyMutex);
+    if (m_keys.size() < LOG_LIMIT_MAX_KEYS && m_keys.insert(hash).second) return true;
+  }
+  /* a repeated key only passes when a tag override sets a rate */
+  if ((m_everyN.load(std::memory_order_relaxed) || m_intervalMs.load(std::memory_order_relaxed)) && AllowRate())
+    return true;
+  m_suppressed.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+namespace {
+/* the ring outlives its thread until the writer has drained it */
+struct ThreadRing {
+  std::shared_ptr<LogRing> ring;
+  ~ThreadRing() {
+    if (ring) ring->closed.store(true, std::memory_order_release);
+  }
+};
+thread_local ThreadRing t_ring;
+}
 /* Logger software version number */
 static const char* log_sw_version = "log version no is r25.0";
 /* String to identify log entries originating from this file */
@@ -38,7 +152,7 @@ Logger::Logger() {
   m_fp = nullptr;
 }
 
-Logger::~Logger() {}
+Logger::~Logger() { StopWorker(); }
 
 bool Logger::Init(const uint8_t toConsoleFile, int nLevel, const char* const pLogPath, const char* const csvLogPath) {
   std::unique_lock<std::mutex> lock(m_mutex);
@@ -48,8 +162,9 @@ bool Logger::Init(const uint8_t toConsoleFile, int nLevel, const char* const pLo
     return true;
   }
 
-  /* bit 0: log to console, bit 1: log to file */
-  m_outputMode = toConsoleFile & (LOG_TO_CONSOLE | LOG_TO_FILE);
+  /* bit 0: log to console, bit 1: log to file, bit 2: file is binary */
+  m_outputMode = toConsoleFile & (LOG_TO_CONSOLE | LOG_TO_FILE | LOG_TO_BINARY_FILE);
+  if (m_outputMode & LOG_TO_BINARY_FILE) m_outputMode |= LOG_TO_FILE;
 
   /* check nLevel, [LOG_LEVEL_NONE, LOG_LEVEL_DEBUG9] */
   if (nLevel < LOG_LEVEL_NONE)
@@ -57,17 +172,18 @@ bool Logger::Init(const uint8_t toConsoleFile, int nLevel, const char* const pLo
   else if (nLevel > LOG_LEVEL_DEBUG9)
     nLevel = LOG_LEVEL_DEBUG9;
 
-  m_logFilter.level = (LOG_LEVEL)nLevel;
+  m_logFilter.level.store(nLevel, std::memory_order_relaxed);
   m_logFilter.tags.clear();
   m_logFilter.keywords.clear();
 
-  if (toConsoleFile & LOG_TO_FILE) {
+  if (m_outputMode & LOG_TO_FILE) {
     m_fp = fopen(pLogPath, "a");  // if file not existed, create it; add content to the end of the file
 
     if (!m_fp) {
       printf("Error: fail to open file %s\n", pLogPath);    
       return false;
     }
+    if (m_outputMode & LOG_TO_BINARY_FILE) WriteFileHeader();
   }
 
   if (pLogPath)
@@ -75,6 +191,8 @@ bool Logger::Init(const uint8_t toConsoleFile, int nLevel, const char* const pLo
   if (csvLogPath)
     memcpy(csv_logPath, csvLogPath, strlen(csvLogPath) + 1);
   m_initFlag = true;
+  m_running.store(true, std::memory_order_release);
+  m_worker = std::thread(&Logger::Run, this);
 
   lock.unlock();
 
@@ -87,11 +205,12 @@ bool Logger::Init(const uint8_t toConsoleFile, int nLevel, const char* const pLo
 }
 
 void Logger::Uninit() {
+  /* write out what is still buffered before closing the file */
+  StopWorker();
   std::lock_guard<std::mutex> lock(m_mutex);
   m_initFlag = false;
   if (m_fp) fclose(m_fp);
   if (csvFile.is_open()) csvFile.close();
-  if (inFile.is_open()) inFile.close();
 
   if (pLog) {
     delete pLog;    
@@ -108,7 +227,7 @@ void Logger::SetLevel(int nLevel) {
     nLevel = LOG_LEVEL_NONE;
   else if (nLevel > LOG_LEVEL_DEBUG9)
     nLevel = LOG_LEVEL_DEBUG9;
-  m_logFilter.level = (LOG_LEVEL)nLevel;
+  m_logFilter.level.store(nLevel, std::memory_order_relaxed);
 }
 
 void Logger::AddTag(const char* const tag) {
@@ -153,7 +272,7 @@ void Logger::ResetKeyword() {
  */
 int Logger::GetLevel() {
   std::lock_guard<std::mutex> lock(m_mutex);
-  return (int)m_logFilter.level;
+  return m_logFilter.level.load(std::memory_order_relaxed);
 }
 
 /**
@@ -188,15 +307,16 @@ struct tm* localtime_r(const time_t* timeep, struct tm* result) {
 #endif
 
 #define LOG_TIME_BUF_SIZE 64
-static inline void log_time(char* const buf) {
-  time_t t;
-  tm local;
-  t = time(NULL);
-  localtime_r(&t, &local);
-
-  struct timespec tp;
-  clock_gettime(CLOCK_REALTIME, &tp);
-  int64_t ms = tp.tv_nsec / 1000000;
+/* only called by the writer thread, the second part is cached */
+static inline void log_time(char* const buf, int64_t timeNs) {
+  static time_t cached_sec = -1;
+  static tm local;
+  time_t t = static_cast<time_t>(timeNs / 1000000000);
+  if (t != cached_sec) {
+    localtime_r(&t, &local);
+    cached_sec = t;
+  }
+  long ms = static_cast<long>((timeNs % 1000000000) / 1000000);
 
   snprintf(buf, LOG_TIME_BUF_SIZE - 1, "%04d%02d%02d %02d:%02d:%02d.%03ld",
            local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour,
@@ -296,6 +416,7 @@ bool Logger::LogFileRotate()
   }
   /* reopen the file */
   m_fp = fopen(m_logPath, "a+");
+  if (m_fp && (m_outputMode & LOG_TO_BINARY_FILE)) WriteFileHeader();
 
   return result;
 }
@@ -308,6 +429,7 @@ bool Logger::LogFileRotate()
 static uint8_t Level2ColorIndex(const long& level)
 {
   switch (level) {
+    case LOG_LEVEL_FATAL:
     case LOG_LEVEL_ERROR:
       return 0;
     case LOG_LEVEL_WARNING:
@@ -356,36 +478,29 @@ void Logger::LogToFile(std::string& strs)
 }
 
 /**
- * @brief Write str to the log csvfile
+ * @brief Write str to the log csvfile, the header row is written when the file is new.
+ * The file stays open until Uninit; for sampled time series use MetricsRecorder.
  * @param strs[In] log content
  */
 void Logger::LogToCsvFile( std::string str) {
   std::vector<std::string> result=Logger::split(str,":",",");
-  std::string line;
   int result_size = result.size();
-  inFile.open(csv_logPath, std::ios::in);
-  if (inFile.is_open()) {
-    inFile.close();
+  if (result_size < 2) return;
+  if (!csvFile.is_open()) {
     csvFile.open(csv_logPath, std::ios::app);
-    int i =1;
-    for(; i < result_size-2; i+=2)
-      csvFile << result[i] << ',';
-    csvFile << result[i];
-    csvFile << '\n';
-  }
-  else {
-    csvFile.open(csv_logPath, std::ios::out);
-    int i = 0;
-    for (;i < result_size-2;i+=2)
-      csvFile << result[i] << ',';
-    csvFile << result[i] << '\n';
-    i =1;
-    for(; i < result_size-2; i+=2)
-      csvFile << result[i] << ',';
-    csvFile << result[i];
-    csvFile << '\n';
-  }
-  csvFile.close();
+    if (!csvFile.is_open()) return;
+    if (csvFile.tellp() == 0) {
+      int i = 0;
+      for (;i < result_size-2;i+=2)
+        csvFile << result[i] << ',';
+      csvFile << result[i] << '\n';
+    }
+  }
+  int i =1;
+  for(; i < result_size-2; i+=2)
+    csvFile << result[i] << ',';
+  csvFile << result[i];
+  csvFile << '\n';
 }
 
 std::vector<std::string> Logger::split(std::string str,std::string pattern1,std::string pattern2) {
@@ -406,174 +521,675 @@ std::vector<std::string> Logger::split(std::string str,std::string pattern1,std:
   return result;
 }
 
+namespace {
+struct LogArg {
+  char type = 0;
+  int64_t i = 0;
+  uint64_t u = 0;
+  double d = 0.0;
+  std::string s;
+};
+
+class LogArgReader {
+ public:
+  LogArgReader(const char* buf, size_t len) : m_buf(buf), m_len(len), m_pos(0) {}
+
+  bool Next(LogArg& arg) {
+    if (m_pos >= m_len) return false;
+    arg.type = m_buf[m_pos++];
+    switch (arg.type) {
+      case 'i':
+        if (!Read(&arg.i, sizeof(arg.i))) return false;
+        arg.u = static_cast<uint64_t>(arg.i);
+        arg.d = static_cast<double>(arg.i);
+        return true;
+      case 'u':
+      case 'p':
+        if (!Read(&arg.u, sizeof(arg.u))) return false;
+        arg.i = static_cast<int64_t>(arg.u);
+        arg.d = static_cast<double>(arg.u);
+        return true;
+      case 'd':
+        if (!Read(&arg.d, sizeof(arg.d))) return false;
+        arg.i = static_cast<int64_t>(arg.d);
+        arg.u = static_cast<uint64_t>(arg.i);
+        return true;
+      case 's': {
+        uint16_t len = 0;
+        if (!Read(&len, sizeof(len)) || m_pos + len > m_len) return false;
+        arg.s.assign(m_buf + m_pos, len);
+        m_pos += len;
+        return true;
+      }
+      default:
+        m_pos = m_len;
+        return false;
+    }
+  }
+
+ private:
+  bool Read(void* out, size_t len) {
+    if (m_pos + len > m_len) return false;
+    memcpy(out, m_buf + m_pos, len);
+    m_pos += len;
+    return true;
+  }
+
+  const char* m_buf;
+  size_t m_len;
+  size_t m_pos;
+};
+
+std::string ArgToString(const LogArg& arg) {
+  switch (arg.type) {
+    case 's': return arg.s;
+    case 'd': return std::to_string(arg.d);
+    case 'u': return std::to_string(arg.u);
+    default: return std::to_string(arg.i);
+  }
+}
+}
+
+/**
+ * @brief printf semantics over encoded arguments: length modifiers are ignored
+ * and each value is converted to what the conversion expects; a conversion
+ * without an argument is printed as it is.
+ */
+std::string FormatLogArgs(const char* format, const char* args, size_t len) {
+  std::string out;
+  LogArgReader reader(args, len);
+  char tmp[MAX_LOG_LEN];
+  for (const char* p = format; *p; ++p) {
+    if (*p != '%') {
+      out += *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      out += '%';
+      ++p;
+      continue;
+    }
+    const char* start = p++;
+    std::string spec = "%";
+    LogArg arg;
+    while (*p && strchr("-+ #0", *p)) spec += *p++;
+    if (*p == '*') {
+      spec += reader.Next(arg) ? std::to_string(arg.i) : "";
+      ++p;
+    }
+    while (*p >= '0' && *p <= '9') spec += *p++;
+    if (*p == '.') {
+      spec += *p++;
+      if (*p == '*') {
+        spec += reader.Next(arg) ? std::to_string(arg.i) : "0";
+        ++p;
+      }
+      while (*p >= '0' && *p <= '9') spec += *p++;
+    }
+    while (*p && strchr("hlLqjzt", *p)) ++p;
+    const char conv = *p;
+    if (!conv) {
+      out += start;
+      break;
+    }
+    if (!reader.Next(arg)) {
+      out.append(start, p + 1 - start);
+      continue;
+    }
+    switch (conv) {
+      case 'd':
+      case 'i':
+        if (arg.type == 's') {
+          out += arg.s;
+          continue;
+        }
+        spec += "lld";
+        snprintf(tmp, sizeof(tmp), spec.c_str(), static_cast<long long>(arg.i));
+        break;
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+        if (arg.type == 's') {
+          out += arg.s;
+          continue;
+        }
+        spec += "ll";
+        spec += conv;
+        snprintf(tmp, sizeof(tmp), spec.c_str(), static_cast<unsigned long long>(arg.u));
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        if (arg.type == 's') {
+          out += arg.s;
+          continue;
+        }
+        spec += conv;
+        snprintf(tmp, sizeof(tmp), spec.c_str(), arg.d);
+        break;
+      case 'c':
+        spec += 'c';
+        snprintf(tmp, sizeof(tmp), spec.c_str(), arg.type == 's' ? (arg.s.empty() ? ' ' : arg.s[0]) : static_cast<int>(arg.i));
+        break;
+      case 'p':
+        snprintf(tmp, sizeof(tmp), "0x%llx", static_cast<unsigned long long>(arg.u));
+        break;
+      case 's':
+      default: {
+        spec += 's';
+        const std::string str = ArgToString(arg);
+        snprintf(tmp, sizeof(tmp), spec.c_str(), str.c_str());
+        break;
+      }
+    }
+    out += tmp;
+  }
+  return out;
+}
+
+LogRing* Logger::GetThreadRing() {
+  if (!t_ring.ring) {
+    auto ring = std::make_shared<LogRing>(static_cast<pid_t>(syscall(SYS_gettid)));
+    std::lock_guard<std::mutex> lock(m_ringMutex);
+    m_rings.push_back(ring);
+    t_ring.ring = std::move(ring);
+  }
+  return t_ring.ring.get();
+}
+
+char* Logger::BeginSite(const LogSite& site, LogRing*& ring, size_t& cap) {
+  if (!m_logFilter.tags.empty()) {
+    char new_tag[LOG_TAG_MAX_LEN + 1] = {0};
+    strncpy(new_tag, site.tag, LOG_TAG_MAX_LEN);
+    if (0 == IsTagInFilter(new_tag, m_logFilter.tags))
+      return nullptr;
+  }
+
+  ring = GetThreadRing();
+  LogRecord* record = Reserve(ring, site.level);
+  if (!record) return nullptr;
+
+  struct timespec tp;
+  clock_gettime(CLOCK_REALTIME, &tp);
+  record->timeNs = static_cast<int64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+  record->site = &site;
+  record->file = site.file;
+  record->tag = site.tag;
+  record->line = site.line;
+  record->level = site.level;
+  cap = MAX_LOG_LEN;
+  return record->msg;
+}
+
+void Logger::EndSite(LogRing* ring, int level, size_t size) {
+  const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  ring->slots[tail & (LOG_RING_CAPACITY - 1)].size = static_cast<uint16_t>(size);
+  Commit(ring, level);
+}
+
+LogRecord* Logger::Reserve(LogRing* ring, const long& nLevel) {
+  const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  if (tail - ring->head.load(std::memory_order_acquire) >= LOG_RING_CAPACITY) {
+    if (nLevel != LOG_LEVEL_FATAL) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    /* never drop FATAL: wait for the writer to make room */
+    Flush();
+    if (tail - ring->head.load(std::memory_order_acquire) >= LOG_RING_CAPACITY) return nullptr;
+  }
+  return &ring->slots[tail & (LOG_RING_CAPACITY - 1)];
+}
+
+void Logger::Commit(LogRing* ring, const long& nLevel) {
+  const uint64_t tail = ring->tail.load(std::memory_order_relaxed) + 1;
+  ring->tail.store(tail, std::memory_order_release);
+  if (nLevel == LOG_LEVEL_FATAL) {
+    Flush();
+  } else if (tail - ring->head.load(std::memory_order_relaxed) >= LOG_RING_CAPACITY / 2 &&
+             !m_wakeup.exchange(true, std::memory_order_relaxed)) {
+    /* half full, do not wait for the flush interval */
+    m_wakeCv.notify_one();
+  }
+}
+
 void Logger::Log(const long& nLevel, const char* const tag, const char* const pszFile, const int& lineNo,
                  const char* pszFmt, ...) {
   LOG_CHECK_AND_RETURN(m_initFlag);
 
   if (((m_outputMode & LOG_TO_CONSOLE) == 0) && ((m_outputMode & LOG_TO_FILE) == 0))
     return;
+  if (nLevel > m_logFilter.level.load(std::memory_order_relaxed))
+    return;
 
-  /* if tag's length > LOG_TAG_MAX_LEN, truncate it */
-  char new_tag[LOG_TAG_MAX_LEN + 1] = { 0 };
-  size_t tag_len = strlen(tag);
-  for (size_t i = 0; i < LOG_TAG_MAX_LEN && i < tag_len; i++) {
-    new_tag[i] = tag[i];
+  if (!m_logFilter.tags.empty()) {
+    /* if tag's length > LOG_TAG_MAX_LEN, truncate it */
+    char new_tag[LOG_TAG_MAX_LEN + 1] = { 0 };
+    strncpy(new_tag, tag, LOG_TAG_MAX_LEN);
+    if (0 == IsTagInFilter(new_tag, m_logFilter.tags))
+      return;
   }
 
-  if (nLevel > m_logFilter.level)
-    return;
-  else if (0 == IsTagInFilter(new_tag, m_logFilter.tags))
-    return;
+  LogRing* ring = GetThreadRing();
+  LogRecord* record = Reserve(ring, nLevel);
+  if (!record) return;
 
-  std::string strDebugInfo = "";
-#ifdef LOG_COLOR_ENABLE
-  std::string strColorStart = "";
-  /* add CSI start sign and color info */
-  strColorStart += CSI_START;
-  uint8_t color_idx = Level2ColorIndex(nLevel);
-  strColorStart += color_output_info[color_idx];
-#endif
+  struct timespec tp;
+  clock_gettime(CLOCK_REALTIME, &tp);
+  record->timeNs = static_cast<int64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+  record->site = nullptr;
+  record->file = pszFile;
+  record->tag = tag;
+  record->line = lineNo;
+  record->level = static_cast<int>(nLevel);
 
-  /* package level info */
-  if (nLevel == LOG_LEVEL_WARNING)
-    strDebugInfo += "[W]";
-  else if (nLevel == LOG_LEVEL_ERROR)
-    strDebugInfo += "[E]";
-  else if (nLevel == LOG_LEVEL_INFO)
-    strDebugInfo += "[I]";
-  else
-    strDebugInfo += "[D]";
+  /* package other log data */
+  va_list ap;
+  va_start(ap, pszFmt);
+  vsnprintf(record->msg, MAX_LOG_LEN, pszFmt, ap);
+  va_end(ap);
 
-#ifdef LOG_TAG_OUTPUT_ENABLE
-  strDebugInfo += "[";
-    strDebugInfo += new_tag;
-    strDebugInfo += "]";
-#endif
+  Commit(ring, nLevel);
+}
 
-  /* package time info */
-  char szTime[LOG_TIME_BUF_SIZE] = {0};
-  log_time(szTime);
-  strDebugInfo += szTime;
+void Logger::Log(const long& nLevel, const char* const tag, const char* pszFmt, ...) {
+  LOG_CHECK_AND_RETURN(m_initFlag);
+  if (((m_outputMode & LOG_TO_CONSOLE) == 0) && ((m_outputMode & LOG_TO_FILE) == 0))
+    return;
+  if (nLevel > m_logFilter.level.load(std::memory_order_relaxed))
+    return;
 
-  /* package thread info */
-  char szThreadID[MAX_THREAD_ID_LEN] = {0};
-  pid_t curThreadID;
-#ifdef _WIN32
-  curThreadID = GetCurrentThreadId();
-#else
-  curThreadID = syscall(SYS_gettid);
-#endif
-  sprintf(szThreadID, " %d ", curThreadID);
-  strDebugInfo += szThreadID;
+  if (!m_logFilter.tags.empty()) {
+    /* if tag's length > LOG_TAG_MAX_LEN, truncate it */
+    char new_tag[LOG_TAG_MAX_LEN + 1] = {0};
+    strncpy(new_tag, tag, LOG_TAG_MAX_LEN);
+    if (0 == IsTagInFilter(new_tag, m_logFilter.tags))
+      return;
+  }
 
-  /* file name and line number info */
-  char szFileLine[MAX_FILE_PATH_LEN];
-  sprintf(szFileLine, "[%s:%d] ", const_basename(pszFile), lineNo);
-  strDebugInfo += szFileLine;
+  LogRing* ring = GetThreadRing();
+  LogRecord* record = Reserve(ring, nLevel);
+  if (!record) return;
+
+  struct timespec tp;
+  clock_gettime(CLOCK_REALTIME, &tp);
+  record->timeNs = static_cast<int64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+  record->site = nullptr;
+  record->file = nullptr;
+  record->tag = tag;
+  record->line = 0;
+  record->level = static_cast<int>(nLevel);
 
-  /* package other log data */
   va_list ap;
   va_start(ap, pszFmt);
-  char szMsg[MAX_LOG_LEN];
-  vsnprintf(szMsg, MAX_LOG_LEN, pszFmt, ap);
+  vsnprintf(record->msg, MAX_LOG_LEN, pszFmt, ap);
   va_end(ap);
 
-  strDebugInfo += szMsg;
+  Commit(ring, nLevel);
+}
 
-  if (strDebugInfo.length() > MAX_LOG_LEN)
-    strDebugInfo = strDebugInfo.substr(0, MAX_LOG_LEN);
+/**
+ * @brief format one record into the console/file batches, writer thread only
+ * @param record[In] log record
+ * @param tid[In] id of the thread that produced the record
+ */
+void Logger::FormatRecord(const LogRecord& record, int tid) {
+  /* console output and the keyword filter need the text, the binary file does not:
+   * without them the frame keeps the site id and raw arguments and nothing is formatted */
+  if ((m_outputMode & LOG_TO_BINARY_FILE) && !(m_outputMode & LOG_TO_CONSOLE) && m_logFilter.keywords.empty()) {
+    if (m_fp) AppendFrame(record, tid);
+    return;
+  }
 
-  if (IsKeyInInfo(strDebugInfo.c_str(), m_logFilter.keywords) == 0) return;
+  std::string strDebugInfo;
+  if (record.file) {
+    /* package level info */
+    if (record.level == LOG_LEVEL_WARNING)
+      strDebugInfo += "[W]";
+    else if (record.level == LOG_LEVEL_ERROR)
+      strDebugInfo += "[E]";
+    else if (record.level == LOG_LEVEL_FATAL)
+      strDebugInfo += "[F]";
+    else if (record.level == LOG_LEVEL_INFO)
+      strDebugInfo += "[I]";
+    else
+      strDebugInfo += "[D]";
 
-#ifdef LOG_COLOR_ENABLE
-  /* add CSI end sign */
-  std::string strColorEnd = "";
-  strColorEnd += CSI_END;
+#ifdef LOG_TAG_OUTPUT_ENABLE
+    strDebugInfo += "[";
+    strDebugInfo.append(record.tag, strnlen(record.tag, LOG_TAG_MAX_LEN));
+    strDebugInfo += "]";
 #endif
 
+    /* package time, thread, file name and line number info */
+    char szPrefix[LOG_TIME_BUF_SIZE + MAX_FILE_PATH_LEN];
+    char szTime[LOG_TIME_BUF_SIZE] = {0};
+    log_time(szTime, record.timeNs);
+    snprintf(szPrefix, sizeof(szPrefix), "%s %d [%s:%d] ", szTime, tid, const_basename(record.file), record.line);
+    strDebugInfo += szPrefix;
+  }
+  if (record.site)
+    strDebugInfo += FormatLogArgs(record.site->format, record.msg, record.size);
+  else
+    strDebugInfo += record.msg;
+
+  if (strDebugInfo.length() > MAX_LOG_LEN)
+    strDebugInfo.resize(MAX_LOG_LEN);
+
+  if (IsKeyInInfo(strDebugInfo.c_str(), m_logFilter.keywords) == 0) return;
+
   /* check if log output to console*/
   if (m_outputMode & LOG_TO_CONSOLE) {
 #ifdef LOG_COLOR_ENABLE
-
-#ifdef _WIN32
-    printf("%s\r\n", (strColorStart + strDebugInfo + strColorEnd).c_str());
+    m_consoleBatch += CSI_START;
+    m_consoleBatch += color_output_info[Level2ColorIndex(record.level)];
+    m_consoleBatch += strDebugInfo;
+    m_consoleBatch += CSI_END;
 #else
-    printf("%s\n", (strColorStart + strDebugInfo + strColorEnd).c_str());   
+    m_consoleBatch += strDebugInfo;
 #endif
+    if (record.file) m_consoleBatch += "\n";
+  }
 
-#else
+  /* check if log output to file*/
+  if ((m_outputMode & LOG_TO_BINARY_FILE) && m_fp) {
+    AppendFrame(record, tid);
+  } else if ((m_outputMode & LOG_TO_FILE) && m_fp) {
+    m_fileBatch += strDebugInfo;
+    m_fileBatch += "\n";
+  }
+}
 
-    #ifdef _WIN32
-      printf("%s\r\n", strDebugInfo.c_str());
-    #else
-      printf("%s\n", strDebugInfo.c_str());   
-    #endif
+static inline void AppendBytes(std::string& out, const void* data, size_t len) {
+  out.append(static_cast<const char*>(data), len);
+}
 
-#endif
-  }
+template <typename T>
+static inline void AppendValue(std::string& out, T v) {
+  AppendBytes(out, &v, sizeof(v));
+}
 
-  /* check if log output to file*/
-  LogToFile(strDebugInfo);
+static inline void AppendString(std::string& out, const char* str) {
+  const uint16_t len = static_cast<uint16_t>(strnlen(str, MAX_LOG_LEN));
+  AppendValue(out, len);
+  AppendBytes(out, str, len);
 }
 
-void Logger::Log(const long& nLevel, const char* const tag, const char* pszFmt, ...) {
-  LOG_CHECK_AND_RETURN(m_initFlag);
-  if (((m_outputMode & LOG_TO_CONSOLE) == 0) && ((m_outputMode & LOG_TO_FILE) == 0))
-    return;
+void Logger::WriteFileHeader() {
+  std::string header;
+  AppendValue(header, static_cast<char>(FRAME_HEADER));
+  AppendBytes(header, kBinaryMagic, sizeof(kBinaryMagic) - 1);
+  AppendValue(header, kBinaryVersion);
+  fwrite(header.data(), 1, header.size(), m_fp);
+  m_totalLogLen = header.size();
+  m_siteWritten.clear();
+}
 
-  /* if tag's length > LOG_TAG_MAX_LEN, truncate it */
-  char new_tag[LOG_TAG_MAX_LEN + 1] = {0};
-  size_t tag_len = strlen(tag);
-  for (size_t i = 0; i < LOG_TAG_MAX_LEN && i < tag_len; i++) {
-    new_tag[i] = tag[i];
+/**
+ * @brief append the binary frame of a record, preceded by its site definition
+ * the first time the site appears in the current file
+ */
+void Logger::AppendFrame(const LogRecord& record, int tid) {
+  if (m_totalLogLen > LOG_FILE_MAX_SIZE) {
+    /* pending frames belong to the current file, the new one starts with a header */
+    fwrite(m_fileBatch.data(), 1, m_fileBatch.size(), m_fp);
+    m_fileBatch.clear();
+    if (false == LogFileRotate() || !m_fp) {
+      m_totalLogLen = 0;
+      return;
+    }
   }
+  const size_t before = m_fileBatch.size();
+  if (record.site) {
+    const LogSite& site = *record.site;
+    if (site.id >= m_siteWritten.size()) m_siteWritten.resize(site.id + 1, false);
+    if (!m_siteWritten[site.id]) {
+      AppendValue(m_fileBatch, static_cast<char>(FRAME_SITE));
+      AppendValue(m_fileBatch, site.id);
+      AppendValue(m_fileBatch, static_cast<int8_t>(site.level));
+      AppendValue(m_fileBatch, static_cast<uint32_t>(site.line));
+      AppendString(m_fileBatch, site.tag);
+      AppendString(m_fileBatch, const_basename(site.file));
+      AppendString(m_fileBatch, site.format);
+      m_siteWritten[site.id] = true;
+    }
+    AppendValue(m_fileBatch, static_cast<char>(FRAME_RECORD));
+    AppendValue(m_fileBatch, site.id);
+    AppendValue(m_fileBatch, record.timeNs);
+    AppendValue(m_fileBatch, static_cast<uint32_t>(tid));
+    AppendValue(m_fileBatch, record.size);
+    AppendBytes(m_fileBatch, record.msg, record.size);
+  } else {
+    AppendValue(m_fileBatch, static_cast<char>(FRAME_TEXT));
+    AppendValue(m_fileBatch, static_cast<int8_t>(record.level));
+    AppendValue(m_fileBatch, record.timeNs);
+    AppendValue(m_fileBatch, static_cast<uint32_t>(tid));
+    AppendValue(m_fileBatch, static_cast<uint32_t>(record.line));
+    AppendString(m_fileBatch, record.file ? const_basename(record.file) : "");
+    AppendString(m_fileBatch, record.msg);
+  }
+  m_totalLogLen += m_fileBatch.size() - before;
+}
 
-  if (nLevel > m_logFilter.level)
-    return;
-  if (0 == IsTagInFilter(new_tag, m_logFilter.tags))
-    return;
+/**
+ * @brief move every pending record of all rings into the batches, merged by time
+ * @return number of records consumed
+ */
+size_t Logger::DrainRings() {
+  struct Cursor {
+    LogRing* ring;
+    uint64_t head;
+    uint64_t tail;
+  };
+  std::vector<std::shared_ptr<LogRing>> rings;
+  {
+    std::lock_guard<std::mutex> lock(m_ringMutex);
+    for (auto it = m_rings.begin(); it != m_rings.end();) {
+      LogRing* ring = it->get();
+      if (ring->closed.load(std::memory_order_acquire) &&
+          ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire)) {
+        m_dropped.fetch_add(ring->dropped.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        it = m_rings.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    rings = m_rings;
+  }
 
-  std::string strDebugInfo = "";
-#ifdef LOG_COLOR_ENABLE
-  /* add CSI start sign and color info */
-  std::string strColorStart = "";
-  strColorStart += CSI_START;
-  uint8_t color_idx = Level2ColorIndex(nLevel);
-  strColorStart += color_output_info[color_idx];
-#endif
+  std::vector<Cursor> cursors;
+  cursors.reserve(rings.size());
+  for (const auto& ring : rings) {
+    m_dropped.fetch_add(ring->dropped.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head != tail) cursors.push_back({ring.get(), head, tail});
+  }
 
-  /* package other log data */
-  va_list ap;
-  va_start(ap, pszFmt);
-  char szMsg[MAX_LOG_LEN];
-  vsnprintf(szMsg, MAX_LOG_LEN, pszFmt, ap);
-  va_end(ap);
+  size_t count = 0;
+  while (!cursors.empty()) {
+    size_t next = 0;
+    for (size_t i = 1; i < cursors.size(); ++i) {
+      const auto& a = cursors[i].ring->slots[cursors[i].head & (LOG_RING_CAPACITY - 1)];
+      const auto& b = cursors[next].ring->slots[cursors[next].head & (LOG_RING_CAPACITY - 1)];
+      if (a.timeNs < b.timeNs) next = i;
+    }
+    Cursor& cursor = cursors[next];
+    FormatRecord(cursor.ring->slots[cursor.head & (LOG_RING_CAPACITY - 1)], cursor.ring->tid);
+    cursor.ring->head.store(++cursor.head, std::memory_order_release);
+    ++count;
+    if (cursor.head == cursor.tail) cursors.erase(cursors.begin() + next);
+  }
+  return count;
+}
 
-  strDebugInfo += szMsg;
+/**
+ * @brief write the batches to console and file, rotate the file if needed
+ */
+void Logger::WriteBatch() {
+  if (!m_consoleBatch.empty()) {
+    fwrite(m_consoleBatch.data(), 1, m_consoleBatch.size(), stdout);
+    fflush(stdout);
+    m_consoleBatch.clear();
+  }
+  if (!m_fileBatch.empty() && (m_outputMode & LOG_TO_BINARY_FILE)) {
+    /* size accounting and rotation are done frame by frame in AppendFrame */
+    if (m_fp) {
+      fwrite(m_fileBatch.data(), 1, m_fileBatch.length(), m_fp);
+      fflush(m_fp);
+    }
+    m_fileBatch.clear();
+  } else if (!m_fileBatch.empty()) {
+    m_totalLogLen += m_fileBatch.length();
+    if (m_totalLogLen > LOG_FILE_MAX_SIZE) {
+      m_totalLogLen = m_fileBatch.length();
+      if (false == LogFileRotate()) {
+        m_fileBatch.clear();
+        return;
+      }
+    }
+    if (m_fp) {
+      fwrite(m_fileBatch.data(), 1, m_fileBatch.length(), m_fp);
+      fflush(m_fp);
+    }
+    m_fileBatch.clear();
+  }
+}
 
-  /* check log length */
-  if (strDebugInfo.length() > MAX_LOG_LEN)
-    strDebugInfo = strDebugInfo.substr(0, MAX_LOG_LEN);
+void Logger::Run() {
+  auto last_flush = std::chrono::steady_clock::now();
+  const auto interval = std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS);
+  auto last_report = last_flush;
+  const auto report_interval = std::chrono::milliseconds(LOG_SUPPRESS_REPORT_MS);
+  while (true) {
+    const bool running = m_running.load(std::memory_order_acquire);
+    const uint64_t flush_request = m_flushRequest.load(std::memory_order_acquire);
+    m_wakeup.store(false, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      DrainRings();
+
+      const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+      if (dropped != m_reportedDropped) {
+        char text[128];
+        snprintf(text, sizeof(text), "Log ring full, %llu records dropped (%llu in total).",
+                 static_cast<unsigned long long>(dropped - m_reportedDropped),
+                 static_cast<unsigned long long>(dropped));
+        WriteNotice(LOG_LEVEL_WARNING, "Logger", __FILE__, __LINE__, text);
+        m_reportedDropped = dropped;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now - last_report >= report_interval || !running) {
+        ReportSuppressed();
+        last_report = now;
+      }
+      if (m_consoleBatch.size() + m_fileBatch.size() >= LOG_BATCH_MAX_BYTES || now - last_flush >= interval ||
+          flush_request != m_flushDone || !running) {
+        WriteBatch();
+        last_flush = now;
+      }
+    }
 
-  /* keyword filter */
-  if (IsKeyInInfo(strDebugInfo.c_str(), m_logFilter.keywords) == 0) return;
-#ifdef LOG_COLOR_ENABLE
-  /* add CSI end sign */
-  std::string strColorEnd;
-  strColorEnd += CSI_END;
-#endif
+    if (flush_request != m_flushDone) {
+      {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_flushDone = flush_request;
+      }
+      m_flushCv.notify_all();
+    }
+    if (!running) break;
 
-  /* check if log output to console*/
-  if (m_outputMode & LOG_TO_CONSOLE) {
-#ifdef LOG_COLOR_ENABLE
-    printf("%s", (strColorStart + strDebugInfo + strColorEnd).c_str());    // PRQA S 6001 # thread safe
-#else
-    printf("%s", strDebugInfo.c_str());    // PRQA S 6001 # thread safe
-#endif
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCv.wait_for(lock, interval, [this] {
+      return m_wakeup.load(std::memory_order_relaxed) || !m_running.load(std::memory_order_relaxed) ||
+             m_flushRequest.load(std::memory_order_relaxed) != m_flushDone;
+    });
   }
+}
 
-  /* check if log output to file*/
-  LogToFile(strDebugInfo);
+/* a record produced by the writer itself, formatted in place */
+void Logger::WriteNotice(int level, const char* tag, const char* file, int line, const char* text) {
+  if (level > m_logFilter.level.load(std::memory_order_relaxed)) return;
+  LogRecord notice;
+  struct timespec tp;
+  clock_gettime(CLOCK_REALTIME, &tp);
+  notice.timeNs = static_cast<int64_t>(tp.tv_sec) * 1000000000 + tp.tv_nsec;
+  notice.site = nullptr;
+  notice.file = file;
+  notice.tag = tag;
+  notice.line = line;
+  notice.level = level;
+  notice.size = 0;
+  snprintf(notice.msg, MAX_LOG_LEN, "%s", text);
+  FormatRecord(notice, static_cast<int>(syscall(SYS_gettid)));
+}
+
+/* one summary line per rate-limited site that suppressed logs since the last report */
+void Logger::ReportSuppressed() {
+  for (LogLimiter* limiter = LogLimiter::Head(); limiter; limiter = limiter->next()) {
+    const uint64_t suppressed = limiter->TakeSuppressed();
+    if (suppressed == 0) continue;
+    char text[96];
+    snprintf(text, sizeof(text), "%llu similar logs suppressed since the last summary.",
+             static_cast<unsigned long long>(suppressed));
+    WriteNotice(limiter->level(), limiter->tag(), limiter->file(), limiter->line(), text);
+  }
+}
+
+void Logger::SetRateLimit(const char* const tag, uint32_t everyN, uint32_t intervalMs) {
+  if (!tag) return;
+  {
+    std::lock_guard<std::mutex> lock(m_rateMutex);
+    m_rateLimits[tag] = std::make_pair(everyN, intervalMs);
+  }
+  LogLimiter::Invalidate();
+}
+
+bool Logger::GetRateLimit(const char* const tag, uint32_t& everyN, uint32_t& intervalMs) {
+  std::lock_guard<std::mutex> lock(m_rateMutex);
+  auto it = m_rateLimits.find(tag);
+  if (it == m_rateLimits.end()) return false;
+  everyN = it->second.first;
+  intervalMs = it->second.second;
+  return true;
+}
+
+void Logger::ResetRateLimits() {
+  {
+    std::lock_guard<std::mutex> lock(m_rateMutex);
+    m_rateLimits.clear();
+  }
+  LogLimiter::Invalidate();
+}
+
+void Logger::Flush() {
+  if (!m_running.load(std::memory_order_acquire) || std::this_thread::get_id() == m_worker.get_id())
+    return;
+  std::unique_lock<std::mutex> lock(m_wakeMutex);
+  const uint64_t request = m_flushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+  m_wakeCv.notify_one();
+  m_flushCv.wait_for(lock, std::chrono::seconds(1), [&] { return m_flushDone >= request; });
+}
+
+uint64_t Logger::GetDroppedCount() const {
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::StopWorker() {
+  if (!m_worker.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_running.store(false, std::memory_order_release);
+  }
+  m_wakeCv.notify_all();
+  m_worker.join();
 }
 
 void Logger::Log(const long& nLevel, const char* const pszFile, const int& lineNo, const char* pszFmt, ...) {
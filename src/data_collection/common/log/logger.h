@@ -13,12 +13,23 @@
 #include <mutex>
 #include <vector>
 #include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <map>
+#include <unordered_set>
 
 #include "logger_config.h"
 
 /* output log's level */
 enum LOG_LEVEL {
-  LOG_LEVEL_NONE = -3,
+  LOG_LEVEL_NONE = -4,
+  LOG_LEVEL_FATAL = -3,
   LOG_LEVEL_ERROR = -2,
   LOG_LEVEL_WARNING = -1,
   LOG_LEVEL_INFO = 0,
@@ -35,17 +46,83 @@ enum LOG_LEVEL {
 
 /**
  * log API short definition
+ *
+ * Each call site owns a static LogSite (level, tag, file, line, format) with a
+ * process-wide id. A call only records the site and the raw arguments; the
+ * writer thread formats them (text file) or writes them as they are (binary
+ * file, see LOG_TO_BINARY_FILE and tools/log_decoder). The format must be a
+ * string literal, arguments may be integers, enums, floating point, C strings,
+ * std::string or pointers.
+ */
+/* levels above this are compiled out, e.g. -DAD_LOG_COMPILE_LEVEL=LOG_LEVEL_INFO for release builds */
+#ifndef AD_LOG_COMPILE_LEVEL
+#define AD_LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG9
+#endif
+
+/* first of (FMT, args...), the trailing 0 keeps '...' non-empty for -Wpedantic */
+#define AD_LOG_FMT(...) AD_LOG_FMT_(__VA_ARGS__, 0)
+#define AD_LOG_FMT_(FMT, ...) FMT
+
+/* the ... is (FMT, args...); LogArgs skips FMT, which the site already holds */
+#define AD_LOG_SITE(LEVEL, TAG, ...)                                         \
+  do {                                                                       \
+    if (LEVEL <= AD_LOG_COMPILE_LEVEL) {                                     \
+      auto* ad_logger_ = dcp::common::Logger::instance();                    \
+      if (ad_logger_->IsEnabled(LEVEL)) {                                    \
+        static const dcp::common::LogSite ad_log_site_{LEVEL, #TAG, __FILE__,\
+                                          __LINE__, AD_LOG_FMT(__VA_ARGS__)};\
+        ad_logger_->LogArgs(ad_log_site_, __VA_ARGS__);                      \
+      }                                                                      \
+    }                                                                        \
+  } while (0)
+
+/**
+ * Same as AD_LOG_SITE, with a per-site LogLimiter consulted after the level
+ * check and before the arguments are touched. ALLOW is Allow() or AllowKey(key).
+ * The limiter is never freed so the writer can still report it during exit.
  */
-#define AD_INFO(TAG,...)                                                 \
-  dcp::common::Logger::instance()->Log(LOG_LEVEL_INFO, #TAG, __FILE__,   \
-    __LINE__, __VA_ARGS__)
-#define AD_ERROR(TAG, ...)                                               \
-  dcp::common::Logger::instance()->Log(LOG_LEVEL_ERROR, #TAG, __FILE__,  \
-    __LINE__, __VA_ARGS__)
-#define AD_WARN(TAG,...)                                                  \
-  dcp::common::Logger::instance()->Log(LOG_LEVEL_WARNING, #TAG, __FILE__, \
-    __LINE__, __VA_ARGS__)
+#define AD_LOG_LIMITED(LEVEL, TAG, EVERY_N, INTERVAL_MS, ALLOW, ...)                   \
+  do {                                                                                 \
+    if (LEVEL <= AD_LOG_COMPILE_LEVEL) {                                               \
+      auto* ad_logger_ = dcp::common::Logger::instance();                              \
+      if (ad_logger_->IsEnabled(LEVEL)) {                                              \
+        static dcp::common::LogLimiter& ad_log_limiter_ =                              \
+            *new dcp::common::LogLimiter(LEVEL, #TAG, __FILE__, __LINE__, EVERY_N, INTERVAL_MS); \
+        if (ad_log_limiter_.ALLOW) {                                                   \
+          static const dcp::common::LogSite ad_log_site_{LEVEL, #TAG, __FILE__,        \
+                                                __LINE__, AD_LOG_FMT(__VA_ARGS__)};    \
+          ad_logger_->LogArgs(ad_log_site_, __VA_ARGS__);                              \
+        }                                                                              \
+      }                                                                                \
+    }                                                                                  \
+  } while (0)
+
+#define AD_INFO(TAG,...) AD_LOG_SITE(LOG_LEVEL_INFO, TAG, __VA_ARGS__)
+#define AD_ERROR(TAG, ...) AD_LOG_SITE(LOG_LEVEL_ERROR, TAG, __VA_ARGS__)
+#define AD_WARN(TAG,...) AD_LOG_SITE(LOG_LEVEL_WARNING, TAG, __VA_ARGS__)
+#define AD_DEBUG(TAG,...) AD_LOG_SITE(LOG_LEVEL_DEBUG1, TAG, __VA_ARGS__)
+/* FATAL is written synchronously: returns after the log reaches console/file */
+#define AD_FATAL(TAG,...) AD_LOG_SITE(LOG_LEVEL_FATAL, TAG, __VA_ARGS__)
 
+/**
+ * hot path logs: suppressed occurrences are counted and summarized by the
+ * writer every LOG_SUPPRESS_REPORT_MS; limits can be overridden per tag at
+ * runtime with Logger::SetRateLimit
+ */
+/* the 1st, N+1th, 2N+1th... occurrence */
+#define AD_INFO_EVERY_N(TAG, N, ...) AD_LOG_LIMITED(LOG_LEVEL_INFO, TAG, N, 0, Allow(), __VA_ARGS__)
+#define AD_WARN_EVERY_N(TAG, N, ...) AD_LOG_LIMITED(LOG_LEVEL_WARNING, TAG, N, 0, Allow(), __VA_ARGS__)
+#define AD_ERROR_EVERY_N(TAG, N, ...) AD_LOG_LIMITED(LOG_LEVEL_ERROR, TAG, N, 0, Allow(), __VA_ARGS__)
+#define AD_DEBUG_EVERY_N(TAG, N, ...) AD_LOG_LIMITED(LOG_LEVEL_DEBUG1, TAG, N, 0, Allow(), __VA_ARGS__)
+/* at most once per MS milliseconds */
+#define AD_INFO_EVERY_MS(TAG, MS, ...) AD_LOG_LIMITED(LOG_LEVEL_INFO, TAG, 0, MS, Allow(), __VA_ARGS__)
+#define AD_WARN_EVERY_MS(TAG, MS, ...) AD_LOG_LIMITED(LOG_LEVEL_WARNING, TAG, 0, MS, Allow(), __VA_ARGS__)
+#define AD_ERROR_EVERY_MS(TAG, MS, ...) AD_LOG_LIMITED(LOG_LEVEL_ERROR, TAG, 0, MS, Allow(), __VA_ARGS__)
+#define AD_DEBUG_EVERY_MS(TAG, MS, ...) AD_LOG_LIMITED(LOG_LEVEL_DEBUG1, TAG, 0, MS, Allow(), __VA_ARGS__)
+/* first occurrence of each KEY (std::string or C string), e.g. per topic */
+#define AD_INFO_FIRST(TAG, KEY, ...) AD_LOG_LIMITED(LOG_LEVEL_INFO, TAG, 0, 0, AllowKey(KEY), __VA_ARGS__)
+#define AD_WARN_FIRST(TAG, KEY, ...) AD_LOG_LIMITED(LOG_LEVEL_WARNING, TAG, 0, 0, AllowKey(KEY), __VA_ARGS__)
+#define AD_ERROR_FIRST(TAG, KEY, ...) AD_LOG_LIMITED(LOG_LEVEL_ERROR, TAG, 0, 0, AllowKey(KEY), __VA_ARGS__)
 
 namespace dcp::common {
 
@@ -70,17 +147,145 @@ typedef struct {
  * keywords' size == 0, output log normally
  */
 typedef struct {
-  LOG_LEVEL level;
+  std::atomic<int> level{LOG_LEVEL_NONE};  // read on every AD_* call, written by SetLevel on hot reload
   std::vector<LogTag> tags;
   std::vector<LogKw> keywords;
 } LogFilter, *LogFilter_t;
 
 /* log output to console or file */
 enum LogOutputMode {
-  LOG_TO_CONSOLE = 1 << 0,  // log output to console
-  LOG_TO_FILE = 1 << 1,     // log output to file
+  LOG_TO_CONSOLE = 1 << 0,      // log output to console
+  LOG_TO_FILE = 1 << 1,         // log output to file
+  LOG_TO_BINARY_FILE = 1 << 2,  // log file keeps format ids and raw arguments, decode with tools/log_decoder
 };
 
+/* static description of one AD_* call site */
+struct LogSite {
+  LogSite(int lvl, const char* t, const char* f, int l, const char* fmt);
+  int level;
+  const char* tag;
+  const char* file;
+  int line;
+  const char* format;
+  uint32_t id;  // assigned on first use, unique within the process
+};
+
+/**
+ * @brief serialize log arguments as [type][value] into a record buffer.
+ * types: 'i' int64, 'u' uint64, 'd' double, 'p' pointer(uint64), 's' uint16 length + bytes.
+ * Values use host byte order. Arguments that do not fit are dropped, strings are truncated.
+ */
+class LogArgEncoder {
+ public:
+  LogArgEncoder(char* buf, size_t cap) : m_buf(buf), m_cap(cap), m_size(0) {}
+
+  template <typename T>
+  void Put(const T& v) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, bool>) {
+      PutValue<int64_t>('i', v ? 1 : 0);
+    } else if constexpr (std::is_enum_v<D>) {
+      PutValue<int64_t>('i', static_cast<int64_t>(v));
+    } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+      PutValue<int64_t>('i', static_cast<int64_t>(v));
+    } else if constexpr (std::is_integral_v<D>) {
+      PutValue<uint64_t>('u', static_cast<uint64_t>(v));
+    } else if constexpr (std::is_floating_point_v<D>) {
+      PutValue<double>('d', static_cast<double>(v));
+    } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+      const char* str = static_cast<const char*>(v);
+      if (!str) str = "(null)";
+      PutString(str, strlen(str));
+    } else if constexpr (std::is_same_v<D, std::string> || std::is_same_v<D, std::string_view>) {
+      PutString(v.data(), v.size());
+    } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+      PutValue<uint64_t>('p', reinterpret_cast<uint64_t>(static_cast<const void*>(v)));
+    } else {
+      static_assert(sizeof(D) == 0, "unsupported log argument type");
+    }
+  }
+
+  size_t size() const { return m_size; }
+
+ private:
+  template <typename V>
+  void PutValue(char type, V v) {
+    if (m_size + 1 + sizeof(V) > m_cap) return;
+    m_buf[m_size++] = type;
+    memcpy(m_buf + m_size, &v, sizeof(V));
+    m_size += sizeof(V);
+  }
+
+  void PutString(const char* str, size_t len) {
+    if (m_size + 1 + sizeof(uint16_t) > m_cap) return;
+    len = std::min(len, m_cap - m_size - 1 - sizeof(uint16_t));
+    const uint16_t len16 = static_cast<uint16_t>(len);
+    m_buf[m_size++] = 's';
+    memcpy(m_buf + m_size, &len16, sizeof(len16));
+    m_size += sizeof(len16);
+    memcpy(m_buf + m_size, str, len);
+    m_size += len;
+  }
+
+  char* m_buf;
+  size_t m_cap;
+  size_t m_size;
+};
+
+/**
+ * @brief per call site rate limiter of the AD_*_EVERY_N / _EVERY_MS / _FIRST macros.
+ * everyN/intervalMs of 0 mean no limit of that kind; a tag override set with
+ * Logger::SetRateLimit replaces the site defaults. For _FIRST sites a repeated
+ * key is suppressed unless an override allows it.
+ */
+class LogLimiter {
+ public:
+  LogLimiter(int level, const char* tag, const char* file, int line, uint32_t everyN, uint32_t intervalMs);
+
+  bool Allow();
+  bool AllowKey(std::string_view key);
+
+  /* suppressed since the last call, used by the writer for summaries */
+  uint64_t TakeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+  int level() const { return m_level; }
+  const char* tag() const { return m_tag; }
+  const char* file() const { return m_file; }
+  int line() const { return m_line; }
+  LogLimiter* next() const { return m_next; }
+
+  /* all limiters ever created, newest first */
+  static LogLimiter* Head() { return s_head.load(std::memory_order_acquire); }
+  /* bumped by Logger::SetRateLimit, limiters re-read their override on change */
+  static void Invalidate() { s_generation.fetch_add(1, std::memory_order_release); }
+
+ private:
+  bool AllowRate();
+  void Refresh();
+
+  int m_level;
+  const char* m_tag;
+  const char* m_file;
+  int m_line;
+  const uint32_t m_defaultEveryN;
+  const uint32_t m_defaultIntervalMs;
+  std::atomic<uint32_t> m_everyN;
+  std::atomic<uint32_t> m_intervalMs;
+  std::atomic<uint32_t> m_generation{0};
+  std::atomic<uint64_t> m_count{0};
+  std::atomic<int64_t> m_lastNs{0};
+  std::atomic<uint64_t> m_suppressed{0};
+  std::mutex m_keyMutex;
+  std::unordered_set<size_t> m_keys;  // key hashes, at most LOG_LIMIT_MAX_KEYS
+  LogLimiter* m_next = nullptr;
+
+  static std::atomic<LogLimiter*> s_head;
+  static std::atomic<uint32_t> s_generation;
+};
+
+/* printf-style formatting of encoded arguments, used by the writer thread */
+std::string FormatLogArgs(const char* format, const char* args, size_t len);
+
 #define LOG_CHECK_AND_RETURN(EXPR)                                       \
   if (!(EXPR)) {                                                         \
     printf("Log is not inited, return\n");                               \
@@ -95,10 +300,20 @@ enum LogOutputMode {
     }                                                                   \
   } while (0)
 
+struct LogRecord;
+struct LogRing;
+
 /**
  * @class Logger
  *
  * @brief Light-weight log system implement.
+ *
+ * Log() only fills a record into the calling thread's lock-free ring
+ * (single producer / single consumer). A background thread merges the rings
+ * by time, adds the prefix, applies the keyword filter and writes in batches,
+ * flushing when LOG_BATCH_MAX_BYTES is reached or every LOG_FLUSH_INTERVAL_MS.
+ * When a ring is full the record is dropped and counted; the writer reports
+ * the count in the log. FATAL logs wait until they are flushed.
  */
 class Logger {
  public:
@@ -139,13 +354,47 @@ class Logger {
   /* rotate the log file */
   bool LogFileRotate();
 
+  /**
+   * @brief override the limits of every rate-limited site with this tag,
+   * e.g. everyN=1 and intervalMs=0 turns limiting off for the tag
+   */
+  void SetRateLimit(const char* const tag, uint32_t everyN, uint32_t intervalMs);
+  bool GetRateLimit(const char* const tag, uint32_t& everyN, uint32_t& intervalMs);
+  void ResetRateLimits();
+
+  /* block until every record logged before this call is written and flushed */
+  void Flush();
+
+  /* total records dropped because a thread's ring was full */
+  uint64_t GetDroppedCount() const;
+
   /* write strs to the log file */
   void LogToFile(std::string& strs);
 
-  /* write strs to the log csvfile */
+  /* write strs to the log csvfile, see MetricsRecorder for hot paths */
   std::vector<std::string> split(std::string str,std::string pattern1,std::string pattern2) ;
   void LogToCsvFile(std::string strs);
 
+  /* level and output check done by AD_* before touching the arguments */
+  bool IsEnabled(const long& nLevel) const {
+    return m_initFlag && nLevel <= m_logFilter.level.load(std::memory_order_relaxed) && (m_outputMode & (LOG_TO_CONSOLE | LOG_TO_FILE));
+  }
+
+  /**
+   * @brief record a call site and its raw arguments, formatting is deferred
+   * to the writer thread
+   */
+  template <typename... Args>
+  void LogArgs(const LogSite& site, const char* /* format, kept in site */, const Args&... args) {
+    size_t cap = 0;
+    LogRing* ring = nullptr;
+    char* buf = BeginSite(site, ring, cap);
+    if (!buf) return;
+    LogArgEncoder encoder(buf, cap);
+    (encoder.Put(args), ...);
+    EndSite(ring, site.level, encoder.size());
+  }
+
   /**
    * @brief output the log
    *
@@ -178,6 +427,21 @@ class Logger {
   Logger(const Logger& rhs) = delete;
   Logger& operator=(const Logger& rhs) = delete;
 
+  char* BeginSite(const LogSite& site, LogRing*& ring, size_t& cap);
+  void EndSite(LogRing* ring, int level, size_t size);
+  void AppendFrame(const LogRecord& record, int tid);
+  void WriteFileHeader();
+  LogRing* GetThreadRing();
+  LogRecord* Reserve(LogRing* ring, const long& nLevel);
+  void Commit(LogRing* ring, const long& nLevel);
+  void Run();
+  size_t DrainRings();
+  void FormatRecord(const LogRecord& record, int tid);
+  void WriteNotice(int level, const char* tag, const char* file, int line, const char* text);
+  void ReportSuppressed();
+  void WriteBatch();
+  void StopWorker();
+
  private:
   static Logger* pLog;
   std::mutex m_mutex;
@@ -185,7 +449,6 @@ class Logger {
 
   /* log file handle */
   FILE* m_fp;
-  std::ifstream inFile;
   std::ofstream csvFile;
 
   /* log file path */
@@ -200,6 +463,29 @@ class Logger {
 
   /* initialization flag */
   bool m_initFlag;
+
+  /* async backend: per-thread rings drained by m_worker */
+  std::vector<std::shared_ptr<LogRing>> m_rings;
+  std::mutex m_ringMutex;
+  std::thread m_worker;
+  std::atomic<bool> m_running{false};
+  std::atomic<bool> m_wakeup{false};
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wakeCv;
+  std::condition_variable m_flushCv;
+  std::atomic<uint64_t> m_flushRequest{0};
+  uint64_t m_flushDone = 0;
+  std::atomic<uint64_t> m_dropped{0};
+  uint64_t m_reportedDropped = 0;
+  std::string m_consoleBatch;
+  std::string m_fileBatch;
+
+  /* binary file: site ids whose definition is already in the current file */
+  std::vector<bool> m_siteWritten;
+
+  /* rate limit overrides by tag */
+  std::map<std::string, std::pair<uint32_t, uint32_t>> m_rateLimits;  // tag -> (everyN, intervalMs)
+  std::mutex m_rateMutex;
 };
 
 } 
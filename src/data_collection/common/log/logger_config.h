@@ -21,6 +21,21 @@ namespace dcp::common {
 /* Logger file log plugin's using max rotate file count */
 #define LOG_FILE_MAX_ROTATE 5
 
+/* records buffered per producer thread, must be a power of 2 */
+#define LOG_RING_CAPACITY 256
+
+/* the writer flushes once this many bytes are batched ... */
+#define LOG_BATCH_MAX_BYTES (64 * 1024)
+
+/* ... or this long after the last flush */
+#define LOG_FLUSH_INTERVAL_MS 100
+
+/* rate-limited sites report their suppressed count this often */
+#define LOG_SUPPRESS_REPORT_MS 10000
+
+/* distinct keys remembered by each AD_*_FIRST site, later keys are suppressed */
+#define LOG_LIMIT_MAX_KEYS 1024
+
 /* enable tag output in the log */
 // #define LOG_TAG_OUTPUT_ENABLE
 
@@ -0,0 +1,349 @@
+//
+// Created by xucong on 25-10-2.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "message_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "common/log/logger.h"
+
+namespace dcp::common {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4d504f4c;  // "MPOL"
+constexpr uint32_t kLargeClass = UINT32_MAX;
+
+void* PoolAllocate(size_t size, void* state) {
+    return static_cast<MessagePool*>(state)->Allocate(size);
+}
+
+void PoolDeallocate(void* ptr, void* state) {
+    static_cast<MessagePool*>(state)->Deallocate(ptr);
+}
+
+void* PoolReallocate(void* ptr, size_t size, void* state) {
+    return static_cast<MessagePool*>(state)->Reallocate(ptr, size);
+}
+
+void* PoolZeroAllocate(size_t count, size_t size, void* state) {
+    const size_t total = count * size;
+    if (size != 0 && total / size != count) {
+        return nullptr;
+    }
+    void* ptr = static_cast<MessagePool*>(state)->Allocate(total);
+    if (ptr) {
+        std::memset(ptr, 0, total);
+    }
+    return ptr;
+}
+
+// 线程退出时其他thread_local对象的析构函数可能晚于线程缓存析构再分配或释放消息
+thread_local bool tls_cache_retired = false;
+
+// 单写者计数，避免lock前缀
+inline void Bump(std::atomic<uint64_t>& counter, uint64_t delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+}
+
+struct MessagePool::ThreadCache {
+    explicit ThreadCache(MessagePool& pool) : pool(pool) {
+        std::lock_guard<std::mutex> lock(pool.caches_mutex_);
+        pool.caches_.push_back(this);
+    }
+    ~ThreadCache() {
+        pool.Retire(*this);
+        tls_cache_retired = true;
+    }
+
+    MessagePool& pool;
+    FreeList lists[kClassCount];
+    size_t cached_bytes = 0;
+    Counters counters;
+};
+
+MessagePool& MessagePool::getInstance() {
+    // 不析构：线程缓存和晚释放的消息都可能在静态析构之后访问
+    static MessagePool* instance = new MessagePool();
+    return *instance;
+}
+
+bool MessagePool::Init(bool enabled, size_t threadCacheBytes, size_t slabBytes) {
+    thread_cache_bytes_ = std::max<size_t>(threadCacheBytes, ClassSize(0));
+    slab_bytes_ = std::max<size_t>(slabBytes, 4096);
+    enabled_ = enabled;
+    AD_INFO(MessagePool, "Init %s, thread cache: %zuKB, slab: %zuKB, classes: %zuB-%zuB",
+            enabled ? "enabled" : "disabled", thread_cache_bytes_ / 1024, slab_bytes_ / 1024,
+            ClassSize(0), ClassSize(kClassCount - 1));
+    return true;
+}
+
+rcutils_allocator_t MessagePool::Allocator() {
+    if (!IsEnabled()) {
+        return rcutils_get_default_allocator();
+    }
+    rcutils_allocator_t allocator = rcutils_get_default_allocator();
+    allocator.allocate = &PoolAllocate;
+    allocator.deallocate = &PoolDeallocate;
+    allocator.reallocate = &PoolReallocate;
+    allocator.zero_allocate = &PoolZeroAllocate;
+    allocator.state = this;
+    return allocator;
+}
+
+size_t MessagePool::ClassOf(size_t size) {
+    size_t cls = 0;
+    while (cls < kClassCount && ClassSize(cls) < size) {
+        ++cls;
+    }
+    return cls;
+}
+
+MessagePool::ThreadCache* MessagePool::LocalCache() {
+    if (tls_cache_retired) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache(*this);
+    return &cache;
+}
+
+void* MessagePool::Allocate(size_t size) {
+    const size_t cls = ClassOf(std::max<size_t>(size, 1));
+    if (cls == kClassCount) {
+        auto* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+        if (!header) {
+            return nullptr;
+        }
+        header->cls = kLargeClass;
+        header->magic = kMagic;
+        header->size = size;
+        large_allocations_.fetch_add(1, std::memory_order_relaxed);
+        large_bytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        return header + 1;
+    }
+
+    ThreadCache* local = LocalCache();
+    if (!local) {
+        return AllocateCentral(cls);
+    }
+    ThreadCache& cache = *local;
+    FreeList& list = cache.lists[cls];
+    if (!list.head) {
+        Bump(cache.counters.cacheMisses);
+        Refill(cache, cls);
+        if (!list.head) {
+            return nullptr;
+        }
+    }
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    --list.count;
+    cache.cached_bytes -= ClassSize(cls);
+    Bump(cache.counters.allocations);
+    Bump(cache.counters.allocatedBytes, ClassSize(cls));
+    return block;
+}
+
+void MessagePool::Deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    Header* header = static_cast<Header*>(ptr) - 1;
+    if (header->magic != kMagic) {
+        AD_ERROR(MessagePool, "Deallocate %p: not allocated by the pool", ptr);
+        return;
+    }
+    if (header->cls == kLargeClass) {
+        large_bytes_.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+        std::free(header);
+        return;
+    }
+
+    const size_t cls = header->cls;
+    ThreadCache* local = LocalCache();
+    if (!local) {
+        DeallocateCentral(cls, static_cast<FreeBlock*>(ptr));
+        return;
+    }
+    ThreadCache& cache = *local;
+    FreeList& list = cache.lists[cls];
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = list.head;
+    list.head = block;
+    ++list.count;
+    cache.cached_bytes += ClassSize(cls);
+    Bump(cache.counters.frees);
+    Bump(cache.counters.freedBytes, ClassSize(cls));
+    if (cache.cached_bytes > thread_cache_bytes_) {
+        // 生产者线程分配、消费者线程释放时块会堆积在消费者，超限后归还一半
+        Release(cache, cls, (list.count + 1) / 2);
+    }
+}
+
+void* MessagePool::Reallocate(void* ptr, size_t size) {
+    if (!ptr) {
+        return Allocate(size);
+    }
+    const Header* header = static_cast<const Header*>(ptr) - 1;
+    const size_t capacity = header->cls == kLargeClass ? header->size : ClassSize(header->cls);
+    if (size <= capacity && (header->cls == kLargeClass ? size > ClassSize(kClassCount - 1)
+                                                        : ClassOf(std::max<size_t>(size, 1)) == header->cls)) {
+        return ptr;
+    }
+    void* resized = Allocate(size);
+    if (!resized) {
+        return nullptr;
+    }
+    std::memcpy(resized, ptr, std::min(capacity, size));
+    Deallocate(ptr);
+    return resized;
+}
+
+void MessagePool::Refill(ThreadCache& cache, size_t cls) {
+    const size_t block_size = ClassSize(cls);
+    // 一次取回约1/4线程缓存容量，大规格至少一块
+    const size_t batch = std::max<size_t>(thread_cache_bytes_ / 4 / block_size, 1);
+    Central& central = central_[cls];
+    FreeList& list = cache.lists[cls];
+
+    std::lock_guard<std::mutex> lock(central.mutex);
+    if (central.list.count == 0 && !Carve(central, cls)) {
+        return;
+    }
+    for (size_t i = 0; i < batch && central.list.head; ++i) {
+        FreeBlock* block = central.list.head;
+        central.list.head = block->next;
+        --central.list.count;
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+        cache.cached_bytes += block_size;
+    }
+}
+
+bool MessagePool::Carve(Central& central, size_t cls) {
+    const size_t block_size = ClassSize(cls);
+    const size_t stride = sizeof(Header) + block_size;
+    const size_t blocks = std::max<size_t>(slab_bytes_ / stride, 1);
+    auto* slab = static_cast<uint8_t*>(std::malloc(blocks * stride));
+    if (!slab) {
+        AD_ERROR(MessagePool, "Allocate slab of %zu x %zuB failed", blocks, block_size);
+        return false;
+    }
+    for (size_t i = 0; i < blocks; ++i) {
+        auto* header = reinterpret_cast<Header*>(slab + i * stride);
+        header->cls = static_cast<uint32_t>(cls);
+        header->magic = kMagic;
+        header->size = 0;
+        auto* block = reinterpret_cast<FreeBlock*>(header + 1);
+        block->next = central.list.head;
+        central.list.head = block;
+    }
+    central.list.count += blocks;
+    slab_bytes_total_.fetch_add(blocks * stride, std::memory_order_relaxed);
+    return true;
+}
+
+void* MessagePool::AllocateCentral(size_t cls) {
+    Central& central = central_[cls];
+    FreeBlock* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(central.mutex);
+        if (central.list.count == 0 && !Carve(central, cls)) {
+            return nullptr;
+        }
+        block = central.list.head;
+        central.list.head = block->next;
+        --central.list.count;
+    }
+    // 多个退出中的线程可能同时走到这里，计数用原子加
+    retired_.allocations.fetch_add(1, std::memory_order_relaxed);
+    retired_.cacheMisses.fetch_add(1, std::memory_order_relaxed);
+    retired_.allocatedBytes.fetch_add(ClassSize(cls), std::memory_order_relaxed);
+    return block;
+}
+
+void MessagePool::DeallocateCentral(size_t cls, FreeBlock* block) {
+    Central& central = central_[cls];
+    {
+        std::lock_guard<std::mutex> lock(central.mutex);
+        block->next = central.list.head;
+        central.list.head = block;
+        ++central.list.count;
+    }
+    retired_.frees.fetch_add(1, std::memory_order_relaxed);
+    retired_.freedBytes.fetch_add(ClassSize(cls), std::memory_order_relaxed);
+}
+
+void MessagePool::Release(ThreadCache& cache, size_t cls, size_t count) {
+    FreeList& list = cache.lists[cls];
+    count = std::min(count, list.count);
+    if (count == 0) {
+        return;
+    }
+    // 先在本线程摘出一段链表，持锁时只做一次拼接
+    FreeBlock* first = list.head;
+    FreeBlock* last = first;
+    for (size_t i = 1; i < count; ++i) {
+        last = last->next;
+    }
+    list.head = last->next;
+    list.count -= count;
+    cache.cached_bytes -= count * ClassSize(cls);
+
+    Central& central = central_[cls];
+    std::lock_guard<std::mutex> lock(central.mutex);
+    last->next = central.list.head;
+    central.list.head = first;
+    central.list.count += count;
+}
+
+void MessagePool::Retire(ThreadCache& cache) {
+    for (size_t cls = 0; cls < kClassCount; ++cls) {
+        Release(cache, cls, cache.lists[cls].count);
+    }
+    std::lock_guard<std::mutex> lock(caches_mutex_);
+    caches_.erase(std::remove(caches_.begin(), caches_.end(), &cache), caches_.end());
+    retired_.allocations += cache.counters.allocations.load(std::memory_order_relaxed);
+    retired_.frees += cache.counters.frees.load(std::memory_order_relaxed);
+    retired_.cacheMisses += cache.counters.cacheMisses.load(std::memory_order_relaxed);
+    retired_.allocatedBytes += cache.counters.allocatedBytes.load(std::memory_order_relaxed);
+    retired_.freedBytes += cache.counters.freedBytes.load(std::memory_order_relaxed);
+}
+
+MessagePool::Stats MessagePool::GetStats() {
+    Stats stats;
+    uint64_t allocated_bytes = 0;
+    uint64_t freed_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(caches_mutex_);
+        auto add = [&](const Counters& counters) {
+            stats.allocations += counters.allocations.load(std::memory_order_relaxed);
+            stats.frees += counters.frees.load(std::memory_order_relaxed);
+            stats.cacheMisses += counters.cacheMisses.load(std::memory_order_relaxed);
+            allocated_bytes += counters.allocatedBytes.load(std::memory_order_relaxed);
+            freed_bytes += counters.freedBytes.load(std::memory_order_relaxed);
+        };
+        add(retired_);
+        for (const ThreadCache* cache : caches_) {
+            add(cache->counters);
+        }
+        stats.threadCaches = caches_.size();
+    }
+    // 跨线程读取的计数不是同一时刻的快照，差值可能短暂为负
+    const int64_t large_bytes = std::max<int64_t>(large_bytes_.load(std::memory_order_relaxed), 0);
+    stats.bytesInUse = (allocated_bytes > freed_bytes ? allocated_bytes - freed_bytes : 0) +
+                       static_cast<uint64_t>(large_bytes);
+    stats.largeAllocations = large_allocations_.load(std::memory_order_relaxed);
+    stats.slabBytes = slab_bytes_total_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}
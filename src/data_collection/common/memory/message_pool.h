@@ -0,0 +1,130 @@
+//
+// Created by xucong on 25-10-2.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+namespace dcp::common {
+
+/**
+ * @brief 序列化消息缓冲区的分级slab内存池，以rcutils_allocator_t的形式提供给
+ *        订阅和录制拷贝使用。
+ *
+ * 按2的幂划分64B~4MB共17个规格，每块前有16字节头记录规格。每个线程持有各规格的
+ * 空闲链表，分配和释放只操作本线程链表（O(1)、无锁）；本线程缓存超过threadCacheBytes
+ * 时归还一半到全局链表，缺块时从全局链表批量取回，全局也为空时按slabBytes向系统
+ * 申请一整块切分。slab不归还系统，块在同规格内循环复用，占用由各规格的峰值决定，
+ * 不随运行时间碎片化增长。超过最大规格的请求直接malloc。
+ * 线程缓存析构之后（线程退出时其他thread_local对象的析构函数里）的分配和释放
+ * 直接持锁操作全局链表。
+ * 实例不析构，释放晚于静态对象析构的消息仍然安全。
+ */
+class MessagePool {
+public:
+    struct Stats {
+        uint64_t allocations = 0;       // 池内分配次数
+        uint64_t frees = 0;             // 池内释放次数
+        uint64_t cacheMisses = 0;       // 线程缓存为空、需从全局链表取块的次数
+        uint64_t largeAllocations = 0;  // 超过最大规格直接malloc的次数
+        uint64_t bytesInUse = 0;        // 已分配未释放的块容量（含large）
+        uint64_t slabBytes = 0;         // 向系统申请的slab总量
+        uint64_t threadCaches = 0;      // 活动线程缓存数
+    };
+
+    static MessagePool& getInstance();
+
+    // 在第一次取Allocator()之前调用；disabled时Allocator()返回rcutils默认分配器
+    bool Init(bool enabled, size_t threadCacheBytes, size_t slabBytes);
+
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    rcutils_allocator_t Allocator();
+
+    void* Allocate(size_t size);
+    void Deallocate(void* ptr);
+    void* Reallocate(void* ptr, size_t size);
+
+    Stats GetStats();
+
+    static constexpr size_t kMinShift = 6;   // 64B
+    static constexpr size_t kMaxShift = 22;  // 4MB
+    static constexpr size_t kClassCount = kMaxShift - kMinShift + 1;
+
+private:
+    struct Header {
+        uint32_t cls;
+        uint32_t magic;
+        uint64_t size;  // 仅large块使用
+    };
+    static_assert(sizeof(Header) == 16, "header keeps the payload 16-byte aligned");
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+    };
+
+    struct Central {
+        std::mutex mutex;
+        FreeList list;
+    };
+
+    // 只由所属线程写入，统计线程并发读取
+    struct Counters {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> cacheMisses{0};
+        std::atomic<uint64_t> allocatedBytes{0};
+        std::atomic<uint64_t> freedBytes{0};
+    };
+
+    struct ThreadCache;
+
+    MessagePool() = default;
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    static size_t ClassOf(size_t size);
+    static size_t ClassSize(size_t cls) { return size_t{1} << (cls + kMinShift); }
+
+    // 本线程缓存已析构时返回nullptr
+    ThreadCache* LocalCache();
+    void Refill(ThreadCache& cache, size_t cls);
+    bool Carve(Central& central, size_t cls);  // 调用方持有central.mutex
+    void* AllocateCentral(size_t cls);
+    void DeallocateCentral(size_t cls, FreeBlock* block);
+    void Release(ThreadCache& cache, size_t cls, size_t count);
+    void Retire(ThreadCache& cache);
+
+    std::atomic<bool> enabled_{false};
+    size_t thread_cache_bytes_ = 1024 * 1024;
+    size_t slab_bytes_ = 256 * 1024;
+
+    Central central_[kClassCount];
+    std::atomic<uint64_t> slab_bytes_total_{0};
+    std::atomic<uint64_t> large_allocations_{0};
+    std::atomic<int64_t> large_bytes_{0};
+
+    // 线程缓存登记，统计时汇总；线程退出后计数并入retired_
+    std::mutex caches_mutex_;
+    std::vector<ThreadCache*> caches_;
+    Counters retired_;
+};
+
+}
+
+#endif // MESSAGE_POOL_H
@@ -0,0 +1,249 @@
+//
+// Created by xucong on 25-9-18.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "metrics_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+
+#include "common/log/logger.h"
+
+namespace dcp::common {
+
+namespace fs = std::filesystem;
+
+MetricSeries::MetricSeries(const std::string& name, const std::vector<std::string>& columns, size_t capacity)
+    : name_(name), columns_(columns), capacity_(capacity) {
+    for (auto& block : blocks_) {
+        block.time.resize(capacity_);
+        block.values.resize(capacity_ * columns_.size());
+    }
+}
+
+MetricsRecorder& MetricsRecorder::getInstance() {
+    static MetricsRecorder instance;
+    return instance;
+}
+
+MetricsRecorder::~MetricsRecorder() {
+    Uninit();
+}
+
+bool MetricsRecorder::Init(const std::string& dir, int flushIntervalMs, int capacityRows, int maxFileMb) {
+    if (running_) {
+        return true;
+    }
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        AD_ERROR(MetricsRecorder, "Create metrics dir %s failed: %s", dir.c_str(), ec.message().c_str());
+        return false;
+    }
+    dir_ = dir;
+    if (!dir_.empty() && dir_.back() != '/') {
+        dir_ += "/";
+    }
+    flush_interval_ = std::chrono::milliseconds(std::max(flushIntervalMs, 10));
+    capacity_rows_ = static_cast<size_t>(std::max(capacityRows, 16));
+    max_file_bytes_ = static_cast<uint64_t>(std::max(maxFileMb, 1)) * 1024 * 1024;
+
+    running_ = true;
+    worker_ = std::thread(&MetricsRecorder::Run, this);
+    AD_INFO(MetricsRecorder, "Init success, dir: %s, flush interval: %dms, capacity: %d rows",
+            dir_.c_str(), flushIntervalMs, capacityRows);
+    return true;
+}
+
+void MetricsRecorder::Uninit() {
+    if (!worker_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_cv_.notify_all();
+    worker_.join();
+
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (auto& series : series_) {
+        FlushSeries(*series);
+        if (series->fp_) {
+            fclose(series->fp_);
+            series->fp_ = nullptr;
+        }
+    }
+}
+
+MetricSeries* MetricsRecorder::RegisterSeries(const std::string& name, const std::vector<std::string>& columns) {
+    if (!running_ || columns.empty()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (auto& series : series_) {
+        if (series->name_ == name) {
+            if (series->columns_ != columns) {
+                AD_ERROR(MetricsRecorder, "Series %s registered again with different columns.", name.c_str());
+                return nullptr;
+            }
+            return series.get();
+        }
+    }
+    series_.emplace_back(new MetricSeries(name, columns, capacity_rows_));
+    return series_.back().get();
+}
+
+MetricSeries* MetricsRecorder::RegisterSampler(const std::string& name, const std::vector<std::string>& columns,
+                                              Sampler sampler) {
+    MetricSeries* series = RegisterSeries(name, columns);
+    if (!series || !sampler) {
+        return series;
+    }
+    std::lock_guard<std::mutex> lock(sampler_mutex_);
+    samplers_.emplace_back(series, std::move(sampler));
+    return series;
+}
+
+bool MetricsRecorder::Record(MetricSeries* series, const double* values, size_t count) {
+    if (!series || !running_.load(std::memory_order_relaxed) || count != series->columns_.size()) {
+        return false;
+    }
+    struct timespec tp;
+    clock_gettime(CLOCK_REALTIME, &tp);
+    const int64_t now = static_cast<int64_t>(tp.tv_sec) * 1000000 + tp.tv_nsec / 1000;
+
+    bool half_full = false;
+    {
+        std::lock_guard<std::mutex> lock(series->mutex_);
+        auto& block = series->blocks_[series->active_];
+        if (block.rows == series->capacity_) {
+            series->dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const size_t row = block.rows++;
+        block.time[row] = now;
+        for (size_t col = 0; col < count; ++col) {
+            block.values[col * series->capacity_ + row] = values[col];
+        }
+        half_full = block.rows == series->capacity_ / 2;
+    }
+    if (half_full && !wakeup_.exchange(true, std::memory_order_relaxed)) {
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+void MetricsRecorder::Flush() {
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (auto& series : series_) {
+        FlushSeries(*series);
+    }
+}
+
+void MetricsRecorder::Run() {
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, flush_interval_, [this] {
+                return wakeup_.load(std::memory_order_relaxed) || !running_;
+            });
+            wakeup_ = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sampler_mutex_);
+            std::vector<double> values;
+            for (auto& [series, sampler] : samplers_) {
+                values.assign(series->columns_.size(), 0.0);
+                sampler(values.data());
+                Record(series, values.data(), values.size());
+            }
+        }
+        Flush();
+    }
+}
+
+bool MetricsRecorder::OpenFile(MetricSeries& series) {
+    const std::string path = dir_ + series.name_ + ".csv";
+    series.fp_ = fopen(path.c_str(), "a");
+    if (!series.fp_) {
+        AD_ERROR(MetricsRecorder, "Open %s failed.", path.c_str());
+        return false;
+    }
+    fseek(series.fp_, 0, SEEK_END);
+    series.file_bytes_ = static_cast<uint64_t>(std::max(ftell(series.fp_), 0L));
+    if (series.file_bytes_ == 0) {
+        std::string header = "timestamp_us";
+        for (const auto& column : series.columns_) {
+            header += "," + column;
+        }
+        header += "\n";
+        fwrite(header.data(), 1, header.size(), series.fp_);
+        series.file_bytes_ = header.size();
+    }
+    return true;
+}
+
+void MetricsRecorder::FlushSeries(MetricSeries& series) {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+    MetricSeries::Block* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(series.mutex_);
+        if (series.blocks_[series.active_].rows == 0) {
+            return;
+        }
+        block = &series.blocks_[series.active_];
+        series.active_ ^= 1;
+    }
+
+    if (!series.fp_ && !OpenFile(series)) {
+        block->rows = 0;
+        return;
+    }
+
+    // 列存转行写出，一次fwrite
+    const size_t columns = series.columns_.size();
+    std::string out;
+    out.reserve(block->rows * (16 + columns * 16));
+    char buf[64];
+    for (size_t row = 0; row < block->rows; ++row) {
+        int n = snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(block->time[row]));
+        out.append(buf, static_cast<size_t>(n));
+        for (size_t col = 0; col < columns; ++col) {
+            n = snprintf(buf, sizeof(buf), ",%.9g", block->values[col * series.capacity_ + row]);
+            out.append(buf, static_cast<size_t>(n));
+        }
+        out += '\n';
+    }
+    fwrite(out.data(), 1, out.size(), series.fp_);
+    fflush(series.fp_);
+    series.file_bytes_ += out.size();
+
+    {
+        // 交换回来之前必须清空，Record只会写入active块
+        std::lock_guard<std::mutex> lock(series.mutex_);
+        block->rows = 0;
+    }
+
+    const uint64_t dropped = series.dropped_.load(std::memory_order_relaxed);
+    if (dropped != series.reported_dropped_) {
+        AD_WARN(MetricsRecorder, "Series %s dropped %llu rows, flush interval too long for the sample rate.",
+                series.name_.c_str(), static_cast<unsigned long long>(dropped - series.reported_dropped_));
+        series.reported_dropped_ = dropped;
+    }
+
+    if (series.file_bytes_ >= max_file_bytes_) {
+        fclose(series.fp_);
+        series.fp_ = nullptr;
+        const std::string path = dir_ + series.name_ + ".csv";
+        std::error_code ec;
+        fs::rename(path, path + ".1", ec);
+        OpenFile(series);
+    }
+}
+
+}
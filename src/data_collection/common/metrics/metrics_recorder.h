@@ -0,0 +1,136 @@
+//
+// Created by xucong on 25-9-18.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef METRICS_RECORDER_H
+#define METRICS_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dcp::common {
+
+class MetricsRecorder;
+
+/**
+ * @brief one time series with fixed columns, created by MetricsRecorder::RegisterSeries.
+ *
+ * Samples go into a preallocated column-major block; the writer swaps it with
+ * a second block and writes the full one to <dir>/<name>.csv. Memory is fixed
+ * at 2 x capacity rows; rows recorded while both blocks are full are dropped.
+ */
+class MetricSeries {
+public:
+    const std::string& name() const { return name_; }
+    const std::vector<std::string>& columns() const { return columns_; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    friend class MetricsRecorder;
+
+    struct Block {
+        std::vector<int64_t> time;   // timestamp_us
+        std::vector<double> values;  // values[col * capacity + row]
+        size_t rows = 0;
+    };
+
+    MetricSeries(const std::string& name, const std::vector<std::string>& columns, size_t capacity);
+
+    std::string name_;
+    std::vector<std::string> columns_;
+    size_t capacity_;
+    Block blocks_[2];
+    int active_ = 0;
+    std::mutex mutex_;
+    std::atomic<uint64_t> dropped_{0};
+
+    /* owned by the writer thread */
+    FILE* fp_ = nullptr;
+    uint64_t file_bytes_ = 0;
+    uint64_t reported_dropped_ = 0;
+};
+
+/**
+ * @brief time-series sink for diagnostics sampled at 10-100 Hz.
+ *
+ * Record() only copies the values into the series' block under a per-series
+ * lock; formatting and file IO happen on a background thread every
+ * flushIntervalMs, or earlier once a block is half full. Files are
+ * append-only CSV with a header row, rotated to <name>.csv.1 at maxFileMb.
+ * Samplers are polled by the writer thread once per flush interval, for
+ * gauges owned by other modules (pool sizes, counters) that have no natural
+ * place to Record from.
+ * Without Init every call is a no-op and RegisterSeries returns nullptr.
+ */
+class MetricsRecorder {
+public:
+    static MetricsRecorder& getInstance();
+
+    bool Init(const std::string& dir, int flushIntervalMs, int capacityRows, int maxFileMb);
+    void Uninit();
+
+    bool IsEnabled() const { return running_.load(std::memory_order_relaxed); }
+
+    /* register once and keep the pointer; a known name returns the existing series */
+    MetricSeries* RegisterSeries(const std::string& name, const std::vector<std::string>& columns);
+
+    /* fills one row in column order; called on the writer thread, must not block */
+    using Sampler = std::function<void(double* values)>;
+
+    /* register a series recorded from sampler once per flush interval */
+    MetricSeries* RegisterSampler(const std::string& name, const std::vector<std::string>& columns,
+                                  Sampler sampler);
+
+    /* values in column order; false if disabled, the count mismatches or the row is dropped */
+    bool Record(MetricSeries* series, std::initializer_list<double> values) {
+        return Record(series, values.begin(), values.size());
+    }
+    bool Record(MetricSeries* series, const double* values, size_t count);
+
+    /* write everything recorded so far */
+    void Flush();
+
+private:
+    MetricsRecorder() = default;
+    ~MetricsRecorder();
+    MetricsRecorder(const MetricsRecorder&) = delete;
+    MetricsRecorder& operator=(const MetricsRecorder&) = delete;
+
+    void Run();
+    void FlushSeries(MetricSeries& series);
+    bool OpenFile(MetricSeries& series);
+
+    std::string dir_;
+    size_t capacity_rows_ = 1024;
+    uint64_t max_file_bytes_ = 0;
+    std::chrono::milliseconds flush_interval_{1000};
+
+    std::vector<std::unique_ptr<MetricSeries>> series_;
+    std::mutex series_mutex_;
+
+    std::vector<std::pair<MetricSeries*, Sampler>> samplers_;
+    std::mutex sampler_mutex_;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> wakeup_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::mutex flush_mutex_;  // serializes the writer and Flush()
+};
+
+}
+
+#endif // METRICS_RECORDER_H
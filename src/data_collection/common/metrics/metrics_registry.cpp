@@ -0,0 +1,317 @@
+//
+// Created by xucong on 25-10-5.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "metrics_registry.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "common/log/logger.h"
+
+namespace dcp::common {
+
+namespace metrics_detail {
+
+size_t ThreadShard() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+}
+
+namespace {
+
+constexpr size_t kExportMinExponent = 4;   // le 15us
+constexpr size_t kExportMaxExponent = 36;  // le ~19h
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void AppendValue(std::string& out, const std::string& name, const std::string& labels, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), " %.9g\n", value);
+    out += name;
+    out += labels;
+    out += buf;
+}
+
+// labels为"{a=\"1\"}"形式，追加一个标签
+std::string WithLabel(const std::string& labels, const std::string& key, const std::string& value) {
+    const std::string label = key + "=\"" + value + "\"";
+    if (labels.empty()) {
+        return "{" + label + "}";
+    }
+    return labels.substr(0, labels.size() - 1) + "," + label + "}";
+}
+
+}
+
+uint64_t Counter::Value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Gauge::Add(double delta) {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Shard::Shard() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t Histogram::BucketOf(uint64_t us) {
+    constexpr uint64_t kSubCount = 1ULL << kSubBits;
+    if (us < kSubCount) {
+        return static_cast<size_t>(us);
+    }
+    us = std::min<uint64_t>(us, (1ULL << kMaxExponent) - 1);
+    const size_t exponent = 63 - __builtin_clzll(us);
+    const size_t sub = static_cast<size_t>(us >> (exponent - kSubBits)) & (kSubCount - 1);
+    return ((exponent - kSubBits + 1) << kSubBits) + sub;
+}
+
+uint64_t Histogram::BucketUpperBound(size_t bucket) {
+    constexpr size_t kSubCount = 1ULL << kSubBits;
+    if (bucket < kSubCount) {
+        return bucket;
+    }
+    const size_t exponent = (bucket >> kSubBits) + kSubBits - 1;
+    const uint64_t sub = bucket & (kSubCount - 1);
+    const uint64_t width = 1ULL << (exponent - kSubBits);
+    return ((kSubCount + sub) << (exponent - kSubBits)) + width - 1;
+}
+
+void Histogram::Record(uint64_t us) {
+    Shard& shard = shards_[metrics_detail::ThreadShard()];
+    shard.buckets[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = shard.max.load(std::memory_order_relaxed);
+    while (us > max && !shard.max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::Collect(Snapshot& snapshot) const {
+    snapshot = Snapshot();
+    for (size_t s = 0; s < metrics_detail::kShards; ++s) {
+        const Shard& shard = shards_[s];
+        for (size_t i = 0; i < kBuckets; ++i) {
+            const uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+    }
+}
+
+uint64_t Histogram::Snapshot::Quantile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+ScopedLatency::~ScopedLatency() {
+    if (histogram_) {
+        histogram_->Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count()));
+    }
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    // 不析构：静态对象析构期间的线程仍可能记录
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return *instance;
+}
+
+std::string MetricsRegistry::RenderLabels(const MetricLabels& labels) {
+    if (labels.empty()) {
+        return "";
+    }
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i > 0) {
+            out += ",";
+        }
+        out += labels[i].first + "=\"";
+        for (char c : labels[i].second) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        out += "\"";
+    }
+    out += "}";
+    return out;
+}
+
+MetricsRegistry::Family* MetricsRegistry::GetFamily(const std::string& name, const std::string& help, Type type) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family{type, help, {}, {}, {}}).first;
+    }
+    if (it->second.type != type) {
+        AD_ERROR(MetricsRegistry, "Metric %s registered again with another type, not exported.", name.c_str());
+        return nullptr;
+    }
+    return &it->second;
+}
+
+Counter* MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family* family = GetFamily(name, help, Type::Counter);
+    if (!family) {
+        return new Counter();
+    }
+    auto& counter = family->counters[RenderLabels(labels)];
+    if (!counter) {
+        counter = std::make_unique<Counter>();
+    }
+    return counter.get();
+}
+
+Gauge* MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family* family = GetFamily(name, help, Type::Gauge);
+    if (!family) {
+        return new Gauge();
+    }
+    auto& gauge = family->gauges[RenderLabels(labels)];
+    if (!gauge) {
+        gauge = std::make_unique<Gauge>();
+    }
+    return gauge.get();
+}
+
+Histogram* MetricsRegistry::GetHistogram(const std::string& name, const std::string& help,
+                                         const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family* family = GetFamily(name, help, Type::Histogram);
+    if (!family) {
+        return new Histogram();
+    }
+    auto& histogram = family->histograms[RenderLabels(labels)];
+    if (!histogram) {
+        histogram = std::make_unique<Histogram>();
+    }
+    return histogram.get();
+}
+
+const MetricsRegistry::Stage& MetricsRegistry::GetStage(const std::string& stage) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stages_.find(stage);
+        if (it != stages_.end()) {
+            return it->second;
+        }
+    }
+    const MetricLabels labels = {{"stage", stage}};
+    Stage metrics{
+        GetCounter("dcp_stage_total", "Items processed by a pipeline stage.", labels),
+        GetCounter("dcp_stage_bytes_total", "Bytes processed by a pipeline stage.", labels),
+        GetCounter("dcp_stage_errors_total", "Failures of a pipeline stage.", labels),
+        GetHistogram("dcp_stage_duration_seconds", "Time spent per item in a pipeline stage.", labels),
+    };
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stages_.emplace(stage, metrics).first->second;
+}
+
+void MetricsRegistry::AddCollector(Collector collector) {
+    if (!collector) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(collector_mutex_);
+    collectors_.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::Export() {
+    {
+        std::lock_guard<std::mutex> lock(collector_mutex_);
+        for (auto& collector : collectors_) {
+            collector();
+        }
+    }
+
+    std::string out;
+    out.reserve(16 * 1024);
+    char buf[64];
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        switch (family.type) {
+            case Type::Counter:
+                out += "# HELP " + name + " " + family.help + "\n# TYPE " + name + " counter\n";
+                for (const auto& [labels, counter] : family.counters) {
+                    AppendValue(out, name, labels, static_cast<double>(counter->Value()));
+                }
+                break;
+            case Type::Gauge:
+                out += "# HELP " + name + " " + family.help + "\n# TYPE " + name + " gauge\n";
+                for (const auto& [labels, gauge] : family.gauges) {
+                    AppendValue(out, name, labels, gauge->Value());
+                }
+                break;
+            case Type::Histogram: {
+                // 单位为秒，与Prometheus惯例一致；细分桶只用于分位数
+                out += "# HELP " + name + " " + family.help + "\n# TYPE " + name + " histogram\n";
+                std::vector<std::pair<std::string, std::unique_ptr<Histogram::Snapshot>>> snapshots;
+                for (const auto& [labels, histogram] : family.histograms) {
+                    auto snapshot = std::make_unique<Histogram::Snapshot>();
+                    histogram->Collect(*snapshot);
+                    uint64_t cumulative = 0;
+                    size_t bucket = 0;
+                    for (size_t exponent = kExportMinExponent; exponent <= kExportMaxExponent; ++exponent) {
+                        const uint64_t bound = (1ULL << exponent) - 1;
+                        while (bucket < Histogram::kBuckets && Histogram::BucketUpperBound(bucket) <= bound) {
+                            cumulative += snapshot->buckets[bucket++];
+                        }
+                        snprintf(buf, sizeof(buf), "%.9g", bound / 1e6);
+                        AppendValue(out, name + "_bucket", WithLabel(labels, "le", buf),
+                                    static_cast<double>(cumulative));
+                    }
+                    AppendValue(out, name + "_bucket", WithLabel(labels, "le", "+Inf"),
+                                static_cast<double>(snapshot->count));
+                    AppendValue(out, name + "_sum", labels, snapshot->sum / 1e6);
+                    AppendValue(out, name + "_count", labels, static_cast<double>(snapshot->count));
+                    snapshots.emplace_back(labels, std::move(snapshot));
+                }
+                const std::string quantile_name = name + "_quantile";
+                out += "# HELP " + quantile_name + " Quantiles of " + name + " since start.\n# TYPE " +
+                       quantile_name + " gauge\n";
+                for (const auto& [labels, snapshot] : snapshots) {
+                    for (double q : kQuantiles) {
+                        snprintf(buf, sizeof(buf), "%g", q);
+                        AppendValue(out, quantile_name, WithLabel(labels, "quantile", buf),
+                                    snapshot->Quantile(q) / 1e6);
+                    }
+                    AppendValue(out, quantile_name, WithLabel(labels, "quantile", "1"), snapshot->max / 1e6);
+                }
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+}
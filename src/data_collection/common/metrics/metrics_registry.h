@@ -0,0 +1,190 @@
+//
+// Created by xucong on 25-10-5.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dcp::common {
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+namespace metrics_detail {
+
+constexpr size_t kShards = 8;
+
+/* shard of the calling thread, assigned round-robin on first use */
+size_t ThreadShard();
+
+struct alignas(64) CounterShard {
+    std::atomic<uint64_t> value{0};
+};
+
+}
+
+/**
+ * @brief monotonically increasing count, sharded per thread.
+ *
+ * Add() is one relaxed fetch_add on a cache line shared with at most
+ * 1/kShards of the threads; Value() sums the shards.
+ */
+class Counter {
+public:
+    void Add(uint64_t n = 1) {
+        shards_[metrics_detail::ThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t Value() const;
+
+private:
+    metrics_detail::CounterShard shards_[metrics_detail::kShards];
+};
+
+/* last-value gauge, for queue depths, pool sizes and measured rates */
+class Gauge {
+public:
+    void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+    void Add(double delta);
+    double Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief log-linear latency histogram in microseconds, sharded per thread.
+ *
+ * HDR-style buckets: 8 linear sub-buckets per power of two, so a recorded
+ * value is known to within 12.5% from 1us up to 2^40us. Record() is two
+ * relaxed fetch_adds and a max update on the caller's shard. Quantiles are
+ * computed from the fine buckets at export; the Prometheus buckets are the
+ * power-of-two boundaries.
+ */
+class Histogram {
+public:
+    static constexpr size_t kSubBits = 3;
+    static constexpr size_t kMaxExponent = 40;
+    static constexpr size_t kBuckets = (kMaxExponent - kSubBits + 1) << kSubBits;
+
+    void Record(uint64_t us);
+
+    struct Snapshot {
+        uint64_t buckets[kBuckets] = {};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        /* upper bound of the bucket holding quantile q, in microseconds */
+        uint64_t Quantile(double q) const;
+    };
+    void Collect(Snapshot& snapshot) const;
+
+    static size_t BucketOf(uint64_t us);
+    static uint64_t BucketUpperBound(size_t bucket);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[kBuckets];
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        Shard();
+    };
+
+    std::unique_ptr<Shard[]> shards_{new Shard[metrics_detail::kShards]};
+};
+
+/* records the lifetime of the scope into a histogram; null histogram is a no-op */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Histogram* histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency();
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief process-wide registry of counters, gauges and histograms, exported
+ *        in the Prometheus text format (see MetricsServer).
+ *
+ * Metrics are created once per (name, labels) and never freed; call sites
+ * look them up once and keep the pointer, so the hot path never touches the
+ * registry lock. A name registered again with another type gets a detached
+ * instance that is not exported, so callers need no null checks.
+ * Collectors run before every export, for values owned by other modules
+ * (pool statistics, topic profiles) that are cheaper to read than to push.
+ *
+ * Pipeline stages share one set of families labelled by stage:
+ * dcp_stage_total, dcp_stage_bytes_total, dcp_stage_errors_total and
+ * dcp_stage_duration_seconds.
+ */
+class MetricsRegistry {
+public:
+    struct Stage {
+        Counter* total;
+        Counter* bytes;
+        Counter* errors;
+        Histogram* duration;
+    };
+
+    static MetricsRegistry& getInstance();
+
+    Counter* GetCounter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge* GetGauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Histogram* GetHistogram(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    /* metrics of one pipeline stage: channel, recorder, compress, encrypt, upload, trigger, planner ... */
+    const Stage& GetStage(const std::string& stage);
+
+    using Collector = std::function<void()>;
+    void AddCollector(Collector collector);
+
+    /* Prometheus text exposition format 0.0.4 */
+    std::string Export();
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;  // key: rendered labels
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    Family* GetFamily(const std::string& name, const std::string& help, Type type);
+    static std::string RenderLabels(const MetricLabels& labels);
+
+    std::map<std::string, Family> families_;
+    std::map<std::string, Stage> stages_;
+    std::mutex mutex_;
+
+    std::vector<Collector> collectors_;
+    std::mutex collector_mutex_;
+};
+
+}
+
+#endif // METRICS_REGISTRY_H
@@ -0,0 +1,197 @@
+//
+// Created by xucong on 25-10-5.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "metrics_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "common/log/logger.h"
+#include "metrics_registry.h"
+#include "span_tracer.h"
+
+namespace dcp::common {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 500;
+constexpr int kIoTimeoutMs = 1000;
+constexpr size_t kMaxRequestBytes = 4096;
+
+void SetIoTimeout(int fd) {
+    timeval tv{kIoTimeoutMs / 1000, (kIoTimeoutMs % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+MetricsServer& MetricsServer::getInstance() {
+    static MetricsServer instance;
+    return instance;
+}
+
+MetricsServer::~MetricsServer() {
+    Uninit();
+}
+
+bool MetricsServer::Init(const std::string& unixSocket, int port) {
+    if (running_) {
+        return true;
+    }
+    if (!unixSocket.empty()) {
+        sockaddr_un addr{};
+        if (unixSocket.size() >= sizeof(addr.sun_path)) {
+            AD_ERROR(MetricsServer, "Unix socket path too long: %s", unixSocket.c_str());
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, unixSocket.c_str(), sizeof(addr.sun_path) - 1);
+        // 上次异常退出残留的socket文件
+        unlink(unixSocket.c_str());
+        unix_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (unix_fd_ < 0 || bind(unix_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(unix_fd_, 4) != 0) {
+            AD_ERROR(MetricsServer, "Listen on %s failed: %s", unixSocket.c_str(), strerror(errno));
+            Uninit();
+            return false;
+        }
+        unix_socket_ = unixSocket;
+    }
+    if (port > 0) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        tcp_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const int reuse = 1;
+        if (tcp_fd_ >= 0) {
+            setsockopt(tcp_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (tcp_fd_ < 0 || bind(tcp_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(tcp_fd_, 4) != 0) {
+            AD_ERROR(MetricsServer, "Listen on 127.0.0.1:%d failed: %s", port, strerror(errno));
+            Uninit();
+            return false;
+        }
+    }
+    if (unix_fd_ < 0 && tcp_fd_ < 0) {
+        return true;
+    }
+
+    running_ = true;
+    worker_ = std::thread(&MetricsServer::Run, this);
+    const std::string tcp = tcp_fd_ >= 0 ? "127.0.0.1:" + std::to_string(port) : "";
+    AD_INFO(MetricsServer, "Serving metrics on %s %s", unix_socket_.c_str(), tcp.c_str());
+    return true;
+}
+
+void MetricsServer::Uninit() {
+    running_ = false;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (unix_fd_ >= 0) {
+        close(unix_fd_);
+        unix_fd_ = -1;
+        unlink(unix_socket_.c_str());
+        unix_socket_.clear();
+    }
+    if (tcp_fd_ >= 0) {
+        close(tcp_fd_);
+        tcp_fd_ = -1;
+    }
+}
+
+void MetricsServer::Run() {
+    pollfd fds[2];
+    nfds_t count = 0;
+    for (int fd : {unix_fd_, tcp_fd_}) {
+        if (fd >= 0) {
+            fds[count++] = pollfd{fd, POLLIN, 0};
+        }
+    }
+    while (running_) {
+        const int ready = poll(fds, count, kPollTimeoutMs);
+        if (ready <= 0) {
+            continue;
+        }
+        for (nfds_t i = 0; i < count; ++i) {
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            const int client = accept4(fds[i].fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                continue;
+            }
+            SetIoTimeout(client);
+            Serve(client);
+            close(client);
+        }
+    }
+}
+
+void MetricsServer::Serve(int fd) {
+    // 只需读到请求头结束，不解析方法以外的内容
+    std::string request;
+    char buf[1024];
+    while (request.size() < kMaxRequestBytes && request.find("\r\n\r\n") == std::string::npos) {
+        const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string status = "200 OK";
+    std::string content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (request.compare(0, 4, "GET ") != 0) {
+        status = "405 Method Not Allowed";
+    } else {
+        const size_t path_end = request.find(' ', 4);
+        const std::string path = request.substr(4, path_end == std::string::npos ? std::string::npos : path_end - 4);
+        if (path == "/" || path.compare(0, 8, "/metrics") == 0) {
+            body = MetricsRegistry::getInstance().Export();
+        } else if (path.compare(0, 6, "/trace") == 0 && SpanTracer::getInstance().IsEnabled()) {
+            body = SpanTracer::getInstance().Dump();
+            content_type = "application/json";
+        } else {
+            status = "404 Not Found";
+        }
+    }
+    const std::string header = "HTTP/1.0 " + status +
+                               "\r\nContent-Type: " + content_type + "\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    SendAll(fd, header) && SendAll(fd, body);
+}
+
+}
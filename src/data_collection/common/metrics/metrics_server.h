@@ -0,0 +1,53 @@
+//
+// Created by xucong on 25-10-5.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace dcp::common {
+
+/**
+ * @brief serves MetricsRegistry::Export() as plain HTTP on a Unix socket
+ *        and/or a loopback TCP port.
+ *
+ * One background thread polls both listeners and answers each request with
+ * the current exposition, then closes the connection, e.g.
+ *   curl --unix-socket /tmp/shadow_mode/metrics.sock http://localhost/metrics
+ *   curl http://127.0.0.1:9464/metrics
+ * /trace returns the SpanTracer ring as Chrome trace JSON when tracing is on.
+ * The TCP listener binds to 127.0.0.1 only; nothing is exposed off-vehicle.
+ */
+class MetricsServer {
+public:
+    static MetricsServer& getInstance();
+
+    /* empty unixSocket / port 0 disables that listener */
+    bool Init(const std::string& unixSocket, int port);
+    void Uninit();
+
+private:
+    MetricsServer() = default;
+    ~MetricsServer();
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    void Run();
+    void Serve(int fd);
+
+    std::string unix_socket_;
+    int unix_fd_ = -1;
+    int tcp_fd_ = -1;
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+};
+
+}
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,171 @@
+//
+// Created by xucong on 25-10-6.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "span_tracer.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+
+#include "common/log/logger.h"
+
+namespace dcp::common {
+
+namespace {
+
+uint64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint32_t ThreadId() {
+    thread_local const uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+}
+
+SpanTracer& SpanTracer::getInstance() {
+    static SpanTracer instance;
+    return instance;
+}
+
+void SpanTracer::Init(bool enabled, size_t capacity, const std::string& dumpPath) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ring_.clear();
+        ring_.resize(enabled ? std::max<size_t>(capacity, 64) : 0);
+        next_ = 0;
+        size_ = 0;
+        dump_path_ = dumpPath;
+    }
+    enabled_ = enabled;
+    if (enabled) {
+        AD_INFO(SpanTracer, "Init success, capacity: %d spans, dump: %s", static_cast<int>(ring_.size()),
+                dump_path_.c_str());
+    }
+}
+
+void SpanTracer::Uninit() {
+    if (!enabled_.exchange(false)) {
+        return;
+    }
+    if (!dump_path_.empty()) {
+        DumpToFile(dump_path_);
+    }
+}
+
+std::string SpanTracer::TraceKey(const std::string& pathOrKey) {
+    const size_t slash = pathOrKey.find_last_of('/');
+    const size_t begin = slash == std::string::npos ? 0 : slash + 1;
+    const size_t dot = pathOrKey.find('.', begin);
+    return pathOrKey.substr(begin, dot == std::string::npos ? std::string::npos : dot - begin);
+}
+
+void SpanTracer::Record(const char* name, const std::string& pathOrKey, uint64_t startUs, uint64_t endUs) {
+    if (!IsEnabled()) {
+        return;
+    }
+    Span span{name, TraceKey(pathOrKey), startUs, endUs > startUs ? endUs - startUs : 0, ThreadId()};
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ring_.empty()) {
+        return;
+    }
+    ring_[next_] = std::move(span);
+    next_ = (next_ + 1) % ring_.size();
+    size_ = std::min(size_ + 1, ring_.size());
+}
+
+std::string SpanTracer::Dump() {
+    std::vector<Span> spans;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spans.reserve(size_);
+        const size_t first = (next_ + ring_.size() - size_) % std::max<size_t>(ring_.size(), 1);
+        for (size_t i = 0; i < size_; ++i) {
+            spans.push_back(ring_[(first + i) % ring_.size()]);
+        }
+    }
+
+    // 每个片段一条轨道，按首个span的时间排序
+    std::map<std::string, uint64_t> first_start;
+    for (const auto& span : spans) {
+        auto [it, inserted] = first_start.emplace(span.trace, span.start_us);
+        if (!inserted) {
+            it->second = std::min(it->second, span.start_us);
+        }
+    }
+    std::vector<std::pair<uint64_t, std::string>> order;
+    for (const auto& [trace, start] : first_start) {
+        order.emplace_back(start, trace);
+    }
+    std::sort(order.begin(), order.end());
+    std::map<std::string, int> tracks;
+
+    nlohmann::json events = nlohmann::json::array();
+    events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", 1}, {"args", {{"name", "dcp clips"}}}});
+    for (const auto& [start, trace] : order) {
+        const int track = static_cast<int>(tracks.size()) + 1;
+        tracks[trace] = track;
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", track},
+                          {"args", {{"name", trace}}}});
+        events.push_back({{"name", "thread_sort_index"}, {"ph", "M"}, {"pid", 1}, {"tid", track},
+                          {"args", {{"sort_index", track}}}});
+    }
+    // 外层span先于内层输出，嵌套关系才能正确显示
+    std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.start_us != b.start_us ? a.start_us < b.start_us : a.dur_us > b.dur_us;
+    });
+    for (const auto& span : spans) {
+        events.push_back({{"name", span.name}, {"cat", "dcp"}, {"ph", "X"}, {"pid", 1},
+                          {"tid", tracks[span.trace]}, {"ts", span.start_us}, {"dur", span.dur_us},
+                          {"args", {{"thread", span.tid}}}});
+    }
+    nlohmann::json trace = {{"displayTimeUnit", "ms"}, {"traceEvents", std::move(events)}};
+    return trace.dump();
+}
+
+bool SpanTracer::DumpToFile(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    // 先写临时文件再改名，读取方不会看到写了一半的JSON
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            AD_ERROR(SpanTracer, "Open %s failed.", tmp.c_str());
+            return false;
+        }
+        out << Dump();
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        AD_ERROR(SpanTracer, "Write %s failed: %s", path.c_str(), ec.message().c_str());
+        return false;
+    }
+    AD_INFO(SpanTracer, "Trace written to %s", path.c_str());
+    return true;
+}
+
+TraceSpan::TraceSpan(const char* name, const std::string& pathOrKey) : name_(name) {
+    if (SpanTracer::getInstance().IsEnabled()) {
+        key_ = pathOrKey;
+        start_us_ = NowUs();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (start_us_ != 0) {
+        SpanTracer::getInstance().Record(name_, key_, start_us_, NowUs());
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+//
+// Created by xucong on 25-10-6.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef SPAN_TRACER_H
+#define SPAN_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dcp::common {
+
+/**
+ * @brief ring of timed spans along each clip's lifecycle, dumped as Chrome
+ *        trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * A trace is one triggered clip. Its key is the clip file stem
+ * (<vin>_..._<businessType>_<triggerId>), so the recorder, compression,
+ * encryption and upload stages, which only see file paths, derive the same
+ * key from whichever .recording / .tar.lz4 / .enc path they work on.
+ * Spans are kept in a fixed ring of capacity events, the oldest overwritten;
+ * each trace becomes one track of the dump, so a late clip shows at a glance
+ * where its time went (queueing, backward capture, bag write, compression,
+ * encryption, upload).
+ * Disabled, a TraceSpan costs one relaxed load; enabled, recording a span
+ * takes a short lock, spans are per clip stage and not per message.
+ */
+class SpanTracer {
+public:
+    static SpanTracer& getInstance();
+
+    void Init(bool enabled, size_t capacity, const std::string& dumpPath);
+
+    /* writes the ring to dumpPath once, on shutdown */
+    void Uninit();
+
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /* clip key of a path or trace id: file name up to the first '.' */
+    static std::string TraceKey(const std::string& pathOrKey);
+
+    /* times in microseconds since the epoch, same clock as GetCurrentTimestamp */
+    void Record(const char* name, const std::string& pathOrKey, uint64_t startUs, uint64_t endUs);
+
+    std::string Dump();
+    bool DumpToFile(const std::string& path);
+
+private:
+    struct Span {
+        const char* name;
+        std::string trace;
+        uint64_t start_us;
+        uint64_t dur_us;
+        uint32_t tid;
+    };
+
+    SpanTracer() = default;
+    SpanTracer(const SpanTracer&) = delete;
+    SpanTracer& operator=(const SpanTracer&) = delete;
+
+    std::atomic<bool> enabled_{false};
+    std::string dump_path_;
+    std::vector<Span> ring_;
+    size_t next_ = 0;
+    size_t size_ = 0;
+    std::mutex mutex_;
+};
+
+/* records [construction, destruction) as a span; name must be a string literal */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const std::string& pathOrKey);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    std::string key_;  // 仅启用时拷贝
+    uint64_t start_us_ = 0;
+};
+
+}
+
+#endif // SPAN_TRACER_H
@@ -89,6 +89,18 @@ public:
         return capacity_;
     }
 
+    // 调整容量并保留最新的数据，策略热更新时使用
+    void set_capacity(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("RingBuffer capacity must be greater than zero.");
+        }
+        std::lock_guard<std::mutex> lc(mtx_);
+        capacity_ = capacity;
+        while (buffer_.size() > capacity_) {
+            buffer_.pop_front();
+        }
+    }
+
     bool empty() {
         std::lock_guard<std::mutex> lc(mtx_);
         return buffer_.empty();
@@ -0,0 +1,129 @@
+//
+// Created by xucong on 25-9-28.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "signal_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dcp::common {
+
+SignalBank::SignalBank(size_t channels, const Options& options)
+    : options_(options), out_(channels, 0.0) {
+    switch (options_.filter) {
+        case Filter::Ema:
+            alpha_ = Ema::AlphaFor(options_.samplingPeriodS, options_.responseTimeS);
+            break;
+        case Filter::Sma:
+            window_ = options_.samplingPeriodS > 0.0
+                ? std::max<size_t>(1, static_cast<size_t>(std::round(options_.responseTimeS / options_.samplingPeriodS)))
+                : 1;
+            ring_.assign(window_ * channels, 0.0);
+            sums_.assign(channels, 0.0);
+            break;
+        case Filter::Kalman:
+            var_.assign(channels, options_.measurementNoise);
+            break;
+    }
+    if (options_.medianWindow > 0) {
+        quantiles_.assign(channels, SlidingQuantile(options_.medianWindow));
+    }
+}
+
+void SignalBank::update(const double* values) {
+    const size_t n = out_.size();
+    double* out = out_.data();
+
+    if (!initialized_) {
+        std::copy(values, values + n, out);
+    }
+    switch (options_.filter) {
+        case Filter::Ema: {
+            if (initialized_) {
+                const double alpha = alpha_;
+                for (size_t c = 0; c < n; ++c) {
+                    out[c] += alpha * (values[c] - out[c]);
+                }
+            }
+            break;
+        }
+        case Filter::Sma: {
+            double* row = ring_.data() + head_ * n;
+            double* sums = sums_.data();
+            if (filled_ == window_) {
+                for (size_t c = 0; c < n; ++c) {
+                    sums[c] += values[c] - row[c];
+                }
+            } else {
+                ++filled_;
+                for (size_t c = 0; c < n; ++c) {
+                    sums[c] += values[c];
+                }
+            }
+            std::copy(values, values + n, row);
+            if (++head_ == window_) {
+                head_ = 0;
+                // 每转一圈重算滑动和，消除浮点累积误差
+                if (filled_ == window_) {
+                    std::fill(sums_.begin(), sums_.end(), 0.0);
+                    for (size_t r = 0; r < window_; ++r) {
+                        const double* line = ring_.data() + r * n;
+                        for (size_t c = 0; c < n; ++c) {
+                            sums[c] += line[c];
+                        }
+                    }
+                }
+            }
+            const double inv = 1.0 / static_cast<double>(filled_);
+            for (size_t c = 0; c < n; ++c) {
+                out[c] = sums[c] * inv;
+            }
+            break;
+        }
+        case Filter::Kalman: {
+            if (initialized_) {
+                const double q = options_.processNoise;
+                const double r = options_.measurementNoise;
+                double* var = var_.data();
+                for (size_t c = 0; c < n; ++c) {
+                    const double p = var[c] + q;
+                    const double k = p / (p + r);
+                    out[c] += k * (values[c] - out[c]);
+                    var[c] = (1.0 - k) * p;
+                }
+            }
+            break;
+        }
+    }
+    initialized_ = true;
+
+    for (size_t c = 0; c < quantiles_.size(); ++c) {
+        quantiles_[c].push(values[c]);
+    }
+}
+
+double SignalBank::median(size_t channel) const {
+    return channel < quantiles_.size() ? quantiles_[channel].median() : 0.0;
+}
+
+double SignalBank::quantile(size_t channel, double q) const {
+    return channel < quantiles_.size() ? quantiles_[channel].quantile(q) : 0.0;
+}
+
+void SignalBank::reset() {
+    initialized_ = false;
+    head_ = 0;
+    filled_ = 0;
+    std::fill(out_.begin(), out_.end(), 0.0);
+    std::fill(ring_.begin(), ring_.end(), 0.0);
+    std::fill(sums_.begin(), sums_.end(), 0.0);
+    std::fill(var_.begin(), var_.end(), options_.measurementNoise);
+    for (auto& quantile : quantiles_) {
+        quantile.reset();
+    }
+}
+
+}
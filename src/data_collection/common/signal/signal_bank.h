@@ -0,0 +1,67 @@
+//
+// Created by xucong on 25-9-28.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef SIGNAL_BANK_H
+#define SIGNAL_BANK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "streaming_stats.h"
+
+namespace dcp::common {
+
+/**
+ * @brief 同频率多通道信号的批量平滑，按结构数组（SoA）存储。
+ *
+ * 一次update传入所有通道的一帧样本，每种滤波是一个连续数组上的循环，编译器可向量化；
+ * 几十路100Hz的车辆信号每帧只需几十纳秒。中值/分位数按通道维护SlidingQuantile，
+ * 仅在medianWindow>0时开启。
+ */
+class SignalBank {
+public:
+    enum class Filter { Ema, Sma, Kalman };
+
+    struct Options {
+        Filter filter = Filter::Ema;
+        double samplingPeriodS = 0.01;   // 采样周期
+        double responseTimeS = 0.1;      // Ema/Sma的期望响应时间
+        double processNoise = 1e-3;      // Kalman过程噪声方差
+        double measurementNoise = 1e-2;  // Kalman测量噪声方差
+        size_t medianWindow = 0;         // 中值窗口（样本数），0不计算
+    };
+
+    SignalBank(size_t channels, const Options& options);
+
+    // values须有channels()个元素
+    void update(const double* values);
+    void update(const std::vector<double>& values) { update(values.data()); }
+
+    size_t channels() const { return out_.size(); }
+    const double* values() const { return out_.data(); }
+    double value(size_t channel) const { return out_[channel]; }
+    double median(size_t channel) const;
+    double quantile(size_t channel, double q) const;
+    void reset();
+
+private:
+    Options options_;
+    double alpha_ = 1.0;
+    size_t window_ = 1;
+    size_t head_ = 0;
+    size_t filled_ = 0;
+    bool initialized_ = false;
+
+    std::vector<double> out_;
+    std::vector<double> ring_;   // Sma: window_ 行 × channels 列
+    std::vector<double> sums_;   // Sma: 每通道滑动和
+    std::vector<double> var_;    // Kalman: 每通道估计方差
+    std::vector<SlidingQuantile> quantiles_;
+};
+
+}
+
+#endif // SIGNAL_BANK_H
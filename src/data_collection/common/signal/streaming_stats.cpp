@@ -0,0 +1,211 @@
+//
+// Created by xucong on 25-9-28.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "streaming_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dcp::common {
+
+double Ema::AlphaFor(double samplingPeriodS, double responseTimeS) {
+    const double n_eff = samplingPeriodS > 0.0 ? std::round(responseTimeS / samplingPeriodS) : 0.0;
+    return 2.0 / (n_eff + 1.0);
+}
+
+double Ema::push(double value) {
+    if (!initialized_) {
+        value_ = value;
+        initialized_ = true;
+    } else {
+        value_ += alpha_ * (value - value_);
+    }
+    return value_;
+}
+
+void Ema::reset() {
+    value_ = 0.0;
+    initialized_ = false;
+}
+
+Sma::Sma(size_t window) : ring_(std::max<size_t>(1, window), 0.0) {}
+
+double Sma::push(double value) {
+    if (count_ == ring_.size()) {
+        sum_ -= ring_[head_];
+    } else {
+        ++count_;
+    }
+    ring_[head_] = value;
+    sum_ += value;
+    if (++head_ == ring_.size()) {
+        head_ = 0;
+        if (count_ == ring_.size()) {
+            sum_ = 0.0;
+            for (double v : ring_) {
+                sum_ += v;
+            }
+        }
+    }
+    return get();
+}
+
+double Sma::get() const {
+    return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_);
+}
+
+void Sma::reset() {
+    head_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+}
+
+double Kalman1D::push(double measurement) {
+    if (!initialized_) {
+        x_ = measurement;
+        p_ = r_;
+        initialized_ = true;
+        return x_;
+    }
+    p_ += q_;
+    const double k = p_ / (p_ + r_);
+    x_ += k * (measurement - x_);
+    p_ *= (1.0 - k);
+    return x_;
+}
+
+void Kalman1D::reset() {
+    x_ = 0.0;
+    p_ = 1.0;
+    initialized_ = false;
+}
+
+SlidingQuantile::SlidingQuantile(size_t window) : window_(std::max<size_t>(1, window)) {
+    sorted_.reserve(window_);
+    ring_.reserve(window_);
+}
+
+void SlidingQuantile::push(double value) {
+    if (ring_.size() < window_) {
+        ring_.push_back(value);
+    } else {
+        const double oldest = ring_[head_];
+        sorted_.erase(std::lower_bound(sorted_.begin(), sorted_.end(), oldest));
+        ring_[head_] = value;
+        head_ = (head_ + 1) % window_;
+    }
+    sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(), value), value);
+}
+
+double SlidingQuantile::quantile(double q) const {
+    if (sorted_.empty()) {
+        return 0.0;
+    }
+    const double pos = std::clamp(q, 0.0, 1.0) * static_cast<double>(sorted_.size() - 1);
+    const auto lo = static_cast<size_t>(pos);
+    const size_t hi = std::min(lo + 1, sorted_.size() - 1);
+    const double frac = pos - static_cast<double>(lo);
+    return sorted_[lo] + (sorted_[hi] - sorted_[lo]) * frac;
+}
+
+void SlidingQuantile::reset() {
+    sorted_.clear();
+    ring_.clear();
+    head_ = 0;
+}
+
+P2Quantile::P2Quantile(double q) : q_(std::clamp(q, 0.0, 1.0)) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    count_ = 0;
+    for (int i = 0; i < 5; ++i) {
+        pos_[i] = i + 1;
+    }
+    desired_[0] = 1;
+    desired_[1] = 1 + 2 * q_;
+    desired_[2] = 1 + 4 * q_;
+    desired_[3] = 3 + 2 * q_;
+    desired_[4] = 5;
+    increment_[0] = 0;
+    increment_[1] = q_ / 2;
+    increment_[2] = q_;
+    increment_[3] = (1 + q_) / 2;
+    increment_[4] = 1;
+}
+
+void P2Quantile::push(double value) {
+    if (count_ < 5) {
+        height_[count_++] = value;
+        if (count_ == 5) {
+            std::sort(height_, height_ + 5);
+        }
+        return;
+    }
+    ++count_;
+
+    int k;
+    if (value < height_[0]) {
+        height_[0] = value;
+        k = 0;
+    } else if (value >= height_[4]) {
+        height_[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && value >= height_[k + 1]) {
+            ++k;
+        }
+    }
+    for (int i = k + 1; i < 5; ++i) {
+        pos_[i] += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+        desired_[i] += increment_[i];
+    }
+
+    // 中间3个标记点偏离期望位置超过1时按抛物线（失败则线性）调整高度
+    for (int i = 1; i <= 3; ++i) {
+        const double d = desired_[i] - pos_[i];
+        if ((d >= 1 && pos_[i + 1] - pos_[i] > 1) || (d <= -1 && pos_[i - 1] - pos_[i] < -1)) {
+            const int step = d > 0 ? 1 : -1;
+            double h = parabolic(i, step);
+            if (!(height_[i - 1] < h && h < height_[i + 1])) {
+                h = linear(i, step);
+            }
+            height_[i] = h;
+            pos_[i] += step;
+        }
+    }
+}
+
+double P2Quantile::parabolic(int i, int d) const {
+    return height_[i] + d / (pos_[i + 1] - pos_[i - 1]) *
+        ((pos_[i] - pos_[i - 1] + d) * (height_[i + 1] - height_[i]) / (pos_[i + 1] - pos_[i]) +
+         (pos_[i + 1] - pos_[i] - d) * (height_[i] - height_[i - 1]) / (pos_[i] - pos_[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const {
+    return height_[i] + d * (height_[i + d] - height_[i]) / (pos_[i + d] - pos_[i]);
+}
+
+double P2Quantile::get() const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    if (count_ < 5) {
+        // 样本不足5个时直接排序取值
+        double tmp[5];
+        std::copy(height_, height_ + count_, tmp);
+        std::sort(tmp, tmp + count_);
+        const auto idx = static_cast<size_t>(std::round(q_ * static_cast<double>(count_ - 1)));
+        return tmp[idx];
+    }
+    return height_[2];
+}
+
+}
@@ -0,0 +1,126 @@
+//
+// Created by xucong on 25-9-28.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace dcp::common {
+
+/**
+ * @brief 单通道流式统计：每次push只做增量更新，不拷贝、不排序。
+ * 多通道同频率的信号用SignalBank一次更新一批。
+ */
+
+// 指数滑动平均，首个样本直接作为初值
+class Ema {
+public:
+    explicit Ema(double alpha) : alpha_(alpha) {}
+
+    // 响应时间内的等效窗口 N = response/period，α = 2/(N+1)，与SignalSmoother一致
+    static double AlphaFor(double samplingPeriodS, double responseTimeS);
+
+    double push(double value);
+    double get() const { return value_; }
+    void reset();
+
+private:
+    double alpha_;
+    double value_ = 0.0;
+    bool initialized_ = false;
+};
+
+// 最近window个样本的算术平均，滑动和每转一圈重算一次，消除浮点累积误差
+class Sma {
+public:
+    explicit Sma(size_t window);
+
+    double push(double value);
+    double get() const;
+    size_t size() const { return count_; }
+    void reset();
+
+private:
+    std::vector<double> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    double sum_ = 0.0;
+};
+
+// 随机游走模型的标量卡尔曼滤波，q为过程噪声方差，r为测量噪声方差
+class Kalman1D {
+public:
+    Kalman1D(double processNoise, double measurementNoise) : q_(processNoise), r_(measurementNoise) {}
+
+    double push(double measurement);
+    double get() const { return x_; }
+    double variance() const { return p_; }
+    void reset();
+
+private:
+    double q_;
+    double r_;
+    double x_ = 0.0;
+    double p_ = 1.0;
+    bool initialized_ = false;
+};
+
+/**
+ * @brief 最近window个样本的任意分位数。
+ *
+ * 维护一份有序数组（顺序统计）和一份按到达顺序的环形数组：新样本二分插入，
+ * 最老样本二分删除，查询直接按下标取值。窗口为几十到几百时数据在一两条缓存行内移动，
+ * 比平衡树和双堆更快，且可同时查询多个分位数。
+ */
+class SlidingQuantile {
+public:
+    explicit SlidingQuantile(size_t window);
+
+    void push(double value);
+    // q取[0,1]，相邻样本间线性插值；median与排序后取中位数（偶数取平均）一致
+    double quantile(double q) const;
+    double median() const { return quantile(0.5); }
+    double min() const { return sorted_.empty() ? 0.0 : sorted_.front(); }
+    double max() const { return sorted_.empty() ? 0.0 : sorted_.back(); }
+    size_t size() const { return sorted_.size(); }
+    void reset();
+
+private:
+    size_t window_;
+    std::vector<double> sorted_;
+    std::vector<double> ring_;
+    size_t head_ = 0;
+};
+
+/**
+ * @brief P²算法的全量流式分位数估计，5个标记点，O(1)内存，适合长时间运行的统计。
+ */
+class P2Quantile {
+public:
+    explicit P2Quantile(double q);
+
+    void push(double value);
+    double get() const;
+    size_t count() const { return count_; }
+    void reset();
+
+private:
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+    double q_;
+    double height_[5] = {};
+    double pos_[5] = {};
+    double desired_[5] = {};
+    double increment_[5] = {};
+    size_t count_ = 0;
+};
+
+}
+
+#endif // STREAMING_STATS_H
@@ -1,9 +1,7 @@
-#include <deque>
-#include <vector>
-#include <algorithm>
-#include <numeric>
 #include <cmath>
-#include <iostream>
+#include <cstddef>
+
+#include "common/signal/streaming_stats.h"
 
 namespace dcp::common {
 class SignalSmoother {
@@ -14,81 +12,51 @@ public:
      * @param use_ema           是否使用 EMA，否则使用 SMA
      */
     SignalSmoother(double sampling_period_s, double response_time_s, bool use_ema = true)
-        : sampling_period_s_(sampling_period_s),
-          response_time_s_(response_time_s),
-          use_ema_(use_ema),
-          ema_initialized_(false),
-          ema_(0.0)
+        : use_ema_(use_ema),
+          ema_(Ema::AlphaFor(sampling_period_s, response_time_s)),
+          window_size_(WindowFor(sampling_period_s, response_time_s)),
+          sma_(window_size_),
+          median_(window_size_)
     {
-        // 计算 EMA α 或 SMA 窗口
-        if(use_ema_) {
-            // EMA 等效窗口 N_eff = 2/α - 1 → α = 2 / (N_eff + 1)
-            size_t N_eff = static_cast<size_t>(std::round(response_time_s_ / sampling_period_s_));
-            ema_alpha_ = 2.0 / (N_eff + 1.0);
-        } else {
-            window_size_ = static_cast<size_t>(std::round(response_time_s_ / sampling_period_s_));
-            if(window_size_ < 1) window_size_ = 1;
-        }
     }
 
     // 推入新数据
     void push(double value) {
         if(use_ema_) {
-            if(!ema_initialized_) {
-                ema_ = value;
-                ema_initialized_ = true;
-            } else {
-                ema_ = ema_alpha_ * value + (1 - ema_alpha_) * ema_;
-            }
+            ema_.push(value);
         } else {
-            buffer_.push_back(value);
-            if(buffer_.size() > window_size_)
-                buffer_.pop_front();
+            sma_.push(value);
+            median_.push(value);
         }
     }
 
     // 获取平滑值
     double get() const {
-        if(use_ema_) {
-            return ema_;
-        } else {
-            if(buffer_.empty()) return 0.0;
-            double sum = std::accumulate(buffer_.begin(), buffer_.end(), 0.0);
-            return sum / buffer_.size();
-        }
+        return use_ema_ ? ema_.get() : sma_.get();
     }
 
-    // 获取中值滤波
+    // 获取中值滤波，仅SMA模式维护窗口；O(log n)定位，不再拷贝排序
     double getMedian() const {
-        if(buffer_.empty()) return 0.0;
-        std::vector<double> tmp(buffer_.begin(), buffer_.end());
-        std::sort(tmp.begin(), tmp.end());
-        size_t mid = tmp.size() / 2;
-        if(tmp.size() % 2 == 0)
-            return 0.5 * (tmp[mid-1] + tmp[mid]);
-        else
-            return tmp[mid];
+        return median_.median();
     }
 
     // 重置历史数据
     void reset() {
-        buffer_.clear();
-        ema_initialized_ = false;
-        ema_ = 0.0;
+        ema_.reset();
+        sma_.reset();
+        median_.reset();
     }
 
 private:
-    double sampling_period_s_;
-    double response_time_s_;
-    bool use_ema_;
-
-    // EMA
-    bool ema_initialized_;
-    double ema_;
-    double ema_alpha_;
+    static size_t WindowFor(double sampling_period_s, double response_time_s) {
+        const auto window = static_cast<size_t>(std::round(response_time_s / sampling_period_s));
+        return window < 1 ? 1 : window;
+    }
 
-    // SMA / Median
+    bool use_ema_;
+    Ema ema_;
     size_t window_size_;
-    std::deque<double> buffer_;
+    Sma sma_;
+    SlidingQuantile median_;
 };
 }
@@ -0,0 +1,106 @@
+//
+// Created by xucong on 25-9-22.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "file_watcher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+#include "common/log/logger.h"
+
+namespace dcp::common {
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+bool FileWatcher::Start(const std::string& filePath, Callback callback, int debounceMs) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (filePath.empty() || !callback) {
+        return false;
+    }
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0) {
+        AD_ERROR(FileWatcher, "eventfd failed: %s", strerror(errno));
+        return false;
+    }
+    file_path_ = filePath;
+    callback_ = std::move(callback);
+    debounce_ms_ = debounceMs;
+    thread_ = std::thread(&FileWatcher::Run, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    const uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0) {
+        AD_WARN(FileWatcher, "Wake watch thread failed: %s", strerror(errno));
+    }
+    thread_.join();
+    close(stop_fd_);
+    stop_fd_ = -1;
+}
+
+void FileWatcher::Run() {
+    const std::filesystem::path path(file_path_);
+    const std::string dir = path.has_parent_path() ? path.parent_path().string() : ".";
+    const std::string name = path.filename().string();
+
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        AD_ERROR(FileWatcher, "Watch %s failed: %s", dir.c_str(), strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+    AD_INFO(FileWatcher, "Watching %s for changes.", file_path_.c_str());
+
+    bool pending = false;
+    alignas(struct inotify_event) char buf[4096];
+    while (true) {
+        struct pollfd fds[2] = {{fd, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+        const int ret = poll(fds, 2, pending ? debounce_ms_ : -1);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            AD_ERROR(FileWatcher, "poll failed: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (ret == 0) {
+            pending = false;
+            callback_();
+            continue;
+        }
+        ssize_t len;
+        while ((len = read(fd, buf, sizeof(buf))) > 0) {
+            for (char* ptr = buf; ptr < buf + len;) {
+                const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+                if (event->len > 0 && name == event->name) {
+                    pending = true;
+                }
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+    close(fd);
+}
+
+}
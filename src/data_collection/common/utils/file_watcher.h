@@ -0,0 +1,49 @@
+//
+// Created by xucong on 25-9-22.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace dcp::common {
+
+/**
+ * @brief 用inotify监听单个文件的修改，回调在监听线程中执行。
+ *
+ * 监听的是文件所在目录：编辑器和部署工具通常写临时文件再rename覆盖，
+ * 直接监听文件会在第一次替换后失效。一次保存会产生多个事件，
+ * 最后一个事件后静默debounceMs才回调一次。
+ */
+class FileWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    FileWatcher() = default;
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool Start(const std::string& filePath, Callback callback, int debounceMs = 200);
+    void Stop();
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+private:
+    void Run();
+
+    std::string file_path_;
+    Callback callback_;
+    int debounce_ms_ = 200;
+    std::thread thread_;
+    int stop_fd_ = -1;
+};
+
+}
+
+#endif // FILE_WATCHER_H
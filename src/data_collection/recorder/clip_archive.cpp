@@ -0,0 +1,234 @@
+//
+// Created by xucong on 25-9-10.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "clip_archive.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+#include <rmw/rmw.h>
+#include <rosbag2_cpp/reader.hpp>
+#include <rosbag2_cpp/writer.hpp>
+#include <rosbag2_storage/storage_filter.hpp>
+
+#include "file_compress.h"
+#include "common/log/logger.h"
+#include "common/utils/utils.h"
+
+namespace dcp::recorder {
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr const char* kSummarySuffix = ".summary.json";
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}
+
+ClipArchive::ClipArchive(const std::string& data_path) : data_path_(data_path) {
+    if (!data_path_.empty() && data_path_.back() != '/') {
+        data_path_ += "/";
+    }
+}
+
+std::string ClipArchive::ClipPath(const std::string& clip_id, const std::string& suffix) const {
+    return data_path_ + clip_id + suffix;
+}
+
+uint64_t ClipArchive::DirectorySize(const std::string& path) {
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec)) {
+        return fs::file_size(path, ec);
+    }
+    uint64_t size = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+        if (entry.is_regular_file(ec)) {
+            size += entry.file_size(ec);
+        }
+    }
+    return size;
+}
+
+bool ClipArchive::SaveSummary(const common::ClipSummary& summary) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream ofs(ClipPath(summary.clip_id, kSummarySuffix));
+    if (!ofs.is_open()) {
+        AD_ERROR(ClipArchive, "Save summary of %s failed.", summary.clip_id.c_str());
+        return false;
+    }
+    common::json j = summary;
+    ofs << j.dump(4) << std::endl;
+    return true;
+}
+
+std::vector<common::ClipSummary> ClipArchive::LoadUnpublished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<common::ClipSummary> summaries;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(data_path_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (!EndsWith(name, kSummarySuffix)) {
+            continue;
+        }
+        try {
+            std::ifstream ifs(entry.path());
+            auto summary = common::json::parse(ifs).get<common::ClipSummary>();
+            if (!summary.published) {
+                summaries.emplace_back(std::move(summary));
+            }
+        } catch (const std::exception& e) {
+            AD_WARN(ClipArchive, "Invalid summary %s: %s", name.c_str(), e.what());
+        }
+    }
+    return summaries;
+}
+
+bool ClipArchive::MarkPublished(const std::string& clip_id) {
+    const std::string path = ClipPath(clip_id, kSummarySuffix);
+    common::ClipSummary summary;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        try {
+            std::ifstream ifs(path);
+            summary = common::json::parse(ifs).get<common::ClipSummary>();
+        } catch (const std::exception& e) {
+            AD_WARN(ClipArchive, "Load summary of %s failed: %s", clip_id.c_str(), e.what());
+            return false;
+        }
+    }
+    summary.published = true;
+    return SaveSummary(summary);
+}
+
+bool ClipArchive::Export(const common::ClipRequest& request, std::string& output) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string bag_path = ClipPath(request.clip_id, ".recording");
+    const std::string tag_path = ClipPath(request.clip_id, ".json");
+    if (!fs::exists(bag_path)) {
+        AD_ERROR(ClipArchive, "Clip %s not found, may have expired.", request.clip_id.c_str());
+        return false;
+    }
+
+    const bool full = request.topics.empty() && request.start_time == 0 && request.end_time == 0;
+    std::vector<std::string> inputs;
+    std::string extracted;
+    if (full) {
+        output = ClipPath(request.clip_id, ".tar.lz4");
+        inputs.emplace_back(bag_path);
+    } else {
+        const std::string suffix = request.request_id.empty()
+            ? std::to_string(common::GetCurrentTimestampMs()) : request.request_id;
+        extracted = ClipPath(request.clip_id + "_" + suffix, ".recording");
+        output = ClipPath(request.clip_id + "_" + suffix, ".tar.lz4");
+        if (!ExtractBag(bag_path, extracted, request)) {
+            std::error_code ec;
+            fs::remove_all(extracted, ec);
+            return false;
+        }
+        inputs.emplace_back(extracted);
+    }
+    if (fs::exists(tag_path)) {
+        inputs.emplace_back(tag_path);
+    }
+
+    auto ret = FileCompress::CompressFiles(inputs, output);
+    std::error_code ec;
+    if (!extracted.empty()) {
+        fs::remove_all(extracted, ec);
+    }
+    if (ret != FileCompress::ErrorCode::Success) {
+        AD_ERROR(ClipArchive, "Compress clip %s failed, ret: %d", request.clip_id.c_str(), static_cast<int>(ret));
+        return false;
+    }
+    // 全量导出后原始数据不再需要，部分导出保留以响应后续请求
+    if (full) {
+        RemoveClip(request.clip_id);
+    }
+    AD_INFO(ClipArchive, "Exported clip %s to %s", request.clip_id.c_str(), output.c_str());
+    return true;
+}
+
+bool ClipArchive::ExtractBag(const std::string& input, const std::string& output, const common::ClipRequest& request) {
+    try {
+        rosbag2_storage::StorageOptions in_options;
+        in_options.uri = input;
+        in_options.storage_id = "sqlite3";
+        rosbag2_cpp::ConverterOptions converter_options;
+        converter_options.input_serialization_format = rmw_get_serialization_format();
+        converter_options.output_serialization_format = rmw_get_serialization_format();
+
+        rosbag2_cpp::Reader reader;
+        reader.open(in_options, converter_options);
+        if (!request.topics.empty()) {
+            rosbag2_storage::StorageFilter filter;
+            filter.topics = request.topics;
+            reader.set_filter(filter);
+        }
+
+        rosbag2_storage::StorageOptions out_options;
+        out_options.uri = output;
+        out_options.storage_id = "sqlite3";
+        rosbag2_cpp::Writer writer;
+        writer.open(out_options, converter_options);
+
+        std::unordered_set<std::string> topics(request.topics.begin(), request.topics.end());
+        for (const auto& metadata : reader.get_all_topics_and_types()) {
+            if (topics.empty() || topics.count(metadata.name)) {
+                writer.create_topic(metadata);
+            }
+        }
+
+        const uint64_t end_time = request.end_time == 0 ? UINT64_MAX : request.end_time;
+        size_t count = 0;
+        while (reader.has_next()) {
+            auto msg = reader.read_next();
+            const auto timestamp = static_cast<uint64_t>(msg->time_stamp);
+            if (timestamp < request.start_time || timestamp > end_time) {
+                continue;
+            }
+            writer.write(msg);
+            ++count;
+        }
+        AD_INFO(ClipArchive, "Extracted %d messages from %s", static_cast<int>(count), input.c_str());
+        return count > 0;
+    } catch (const std::exception& e) {
+        AD_ERROR(ClipArchive, "Extract %s failed: %s", input.c_str(), e.what());
+        return false;
+    }
+}
+
+void ClipArchive::RemoveClip(const std::string& clip_id) {
+    std::error_code ec;
+    fs::remove_all(ClipPath(clip_id, ".recording"), ec);
+    fs::remove(ClipPath(clip_id, ".json"), ec);
+    fs::remove(ClipPath(clip_id, kSummarySuffix), ec);
+}
+
+int ClipArchive::ExpireClips(int retention_hours) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto deadline = fs::file_time_type::clock::now() - std::chrono::hours(retention_hours);
+    std::vector<std::string> expired;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(data_path_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (!EndsWith(name, kSummarySuffix)) {
+            continue;
+        }
+        if (entry.last_write_time(ec) < deadline) {
+            expired.emplace_back(name.substr(0, name.size() - std::string(kSummarySuffix).size()));
+        }
+    }
+    for (const auto& clip_id : expired) {
+        RemoveClip(clip_id);
+        AD_INFO(ClipArchive, "Clip %s was never requested, expired.", clip_id.c_str());
+    }
+    return static_cast<int>(expired.size());
+}
+
+}
@@ -0,0 +1,54 @@
+//
+// Created by xucong on 25-9-10.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CLIP_ARCHIVE_H
+#define CLIP_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "common/data.h"
+
+namespace dcp::recorder {
+
+/**
+ * 两阶段上传的本地片段库。未被请求的片段只保留原始录制目录、标签json和摘要：
+ *   <clip>.recording      录制目录
+ *   <clip>.json           标签
+ *   <clip>.summary.json   摘要
+ * 云端请求后再压缩为 <clip>.tar.lz4（全量）或 <clip>_<requestId>.tar.lz4（指定topic/时间段），
+ * 由常规上传流程上传；超过保留时长仍未请求的片段直接删除。
+ */
+class ClipArchive {
+public:
+    explicit ClipArchive(const std::string& data_path);
+    ~ClipArchive() = default;
+
+    bool SaveSummary(const common::ClipSummary& summary);
+    std::vector<common::ClipSummary> LoadUnpublished();
+    bool MarkPublished(const std::string& clip_id);
+
+    // 按请求导出压缩包，output为待上传文件路径
+    bool Export(const common::ClipRequest& request, std::string& output);
+
+    // 删除超过保留时长的片段，返回删除数量
+    int ExpireClips(int retention_hours);
+
+    static uint64_t DirectorySize(const std::string& path);
+
+private:
+    std::string ClipPath(const std::string& clip_id, const std::string& suffix) const;
+    bool ExtractBag(const std::string& input, const std::string& output, const common::ClipRequest& request);
+    void RemoveClip(const std::string& clip_id);
+
+    std::string data_path_;
+    std::mutex mutex_;
+};
+
+}
+
+#endif //CLIP_ARCHIVE_H
@@ -5,7 +5,11 @@
 //
 
 #include "data_storage.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
 #include "common/log/logger.h"
+#include "common/metrics/span_tracer.h"
 #include "common/utils/utils.h"
 
 namespace dcp::recorder {
@@ -14,15 +18,84 @@ namespace fs = std::filesystem;
 
 constexpr float kDiskThreshold = 90.0f;
 constexpr uint64_t kDefaultDataSizeBytes = 1024 * 1024; // 1GB
+constexpr size_t kMaxSignalSamples = 10000; // 每个信号保留的采样上限
+constexpr uint64_t kHousekeepingIntervalUs = 60 * 1000000ULL;
+constexpr size_t kClipThreads = 4; // 可同时采集的片段数
+constexpr int kClipTickMs = 10;
+constexpr size_t kExportThreads = 1; // 导出不可中断，同时只压缩一个片段
+
+std::shared_ptr<const DataStorage::ActiveStrategies> DataStorage::make_strategies(
+    const trigger::StrategyConfig& strategy_config)
+{
+    auto strategies = std::make_shared<ActiveStrategies>();
+    for (const auto& k: strategy_config.strategies) {
+        if (!k.trigger.enabled) continue;
+        auto strategy = std::make_shared<const trigger::Strategy>(k);
+        strategies->list.push_back(strategy);
+        strategies->by_id[k.trigger.triggerId] = strategy;
+        // 兼容旧行为：无法按triggerId匹配的触发使用最后一个enabled策略
+        strategies->fallback = strategy;
+    }
+    return strategies;
+}
+
+std::shared_ptr<const trigger::Strategy> DataStorage::find_strategy(const std::string& trigger_id) const
+{
+    const auto strategies = std::atomic_load(&strategies_);
+    if (!strategies) return nullptr;
+    auto it = strategies->by_id.find(trigger_id);
+    return it != strategies->by_id.end() ? it->second : strategies->fallback;
+}
+
+bool DataStorage::acquire_strategy(const trigger::Strategy& strategy)
+{
+    const std::string& id = strategy.trigger.triggerId;
+    std::lock_guard<std::mutex> lock(strategy_state_mutex_);
+    if (capturing_strategies_.count(id)) {
+        AD_INFO(DataStorage, "Strategy %s is capturing, trigger dropped.", id.c_str());
+        return false;
+    }
+    // 排队等线程的片段会错过前向窗口，在途片段不超过调度器的一次性任务名额；
+    // 优先级高于某个在途片段时可多占一个，借保留线程运行，低优先级片段的后处理让出
+    if (capturing_strategies_.size() >= kClipThreads) {
+        const bool outranks = capturing_strategies_.size() == kClipThreads &&
+            std::any_of(capturing_strategies_.begin(), capturing_strategies_.end(),
+                        [&](const auto& clip) { return strategy.trigger.priority < clip.second; });
+        if (!outranks) {
+            AD_WARN(DataStorage, "%d clips in flight, trigger of %s dropped.",
+                    static_cast<int>(capturing_strategies_.size()), id.c_str());
+            return false;
+        }
+    }
+    auto it = last_finish_timestamps_.find(id);
+    if (it != last_finish_timestamps_.end()) {
+        const uint64_t required_cooldown_us = strategy.mode.cacheMode.cooldownDurationSec * 1000000ULL;
+        const uint64_t since_last_finish = common::GetCurrentTimestamp() - it->second;
+        if (since_last_finish < required_cooldown_us) {
+            AD_INFO(DataStorage, "Strategy %s cooling down, remaining: %.2f seconds, trigger dropped.", id.c_str(),
+                    (required_cooldown_us - since_last_finish) / 1e6);
+            return false;
+        }
+    }
+    capturing_strategies_.emplace(id, strategy.trigger.priority);
+    return true;
+}
+
+void DataStorage::release_strategy(const trigger::Strategy& strategy)
+{
+    std::lock_guard<std::mutex> lock(strategy_state_mutex_);
+    capturing_strategies_.erase(strategy.trigger.triggerId);
+    last_finish_timestamps_[strategy.trigger.triggerId] = common::GetCurrentTimestamp();
+}
 
 bool DataStorage::Init(const std::shared_ptr<rclcpp::Node>& node, const trigger::StrategyConfig& strategy_config)
 {
     node_ = node;
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
     config_ = strategy_config;
 
-    auto it  = appconfig.dataStorage.storagePaths.find("bagPath");
-    if (it != appconfig.dataStorage.storagePaths.end()) {
+    auto it  = appconfig->dataStorage.storagePaths.find("bagPath");
+    if (it != appconfig->dataStorage.storagePaths.end()) {
         data_path_ = it->second;
     }
     data_path_ = data_path_.empty() ? "./data" : data_path_;
@@ -48,12 +121,8 @@ bool DataStorage::Init(const std::shared_ptr<rclcpp::Node>& node, const trigger:
         return false;
     }
 
-    for (const auto& k: config_.strategies) {
-        if (k.trigger.enabled)
-            strategy_ = std::make_shared<trigger::Strategy>(k);
-    }
-
-    if(!strategy_)
+    const auto strategies = make_strategies(config_);
+    if (strategies->list.empty())
     {
         AD_ERROR(DataStorage,"no own strategy");
         return false;
@@ -61,15 +130,50 @@ bool DataStorage::Init(const std::shared_ptr<rclcpp::Node>& node, const trigger:
 
     ros2bag_recorder_ = std::make_shared<Ros2BagRecorder>(node_);
     ros2bag_recorder_->Init();
-    last_trigger_timestamp_ = common::GetCurrentTimestamp();
+    // 缓冲区容量按实测频率修正，策略声明的帧率不准时不截断片段
+    ros2bag_recorder_->SetAutoSize(appconfig->profiler.enabled && appconfig->profiler.autoSizeBuffers,
+                                   appconfig->profiler.rateHeadroom);
+    if (!ros2bag_recorder_->SetStrategies(strategies->list)) {
+        AD_ERROR(DataStorage, "Init ring buffers for %d strategies failed.", static_cast<int>(strategies->list.size()));
+        return false;
+    }
+    std::atomic_store(&strategies_, strategies);
+
+    const bool streaming = std::any_of(strategies->list.begin(), strategies->list.end(),
+                                       [](const auto& strategy) { return strategy->mode.streamingUpload; });
+    if (streaming && !appconfig->debug.closeDataUpload) {
+        stream_uploader_ = std::make_unique<uploader::StreamUploader>();
+        if (!stream_uploader_->Init(appconfig->dataUpload)) {
+            AD_WARN(DataStorage, "StreamUploader init failed, clips use normal upload.");
+            stream_uploader_.reset();
+        }
+    }
+    if (appconfig->dataUpload.twoPhase.enabled) {
+        clip_archive_ = std::make_unique<ClipArchive>(data_path_);
+        clip_channel_ = std::make_unique<uploader::ClipSummaryChannel>();
+        if (!clip_channel_->Init(*appconfig, [this](const common::ClipRequest& request) { handle_request(request); })) {
+            // 通道不可用时摘要留在本地，连接恢复后由housekeeping补发
+            AD_WARN(DataStorage, "ClipSummaryChannel init failed, summaries will be published later.");
+        }
+    }
+    // 一次性任务名额为workers-1，多出的一个线程留给抢占者
+    clip_scheduler_ = std::make_unique<trigger::TimerWheelScheduler>(kClipThreads + 1, kClipTickMs, "clip");
+    clip_scheduler_->StartScheduling();
+    if (clip_archive_) {
+        export_scheduler_ = std::make_unique<trigger::TimerWheelScheduler>(kExportThreads + 1, kClipTickMs, "export");
+        export_scheduler_->StartScheduling();
+    }
+    trigger_metrics_ = common::MetricsRecorder::getInstance().RegisterSeries(
+        "recorder_trigger", {"queue_depth", "handle_ms", "ok"});
 
     return true;
 }
 
 
-bool DataStorage::save_json(std::string& output_json_filename, const trigger::TriggerContext& current_trigger)
+bool DataStorage::save_json(std::string& output_json_filename, const trigger::TriggerContext& current_trigger,
+                            const trigger::Strategy& strategy)
 {
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
     nlohmann::json json;
     json["city"] = "WuHan";
     json["day_night"] = "day";
@@ -77,10 +181,10 @@ bool DataStorage::save_json(std::string& output_json_filename, const trigger::Tr
     json["shadow_tag_info"]["businessType"] = current_trigger.businessType;
     json["shadow_tag_info"]["triggerId"] = current_trigger.triggerId;
     json["shadow_tag_info"]["timeStamp"] = common::UnixSecondsToString(current_trigger.triggerTimestamp/1e6);
-    json["shadow_tag_info"]["forward_time"] = strategy_->mode.cacheMode.forwardCaptureDurationSec;
-    json["shadow_tag_info"]["backward_time"] = strategy_->mode.cacheMode.backwardCaptureDurationSec;
+    json["shadow_tag_info"]["forward_time"] = strategy.mode.cacheMode.forwardCaptureDurationSec;
+    json["shadow_tag_info"]["backward_time"] = strategy.mode.cacheMode.backwardCaptureDurationSec;
     json["shadow_tag_info"]["triggerDesc"] = current_trigger.triggerDesc;
-    json["is_cloud_upload"] = !appconfig.debug.closeDataUpload;
+    json["is_cloud_upload"] = !appconfig->debug.closeDataUpload;
 
     std::ofstream ofs(output_json_filename);
     if (ofs.is_open()){
@@ -94,9 +198,34 @@ bool DataStorage::save_json(std::string& output_json_filename, const trigger::Tr
     }
 }
 
-bool DataStorage::handle_trigger(const trigger::TriggerContext& trigger)
+bool DataStorage::run_clip(ClipJob& job, const std::atomic<bool>& preempted)
 {
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    if (!job.captured) {
+        job.handle_start = common::GetCurrentTimestamp();
+        job.ok = capture_clip(job);
+        job.captured = true;
+        // 采集受窗口时间约束不能中断；后处理（打包、压缩）可以推迟。
+        // 流式上传的片段和退出时不让出，避免长时间占着流或留下未打包的片段
+        if (job.ok && !job.stream && preempted.load() && !stop_.load()) {
+            AD_INFO(DataStorage, "Trigger %s yields post-processing to a higher priority clip.",
+                    job.trigger.triggerId.c_str());
+            return false;
+        }
+    }
+    if (job.ok) {
+        finish_clip(job);
+    }
+    release_strategy(*job.strategy);
+    const uint64_t handle_end = common::GetCurrentTimestamp();
+    common::MetricsRecorder::getInstance().Record(trigger_metrics_, {
+        static_cast<double>(job.queue_depth), (handle_end - job.handle_start) / 1e3, job.ok ? 1.0 : 0.0});
+    return true;
+}
+
+bool DataStorage::capture_clip(ClipJob& job)
+{
+    const auto& trigger = job.trigger;
+    const auto& strategy = job.strategy;
     const float currentUsage = disk_space_checker_->getUsagePercentage(data_path_);
     if (disk_space_checker_->isOverThreshold(data_path_)) {
         AD_WARN(DataStorage, "Disk space is insufficient! Current usage: %f%, unable to start collection", currentUsage);
@@ -107,19 +236,48 @@ bool DataStorage::handle_trigger(const trigger::TriggerContext& trigger)
     // data_reporter_->getCollectBagDistance(bag_distance);
     uint64_t now = common::GetCurrentTimestamp();
     if ((now - trigger.triggerTimestamp) >= 0.01*1e9) return false;
-    std::string filepath = data_path_ +
+    job.filepath = data_path_ +
         common::MakeRecorderFileName(trigger.triggerId, trigger.businessType, trigger.triggerTimestamp/1e9);
-    ros2bag_recorder_->TriggerRecord(trigger.triggerTimestamp, filepath);
+    const std::string& filepath = job.filepath;
+    // 触发到开始处理之间在trigger队列和clip调度器中等待
+    common::SpanTracer::getInstance().Record("trigger_queue", filepath, trigger.triggerTimestamp, now);
+    common::TraceSpan trace_span("capture", filepath);
+
+    std::string& base_filename = job.base_filename;
+    base_filename = filepath;
+    const std::string recording_suffix = ".recording";
+    if (base_filename.size() > recording_suffix.size() &&
+        base_filename.compare(base_filename.size() - recording_suffix.size(), recording_suffix.size(), recording_suffix) == 0) {
+        base_filename.erase(base_filename.size() - recording_suffix.size());
+    }
+
+    // 会话由录制器在固定前向窗口之后再打开
+    std::function<uploader::StreamUploader*()> open_stream;
+    if (stream_uploader_ && strategy->mode.streamingUpload && !stream_busy_.exchange(true)) {
+        open_stream = [this, &job] {
+            if (stream_uploader_->Open(fs::path(job.base_filename + ".tar.lz4").filename().string() + ".stream")) {
+                job.stream = stream_uploader_.get();
+            }
+            return job.stream;
+        };
+    }
+    ros2bag_recorder_->TriggerRecord(strategy, trigger.triggerTimestamp, filepath, open_stream, &job.bag_info);
+    if (open_stream && !job.stream) {
+        stream_busy_ = false;
+    }
     AD_INFO(DataStorage, "Trigger Recorder path:%s, Trigger ID: %s", filepath.c_str(), trigger.triggerId.c_str());
+    return true;
+}
+
+void DataStorage::finish_clip(ClipJob& job)
+{
+    const auto& trigger = job.trigger;
+    const std::string& filepath = job.filepath;
+    common::TraceSpan trace_span("post_process", filepath);
 
     std::vector<std::string> inputFilePaths;
-    std::string output_json_filename = filepath;
-    std::string output_lz4_filename = filepath;
-    size_t start_pos = filepath.find("splite");
-    if (start_pos != std::string::npos){
-        output_json_filename.replace(start_pos,6,"json");
-        output_lz4_filename.replace(start_pos,6,"tar.lz4");
-    }
+    std::string output_json_filename = job.base_filename + ".json";
+    std::string output_lz4_filename = job.base_filename + ".tar.lz4";
 
     AD_INFO(DataStorage, "========================================================");
     AD_INFO(DataStorage, "Shadow tag file :%s", output_json_filename.c_str());
@@ -127,36 +285,159 @@ bool DataStorage::handle_trigger(const trigger::TriggerContext& trigger)
     AD_INFO(DataStorage, "Shadow upload file :%s", output_lz4_filename.c_str());
     AD_INFO(DataStorage, "========================================================");
 
-    save_json(output_json_filename, trigger);
+    save_json(output_json_filename, trigger, *job.strategy);
+
+    bool streamed = false;
+    if (auto* stream = job.stream) {
+        common::TraceSpan stream_span("stream_finalize", filepath);
+        std::ifstream ifs(output_json_filename);
+        std::string tag((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        stream->Append(uploader::StreamUploader::RecordKind::Meta, "", trigger.triggerTimestamp, tag.data(), tag.size());
+        streamed = stream->Finalize();
+        AD_INFO(DataStorage, "Stream upload of trigger %s %s, latency: %.2f seconds", trigger.triggerId.c_str(),
+                streamed ? "succeeded" : "failed", (common::GetCurrentTimestamp() - trigger.triggerTimestamp) / 1e6);
+        stream_busy_ = false;
+    }
 
-    inputFilePaths.emplace_back(filepath);
-    inputFilePaths.emplace_back(output_json_filename);
-    if(compress_files(inputFilePaths, output_lz4_filename)) {
-        double bag_capacity = 0;
-        bag_capacity = static_cast<double>(fs::file_size(fs::path(output_lz4_filename)))/kDefaultDataSizeBytes;
-        AD_INFO(DataStorage, "bag_capacity: %fM", bag_capacity);
-        // data_reporter_->addCollectBagInfo(bag_distance, bag_capacity);
+    if (clip_archive_ && !streamed) {
+        // 两阶段上传：仅上报摘要，原始数据待云端请求后再压缩上传
+        common::TraceSpan archive_span("archive", filepath);
+        handle_clip(trigger, filepath, *job.strategy, job.bag_info);
+    } else {
+        inputFilePaths.emplace_back(filepath);
+        inputFilePaths.emplace_back(output_json_filename);
+        if(compress_files(inputFilePaths, output_lz4_filename)) {
+            double bag_capacity = 0;
+            bag_capacity = static_cast<double>(fs::file_size(fs::path(output_lz4_filename)))/kDefaultDataSizeBytes;
+            AD_INFO(DataStorage, "bag_capacity: %fM", bag_capacity);
+            if (streamed) {
+                // 已流式上传，标记后常规上传跳过该文件，本地仍按滚动策略保留
+                std::ofstream marker(output_lz4_filename + ".streamed");
+            }
+            // data_reporter_->addCollectBagInfo(bag_distance, bag_capacity);
+        }
     }
 
-    int cooldownDurationSec = strategy_->mode.cacheMode.cooldownDurationSec;
-    auto time_since_last_finish = common::GetCurrentTimestamp() - last_trigger_timestamp_;
+    AD_INFO(DataStorage, "Trigger %s finished at: %lld", trigger.triggerId.c_str(), common::GetCurrentTimestamp());
+}
 
-    uint64_t required_cooldown_us = cooldownDurationSec * 1e6;
-    uint64_t remaining_cooldown = (time_since_last_finish < required_cooldown_us)
-                                      ? (required_cooldown_us - time_since_last_finish)
-                                      : 0;
+bool DataStorage::handle_clip(const trigger::TriggerContext& trigger, const std::string& bag_path,
+                              const trigger::Strategy& strategy, const TBagInfo& bag_info)
+{
 
-    if(remaining_cooldown > 0){
-        AD_INFO(DataStorage, "Cooling down, remaining: %.2f seconds", remaining_cooldown / 1e6);
-        std::this_thread::sleep_for(std::chrono::microseconds(remaining_cooldown));
+    common::ClipSummary summary;
+    summary.clip_id = fs::path(bag_path).stem().string();
+    summary.trigger_id = trigger.triggerId;
+    summary.business_type = trigger.businessType;
+    summary.trigger_desc = trigger.triggerDesc;
+    summary.trigger_timestamp = trigger.triggerTimestamp;
+    summary.pos_x = trigger.pos.x;
+    summary.pos_y = trigger.pos.y;
+    summary.size_bytes = ClipArchive::DirectorySize(bag_path);
+    summary.start_timestamp = bag_info.start_timestamp;
+    summary.end_timestamp = bag_info.end_timestamp;
+    for (const auto& [topic, metadata] : bag_info.topics) {
+        summary.topics.push_back({topic, metadata.message_count, metadata.data_size});
     }
 
-    last_trigger_timestamp_ = common::GetCurrentTimestamp();
-    AD_INFO(DataStorage, "Trigger finished at: %lld", last_trigger_timestamp_);
+    if (signal_history_) {
+        // 槽位时刻为SignalSlots的单调时钟，片段窗口换算到同一时钟
+        const int64_t clock_offset = static_cast<int64_t>(common::GetCurrentTimestamp()) - trigger::SignalSlots::nowUs();
+        const int64_t window_start = static_cast<int64_t>(trigger.triggerTimestamp) - clock_offset -
+            static_cast<int64_t>(strategy.mode.cacheMode.forwardCaptureDurationSec * 1e6);
+        const int64_t window_end = static_cast<int64_t>(trigger.triggerTimestamp) - clock_offset +
+            static_cast<int64_t>(strategy.mode.cacheMode.backwardCaptureDurationSec * 1e6);
+        std::vector<std::pair<uint32_t, common::ClipSummary::SignalStat>> stats;
+        {
+            std::lock_guard<std::mutex> lock(signal_history_->mutex);
+            for (const auto& [slot, samples] : signal_history_->samples) {
+                common::ClipSummary::SignalStat stat;
+                double sum = 0.0;
+                for (const auto& [timestamp, value] : samples) {
+                    if (timestamp < window_start || timestamp > window_end) continue;
+                    stat.min = stat.count == 0 ? value : std::min(stat.min, value);
+                    stat.max = stat.count == 0 ? value : std::max(stat.max, value);
+                    sum += value;
+                    ++stat.count;
+                }
+                if (stat.count > 0) {
+                    stat.mean = sum / stat.count;
+                    stats.emplace_back(slot, std::move(stat));
+                }
+            }
+        }
+        for (auto& [slot, stat] : stats) {
+            stat.name = signal_slots_->name(slot);
+            summary.signals.emplace_back(std::move(stat));
+        }
+    }
 
+    if (!clip_archive_->SaveSummary(summary)) {
+        return false;
+    }
+    bool published = false;
+    if (clip_channel_) {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        published = clip_channel_->PublishSummary(summary);
+    }
+    if (published) {
+        clip_archive_->MarkPublished(summary.clip_id);
+    }
+    AD_INFO(DataStorage, "Clip %s archived, size: %fM, topics: %d", summary.clip_id.c_str(),
+            static_cast<double>(summary.size_bytes) / kDefaultDataSizeBytes, static_cast<int>(summary.topics.size()));
     return true;
 }
 
+void DataStorage::handle_request(const common::ClipRequest& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(trigger_mutex_);
+        request_queue_.push(request);
+    }
+    cv_.notify_one();
+}
+
+void DataStorage::housekeeping()
+{
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
+    for (const auto& summary : clip_archive_->LoadUnpublished()) {
+        if (!clip_channel_) break;
+        std::unique_lock<std::mutex> lock(publish_mutex_);
+        if (!clip_channel_->PublishSummary(summary)) break;
+        lock.unlock();
+        clip_archive_->MarkPublished(summary.clip_id);
+    }
+    const int expired = clip_archive_->ExpireClips(appconfig->dataUpload.twoPhase.retentionHours);
+    if (expired > 0) {
+        AD_INFO(DataStorage, "%d clips expired.", expired);
+    }
+    last_housekeeping_timestamp_ = common::GetCurrentTimestamp();
+}
+
+void DataStorage::SignalHistory::Record(uint32_t slot, double value, int64_t stampUs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& history = samples[slot];
+    history.emplace_back(stampUs, value);
+    if (history.size() > kMaxSignalSamples) {
+        history.pop_front();
+    }
+}
+
+void DataStorage::SetSignalSource(const std::shared_ptr<trigger::SignalSlots>& slots)
+{
+    if (!clip_archive_ || !slots) return;
+    if (signal_slots_) {
+        signal_slots_->setTap(nullptr);
+    }
+    signal_slots_ = slots;
+    signal_history_ = std::make_shared<SignalHistory>();
+    // 消息解析和求值器写槽位时顺带记录，片段摘要按片段窗口统计
+    signal_slots_->setTap([history = signal_history_](uint32_t slot, double value, int64_t stampUs) {
+        history->Record(slot, value, stampUs);
+    });
+}
+
 void DataStorage::AddTrigger(const trigger::TriggerContext& context)
 {
     {
@@ -166,23 +447,100 @@ void DataStorage::AddTrigger(const trigger::TriggerContext& context)
     cv_.notify_one();
 }
 
+bool DataStorage::UpdateStrategy(const trigger::StrategyConfig& strategy_config)
+{
+    if (!ros2bag_recorder_) {
+        AD_ERROR(DataStorage, "Not initialized.");
+        return false;
+    }
+    const auto strategies = make_strategies(strategy_config);
+    if (strategies->list.empty()) {
+        AD_ERROR(DataStorage, "no own strategy in new config, keep the current ones");
+        return false;
+    }
+    if (!ros2bag_recorder_->SetStrategies(strategies->list)) {
+        AD_ERROR(DataStorage, "Apply %d strategies failed, keep the current ones.",
+                 static_cast<int>(strategies->list.size()));
+        return false;
+    }
+    for (const auto& strategy : strategies->list) {
+        if (strategy->mode.streamingUpload && !stream_uploader_) {
+            AD_WARN(DataStorage, "streamingUpload of %s takes effect after restart.",
+                    strategy->trigger.triggerId.c_str());
+        }
+    }
+    config_ = strategy_config;
+    std::atomic_store(&strategies_, strategies);
+    AD_INFO(DataStorage, "%d strategies active", static_cast<int>(strategies->list.size()));
+    return true;
+}
+
 bool DataStorage::Start() {
     while (!stop_.load()) {
         std::unique_lock<std::mutex> lock(trigger_mutex_);
-        cv_.wait(lock, [&]{
-            return !trigger_queue_.empty() || stop_.load();
+        cv_.wait_for(lock, std::chrono::seconds(60), [&]{
+            return !trigger_queue_.empty() || !request_queue_.empty() || stop_.load();
         });
 
         if (stop_.load()) break;
 
+        if (!request_queue_.empty()) {
+            auto request = request_queue_.front();
+            request_queue_.pop();
+            lock.unlock();
+            if (!export_scheduler_) {
+                AD_WARN(DataStorage, "Two-phase upload disabled, drop request %s.", request.request_id.c_str());
+                continue;
+            }
+            // 导出（压缩已归档的片段）不能在中途让出，放在独立的调度器，不占用片段采集的线程
+            export_scheduler_->ScheduleOnce("export", std::numeric_limits<int8_t>::max(), std::chrono::milliseconds(0),
+                                          [this, request](const std::atomic<bool>&) {
+                std::string output;
+                // 导出的压缩包落在数据目录，由DataUploader轮询上传
+                if (!clip_archive_->Export(request, output)) {
+                    AD_ERROR(DataStorage, "Export clip %s for request %s failed.",
+                             request.clip_id.c_str(), request.request_id.c_str());
+                }
+                return true;
+            });
+            continue;
+        }
+
+        if (trigger_queue_.empty()) {
+            lock.unlock();
+            if (clip_archive_ &&
+                common::GetCurrentTimestamp() - last_housekeeping_timestamp_ >= kHousekeepingIntervalUs) {
+                housekeeping();
+            }
+            continue;
+        }
+
         auto ctx = trigger_queue_.front();
         trigger_queue_.pop();
+        const size_t queue_depth = trigger_queue_.size();
 
         AD_INFO(DataStorage, "Processed trigger - ID: %s, Timestamp: %lld",
                 ctx.triggerId.c_str(),
                 ctx.triggerTimestamp);
         lock.unlock();
-        handle_trigger(ctx);
+        auto strategy = find_strategy(ctx.triggerId);
+        if (!strategy) {
+            AD_WARN(DataStorage, "No strategy for trigger %s.", ctx.triggerId.c_str());
+            continue;
+        }
+        if (!acquire_strategy(*strategy)) {
+            continue;
+        }
+        // 片段采集要等待后向窗口，交给调度器，不同策略的片段互不阻塞；
+        // job名按triggerId取，指标标签的取值有限
+        auto job = std::make_shared<ClipJob>();
+        job->trigger = ctx;
+        job->strategy = strategy;
+        job->queue_depth = queue_depth;
+        clip_scheduler_->ScheduleOnce("clip/" + strategy->trigger.triggerId, strategy->trigger.priority,
+                                      std::chrono::milliseconds(0), [this, job](const std::atomic<bool>& preempted) {
+            return run_clip(*job, preempted);
+        });
     }
 
     return true;
@@ -190,21 +548,36 @@ bool DataStorage::Start() {
 
 bool DataStorage::Stop() {
     AD_INFO(DataStorage, "Stop.");
+    stop_ = true;
+    if (clip_channel_) {
+        clip_channel_->Stop();
+    }
     cv_.notify_all();
 
     return true;
 }
 
+DataStorage::~DataStorage()
+{
+    // 先等在途片段和导出结束，它们还在使用下面的成员
+    clip_scheduler_.reset();
+    export_scheduler_.reset();
+    // 录制退出后不再记录信号历史
+    if (signal_slots_) {
+        signal_slots_->setTap(nullptr);
+    }
+}
+
 bool DataStorage::check_disk_space()
 {
 
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
     unsigned long long total, freeSpaceBytes;
     if (!disk_space_checker_->getDiskSpace(data_path_, total, freeSpaceBytes)) {
         throw std::runtime_error("Failed to get disk space");
     }
     const uint64_t freeSpaceMb = freeSpaceBytes / (1024 * 1024);
-    return freeSpaceMb >= static_cast<uint64_t>(appconfig.dataStorage.requriedSpaceMb);
+    return freeSpaceMb >= static_cast<uint64_t>(appconfig->dataStorage.requriedSpaceMb);
 }
 
 bool DataStorage::compress_files(const std::vector<std::string>& inputFilePaths, const std::string& outputFilePath) {
@@ -229,6 +602,7 @@ bool DataStorage::compress_files(const std::vector<std::string>& inputFilePaths,
     if (ret == FileCompress::ErrorCode::Success) {
         AD_INFO(DataStorage,"compressFiles success, outputFilePath: %s", outputFilePath.c_str());
         common::DeleteFiles(inputFilePaths);
+        std::lock_guard<std::mutex> lock(roll_mutex_);
         file_roller_->rollFiles();
     }
 
@@ -11,14 +11,22 @@
 #include <memory>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <unordered_map>
 #include "nlohmann/json.hpp"
 
 #include "../msg/ad_trigger/dcp_trigger.h"
+#include "trigger/common/condition_program.h"
+#include "trigger/priority_scheduler/timer_wheel_scheduler.h"
 #include "ros2bag_recorder.h"
 #include "common/config/app_config.h"
 #include "diskspace_checker.hpp"
 #include "file_roller.h"
 #include "file_compress.h"
+#include "uploader/stream_uploader.h"
+#include "uploader/clip_summary_channel.h"
+#include "clip_archive.h"
+#include "common/metrics/metrics_recorder.h"
 
 namespace dcp::recorder {
 
@@ -31,7 +39,7 @@ struct Point
 class DataStorage {
 public:
     DataStorage() = default;
-    ~DataStorage() = default;
+    ~DataStorage();
 
     bool Init(const std::shared_ptr<rclcpp::Node>& node,
               const trigger::StrategyConfig& strategy_config);
@@ -42,6 +50,12 @@ public:
 
     void AddTrigger(const trigger::TriggerContext& context);
 
+    // 策略热更新：切换生效的策略集合并增量调整共享缓冲区，未变化topic的缓存数据保留
+    bool UpdateStrategy(const trigger::StrategyConfig& strategy_config);
+
+    // 两阶段上传时记录信号槽位的写入历史，用于生成片段摘要中的信号统计；需在Init之后调用
+    void SetSignalSource(const std::shared_ptr<trigger::SignalSlots>& slots);
+
     // void StoreData(const Point& data);
 
 private:
@@ -49,12 +63,60 @@ private:
 
     bool compress_files(const std::vector<std::string>& inputFilePaths, const std::string& outputFilePath);
 
+    // 所有enabled策略同时生效，按triggerId查找；未匹配的触发（如规划触发）使用fallback
+    struct ActiveStrategies {
+        std::vector<std::shared_ptr<const trigger::Strategy>> list;
+        std::unordered_map<std::string, std::shared_ptr<const trigger::Strategy>> by_id;
+        std::shared_ptr<const trigger::Strategy> fallback;
+    };
+
+    static std::shared_ptr<const ActiveStrategies> make_strategies(const trigger::StrategyConfig& strategy_config);
+
+    std::shared_ptr<const trigger::Strategy> find_strategy(const std::string& trigger_id) const;
+
+    // 同一策略同时只采集一个片段，结束后经过冷却时间才接受新的触发
+    bool acquire_strategy(const trigger::Strategy& strategy);
+
+    void release_strategy(const trigger::Strategy& strategy);
+
     bool save_json(std::string& output_json_filename,
-                             const trigger::TriggerContext& current_trigger);
+                             const trigger::TriggerContext& current_trigger,
+                             const trigger::Strategy& strategy);
+
+    // 一个片段的处理过程：采集完成后是让出点，被更高优先级的片段抢占时后处理稍后继续
+    struct ClipJob {
+        trigger::TriggerContext trigger;
+        std::shared_ptr<const trigger::Strategy> strategy;
+        size_t queue_depth = 0;
+        uint64_t handle_start = 0;
+        bool captured = false;
+        bool ok = false;
+        std::string filepath;
+        std::string base_filename; // 去掉.recording后缀，打包和上传文件名以此为前缀
+        uploader::StreamUploader* stream = nullptr;
+        TBagInfo bag_info;
+    };
+
+    // 调度器中执行，返回false表示让出，之后继续
+    bool run_clip(ClipJob& job, const std::atomic<bool>& preempted);
+
+    bool capture_clip(ClipJob& job);
+
+    void finish_clip(ClipJob& job);
+
+    bool handle_clip(const trigger::TriggerContext& trigger, const std::string& bag_path,
+                     const trigger::Strategy& strategy, const TBagInfo& bag_info);
 
-    bool handle_trigger(const trigger::TriggerContext& trigger);
+    void handle_request(const common::ClipRequest& request);
 
+    void housekeeping();
 
+    // 信号写入历史，由SignalSlots的写入回调填充；回调持有shared_ptr，不依赖DataStorage的生命周期
+    struct SignalHistory {
+        std::mutex mutex;
+        std::unordered_map<uint32_t, std::deque<std::pair<int64_t, double>>> samples; // 槽位 -> {单调时钟时刻, 值}
+        void Record(uint32_t slot, double value, int64_t stampUs);
+    };
 
 private:
     std::shared_ptr<rclcpp::Node> node_;
@@ -62,11 +124,26 @@ private:
     std::string data_path_;
     std::shared_ptr<DiskSpaceChecker> disk_space_checker_;
     std::unique_ptr<FileRoller> file_roller_;
-    std::shared_ptr<trigger::Strategy> strategy_;
+    std::shared_ptr<const ActiveStrategies> strategies_; // 只通过std::atomic_load/atomic_store访问
 
     std::shared_ptr<Ros2BagRecorder> ros2bag_recorder_;
+    std::unique_ptr<uploader::StreamUploader> stream_uploader_;
+    std::atomic<bool> stream_busy_{false}; // 流式上传同时只服务一个片段，其余走常规上传
+    std::unique_ptr<trigger::TimerWheelScheduler> clip_scheduler_; // 不同策略的片段并行采集
+    std::unique_ptr<trigger::TimerWheelScheduler> export_scheduler_; // 云端请求的导出逐个执行，不占片段采集的名额
+    std::unique_ptr<ClipArchive> clip_archive_;
+    std::unique_ptr<uploader::ClipSummaryChannel> clip_channel_;
     std::queue<trigger::TriggerContext> trigger_queue_;
-    uint64_t last_trigger_timestamp_ = 0;
+    std::queue<common::ClipRequest> request_queue_;
+    std::shared_ptr<trigger::SignalSlots> signal_slots_;
+    std::shared_ptr<SignalHistory> signal_history_;
+    uint64_t last_housekeeping_timestamp_ = 0;
+    std::unordered_map<std::string, uint64_t> last_finish_timestamps_;
+    std::unordered_map<std::string, int8_t> capturing_strategies_; // triggerId -> 优先级
+    std::mutex strategy_state_mutex_;
+    std::mutex roll_mutex_;    // 文件滚动扫描目录并删除最老的文件，同时只做一次
+    std::mutex publish_mutex_; // ClipSummaryChannel按需重连，发布逐个进行
+    common::MetricSeries* trigger_metrics_ = nullptr;
     std::mutex trigger_mutex_;
     std::condition_variable cv_;
     std::atomic<bool> stop_{false};
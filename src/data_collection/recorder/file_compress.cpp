@@ -5,6 +5,8 @@
 #include <cstdio>
 #include <filesystem>
 #include "microtar/microtar.h"
+#include "common/metrics/metrics_registry.h"
+#include "common/metrics/span_tracer.h"
 
 namespace fs = std::filesystem;
 
@@ -14,6 +16,7 @@ namespace dcp::recorder {
 FileCompress::ErrorCode FileCompress::CompressFiles(
     const std::vector<std::string>& inputFiles,
     const std::string& outputFile) {
+    common::TraceSpan trace_span("compress", outputFile);
     std::vector<std::string> allFiles;
 
     for (const auto& path : inputFiles) {
@@ -129,12 +132,17 @@ FileCompress::ErrorCode FileCompress::CompressSingleFileToLz4(
 
 
 FileCompress::ErrorCode FileCompress::CompressData(const std::vector<char>& input, std::vector<char>& compressedData) {
+    static const auto& stage = common::MetricsRegistry::getInstance().GetStage("compress");
+    common::ScopedLatency latency(stage.duration);
+    stage.total->Add();
+    stage.bytes->Add(input.size());
     size_t srcSize = input.size();
 
     LZ4F_cctx* cctx;
     size_t err = LZ4F_createCompressionContext(&cctx, LZ4F_VERSION);
     if (LZ4F_isError(err)) {
         std::cerr << "LZ4F_createCompressionContext error: " << LZ4F_getErrorName(err) << std::endl;
+        stage.errors->Add();
         return ErrorCode::CompressionFailed;
     }
 
@@ -155,6 +163,7 @@ FileCompress::ErrorCode FileCompress::CompressData(const std::vector<char>& inpu
     if (LZ4F_isError(compressedSize)) {
         std::cerr << "LZ4F_compressFrame error: " << LZ4F_getErrorName(compressedSize) << std::endl;
         LZ4F_freeCompressionContext(cctx);
+        stage.errors->Add();
         return ErrorCode::CompressionFailed;
     }
 
@@ -14,9 +14,9 @@ namespace dcp::recorder {
 namespace fs = std::filesystem;
 
 FileRoller::FileRoller(){
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
-    auto it  = appconfig.dataStorage.storagePaths.find("bagPath");
-    if (it != appconfig.dataStorage.storagePaths.end()) {
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
+    auto it  = appconfig->dataStorage.storagePaths.find("bagPath");
+    if (it != appconfig->dataStorage.storagePaths.end()) {
         bagPath = it->second;
     }
     bagPath = bagPath.empty() ? "./data" : bagPath;
@@ -30,7 +30,7 @@ FileRoller::FileRoller(){
 }
 
 std::vector<std::string> FileRoller::getSortedCompressedFiles() const {
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
     std::vector<std::string> files;
 
     try {
@@ -39,7 +39,7 @@ std::vector<std::string> FileRoller::getSortedCompressedFiles() const {
             return files;
         }
 
-        std::string pattern = appconfig.dataUpload.filenameRegex;
+        std::string pattern = appconfig->dataUpload.filenameRegex;
         for (const auto& entry : fs::directory_iterator(bagPath)) {
             if (entry.is_regular_file()) {
                 const std::string filename = entry.path().filename().string();
@@ -60,24 +60,28 @@ std::vector<std::string> FileRoller::getSortedCompressedFiles() const {
 }
 
 int FileRoller::rollFiles() {
-    auto appconfig = common::AppConfig::getInstance().GetConfig();
+    const auto appconfig = common::AppConfig::getInstance().Snapshot();
     auto files = getSortedCompressedFiles();
     int deletedCount = 0;
 
     std::cout << "files to delete count = " << files.size() <<std::endl;
 
     // 如果文件数量超过阈值，删除最早的文件
-    while (files.size() > appconfig.dataStorage.rollingDeleteThreshold) {
+    while (files.size() > appconfig->dataStorage.rollingDeleteThreshold) {
         try {
             const std::string& oldestFile = files.front();
             if (fs::remove(oldestFile)) {
                 std::cout << "Deleted old file: " << oldestFile << std::endl;
                 fs::path oldestFile_path(oldestFile);
-                std::string encFile = appconfig.dataStorage.storagePaths["encPath"] + "/" + oldestFile_path.filename().string() + ".enc";
+                std::string encFile = appconfig->dataStorage.storagePaths.at("encPath") + "/" + oldestFile_path.filename().string() + ".enc";
                 std::cout << "Deleted old enc file: " << encFile << std::endl;
                 if(fs::exists(encFile)){
                     fs::remove(encFile);
                 }
+                std::string streamedMarker = oldestFile + ".streamed";
+                if(fs::exists(streamedMarker)){
+                    fs::remove(streamedMarker);
+                }
                 deletedCount++;
             } else {
                 std::cerr << "Failed to delete file: " << oldestFile << std::endl;
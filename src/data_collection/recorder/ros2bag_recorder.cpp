@@ -9,10 +9,17 @@
 #include <sstream>
 #include <chrono>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
 
 #include "rosbag2_cpp/writers/sequential_writer.hpp"
 #include "rosbag2_storage/serialized_bag_message.hpp"
 #include "rcutils/error_handling.h"
+#include "channel/topic_profiler.h"
+#include "common/memory/message_pool.h"
+#include "common/metrics/metrics_registry.h"
+#include "common/metrics/span_tracer.h"
 #include "common/utils/utils.h"
 
 namespace dcp::recorder {
@@ -47,36 +54,86 @@ bool Ros2BagRecorder::Init() {
   return true;
 }
 
-
-bool Ros2BagRecorder::InitRingBuffers() {
-  for (const auto& channel : strategy_->dds.channels) {
-    const std::string& topic = channel.topic;
-    if (channel.originalFrameRate <=0 || channel.capturedFrameRate <=0)
-    {
+bool Ros2BagRecorder::SetStrategies(const std::vector<std::shared_ptr<const trigger::Strategy>>& strategies) {
+  for (const auto& strategy : strategies) {
+    if (!strategy) {
       return false;
     }
-    trigger::CacheMode cache_mode_ = strategy_->mode.cacheMode;
+    for (const auto& channel : strategy->dds.channels) {
+      if (channel.originalFrameRate <= 0 || channel.capturedFrameRate <= 0) {
+        RCLCPP_ERROR(node_->get_logger(), "Invalid frame rate for topic: %s", channel.topic.c_str());
+        return false;
+      }
+    }
+  }
 
-    int32_t forward_size = cache_mode_.forwardCaptureDurationSec * channel.capturedFrameRate;
-    int32_t backward_size = cache_mode_.backwardCaptureDurationSec * channel.capturedFrameRate;
+  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  if (!captures_.empty()) {
+    // 正在采集的片段仍按旧的缓冲区取数据，全部结束后再切换
+    pending_strategies_ = strategies;
+    has_pending_strategies_ = true;
+    RCLCPP_INFO(node_->get_logger(), "Capture in progress, strategy change deferred");
+    return true;
+  }
+  apply_strategies(strategies);
+  return true;
+}
 
-    auto forward_buf = std::make_unique<BufferType>(forward_size);
-    if (!forward_buf) {
-      RCLCPP_ERROR(node_->get_logger(), "Create forward buffer failed for topic: %s", topic.c_str());
-      return false;
+void Ros2BagRecorder::apply_strategies(const std::vector<std::shared_ptr<const trigger::Strategy>>& strategies) {
+  // 每个topic只有一个缓冲区，按录制它的所有策略中最长的前向+后向窗口保留
+  struct Requirement {
+    uint64_t retention_us = 0;
+    size_t capacity = 1;
+  };
+  std::unordered_map<std::string, Requirement> requirements;
+  for (const auto& strategy : strategies) {
+    const trigger::CacheMode& cache_mode = strategy->mode.cacheMode;
+    const int window_sec = std::max(cache_mode.forwardCaptureDurationSec + cache_mode.backwardCaptureDurationSec, 0);
+    for (const auto& channel : strategy->dds.channels) {
+      auto& requirement = requirements[channel.topic];
+      requirement.retention_us = std::max<uint64_t>(requirement.retention_us, window_sec * 1000000ULL);
+      requirement.capacity = std::max<size_t>(requirement.capacity, window_sec * channel.capturedFrameRate);
+      if (auto_size_) {
+        // 声明的帧率与实际不符时以实测峰值为准，topic尚未收到数据时为0
+        const double measured = channel::TopicProfiler::getInstance().MeasuredRate(channel.topic);
+        requirement.capacity = std::max<size_t>(
+            requirement.capacity, static_cast<size_t>(std::ceil(window_sec * measured * rate_headroom_)));
+      }
     }
+  }
 
-    auto backward_buf = std::make_unique<BufferType>(backward_size);
-    if (!backward_buf) {
-      RCLCPP_ERROR(node_->get_logger(), "Create backward buffer failed for topic: %s", topic.c_str());
-      return false;
+  size_t kept = 0;
+  size_t total_capacity = 0;
+  for (const auto& [topic, requirement] : requirements) {
+    total_capacity += requirement.capacity;
+    auto it = topic_buffers_.find(topic);
+    if (it != topic_buffers_.end()) {
+      // 保留已缓存的数据，只调整容量
+      it->second.buffer->set_capacity(requirement.capacity);
+      it->second.retention_us = requirement.retention_us;
+      ++kept;
+      continue;
     }
+    auto& topic_buffer = topic_buffers_[topic];
+    topic_buffer.buffer = std::make_unique<BufferType>(requirement.capacity);
+    topic_buffer.retention_us = requirement.retention_us;
+    RCLCPP_INFO(node_->get_logger(), "Init buffer for topic: %s, size: %zu, retention: %llums",
+                topic.c_str(), requirement.capacity,
+                static_cast<unsigned long long>(requirement.retention_us / 1000));
+  }
 
-    forward_ringbuffers_[topic] = std::move(forward_buf);
-    backward_ringbuffers_[topic] = std::move(backward_buf);
-    RCLCPP_INFO(node_->get_logger(), "Init buffer for topic: %s, forward size: %d, backward size: %d", topic.c_str(), forward_size, backward_size);
+  for (auto it = topic_buffers_.begin(); it != topic_buffers_.end();) {
+    if (requirements.count(it->first) == 0) {
+      RCLCPP_INFO(node_->get_logger(), "Release buffer for topic: %s", it->first.c_str());
+      it = topic_buffers_.erase(it);
+    } else {
+      ++it;
+    }
   }
-  return true;
+
+  strategies_ = strategies;
+  RCLCPP_INFO(node_->get_logger(), "%zu strategies applied, %zu topics, %zu buffers kept, %zu messages max",
+              strategies.size(), requirements.size(), kept, total_capacity);
 }
 
 bool Ros2BagRecorder::Open(OptMode opt_mode, const std::string& full_path) {
@@ -115,6 +172,8 @@ bool Ros2BagRecorder::Open(OptMode opt_mode, const std::string& full_path) {
       writer_ = std::make_unique<rosbag2_cpp::Writer>(std::make_unique<rosbag2_cpp::writers::SequentialWriter>());
       writer_->open(storage_options, converter_options);
 
+      // 统计按包独立计数，片段摘要依赖此处的per-topic统计
+      bag_info_ = TBagInfo{};
       bag_info_.bag_path = full_path;
       bag_info_.is_opened = true;
       bag_info_.mode = OptMode::WRITE;
@@ -257,121 +316,165 @@ bool Ros2BagRecorder::Close() {
 
 bool Ros2BagRecorder::HasDataWritten() const { return has_data_written_; }
 
-bool Ros2BagRecorder::TriggerRecord(uint64_t trigger_timestamp,
-                                    const std::string& output_file_path) {
-  // if (!is_opened_) {
-  //   RCLCPP_ERROR(node_->get_logger(), "Cannot trigger: bag not open");
-  //   return false;
-  // }
+bool Ros2BagRecorder::TriggerRecord(const std::shared_ptr<const trigger::Strategy>& strategy,
+                                    uint64_t trigger_timestamp,
+                                    const std::string& output_file_path,
+                                    const std::function<uploader::StreamUploader*()>& open_stream,
+                                    TBagInfo* bag_info) {
+  if (!strategy) {
+    RCLCPP_ERROR(node_->get_logger(), "Trigger ignored: no strategy");
+    return false;
+  }
+  const trigger::CacheMode& cache_mode = strategy->mode.cacheMode;
+  const uint64_t forward_duration_us = cache_mode.forwardCaptureDurationSec * 1000000ULL;
+  const uint64_t backward_duration_us = cache_mode.backwardCaptureDurationSec * 1000000ULL;
+
+  Capture capture;
+  capture.strategy = strategy;
+  capture.trigger_timestamp = trigger_timestamp;
+  capture.end_timestamp = trigger_timestamp + backward_duration_us;
+  RCLCPP_INFO(node_->get_logger(), "Triggered %s at %llu, backward duration: %ds",
+              strategy->trigger.triggerId.c_str(), static_cast<unsigned long long>(trigger_timestamp),
+              cache_mode.backwardCaptureDurationSec);
 
-  if (is_triggered_) {
-    RCLCPP_WARN(node_->get_logger(), "Trigger ignored: bag already triggered");
-    return false; //TODO
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    // 前向数据只持有共享消息的引用，不拷贝
+    for (const auto& channel : strategy->dds.channels) {
+      auto& view = capture.messages[channel.topic];
+      auto it = topic_buffers_.find(channel.topic);
+      if (it == topic_buffers_.end()) {
+        continue;
+      }
+      for (const auto& data : *it->second.buffer) {
+        if (data.timestamp <= trigger_timestamp && (trigger_timestamp - data.timestamp) <= forward_duration_us) {
+          view.push_back(data);
+        }
+      }
+    }
+    captures_.push_back(&capture);
   }
+  const auto backward_end = std::chrono::steady_clock::now() +
+                            std::chrono::seconds(cache_mode.backwardCaptureDurationSec);
 
-  is_triggered_ = true;
-  trigger_timestamp_ = trigger_timestamp;
-  RCLCPP_INFO(node_->get_logger(), "Triggered at %llu, backward duration: %ds", trigger_timestamp_, cache_mode_.backwardCaptureDurationSec);
+  // 前向窗口已固定，再申请流式会话：申请地址的网络往返不推迟后向窗口的开始
+  uploader::StreamUploader* stream = open_stream ? open_stream() : nullptr;
+  if (stream && stream->IsOpened()) {
+    std::vector<std::pair<std::string, TimestampedData>> backlog;
+    {
+      std::lock_guard<std::mutex> lock(buffer_mutex_);
+      // 此后到达的后向消息由OnMessageReceived实时追加，此前已进入缓冲区的在下面补发
+      capture.stream = stream;
+      for (const auto& [topic, view] : capture.messages) {
+        auto it = topic_buffers_.find(topic);
+        if (it == topic_buffers_.end()) {
+          continue;
+        }
+        for (const auto& data : *it->second.buffer) {
+          if (data.timestamp > trigger_timestamp && data.timestamp <= capture.end_timestamp) {
+            backlog.emplace_back(topic, data);
+          }
+        }
+      }
+    }
+    // 补发只读共享消息，不持有缓冲区锁，与实时追加的记录可能交错
+    for (const auto& [topic, view] : capture.messages) {
+      for (const auto& data : view) {
+        auto& rcl_msg = data.msg->get_rcl_serialized_message();
+        stream->Append(uploader::StreamUploader::RecordKind::Message, topic, data.timestamp,
+                       rcl_msg.buffer, rcl_msg.buffer_length);
+      }
+    }
+    for (const auto& [topic, data] : backlog) {
+      auto& rcl_msg = data.msg->get_rcl_serialized_message();
+      stream->Append(uploader::StreamUploader::RecordKind::Message, topic, data.timestamp,
+                     rcl_msg.buffer, rcl_msg.buffer_length);
+    }
+    stream->Flush();
+  }
 
   {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    uint64_t forward_duration_us = cache_mode_.forwardCaptureDurationSec * 1000000ULL;
-    forward_capture_duration_us_ = forward_duration_us;
-
-    for (const auto& pair : forward_ringbuffers_) {
-      const std::string& topic = pair.first;
-      const auto& buffer = pair.second;
-
-      std::vector<TimestampedData> saved_data;
-      for (const auto& data : *buffer) {
-        if (data.timestamp <= trigger_timestamp_ &&
-            (trigger_timestamp_ - data.timestamp) <= forward_duration_us) {
-          saved_data.push_back(data);
-            }
+    common::TraceSpan capture_span("backward_capture", output_file_path);
+    if (capture.stream) {
+      auto interval = std::chrono::milliseconds(std::max(stream->SegmentIntervalMs(), 100));
+      while (std::chrono::steady_clock::now() < backward_end) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            interval, backward_end - std::chrono::steady_clock::now()));
+        capture.stream->Flush();
       }
-      triggered_forward_buffers_[topic] = std::move(saved_data);
+    } else {
+      std::this_thread::sleep_until(backward_end);
     }
   }
 
-  std::this_thread::sleep_for(std::chrono::seconds(cache_mode_.backwardCaptureDurationSec));
   {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
-    write_ringbuffer(output_file_path);
-    triggered_forward_buffers_.clear();
+    // 后向数据同样取自共享缓冲区，其保留时长覆盖所有策略的前向+后向窗口
+    for (auto& [topic, view] : capture.messages) {
+      auto it = topic_buffers_.find(topic);
+      if (it == topic_buffers_.end()) {
+        continue;
+      }
+      for (const auto& data : *it->second.buffer) {
+        if (data.timestamp > trigger_timestamp && data.timestamp <= capture.end_timestamp) {
+          view.push_back(data);
+        }
+      }
+    }
+    captures_.erase(std::remove(captures_.begin(), captures_.end(), &capture), captures_.end());
+    if (captures_.empty() && has_pending_strategies_) {
+      apply_strategies(pending_strategies_);
+      pending_strategies_.clear();
+      has_pending_strategies_ = false;
+    }
+  }
+  if (capture.stream) {
+    // 等锁外正在进行的追加完成，之后才能结束会话
+    while (stream_appends_.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+    capture.stream = nullptr;
   }
-  is_triggered_ = false;
-  forward_capture_duration_us_ = 0;
 
+  return write_clip(capture, output_file_path, bag_info);
 }
 
-bool Ros2BagRecorder::write_ringbuffer(const std::string& outputfilePath) {
+bool Ros2BagRecorder::write_clip(const Capture& capture, const std::string& outputfilePath,
+                                 TBagInfo* bag_info) {
+    // writer_和bag_info_为所有片段共用，逐个写出
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // 与上一个backward_capture之间的空隙即等待其它片段写盘的时间
+    common::TraceSpan trace_span("bag_write", outputfilePath);
+    static const auto& stage = common::MetricsRegistry::getInstance().GetStage("recorder");
+    common::ScopedLatency latency(stage.duration);
     uint64_t min_timestamp = UINT64_MAX;
     uint64_t max_timestamp = 0;
 
     if (!Open(OptMode::WRITE, outputfilePath)) {
       RCLCPP_ERROR(node_->get_logger(), "Failed to open bag:   %s", outputfilePath.c_str());
+      stage.errors->Add();
       return false;
     }
 
-    uint64_t start_time = trigger_timestamp_ - (cache_mode_.forwardCaptureDurationSec * 1e9);
-    uint64_t end_time = trigger_timestamp_ + (cache_mode_.backwardCaptureDurationSec * 1e9);
-
-    for (const auto& channel : strategy_->dds.channels) {
+    for (const auto& channel : capture.strategy->dds.channels) {
         const std::string& topic = channel.topic;
-        auto forward_it = triggered_forward_buffers_.find(topic);
-        auto backward_it = backward_ringbuffers_.find(topic);
-        auto current_forward_it = forward_ringbuffers_.find(topic);
-
-        if (forward_it == triggered_forward_buffers_.end() && backward_it == backward_ringbuffers_.end()) {
-          RCLCPP_WARN(node_->get_logger(), "No buffer found for topic: %s", topic.c_str());
+        auto view_it = capture.messages.find(topic);
+        if (view_it == capture.messages.end() || view_it->second.empty()) {
+          RCLCPP_WARN(node_->get_logger(), "No data captured for topic: %s", topic.c_str());
           continue;
         }
 
         size_t forward_count = 0;
         size_t backward_count = 0;
-
-        std::unordered_set<uint64_t> written_timestamps;
-        if (forward_it != triggered_forward_buffers_.end()) {
-          for (const auto& data : forward_it->second) {
-            auto& rcl_msg = data.msg.get_rcl_serialized_message();
-            if (data.timestamp <= trigger_timestamp_ && data.timestamp >= start_time) {
-              min_timestamp = std::min(min_timestamp, data.timestamp);
-              max_timestamp = std::max(max_timestamp, data.timestamp);
-              Write(topic, data.timestamp, rcl_msg.buffer, rcl_msg.buffer_length);
-              written_timestamps.insert(data.timestamp);
-              forward_count++;
-            }
-          }
-        }
-
-        // 处理当前前向缓冲区中的数据
-        if (current_forward_it != forward_ringbuffers_.end() && forward_it != triggered_forward_buffers_.end()) {
-          const auto& current_buffer = current_forward_it->second;
-          for (const auto& data : *current_buffer) {
-            auto& rcl_msg = data.msg.get_rcl_serialized_message();
-            if (data.timestamp <= trigger_timestamp_ && data.timestamp >= start_time) {
-              if (written_timestamps.find(data.timestamp) == written_timestamps.end()) {
-                min_timestamp = std::min(min_timestamp, data.timestamp);
-                max_timestamp = std::max(max_timestamp, data.timestamp);
-                Write(topic, data.timestamp, rcl_msg.buffer, rcl_msg.buffer_length);
-                written_timestamps.insert(data.timestamp);
-                forward_count++;
-              }
-            }
-          }
-        }
-
-        // 写入后向数据
-        if (backward_it != backward_ringbuffers_.end()) {
-          auto& backward_buf = backward_it->second;
-          for (const auto& data : *backward_buf) {
-            auto& rcl_msg = data.msg.get_rcl_serialized_message();
-            if (data.timestamp > trigger_timestamp_ && data.timestamp <= end_time) {
-              min_timestamp = std::min(min_timestamp, data.timestamp);
-              max_timestamp = std::max(max_timestamp, data.timestamp);
-              Write(topic, data.timestamp, rcl_msg.buffer, rcl_msg.buffer_length);
-              backward_count++;
-            }
+        for (const auto& data : view_it->second) {
+          auto& rcl_msg = data.msg->get_rcl_serialized_message();
+          min_timestamp = std::min(min_timestamp, data.timestamp);
+          max_timestamp = std::max(max_timestamp, data.timestamp);
+          Write(topic, data.timestamp, rcl_msg.buffer, rcl_msg.buffer_length);
+          if (data.timestamp <= capture.trigger_timestamp) {
+            forward_count++;
+          } else {
+            backward_count++;
           }
         }
 
@@ -379,10 +482,15 @@ bool Ros2BagRecorder::write_ringbuffer(const std::string& outputfilePath) {
                  topic.c_str(), forward_count, backward_count);
     }
 
-    double duration_seconds = (max_timestamp - min_timestamp) / 1e6;
+    double duration_seconds = max_timestamp > min_timestamp ? (max_timestamp - min_timestamp) / 1e6 : 0.0;
     RCLCPP_INFO(node_->get_logger(), "Total recording duration: %.3f seconds", duration_seconds);
 
     Close();
+    if (bag_info) {
+      *bag_info = bag_info_;
+    }
+    stage.total->Add();
+    stage.bytes->Add(bag_info_.total_data_size);
     RCLCPP_INFO(node_->get_logger(), "Wrote all topics to file: %s", outputfilePath.c_str());
     return true;
 }
@@ -396,32 +504,82 @@ bool Ros2BagRecorder::SetMaxBagSize(size_t max_size_mb) {
   return true;
 }
 
+void Ros2BagRecorder::SetAutoSize(bool enabled, double headroom) {
+  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  auto_size_ = enabled;
+  rate_headroom_ = std::max(headroom, 1.0);
+}
+
+void Ros2BagRecorder::grow_buffer(const std::string& topic, TopicBuffer& topic_buffer, uint64_t now_us) {
+  // 已满但最早的消息仍在保留窗口内，说明容量小于实际频率，继续写入会截断片段
+  if (now_us - topic_buffer.last_grow_us < kGrowIntervalUs) {
+    return;
+  }
+  topic_buffer.last_grow_us = now_us;
+  auto& buffer = *topic_buffer.buffer;
+  const size_t current = buffer.capacity();
+  const double measured = channel::TopicProfiler::getInstance().MeasuredRate(topic);
+  size_t target = static_cast<size_t>(std::ceil(topic_buffer.retention_us / 1e6 * measured * rate_headroom_));
+  if (target <= current) {
+    // 尚无实测数据，或突发超过了近期峰值
+    target = current * 2;
+  }
+  buffer.set_capacity(target);
+  RCLCPP_WARN(node_->get_logger(), "Buffer for topic %s full within %llums, capacity %zu -> %zu (measured %.1fHz)",
+              topic.c_str(), static_cast<unsigned long long>(topic_buffer.retention_us / 1000), current, target,
+              measured);
+}
+
 TBagInfo Ros2BagRecorder::GetStatistics() const {
   return GetBagInfo();
 }
 
 void Ros2BagRecorder::OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg) {
-  // if (msg) return;
   uint64_t message_timestamp = common::GetCurrentTimestamp();
-  // LOG_INFO("Received message on topic: %s, timestamp: %llu", topic.c_str(), message_timestamp);
 
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
-  if (forward_ringbuffers_.count(topic)) {
-    uint64_t forward_duration_us = cache_mode_.forwardCaptureDurationSec * 1000000ULL;
-    while (!forward_ringbuffers_[topic]->empty() &&
-           (message_timestamp - forward_ringbuffers_[topic]->front().timestamp) > forward_duration_us) {
-      forward_ringbuffers_[topic]->pop_front();
-           }
-    forward_ringbuffers_[topic]->push_back(TimestampedData{msg, message_timestamp});
-  }
-
-  if (is_triggered_ && backward_ringbuffers_.count(topic)) {
-    uint64_t backward_duration_us = cache_mode_.backwardCaptureDurationSec * 1000000ULL;
-    if ((message_timestamp - trigger_timestamp_) <= backward_duration_us) {
-      backward_ringbuffers_[topic]->push_back(TimestampedData{msg, static_cast<uint64_t>(message_timestamp)});
+  // 每条消息只拷贝一次，各策略的片段共享同一份数据；拷贝从内存池分配。
+  // 分配和拷贝在锁外进行，相机等大消息不阻塞其他topic的回调
+  const auto& src = msg.get_rcl_serialized_message();
+  auto copy = std::make_shared<rclcpp::SerializedMessage>(src.buffer_length,
+                                                          common::MessagePool::getInstance().Allocator());
+  auto& dst = copy->get_rcl_serialized_message();
+  std::memcpy(dst.buffer, src.buffer, src.buffer_length);
+  dst.buffer_length = src.buffer_length;
+  TimestampedData data{std::move(copy), message_timestamp};
+
+  uploader::StreamUploader* stream = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    auto it = topic_buffers_.find(topic);
+    if (it == topic_buffers_.end()) {
+      return;
+    }
+    auto& buffer = *it->second.buffer;
+    while (!buffer.empty() && (message_timestamp - buffer.front().timestamp) > it->second.retention_us) {
+      buffer.pop_front();
+    }
+    if (auto_size_ && buffer.size() >= buffer.capacity()) {
+      grow_buffer(topic, it->second, message_timestamp);
+    }
+    buffer.push_back(data);
+
+    // 流式会话同时只有一个；是否追加在锁内决定，与TriggerRecord补发的消息不重不漏
+    for (Capture* capture : captures_) {
+      if (capture->stream && message_timestamp > capture->trigger_timestamp &&
+          message_timestamp <= capture->end_timestamp && capture->messages.count(topic) != 0) {
+        stream = capture->stream;
+        stream_appends_.fetch_add(1, std::memory_order_acquire);
+        break;
+      }
     }
   }
 
+  if (stream) {
+    auto& rcl_msg = data.msg->get_rcl_serialized_message();
+    stream->Append(uploader::StreamUploader::RecordKind::Message, topic, message_timestamp,
+                   rcl_msg.buffer, rcl_msg.buffer_length);
+    stream_appends_.fetch_sub(1, std::memory_order_release);
+  }
 }
 
 
@@ -438,12 +596,21 @@ void Ros2BagRecorder::update_statistics(const std::string& topic_name,
   bag_info_.end_timestamp = timestamp;
 
   // Update per-topic statistics
-  if (topics_metadata_.find(topic_name) != topics_metadata_.end()) {
-    topics_metadata_[topic_name].message_count++;
-    topics_metadata_[topic_name].last_timestamp = timestamp;
-    topics_metadata_[topic_name].data_size += data_size;
-    bag_info_.topics[topic_name] = topics_metadata_[topic_name];
+  auto it = topics_metadata_.find(topic_name);
+  if (it != topics_metadata_.end()) {
+    it->second.message_count++;
+    it->second.last_timestamp = timestamp;
+    it->second.data_size += data_size;
+  }
+  auto& stat = bag_info_.topics[topic_name];
+  if (stat.topic_name.empty()) {
+    stat.topic_name = topic_name;
+    stat.message_type = it != topics_metadata_.end() ? it->second.message_type : "";
+    bag_info_.num_topics = bag_info_.topics.size();
   }
+  stat.message_count++;
+  stat.last_timestamp = timestamp;
+  stat.data_size += data_size;
 
   // Log statistics periodically
   auto now = std::chrono::steady_clock::now();
@@ -5,9 +5,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +22,7 @@
 #include "channel/observer.h"
 #include "common/ringBuffer.h"
 #include "trigger/strategy_parser/strategy_config.h"
+#include "uploader/stream_uploader.h"
 
 namespace dcp::recorder {
 
@@ -125,10 +130,18 @@ class Ros2BagRecorder : public channel::Observer {  // 继承自Observer
   bool Init();
 
   /**
-   * @brief Initialize ring buffers for circular buffer recording
-   * @return true if initialization successful, false otherwise
+   * @brief Apply the set of active strategies to the shared topic buffers
+   * Every recorded topic has exactly one buffer, shared by all strategies
+   * recording it and sized to the longest forward + backward window among
+   * them, so memory grows with the topics and not with the strategies.
+   * Buffers of kept topics retain their data and are only resized; buffers
+   * of new topics are created and those no strategy records any more are
+   * released. While clips are being captured the change is deferred until
+   * the last capture finished.
+   * @param strategies Enabled strategies
+   * @return true if all strategies are valid, false otherwise
    */
-  bool InitRingBuffers();
+  bool SetStrategies(const std::vector<std::shared_ptr<const trigger::Strategy>>& strategies);
 
   /**
    * @brief Open a bag file in specified mode
@@ -187,15 +200,27 @@ class Ros2BagRecorder : public channel::Observer {  // 继承自Observer
   bool HasDataWritten() const;
 
   /**
-   * @brief Trigger recording output for circular buffer mode
-   * Saves accumulated data to a new file with timestamp
-   * 
-   * @param trigger_timestamp Timestamp when trigger occurred (for logging)
+   * @brief Capture a clip of one strategy from the shared buffers
+   * The forward window is pinned at once (messages are shared, not copied),
+   * the call then waits for the backward window to pass, takes the backward
+   * messages from the same buffers and writes the clip. Clips of different
+   * strategies may be captured concurrently from different threads.
+   *
+   * @param strategy Strategy whose topics and capture window form the clip
+   * @param trigger_timestamp Timestamp when trigger occurred (microseconds)
    * @param output_file_path Path where to save the triggered data
+   * @param open_stream Opens a stream session, called after the forward window
+   *        is pinned so its network round trip does not delay the capture;
+   *        the forward data and the backward data received so far are then
+   *        replayed, later backward data is streamed as it arrives (optional)
+   * @param bag_info [out] Statistics of the written clip (optional)
    * @return true if trigger successful, false otherwise
    */
-  bool TriggerRecord(uint64_t trigger_timestamp,
-                     const std::string& output_file_path);
+  bool TriggerRecord(const std::shared_ptr<const trigger::Strategy>& strategy,
+                     uint64_t trigger_timestamp,
+                     const std::string& output_file_path,
+                     const std::function<uploader::StreamUploader*()>& open_stream = nullptr,
+                     TBagInfo* bag_info = nullptr);
 
   /**
    * @brief Set maximum bag file size (for auto-rotation)
@@ -204,6 +229,18 @@ class Ros2BagRecorder : public channel::Observer {  // 继承自Observer
    */
   bool SetMaxBagSize(size_t max_size_mb);
 
+  /**
+   * @brief Size topic buffers by the measured message rate
+   * The declared capturedFrameRate only sets the initial capacity; with auto
+   * sizing the capacity is at least the measured peak rate (TopicProfiler)
+   * times the window times the headroom, and a buffer that starts dropping
+   * messages still inside its retention window grows instead of truncating
+   * the clip. Call before SetStrategies.
+   * @param enabled Enable auto sizing
+   * @param headroom Factor applied to the measured rate
+   */
+  void SetAutoSize(bool enabled, double headroom);
+
   /**
    * @brief Get current recording statistics
    * @return TBagInfo with current statistics
@@ -219,8 +256,24 @@ class Ros2BagRecorder : public channel::Observer {  // 继承自Observer
   void OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& msg) override;
 
  private:
+  struct TimestampedData {
+    std::shared_ptr<const rclcpp::SerializedMessage> msg;
+    uint64_t timestamp;
+  };
+
+  // A clip being captured: a view over the shared buffers
+  struct Capture {
+    std::shared_ptr<const trigger::Strategy> strategy;
+    uint64_t trigger_timestamp = 0;
+    uint64_t end_timestamp = 0;
+    std::unordered_map<std::string, std::vector<TimestampedData>> messages;
+    uploader::StreamUploader* stream = nullptr;
+  };
+
   // Internal helper methods
-  bool write_ringbuffer(const std::string& outputfilePath);
+  bool write_clip(const Capture& capture, const std::string& outputfilePath, TBagInfo* bag_info);
+
+  void apply_strategies(const std::vector<std::shared_ptr<const trigger::Strategy>>& strategies);
   
   void update_statistics(const std::string& topic_name, uint64_t timestamp,
                         size_t data_size);
@@ -248,22 +301,31 @@ class Ros2BagRecorder : public channel::Observer {  // 继承自Observer
   std::chrono::steady_clock::time_point last_log_time_;
   size_t messages_since_last_log_;
 
-  // Circular buffer
-  std::shared_ptr<trigger::Strategy> strategy_{nullptr};
-  trigger::CacheMode cache_mode_;
-  struct TimestampedData {
-    rclcpp::SerializedMessage msg;
-    uint64_t timestamp;
-  };
+  // Shared per-topic buffers, guarded by buffer_mutex_
   using BufferType = common::RingBuffer<TimestampedData>;
-  std::unordered_map<std::string, std::unique_ptr<BufferType>> forward_ringbuffers_;
-  std::unordered_map<std::string, std::unique_ptr<BufferType>> backward_ringbuffers_;
-  std::unordered_map<std::string, std::vector<TimestampedData>> triggered_forward_buffers_;
-  uint64_t forward_capture_duration_us_{0};
-
-  std::atomic<bool> is_triggered_{false};
-  uint64_t trigger_timestamp_{0};
-  std::mutex buffer_mutex_;
+  struct TopicBuffer {
+    std::unique_ptr<BufferType> buffer;
+    uint64_t retention_us = 0;  ///< Longest forward + backward window of the strategies recording it
+    uint64_t last_grow_us = 0;  ///< Last time the capacity was raised to the measured rate
+  };
+  std::unordered_map<std::string, TopicBuffer> topic_buffers_;
+
+  /**
+   * @brief Raise the capacity of a full buffer whose oldest message is still
+   * inside the retention window, at most once per kGrowIntervalUs
+   */
+  void grow_buffer(const std::string& topic, TopicBuffer& topic_buffer, uint64_t now_us);
+  static constexpr uint64_t kGrowIntervalUs = 1000000;
+
+  std::vector<std::shared_ptr<const trigger::Strategy>> strategies_;
+  std::vector<std::shared_ptr<const trigger::Strategy>> pending_strategies_;  ///< Applied after the running captures
+  bool has_pending_strategies_{false};
+  std::vector<Capture*> captures_;  ///< Clips whose backward window is open
+  std::mutex buffer_mutex_;  ///< Held only for buffer push/eviction and capture bookkeeping, never for copies
+  std::atomic<int> stream_appends_{0};  ///< Live stream appends running outside buffer_mutex_
+  std::mutex write_mutex_;  ///< One bag is written at a time
+  bool auto_size_{false};
+  double rate_headroom_{1.2};
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,288 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "channel/cdr_field_plan.h"
+
+namespace dcp::channel {
+namespace {
+
+using Type = FieldLayout::Type;
+using Container = FieldLayout::Container;
+
+FieldLayout Field(const std::string& name, Type type, Container container = Container::None, uint32_t size = 0) {
+    FieldLayout field;
+    field.name = name;
+    field.type = type;
+    field.container = container;
+    field.arraySize = size;
+    return field;
+}
+
+FieldLayout Message(const std::string& name, std::vector<FieldLayout> members,
+                    Container container = Container::None, uint32_t size = 0) {
+    FieldLayout message = Field(name, Type::Message, container, size);
+    message.members = std::move(members);
+    return message;
+}
+
+// XCDR1写入：对齐相对于4字节封装头之后的起点
+class CdrWriter {
+public:
+    explicit CdrWriter(bool little) : little_(little), buf_{0, static_cast<uint8_t>(little ? 1 : 0), 0, 0} {}
+
+    template <typename T>
+    CdrWriter& Put(T value) {
+        Align(sizeof(T));
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        constexpr bool kHostLittle = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+        if (little_ != kHostLittle) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        buf_.insert(buf_.end(), bytes, bytes + sizeof(T));
+        return *this;
+    }
+
+    CdrWriter& String(const std::string& value) {
+        Put<uint32_t>(static_cast<uint32_t>(value.size() + 1));
+        buf_.insert(buf_.end(), value.begin(), value.end());
+        buf_.push_back(0);
+        return *this;
+    }
+
+    const std::vector<uint8_t>& bytes() const { return buf_; }
+
+private:
+    void Align(size_t align) {
+        while ((buf_.size() - 4) % align != 0) {
+            buf_.push_back(0xAA);  // 填充字节写非零值，读错位置能被发现
+        }
+    }
+
+    bool little_;
+    std::vector<uint8_t> buf_;
+};
+
+bool ReadField(const FieldLayout& root, const std::string& path, const std::vector<uint8_t>& bytes,
+               double& value, bool* fixed = nullptr) {
+    CdrFieldPlan plan;
+    EXPECT_TRUE(plan.Compile(root, path)) << path << ": " << plan.LastError();
+    if (fixed) {
+        *fixed = plan.IsFixedOffset();
+    }
+    return plan.Read(bytes.data(), bytes.size(), value);
+}
+
+class CdrFieldPlanTest : public ::testing::TestWithParam<bool> {
+protected:
+    CdrWriter Writer() const { return CdrWriter(GetParam()); }
+};
+
+// uint8 flag; double speed; int16 gear; float wheel[3]; Pose{int32 id; double x} pose; uint64 stamp
+TEST_P(CdrFieldPlanTest, FixedLayoutFoldsToOneOffset) {
+    const FieldLayout root = Message("", {
+        Field("flag", Type::UInt8),
+        Field("speed", Type::Double),
+        Field("gear", Type::Int16),
+        Field("wheel", Type::Float, Container::Array, 3),
+        Message("pose", {Field("id", Type::Int32), Field("x", Type::Double)}),
+        Field("stamp", Type::UInt64),
+    });
+    const auto bytes = Writer()
+        .Put<uint8_t>(7).Put<double>(12.5).Put<int16_t>(-3)
+        .Put<float>(1.f).Put<float>(2.f).Put<float>(3.5f)
+        .Put<int32_t>(42).Put<double>(-8.25)
+        .Put<uint64_t>(1234567890123ull).bytes();
+
+    const std::pair<const char*, double> expected[] = {
+        {"flag", 7}, {"speed", 12.5}, {"gear", -3}, {"wheel[0]", 1}, {"wheel[2]", 3.5},
+        {"pose.id", 42}, {"pose.x", -8.25}, {"stamp", 1234567890123.0},
+    };
+    for (const auto& [path, want] : expected) {
+        double value = 0.0;
+        bool fixed = false;
+        ASSERT_TRUE(ReadField(root, path, bytes, value, &fixed)) << path;
+        EXPECT_EQ(value, want) << path;
+        EXPECT_TRUE(fixed) << path;
+    }
+}
+
+TEST_P(CdrFieldPlanTest, StringBeforeTargetMakesOffsetDynamic) {
+    const FieldLayout root = Message("", {
+        Field("frame_id", Type::String),
+        Field("seq", Type::UInt32),
+        Field("speed", Type::Double),
+    });
+    for (const std::string frame_id : {"", "a", "base_link"}) {
+        const auto bytes = Writer().String(frame_id).Put<uint32_t>(9).Put<double>(3.25).bytes();
+        double value = 0.0;
+        bool fixed = true;
+        ASSERT_TRUE(ReadField(root, "speed", bytes, value, &fixed)) << frame_id;
+        EXPECT_EQ(value, 3.25);
+        EXPECT_FALSE(fixed);
+        ASSERT_TRUE(ReadField(root, "seq", bytes, value));
+        EXPECT_EQ(value, 9);
+    }
+}
+
+TEST_P(CdrFieldPlanTest, PrimitiveSequenceIndexAndSkip) {
+    const FieldLayout root = Message("", {
+        Field("flag", Type::UInt8),
+        Field("position", Type::Double, Container::Sequence),
+        Field("count", Type::Int32),
+    });
+    const auto bytes = Writer()
+        .Put<uint8_t>(1).Put<uint32_t>(3).Put<double>(0.5).Put<double>(1.5).Put<double>(2.5)
+        .Put<int32_t>(-7).bytes();
+    double value = 0.0;
+    ASSERT_TRUE(ReadField(root, "position[2]", bytes, value));
+    EXPECT_EQ(value, 2.5);
+    ASSERT_TRUE(ReadField(root, "count", bytes, value));
+    EXPECT_EQ(value, -7);
+    EXPECT_FALSE(ReadField(root, "position[3]", bytes, value));  // 下标超出实际长度
+}
+
+// 空序列后面没有元素对齐，紧跟的字段按计数之后的位置对齐
+TEST_P(CdrFieldPlanTest, EmptySequenceHasNoElementPadding) {
+    const FieldLayout root = Message("", {
+        Field("values", Type::Double, Container::Sequence),
+        Field("after", Type::Int32),
+    });
+    const auto bytes = Writer().Put<uint32_t>(0).Put<int32_t>(11).bytes();
+    ASSERT_EQ(bytes.size(), 4u + 8u);
+    double value = 0.0;
+    ASSERT_TRUE(ReadField(root, "after", bytes, value));
+    EXPECT_EQ(value, 11);
+}
+
+// objects: sequence<Object{string label; double x; sequence<int16> ids}>
+TEST_P(CdrFieldPlanTest, MessageSequenceWithDynamicElements) {
+    const FieldLayout object = Message("objects", {
+        Field("label", Type::String),
+        Field("x", Type::Double),
+        Field("ids", Type::Int16, Container::Sequence),
+    }, Container::Sequence);
+    const FieldLayout root = Message("", {object, Field("total", Type::Float)});
+
+    auto writer = Writer();
+    writer.Put<uint32_t>(3);
+    const char* labels[] = {"car", "pedestrian", ""};
+    for (int i = 0; i < 3; ++i) {
+        writer.String(labels[i]).Put<double>(10.0 * (i + 1)).Put<uint32_t>(static_cast<uint32_t>(i));
+        for (int k = 0; k < i; ++k) {
+            writer.Put<int16_t>(static_cast<int16_t>(100 + k));
+        }
+    }
+    const auto bytes = writer.Put<float>(4.5f).bytes();
+
+    double value = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ReadField(root, "objects[" + std::to_string(i) + "].x", bytes, value)) << i;
+        EXPECT_EQ(value, 10.0 * (i + 1));
+    }
+    ASSERT_TRUE(ReadField(root, "objects[2].ids[1]", bytes, value));
+    EXPECT_EQ(value, 101);
+    ASSERT_TRUE(ReadField(root, "total", bytes, value));
+    EXPECT_EQ(value, 4.5);
+    EXPECT_FALSE(ReadField(root, "objects[3].x", bytes, value));
+}
+
+// 定长消息数组在静态部分内按元素展开，目标仍是固定偏移
+TEST_P(CdrFieldPlanTest, FixedMessageArrayStaysStatic) {
+    const FieldLayout root = Message("", {
+        Field("flag", Type::Bool),
+        Message("corners", {Field("x", Type::Float), Field("y", Type::Double)}, Container::Array, 2),
+        Field("z", Type::Int16),
+    });
+    const auto bytes = Writer()
+        .Put<uint8_t>(1).Put<float>(1.f).Put<double>(2.0).Put<float>(3.f).Put<double>(4.0).Put<int16_t>(5).bytes();
+    double value = 0.0;
+    bool fixed = false;
+    ASSERT_TRUE(ReadField(root, "corners[1].y", bytes, value, &fixed));
+    EXPECT_EQ(value, 4.0);
+    EXPECT_TRUE(fixed);
+    ASSERT_TRUE(ReadField(root, "z", bytes, value, &fixed));
+    EXPECT_EQ(value, 5);
+    EXPECT_TRUE(fixed);
+    ASSERT_TRUE(ReadField(root, "flag", bytes, value));
+    EXPECT_EQ(value, 1.0);
+}
+
+TEST_P(CdrFieldPlanTest, TruncatedMessageFailsInsteadOfReadingPastTheEnd) {
+    const FieldLayout root = Message("", {
+        Field("name", Type::String),
+        Field("speed", Type::Double),
+    });
+    auto bytes = Writer().String("abc").Put<double>(1.0).bytes();
+    double value = 0.0;
+    for (size_t length = 0; length < bytes.size(); ++length) {
+        const std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + length);
+        EXPECT_FALSE(ReadField(root, "speed", truncated, value)) << length;
+    }
+    // 字符串长度字段被篡改
+    bytes[GetParam() ? 4 : 7] = 0xFF;
+    EXPECT_FALSE(ReadField(root, "speed", bytes, value));
+}
+
+INSTANTIATE_TEST_SUITE_P(Endianness, CdrFieldPlanTest, ::testing::Values(true, false),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                             return info.param ? "LittleEndian" : "BigEndian";
+                         });
+
+TEST(CdrFieldPlanCompileTest, RejectsBadPaths) {
+    const FieldLayout root = Message("", {
+        Field("label", Type::String),
+        Field("values", Type::Double, Container::Array, 2),
+        Field("speed", Type::Double),
+        Message("pose", {Field("x", Type::Double)}),
+        Field("extended", Type::LongDouble),
+    });
+    const char* bad[] = {
+        "missing",       // 无此字段
+        "values",        // 数组缺下标
+        "speed[0]",      // 非数组带下标
+        "values[2]",     // 定长数组越界
+        "values[-1]",
+        "values[x]",
+        "label",         // 非数值
+        "pose",          // 消息不是标量
+        "speed.x",       // 标量没有成员
+        "extended",      // long double不支持
+        "pose.y",
+    };
+    for (const char* path : bad) {
+        CdrFieldPlan plan;
+        EXPECT_FALSE(plan.Compile(root, path)) << path;
+        EXPECT_FALSE(plan.LastError().empty()) << path;
+    }
+    // wstring宽度依赖rmw，目标在其后时无法定位
+    const FieldLayout wide = Message("", {Field("name", Type::WString), Field("speed", Type::Double)});
+    CdrFieldPlan plan;
+    EXPECT_FALSE(plan.Compile(wide, "speed"));
+    EXPECT_NE(plan.LastError().find("wstring"), std::string::npos) << plan.LastError();
+}
+
+TEST(CdrFieldPlanCompileTest, RejectsUnsupportedEncapsulation) {
+    const FieldLayout root = Message("", {Field("speed", Type::Double)});
+    CdrFieldPlan plan;
+    ASSERT_TRUE(plan.Compile(root, "speed"));
+    auto bytes = CdrWriter(true).Put<double>(1.0).bytes();
+    double value = 0.0;
+    EXPECT_TRUE(plan.Read(bytes.data(), bytes.size(), value));
+    bytes[1] = 3;  // PL_CDR_LE
+    EXPECT_FALSE(plan.Read(bytes.data(), bytes.size(), value));
+    EXPECT_FALSE(plan.Read(nullptr, 0, value));
+}
+
+}
+}
@@ -0,0 +1,221 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "trigger/common/condition_program.h"
+
+namespace dcp::trigger {
+namespace {
+
+class ConditionProgramTest : public ::testing::Test {
+protected:
+    bool Eval(const std::string& condition) {
+        ConditionProgram program;
+        EXPECT_TRUE(program.compile(condition, slots_)) << program.lastError();
+        return program.evaluate(slots_);
+    }
+
+    void Set(const std::string& name, double value) { slots_.set(slots_.intern(name), value); }
+
+    SignalSlots slots_;
+};
+
+TEST_F(ConditionProgramTest, ArithmeticPrecedence) {
+    EXPECT_TRUE(Eval("1 + 2 * 3 == 7"));
+    EXPECT_TRUE(Eval("(1 + 2) * 3 == 9"));
+    EXPECT_TRUE(Eval("-2 * -3 == 6"));
+    EXPECT_TRUE(Eval("10 - 4 - 3 == 3"));
+    EXPECT_TRUE(Eval("12 / 3 / 2 == 2"));
+    EXPECT_TRUE(Eval("1 < 2 == 1"));
+}
+
+TEST_F(ConditionProgramTest, EqualityUsesRelativeTolerance) {
+    Set("x", 0.1 + 0.2);
+    EXPECT_TRUE(Eval("x == 0.3"));
+    EXPECT_FALSE(Eval("x != 0.3"));
+    EXPECT_TRUE(Eval("x <> 0.31"));
+}
+
+TEST_F(ConditionProgramTest, KeywordsAndSymbolsAreEquivalent) {
+    Set("a", 1);
+    Set("b", 0);
+    EXPECT_TRUE(Eval("a AND NOT b"));
+    EXPECT_TRUE(Eval("a && !b"));
+    EXPECT_TRUE(Eval("b Or a"));
+    EXPECT_TRUE(Eval("true and not false"));
+}
+
+TEST_F(ConditionProgramTest, VariablesAreInternedOnceAndDeduplicated) {
+    ConditionProgram program;
+    ASSERT_TRUE(program.compile("speed > 3 and speed < 10 or gear == 2", slots_));
+    ASSERT_EQ(program.variables().size(), 2u);
+    EXPECT_EQ(program.variables()[0], slots_.find("speed"));
+    EXPECT_EQ(program.variables()[1], slots_.find("gear"));
+    EXPECT_FALSE(program.timeDependent());
+}
+
+// and/or链的跳转目标在编译时回填，用全部取值组合和直接求值的结果对照
+TEST_F(ConditionProgramTest, ShortCircuitJumpsMatchTruthTable) {
+    struct Case {
+        const char* condition;
+        std::function<bool(bool, bool, bool, bool)> expected;
+    };
+    const Case cases[] = {
+        {"a and b and c and d", [](bool a, bool b, bool c, bool d) { return a && b && c && d; }},
+        {"a or b or c or d", [](bool a, bool b, bool c, bool d) { return a || b || c || d; }},
+        {"a and b or c and d", [](bool a, bool b, bool c, bool d) { return (a && b) || (c && d); }},
+        {"a or b and c or d", [](bool a, bool b, bool c, bool d) { return a || (b && c) || d; }},
+        {"(a or b) and (c or d)", [](bool a, bool b, bool c, bool d) { return (a || b) && (c || d); }},
+        {"not a and (b or not c) and d", [](bool a, bool b, bool c, bool d) { return !a && (b || !c) && d; }},
+        {"a and (b and (c or d)) or not a and d",
+         [](bool a, bool b, bool c, bool d) { return (a && b && (c || d)) || (!a && d); }},
+    };
+    const uint32_t a = slots_.intern("a");
+    const uint32_t b = slots_.intern("b");
+    const uint32_t c = slots_.intern("c");
+    const uint32_t d = slots_.intern("d");
+    for (const auto& test : cases) {
+        ConditionProgram program;
+        ASSERT_TRUE(program.compile(test.condition, slots_)) << program.lastError();
+        for (int bits = 0; bits < 16; ++bits) {
+            const bool va = bits & 1, vb = bits & 2, vc = bits & 4, vd = bits & 8;
+            slots_.set(a, va);
+            slots_.set(b, vb);
+            slots_.set(c, vc);
+            slots_.set(d, vd);
+            EXPECT_EQ(program.evaluate(slots_), test.expected(va, vb, vc, vd))
+                << test.condition << " with a=" << va << " b=" << vb << " c=" << vc << " d=" << vd;
+        }
+    }
+}
+
+TEST_F(ConditionProgramTest, NonBooleanOperandsAreTruthValues) {
+    Set("x", 5);
+    Set("y", 0);
+    EXPECT_TRUE(Eval("x and 2"));
+    EXPECT_FALSE(Eval("x and y"));
+    EXPECT_TRUE(Eval("(y or x) == 1"));
+}
+
+TEST_F(ConditionProgramTest, CompileErrorsLeaveProgramInvalid) {
+    const char* bad[] = {"a >", "(a and b", "a and", "a $ b", "foo(a)", "max(a)", "max(a, -5) > 1", "and a", ""};
+    for (const char* condition : bad) {
+        ConditionProgram program;
+        EXPECT_FALSE(program.compile(condition, slots_)) << condition;
+        EXPECT_FALSE(program.valid()) << condition;
+        EXPECT_FALSE(program.lastError().empty()) << condition;
+        EXPECT_FALSE(program.evaluate(slots_)) << condition;
+    }
+}
+
+TEST_F(ConditionProgramTest, RejectsExpressionsDeeperThanTheStack) {
+    std::string condition = "1";
+    for (int i = 0; i < 80; ++i) {
+        condition = "1 + (" + condition + ")";
+    }
+    ConditionProgram program;
+    EXPECT_FALSE(program.compile(condition, slots_));
+    EXPECT_NE(program.lastError().find("too deep"), std::string::npos) << program.lastError();
+}
+
+TEST_F(ConditionProgramTest, RecompileReplacesProgram) {
+    ConditionProgram program;
+    ASSERT_TRUE(program.compile("1 == 1", slots_));
+    EXPECT_TRUE(program.evaluate(slots_));
+    ASSERT_TRUE(program.compile("1 == 2", slots_));
+    EXPECT_FALSE(program.evaluate(slots_));
+    EXPECT_FALSE(program.compile("1 ==", slots_));
+    EXPECT_FALSE(program.valid());
+}
+
+TEST_F(ConditionProgramTest, WindowOperators) {
+    const uint32_t speed = slots_.intern("speed");
+    ConditionProgram program;
+    ASSERT_TRUE(program.compile("max(speed, 10000) - speed > 3", slots_)) << program.lastError();
+    EXPECT_TRUE(program.timeDependent());
+    slots_.set(speed, 10);
+    EXPECT_FALSE(program.evaluate(slots_));
+    slots_.set(speed, 5);
+    EXPECT_TRUE(program.evaluate(slots_));
+
+    // 注册窗口时以当前值作为进入值
+    ConditionProgram delta;
+    ASSERT_TRUE(delta.compile("delta(speed, 20000) == 1", slots_));
+    slots_.set(speed, 6);
+    EXPECT_TRUE(delta.evaluate(slots_));
+}
+
+// 完整求值时右操作数的边沿状态也要更新，否则下一次求值会误报上升沿
+TEST_F(ConditionProgramTest, EdgeStateUpdatesEvenWhenShortCircuitWouldSkipIt) {
+    const uint32_t a = slots_.intern("a");
+    const uint32_t b = slots_.intern("b");
+    ConditionProgram program;
+    ASSERT_TRUE(program.compile("b or rise(a > 0)", slots_)) << program.lastError();
+
+    slots_.set(a, 0);
+    slots_.set(b, 1);
+    EXPECT_TRUE(program.evaluate(slots_));
+    slots_.set(a, 1);
+    EXPECT_TRUE(program.evaluate(slots_));  // a上升，但b已为真
+    slots_.set(b, 0);
+    EXPECT_FALSE(program.evaluate(slots_));  // 上升沿已在上一次消费
+}
+
+TEST_F(ConditionProgramTest, RiseAndFallNeedAKnownPreviousValue) {
+    const uint32_t a = slots_.intern("a");
+    ConditionProgram rise;
+    ConditionProgram fall;
+    ASSERT_TRUE(rise.compile("rise(a > 0)", slots_));
+    ASSERT_TRUE(fall.compile("fall(a > 0)", slots_));
+    slots_.set(a, 1);
+    EXPECT_FALSE(rise.evaluate(slots_));  // 首次求值为假
+    EXPECT_FALSE(fall.evaluate(slots_));
+    slots_.set(a, 0);
+    EXPECT_FALSE(rise.evaluate(slots_));
+    EXPECT_TRUE(fall.evaluate(slots_));
+    slots_.set(a, 1);
+    EXPECT_TRUE(rise.evaluate(slots_));
+    EXPECT_FALSE(fall.evaluate(slots_));
+}
+
+TEST_F(ConditionProgramTest, HeldRequiresContinuousTruth) {
+    const uint32_t a = slots_.intern("a");
+    ConditionProgram program;
+    ASSERT_TRUE(program.compile("held(a > 0, 30)", slots_));
+    EXPECT_TRUE(program.timeDependent());
+    slots_.set(a, 1);
+    EXPECT_FALSE(program.evaluate(slots_));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_TRUE(program.evaluate(slots_));
+    slots_.set(a, 0);
+    EXPECT_FALSE(program.evaluate(slots_));
+    slots_.set(a, 1);
+    EXPECT_FALSE(program.evaluate(slots_));  // 中断后重新计时
+}
+
+TEST(SignalSlotsTest, SampleCarriesStampAndWriteCount) {
+    SignalSlots slots;
+    const uint32_t slot = slots.intern("speed");
+    EXPECT_EQ(slots.intern("speed"), slot);
+    EXPECT_EQ(slots.find("missing"), SignalSlots::kInvalidSlot);
+    EXPECT_EQ(slots.sample(slot).seq, 0u);
+    slots.set(slot, 3.5, 1000);
+    slots.set(slot, 4.5, 2000);
+    const auto sample = slots.sample(slot);
+    EXPECT_DOUBLE_EQ(sample.value, 4.5);
+    EXPECT_EQ(sample.stampUs, 2000);
+    EXPECT_EQ(sample.seq, 2u);
+    EXPECT_EQ(slots.name(slot), "speed");
+}
+
+}
+}
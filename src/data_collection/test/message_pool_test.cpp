@@ -0,0 +1,155 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "common/memory/message_pool.h"
+
+namespace dcp::common {
+namespace {
+
+constexpr size_t kMinClass = size_t{1} << MessagePool::kMinShift;
+constexpr size_t kMaxClass = size_t{1} << MessagePool::kMaxShift;
+
+MessagePool& Pool() {
+    return MessagePool::getInstance();
+}
+
+// 统计是全局累计的，测试只比较前后差值；各测试在独立线程里跑，结束时线程缓存已归还
+template <typename Fn>
+void RunInThread(Fn&& fn) {
+    std::thread(std::forward<Fn>(fn)).join();
+}
+
+TEST(MessagePoolTest, EverySlabClassRoundTrips) {
+    RunInThread([] {
+        const auto before = Pool().GetStats();
+        std::vector<void*> blocks;
+        for (size_t size = kMinClass; size <= kMaxClass; size <<= 1) {
+            // 正好一个规格和多出一字节分别落在相邻两个规格
+            for (size_t request : {size - 1, size, size + 1}) {
+                void* ptr = Pool().Allocate(request);
+                ASSERT_NE(ptr, nullptr) << request;
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0u) << request;
+                std::memset(ptr, 0x5a, request);
+                blocks.push_back(ptr);
+            }
+        }
+        const auto during = Pool().GetStats();
+        EXPECT_EQ(during.allocations - before.allocations, blocks.size() - 1);  // 4MB+1走large
+        EXPECT_EQ(during.largeAllocations - before.largeAllocations, 1u);
+        for (void* ptr : blocks) {
+            Pool().Deallocate(ptr);
+        }
+        const auto after = Pool().GetStats();
+        EXPECT_EQ(after.frees - before.frees, blocks.size() - 1);
+        EXPECT_EQ(after.bytesInUse, before.bytesInUse);
+    });
+}
+
+TEST(MessagePoolTest, FreedBlockIsReusedFromTheThreadCache) {
+    RunInThread([] {
+        void* first = Pool().Allocate(1000);
+        Pool().Deallocate(first);
+        const auto before = Pool().GetStats();
+        void* second = Pool().Allocate(700);  // 同为1KB规格
+        EXPECT_EQ(second, first);
+        EXPECT_EQ(Pool().GetStats().cacheMisses, before.cacheMisses);
+        Pool().Deallocate(second);
+    });
+}
+
+TEST(MessagePoolTest, ReallocateKeepsBlockWithinItsClass) {
+    RunInThread([] {
+        auto* ptr = static_cast<char*>(Pool().Allocate(100));
+        std::memcpy(ptr, "payload", 8);
+        EXPECT_EQ(Pool().Reallocate(ptr, 128), ptr);
+        // 缩到更小的规格和扩到更大的规格都换块，内容保留
+        auto* smaller = static_cast<char*>(Pool().Reallocate(ptr, 8));
+        ASSERT_NE(smaller, ptr);
+        EXPECT_EQ(std::memcmp(smaller, "payload", 8), 0);
+        auto* larger = static_cast<char*>(Pool().Reallocate(smaller, kMaxClass + 10));
+        ASSERT_NE(larger, nullptr);
+        EXPECT_EQ(std::memcmp(larger, "payload", 8), 0);
+        EXPECT_EQ(Pool().Reallocate(larger, kMaxClass + 5), larger);
+        Pool().Deallocate(larger);
+    });
+}
+
+TEST(MessagePoolTest, ZeroAllocateClearsRecycledBlocks) {
+    MessagePool& pool = Pool();
+    ASSERT_TRUE(pool.Init(true, 64 * 1024, 64 * 1024));
+    const rcutils_allocator_t allocator = pool.Allocator();
+    ASSERT_EQ(allocator.state, &pool);
+    RunInThread([&] {
+        void* dirty = allocator.allocate(256, allocator.state);
+        std::memset(dirty, 0xff, 256);
+        allocator.deallocate(dirty, allocator.state);
+        auto* zeroed = static_cast<uint8_t*>(allocator.zero_allocate(16, 16, allocator.state));
+        ASSERT_EQ(zeroed, dirty);
+        for (size_t i = 0; i < 256; ++i) {
+            ASSERT_EQ(zeroed[i], 0) << i;
+        }
+        allocator.deallocate(zeroed, allocator.state);
+        EXPECT_EQ(allocator.zero_allocate(SIZE_MAX / 2, 4, allocator.state), nullptr);  // 溢出
+    });
+}
+
+// 生产者分配、消费者释放，块堆积在消费者缓存，超限后归还全局链表
+TEST(MessagePoolTest, CrossThreadFreesReturnToTheCentralList) {
+    constexpr size_t kBlocks = 4096;
+    std::vector<void*> blocks;
+    const auto before = Pool().GetStats();
+    RunInThread([&] {
+        for (size_t i = 0; i < kBlocks; ++i) {
+            blocks.push_back(Pool().Allocate(kMinClass));
+        }
+    });
+    RunInThread([&] {
+        for (void* ptr : blocks) {
+            Pool().Deallocate(ptr);
+        }
+    });
+    const auto after = Pool().GetStats();
+    EXPECT_EQ(after.allocations - before.allocations, kBlocks);
+    EXPECT_EQ(after.frees - before.frees, kBlocks);
+    EXPECT_EQ(after.bytesInUse, before.bytesInUse);
+    EXPECT_EQ(after.threadCaches, before.threadCaches);
+}
+
+// 线程退出时先析构线程缓存，再析构更早构造的thread_local对象
+struct LateReleaser {
+    ~LateReleaser() {
+        Pool().Deallocate(held);
+        void* again = Pool().Allocate(300);
+        allocated_after_retire = again != nullptr;
+        Pool().Deallocate(again);
+    }
+    void* held = nullptr;
+    static bool allocated_after_retire;
+};
+bool LateReleaser::allocated_after_retire = false;
+
+TEST(MessagePoolTest, ReleaseAfterThreadCacheDestructionUsesTheCentralList) {
+    const auto before = Pool().GetStats();
+    RunInThread([] {
+        thread_local LateReleaser releaser;
+        releaser.held = Pool().Allocate(300);
+    });
+    const auto after = Pool().GetStats();
+    EXPECT_TRUE(LateReleaser::allocated_after_retire);
+    EXPECT_EQ(after.allocations - before.allocations, 2u);
+    EXPECT_EQ(after.frees - before.frees, 2u);
+    EXPECT_EQ(after.bytesInUse, before.bytesInUse);
+    EXPECT_EQ(after.threadCaches, before.threadCaches);
+}
+
+}
+}
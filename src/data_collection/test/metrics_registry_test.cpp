@@ -0,0 +1,152 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/metrics/metrics_registry.h"
+
+namespace dcp::common {
+namespace {
+
+bool Contains(const std::string& text, const std::string& line) {
+    return text.find(line) != std::string::npos;
+}
+
+TEST(HistogramTest, SmallValuesHaveExactBuckets) {
+    for (uint64_t us = 0; us < 8; ++us) {
+        EXPECT_EQ(Histogram::BucketOf(us), us);
+        EXPECT_EQ(Histogram::BucketUpperBound(us), us);
+    }
+    EXPECT_EQ(Histogram::BucketOf(8), 8u);
+    EXPECT_EQ(Histogram::BucketOf(16), 16u);
+    EXPECT_EQ(Histogram::BucketOf(17), 16u);  // 16~17共用一个桶
+    EXPECT_EQ(Histogram::BucketOf(18), 17u);
+}
+
+// 相邻桶首尾相接，每个值落在上界不小于它的第一个桶，桶宽不超过下界的1/8
+TEST(HistogramTest, BucketsTileTheRangeWithBoundedWidth) {
+    for (size_t bucket = 1; bucket < Histogram::kBuckets; ++bucket) {
+        const uint64_t lower = Histogram::BucketUpperBound(bucket - 1) + 1;
+        const uint64_t upper = Histogram::BucketUpperBound(bucket);
+        ASSERT_LE(lower, upper) << bucket;
+        ASSERT_EQ(Histogram::BucketOf(lower), bucket);
+        ASSERT_EQ(Histogram::BucketOf(upper), bucket);
+        if (bucket >= 8) {
+            ASSERT_LE(upper - lower + 1, lower / 8) << bucket;
+        }
+    }
+    EXPECT_EQ(Histogram::BucketUpperBound(Histogram::kBuckets - 1), (1ULL << Histogram::kMaxExponent) - 1);
+}
+
+TEST(HistogramTest, ValuesBeyondTheRangeClampToTheLastBucket) {
+    EXPECT_EQ(Histogram::BucketOf(1ULL << Histogram::kMaxExponent), Histogram::kBuckets - 1);
+    EXPECT_EQ(Histogram::BucketOf(UINT64_MAX), Histogram::kBuckets - 1);
+}
+
+TEST(HistogramTest, QuantileReturnsBucketUpperBoundCappedAtMax) {
+    Histogram histogram;
+    Histogram::Snapshot snapshot;
+    histogram.Collect(snapshot);
+    EXPECT_EQ(snapshot.Quantile(0.5), 0u);
+
+    for (uint64_t us = 1; us <= 1000; ++us) {
+        histogram.Record(us);
+    }
+    histogram.Collect(snapshot);
+    EXPECT_EQ(snapshot.count, 1000u);
+    EXPECT_EQ(snapshot.sum, 500500u);
+    EXPECT_EQ(snapshot.max, 1000u);
+    EXPECT_EQ(snapshot.Quantile(0.0), 1u);
+    EXPECT_EQ(snapshot.Quantile(1.0), 1000u);  // 所在桶上界1023，取max
+    for (double q : {0.5, 0.9, 0.99}) {
+        const uint64_t exact = static_cast<uint64_t>(q * 1000 + 0.5);
+        const uint64_t estimate = snapshot.Quantile(q);
+        EXPECT_GE(estimate, exact) << q;
+        EXPECT_LE(estimate, exact + exact / 8) << q;
+    }
+}
+
+TEST(HistogramTest, CollectMergesAllShards) {
+    Histogram histogram;
+    std::vector<std::thread> threads;
+    for (uint64_t t = 1; t <= 8; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < 1000; ++i) {
+                histogram.Record(t * 100);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Histogram::Snapshot snapshot;
+    histogram.Collect(snapshot);
+    EXPECT_EQ(snapshot.count, 8000u);
+    EXPECT_EQ(snapshot.sum, 1000u * 100 * (1 + 2 + 3 + 4 + 5 + 6 + 7 + 8));
+    EXPECT_EQ(snapshot.max, 800u);
+    EXPECT_EQ(snapshot.buckets[Histogram::BucketOf(300)], 1000u);
+}
+
+TEST(MetricsRegistryTest, SameNameAndLabelsReturnTheSameMetric) {
+    auto& registry = MetricsRegistry::getInstance();
+    Counter* counter = registry.GetCounter("test_registry_total", "Test counter.", {{"lane", "a"}});
+    EXPECT_EQ(registry.GetCounter("test_registry_total", "", {{"lane", "a"}}), counter);
+    EXPECT_NE(registry.GetCounter("test_registry_total", "", {{"lane", "b"}}), counter);
+    counter->Add();
+    counter->Add(4);
+    EXPECT_EQ(counter->Value(), 5u);
+
+    // 类型冲突时返回不导出的独立实例，由调用方持有
+    std::unique_ptr<Gauge> detached(registry.GetGauge("test_registry_total", ""));
+    ASSERT_NE(detached, nullptr);
+    detached->Set(42.0);
+    EXPECT_FALSE(Contains(registry.Export(), "test_registry_total 42"));
+}
+
+TEST(MetricsRegistryTest, ExportWritesPrometheusText) {
+    auto& registry = MetricsRegistry::getInstance();
+    registry.GetCounter("test_export_total", "Exported counter.", {{"path", "a\"b\\c"}})->Add(3);
+    Gauge* gauge = registry.GetGauge("test_export_depth", "Exported gauge.");
+    gauge->Set(1.5);
+    gauge->Add(-0.25);
+    Histogram* histogram = registry.GetHistogram("test_export_seconds", "Exported histogram.", {{"stage", "x"}});
+    histogram->Record(10);
+    histogram->Record(100);
+    histogram->Record(5000000);
+
+    const std::string text = registry.Export();
+    EXPECT_TRUE(Contains(text, "# TYPE test_export_total counter\n"));
+    EXPECT_TRUE(Contains(text, "test_export_total{path=\"a\\\"b\\\\c\"} 3\n"));
+    EXPECT_TRUE(Contains(text, "# TYPE test_export_depth gauge\n"));
+    EXPECT_TRUE(Contains(text, "test_export_depth 1.25\n"));
+    // Prometheus桶按2的幂取边界，计数累加
+    EXPECT_TRUE(Contains(text, "# TYPE test_export_seconds histogram\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"1.5e-05\"} 1\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"6.3e-05\"} 1\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"0.000127\"} 2\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"4.194303\"} 2\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"8.388607\"} 3\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_bucket{stage=\"x\",le=\"+Inf\"} 3\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_sum{stage=\"x\"} 5.00011\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_count{stage=\"x\"} 3\n"));
+    EXPECT_TRUE(Contains(text, "test_export_seconds_quantile{stage=\"x\",quantile=\"1\"} 5\n"));
+}
+
+TEST(MetricsRegistryTest, CollectorsRunBeforeExport) {
+    auto& registry = MetricsRegistry::getInstance();
+    Gauge* gauge = registry.GetGauge("test_collected", "Set by a collector.");
+    registry.AddCollector([gauge] { gauge->Add(1.0); });
+    EXPECT_TRUE(Contains(registry.Export(), "test_collected 1\n"));
+    EXPECT_TRUE(Contains(registry.Export(), "test_collected 2\n"));
+}
+
+}
+}
@@ -0,0 +1,131 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "trigger/common/sliding_window.h"
+
+namespace dcp::trigger {
+namespace {
+
+constexpr int64_t kSecond = 1000000;
+
+TEST(SlidingWindowTest, EmptyWindowReturnsZero) {
+    SlidingWindow window(kSecond);
+    EXPECT_EQ(window.min(0), 0.0);
+    EXPECT_EQ(window.max(0), 0.0);
+    EXPECT_EQ(window.avg(0), 0.0);
+    EXPECT_EQ(window.count(0), 0.0);
+    EXPECT_EQ(window.delta(0), 0.0);
+}
+
+// 长时间不变的信号，窗口内的值就是进入值
+TEST(SlidingWindowTest, EntryValueIsKeptWhenSignalIsUnchanged) {
+    SlidingWindow window(kSecond);
+    window.push(0, 5.0);
+    const int64_t now = 10 * kSecond;
+    EXPECT_EQ(window.min(now), 5.0);
+    EXPECT_EQ(window.max(now), 5.0);
+    EXPECT_EQ(window.avg(now), 5.0);
+    EXPECT_EQ(window.count(now), 0.0);
+    EXPECT_EQ(window.delta(now), 0.0);
+}
+
+TEST(SlidingWindowTest, MinMaxDeltaFollowTheWindow) {
+    SlidingWindow window(kSecond);
+    window.push(0, 3.0);
+    window.push(400000, 9.0);
+    window.push(800000, 1.0);
+    EXPECT_EQ(window.min(900000), 1.0);
+    EXPECT_EQ(window.max(900000), 9.0);
+    EXPECT_EQ(window.delta(900000), -2.0);
+    EXPECT_EQ(window.count(900000), 3.0);
+    // 1.5s时窗口起点为0.5s，进入值是0.4s写入的9
+    EXPECT_EQ(window.max(1500000), 9.0);
+    EXPECT_EQ(window.delta(1500000), -8.0);
+    EXPECT_EQ(window.count(1500000), 1.0);
+    // 1.9s时进入值为1
+    EXPECT_EQ(window.max(1900000), 1.0);
+    EXPECT_EQ(window.min(1900000), 1.0);
+}
+
+// 密集的一段采样不应拉偏均值：0持续0.9s，随后0.1s内写入10个10
+TEST(SlidingWindowTest, AverageIsWeightedByHoldTime) {
+    SlidingWindow window(kSecond);
+    window.push(0, 0.0);
+    for (int i = 0; i < 10; ++i) {
+        window.push(900000 + i * 10000, 10.0);
+    }
+    EXPECT_NEAR(window.avg(kSecond), 1.0, 1e-9);
+}
+
+TEST(SlidingWindowTest, AverageCountsOnlyTheEntryValuePartInsideTheWindow) {
+    SlidingWindow window(kSecond);
+    window.push(0, 4.0);
+    window.push(2 * kSecond, 8.0);
+    // 窗口[1.5s, 2.5s]：4保持0.5s，8保持0.5s
+    EXPECT_NEAR(window.avg(2500000), 6.0, 1e-9);
+    // 窗口起点早于首个样本时只计首个样本之后
+    SlidingWindow young(10 * kSecond);
+    young.push(kSecond, 2.0);
+    young.push(2 * kSecond, 6.0);
+    EXPECT_NEAR(young.avg(4 * kSecond), (2.0 * 1 + 6.0 * 2) / 3, 1e-9);
+}
+
+TEST(SlidingWindowTest, AverageAtTheSampleInstantIsTheValue) {
+    SlidingWindow window(kSecond);
+    window.push(kSecond, 7.0);
+    EXPECT_EQ(window.avg(kSecond), 7.0);
+}
+
+// 与逐点积分的暴力结果对照，覆盖淘汰和面积重算
+TEST(SlidingWindowTest, MatchesBruteForceOnRandomStream) {
+    const int64_t window_us = 200000;
+    SlidingWindow window(window_us);
+    std::vector<std::pair<int64_t, double>> samples;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int64_t> gap(1, 30000);
+    std::uniform_real_distribution<double> value(-100.0, 100.0);
+    int64_t now = 0;
+    int64_t next_gap = gap(rng);
+    for (int i = 0; i < 5000; ++i) {
+        now += next_gap;
+        const double v = value(rng);
+        window.push(now, v);
+        samples.emplace_back(now, v);
+
+        // 查询时刻落在下一次写入之前，时间单调
+        next_gap = gap(rng);
+        const int64_t query = now + next_gap / 2;
+        const int64_t start = query - window_us;
+        size_t first = 0;
+        while (first + 1 < samples.size() && samples[first + 1].first <= start) {
+            ++first;
+        }
+        double lo = samples[first].second;
+        double hi = lo;
+        double area = 0.0;
+        const int64_t begin = std::max(start, samples[first].first);
+        for (size_t k = first; k < samples.size(); ++k) {
+            lo = std::min(lo, samples[k].second);
+            hi = std::max(hi, samples[k].second);
+            const int64_t from = std::max(begin, samples[k].first);
+            const int64_t to = k + 1 < samples.size() ? samples[k + 1].first : query;
+            area += samples[k].second * static_cast<double>(to - from);
+        }
+        ASSERT_EQ(window.min(query), lo) << i;
+        ASSERT_EQ(window.max(query), hi) << i;
+        ASSERT_NEAR(window.avg(query), area / static_cast<double>(query - begin), 1e-6) << i;
+        ASSERT_EQ(window.delta(query), samples.back().second - samples[first].second) << i;
+    }
+}
+
+}
+}
@@ -0,0 +1,171 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "common/signal/signal_bank.h"
+#include "common/signal/streaming_stats.h"
+
+namespace dcp::common {
+namespace {
+
+double SortedQuantile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    const double pos = q * static_cast<double>(values.size() - 1);
+    const auto lo = static_cast<size_t>(pos);
+    const size_t hi = std::min(lo + 1, values.size() - 1);
+    return values[lo] + (values[hi] - values[lo]) * (pos - static_cast<double>(lo));
+}
+
+TEST(StreamingStatsTest, EmaStartsAtFirstSampleAndConverges) {
+    EXPECT_DOUBLE_EQ(Ema::AlphaFor(0.01, 0.1), 2.0 / 11.0);
+    Ema ema(0.5);
+    EXPECT_EQ(ema.push(4.0), 4.0);
+    EXPECT_EQ(ema.push(8.0), 6.0);
+    EXPECT_EQ(ema.push(8.0), 7.0);
+    ema.reset();
+    EXPECT_EQ(ema.push(1.0), 1.0);
+}
+
+TEST(StreamingStatsTest, SmaAveragesTheLastWindowSamples) {
+    Sma sma(3);
+    EXPECT_EQ(sma.get(), 0.0);
+    EXPECT_EQ(sma.push(3.0), 3.0);
+    EXPECT_EQ(sma.push(6.0), 4.5);
+    EXPECT_EQ(sma.push(9.0), 6.0);
+    EXPECT_EQ(sma.push(12.0), 9.0);
+    EXPECT_EQ(sma.size(), 3u);
+}
+
+// 滑动和每转一圈重算，大数相消后不留误差
+TEST(StreamingStatsTest, SmaDoesNotDriftAfterLargeValues) {
+    Sma sma(4);
+    for (int i = 0; i < 4; ++i) {
+        sma.push(1e12);
+    }
+    for (int i = 0; i < 4; ++i) {
+        sma.push(0.1);
+    }
+    EXPECT_DOUBLE_EQ(sma.get(), 0.1);
+}
+
+TEST(StreamingStatsTest, KalmanVarianceShrinksAndEstimateTracksConstant) {
+    Kalman1D kalman(1e-4, 1.0);
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    double last_variance = 2.0;
+    for (int i = 0; i < 500; ++i) {
+        kalman.push(5.0 + noise(rng));
+        EXPECT_LE(kalman.variance(), last_variance);
+        last_variance = kalman.variance();
+    }
+    EXPECT_NEAR(kalman.get(), 5.0, 0.3);
+}
+
+TEST(StreamingStatsTest, SlidingQuantileMatchesSortedWindow) {
+    const size_t window = 21;
+    SlidingQuantile quantile(window);
+    std::deque<double> recent;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> value(-50, 50);  // 含重复值
+    for (int i = 0; i < 2000; ++i) {
+        const double v = value(rng);
+        quantile.push(v);
+        recent.push_back(v);
+        if (recent.size() > window) {
+            recent.pop_front();
+        }
+        const std::vector<double> values(recent.begin(), recent.end());
+        ASSERT_EQ(quantile.size(), values.size());
+        for (double q : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+            ASSERT_DOUBLE_EQ(quantile.quantile(q), SortedQuantile(values, q)) << i << " q=" << q;
+        }
+        ASSERT_EQ(quantile.min(), *std::min_element(values.begin(), values.end()));
+        ASSERT_EQ(quantile.max(), *std::max_element(values.begin(), values.end()));
+    }
+}
+
+TEST(StreamingStatsTest, SlidingQuantileMedianOfEvenWindowAverages) {
+    SlidingQuantile quantile(4);
+    for (double v : {4.0, 1.0, 3.0, 2.0}) {
+        quantile.push(v);
+    }
+    EXPECT_DOUBLE_EQ(quantile.median(), 2.5);
+}
+
+TEST(StreamingStatsTest, P2QuantileEstimatesUniformQuantiles) {
+    P2Quantile median(0.5);
+    P2Quantile p90(0.9);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> value(0.0, 100.0);
+    for (int i = 0; i < 20000; ++i) {
+        const double v = value(rng);
+        median.push(v);
+        p90.push(v);
+    }
+    EXPECT_NEAR(median.get(), 50.0, 2.0);
+    EXPECT_NEAR(p90.get(), 90.0, 2.0);
+}
+
+TEST(StreamingStatsTest, P2QuantileWithFewSamplesSorts) {
+    P2Quantile median(0.5);
+    EXPECT_EQ(median.get(), 0.0);
+    for (double v : {9.0, 1.0, 5.0}) {
+        median.push(v);
+    }
+    EXPECT_EQ(median.get(), 5.0);
+}
+
+// 多通道批量更新与逐通道的单通道滤波结果一致
+class SignalBankTest : public ::testing::TestWithParam<SignalBank::Filter> {};
+
+TEST_P(SignalBankTest, MatchesSingleChannelFilters) {
+    constexpr size_t kChannels = 5;
+    SignalBank::Options options;
+    options.filter = GetParam();
+    options.samplingPeriodS = 0.01;
+    options.responseTimeS = 0.05;
+    options.medianWindow = 7;
+    SignalBank bank(kChannels, options);
+
+    std::vector<Ema> emas(kChannels, Ema(Ema::AlphaFor(0.01, 0.05)));
+    std::vector<Sma> smas(kChannels, Sma(5));
+    std::vector<Kalman1D> kalmans(kChannels, Kalman1D(options.processNoise, options.measurementNoise));
+    std::vector<SlidingQuantile> medians(kChannels, SlidingQuantile(7));
+
+    std::mt19937 rng(11);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<double> frame(kChannels);
+    for (int i = 0; i < 300; ++i) {
+        for (size_t c = 0; c < kChannels; ++c) {
+            frame[c] = static_cast<double>(c) * 10.0 + noise(rng);
+        }
+        bank.update(frame);
+        for (size_t c = 0; c < kChannels; ++c) {
+            double expected = 0.0;
+            switch (GetParam()) {
+                case SignalBank::Filter::Ema: expected = emas[c].push(frame[c]); break;
+                case SignalBank::Filter::Sma: expected = smas[c].push(frame[c]); break;
+                case SignalBank::Filter::Kalman: expected = kalmans[c].push(frame[c]); break;
+            }
+            medians[c].push(frame[c]);
+            ASSERT_NEAR(bank.value(c), expected, 1e-9) << "frame " << i << " channel " << c;
+            ASSERT_DOUBLE_EQ(bank.median(c), medians[c].median());
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Filters, SignalBankTest,
+                         ::testing::Values(SignalBank::Filter::Ema, SignalBank::Filter::Sma,
+                                           SignalBank::Filter::Kalman));
+
+}
+}
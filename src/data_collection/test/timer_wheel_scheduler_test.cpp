@@ -0,0 +1,236 @@
+//
+// Created by xucong on 25-10-7.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/metrics/metrics_registry.h"
+#include "trigger/priority_scheduler/timer_wheel_scheduler.h"
+
+namespace dcp::trigger {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+class FakeTrigger : public TriggerBase {
+public:
+    explicit FakeTrigger(milliseconds work = milliseconds(0)) : work_(work) {}
+
+    bool proc() override {
+        const int running = ++running_;
+        max_running_ = std::max(max_running_.load(), running);
+        std::this_thread::sleep_for(work_);
+        ++runs_;
+        --running_;
+        return true;
+    }
+    bool checkCondition() override { return false; }
+    void registerVariableGetter(const std::string&, std::function<TriggerChecker::Value()>) override {}
+    void OnMessageReceived(const std::string&, const rclcpp::SerializedMessage&) override {}
+
+    std::atomic<int> runs_{0};
+    std::atomic<int> running_{0};
+    std::atomic<int> max_running_{0};
+
+private:
+    milliseconds work_;
+};
+
+TriggerTask MakeTask(const std::string& id, milliseconds period, std::shared_ptr<TriggerBase> trigger) {
+    TriggerTask task;
+    task.triggerId = id;
+    task.priority = 0;
+    task.period = period;
+    task.trigger = std::move(trigger);
+    return task;
+}
+
+uint64_t CounterValue(const std::string& name, const std::string& scheduler, const std::string& job) {
+    return common::MetricsRegistry::getInstance()
+        .GetCounter(name, "", {{"scheduler", scheduler}, {"job", job}})->Value();
+}
+
+bool WaitFor(const std::function<bool()>& done, milliseconds timeout = milliseconds(2000)) {
+    const auto deadline = Clock::now() + timeout;
+    while (!done()) {
+        if (Clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+// 超过64个tick的任务挂在高层，逐层级联回低层后按期限执行，不会提前
+TEST(TimerWheelSchedulerTest, OnceJobsCascadeAndFireInDeadlineOrder) {
+    TimerWheelScheduler scheduler(4, 1, "test_cascade");
+    scheduler.StartScheduling();
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<bool> early;
+    const auto start = Clock::now();
+    const int delays[] = {300, 5, 80, 150, 40};
+    for (int delay : delays) {
+        scheduler.ScheduleOnce("once", 0, milliseconds(delay), [&, delay](const std::atomic<bool>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(delay);
+            early.push_back(Clock::now() - start < milliseconds(delay));
+            return true;
+        });
+    }
+    ASSERT_TRUE(WaitFor([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order.size() == std::size(delays);
+    }));
+    EXPECT_EQ(order, (std::vector<int>{5, 40, 80, 150, 300}));
+    EXPECT_EQ(std::count(early.begin(), early.end(), true), 0);
+}
+
+// 第二层一格为4096个tick
+TEST(TimerWheelSchedulerTest, OnceJobCascadesFromTheThirdLevel) {
+    TimerWheelScheduler scheduler(2, 1, "test_cascade");
+    scheduler.StartScheduling();
+
+    std::atomic<int64_t> elapsed_ms{-1};
+    const auto start = Clock::now();
+    scheduler.ScheduleOnce("once", 0, milliseconds(4200), [&](const std::atomic<bool>&) {
+        elapsed_ms = std::chrono::duration_cast<milliseconds>(Clock::now() - start).count();
+        return true;
+    });
+    ASSERT_TRUE(WaitFor([&] { return elapsed_ms >= 0; }, milliseconds(6000)));
+    EXPECT_GE(elapsed_ms.load(), 4200);
+    EXPECT_LT(elapsed_ms.load(), 4700);
+}
+
+TEST(TimerWheelSchedulerTest, PeriodicTaskRunsAtFixedRate) {
+    TimerWheelScheduler scheduler(2, 1, "test_periodic");
+    auto trigger = std::make_shared<FakeTrigger>();
+    scheduler.AddTask(MakeTask("periodic", milliseconds(20), trigger));
+    scheduler.StartScheduling();
+    std::this_thread::sleep_for(milliseconds(300));
+    scheduler.Stop();
+    EXPECT_GE(trigger->runs_.load(), 12);
+    EXPECT_LE(trigger->runs_.load(), 17);
+}
+
+// 执行比周期慢时不重叠执行，错过的周期计为overrun并导出
+TEST(TimerWheelSchedulerTest, SlowPeriodicTaskNeverOverlapsAndCountsOverruns) {
+    TimerWheelScheduler scheduler(3, 1, "test_overrun");
+    auto trigger = std::make_shared<FakeTrigger>(milliseconds(35));
+    scheduler.AddTask(MakeTask("slow", milliseconds(10), trigger));
+    scheduler.StartScheduling();
+    std::this_thread::sleep_for(milliseconds(300));
+    scheduler.Stop();
+    EXPECT_EQ(trigger->max_running_.load(), 1);
+    EXPECT_GE(trigger->runs_.load(), 5);
+    EXPECT_GT(CounterValue("dcp_scheduler_overruns_total", "test_overrun", "slow"), 0u);
+}
+
+TEST(TimerWheelSchedulerTest, RemovedTaskStopsRunning) {
+    TimerWheelScheduler scheduler(2, 1, "test_remove");
+    auto trigger = std::make_shared<FakeTrigger>();
+    scheduler.AddTask(MakeTask("removed", milliseconds(5), trigger));
+    scheduler.StartScheduling();
+    ASSERT_TRUE(WaitFor([&] { return trigger->runs_ >= 3; }));
+    scheduler.RemoveTask("removed");
+    std::this_thread::sleep_for(milliseconds(20));
+    const int runs = trigger->runs_;
+    std::this_thread::sleep_for(milliseconds(50));
+    EXPECT_EQ(trigger->runs_.load(), runs);
+}
+
+// workers=1也至少有2个线程：被抢占的任务走到让出点之前，抢占者已经在运行
+TEST(TimerWheelSchedulerTest, PreempterRunsAlongsideYieldingVictim) {
+    TimerWheelScheduler scheduler(1, 1, "test_preempt");
+    scheduler.StartScheduling();
+
+    std::atomic<int> low_runs{0};
+    std::atomic<bool> low_running{false};
+    std::atomic<bool> low_done{false};
+    std::atomic<bool> high_done{false};
+    std::atomic<bool> high_overlapped{false};
+    scheduler.ScheduleOnce("low", 10, milliseconds(0), [&](const std::atomic<bool>& preempted) {
+        low_running = true;
+        if (++low_runs == 1) {
+            // 模拟不可中断的采集：看到抢占后还要再跑一段才能让出
+            EXPECT_TRUE(WaitFor([&] { return preempted.load(); }));
+            std::this_thread::sleep_for(milliseconds(50));
+            low_running = false;
+            return false;
+        }
+        EXPECT_TRUE(high_done.load());
+        low_running = false;
+        low_done = true;
+        return true;
+    });
+    ASSERT_TRUE(WaitFor([&] { return low_running.load(); }));
+    scheduler.ScheduleOnce("high", 1, milliseconds(0), [&](const std::atomic<bool>&) {
+        high_overlapped = low_running.load();
+        high_done = true;
+        return true;
+    });
+    ASSERT_TRUE(WaitFor([&] { return low_done.load(); }));
+    EXPECT_TRUE(high_overlapped.load());
+    EXPECT_EQ(low_runs.load(), 2);
+    EXPECT_EQ(CounterValue("dcp_scheduler_preemptions_total", "test_preempt", "low"), 1u);
+}
+
+TEST(TimerWheelSchedulerTest, SameOrLowerPriorityDoesNotPreempt) {
+    TimerWheelScheduler scheduler(2, 1, "test_no_preempt");
+    scheduler.StartScheduling();
+
+    std::atomic<bool> first_running{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> preempted_seen{false};
+    std::atomic<int> done{0};
+    scheduler.ScheduleOnce("first", 5, milliseconds(0), [&](const std::atomic<bool>& preempted) {
+        first_running = true;
+        WaitFor([&] { return release.load(); });
+        preempted_seen = preempted.load();
+        ++done;
+        return true;
+    });
+    ASSERT_TRUE(WaitFor([&] { return first_running.load(); }));
+    for (int8_t priority : {5, 9}) {
+        scheduler.ScheduleOnce("second", priority, milliseconds(0), [&](const std::atomic<bool>&) {
+            ++done;
+            return true;
+        });
+    }
+    std::this_thread::sleep_for(milliseconds(20));
+    EXPECT_EQ(done.load(), 0);  // 一次性任务名额只有1个
+    release = true;
+    ASSERT_TRUE(WaitFor([&] { return done == 3; }));
+    EXPECT_FALSE(preempted_seen.load());
+}
+
+TEST(TimerWheelSchedulerTest, LatenessIsExported) {
+    TimerWheelScheduler scheduler(2, 1, "test_lateness");
+    scheduler.StartScheduling();
+    std::atomic<bool> ran{false};
+    scheduler.ScheduleOnce("once", 0, milliseconds(10), [&](const std::atomic<bool>&) {
+        ran = true;
+        return true;
+    });
+    ASSERT_TRUE(WaitFor([&] { return ran.load(); }));
+    common::Histogram::Snapshot snapshot;
+    common::MetricsRegistry::getInstance()
+        .GetHistogram("dcp_scheduler_lateness_seconds", "", {{"scheduler", "test_lateness"}, {"job", "once"}})
+        ->Collect(snapshot);
+    EXPECT_EQ(snapshot.count, 1u);
+}
+
+}
+}
@@ -0,0 +1,197 @@
+//
+// Created by xucong on 25-9-25.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "condition_evaluator.h"
+
+#include <algorithm>
+
+#include "common/log/logger.h"
+
+namespace dcp::trigger
+{
+
+ConditionEvaluator::ConditionEvaluator(std::shared_ptr<SignalSlots> slots, size_t workers, int pollIntervalMs)
+    : slots_(slots ? std::move(slots) : std::make_shared<SignalSlots>()),
+      worker_count_(std::max<size_t>(1, workers)),
+      poll_interval_(std::max(1, pollIntervalMs)) {
+}
+
+ConditionEvaluator::~ConditionEvaluator() {
+    stop();
+}
+
+void ConditionEvaluator::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!workers_.empty()) {
+        return;
+    }
+    stopping_ = false;
+    next_poll_ = std::chrono::steady_clock::now() + poll_interval_;
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back(&ConditionEvaluator::workerLoop, this);
+    }
+    AD_INFO(ConditionEvaluator, "Started %d workers, poll interval %d ms.",
+            static_cast<int>(worker_count_), static_cast<int>(poll_interval_.count()));
+}
+
+void ConditionEvaluator::stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        workers.swap(workers_);
+    }
+    cond_.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ConditionEvaluator::addTrigger(const std::string& triggerId, int priority,
+                                    const std::shared_ptr<TriggerBase>& trigger) {
+    if (!trigger) {
+        return;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->triggerId = triggerId;
+    entry->priority = priority;
+    entry->trigger = trigger;
+    entry->variables = trigger->variables();
+    entry->polled = trigger->needsPolling();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = entries_[triggerId];
+    if (slot) {
+        slot->removed = true;
+    }
+    slot = entry;
+    rebuildGraph();
+    // 注册后先按当前信号值求值一次
+    enqueueLocked(entry);
+    AD_INFO(ConditionEvaluator, "Trigger [%s] added, priority: %d, variables: %d%s", triggerId.c_str(), priority,
+            static_cast<int>(entry->variables.size()), entry->polled ? ", polled" : "");
+}
+
+void ConditionEvaluator::removeTrigger(const std::string& triggerId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(triggerId);
+    if (it == entries_.end()) {
+        return;
+    }
+    // 已入队或正在执行的条目由工作线程看到removed后丢弃
+    it->second->removed = true;
+    entries_.erase(it);
+    rebuildGraph();
+    AD_INFO(ConditionEvaluator, "Trigger [%s] removed.", triggerId.c_str());
+}
+
+void ConditionEvaluator::rebuildGraph() {
+    auto graph = std::make_shared<Graph>();
+    for (const auto& [id, entry] : entries_) {
+        for (uint32_t slot : entry->variables) {
+            if (slot >= graph->dependents.size()) {
+                graph->dependents.resize(slot + 1);
+            }
+            graph->dependents[slot].push_back(entry);
+        }
+        if (entry->polled) {
+            graph->polled.push_back(entry);
+        }
+    }
+    std::atomic_store(&graph_, std::shared_ptr<const Graph>(std::move(graph)));
+}
+
+void ConditionEvaluator::update(uint32_t slot, double value) {
+    if (slot >= SignalSlots::kMaxSlots) {
+        return;
+    }
+    // 值不变也要写入，刷新时刻供过期检查；只有值变化才唤醒依赖的trigger
+    const bool changed = slots_->get(slot) != value;
+    slots_->set(slot, value);
+    if (changed) {
+        markDirty(slot);
+    }
+}
+
+void ConditionEvaluator::markDirty(uint32_t slot) {
+    const auto graph = std::atomic_load(&graph_);
+    if (slot >= graph->dependents.size() || graph->dependents[slot].empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : graph->dependents[slot]) {
+        enqueueLocked(entry);
+    }
+}
+
+void ConditionEvaluator::enqueueLocked(const EntryPtr& entry) {
+    if (entry->removed) {
+        return;
+    }
+    if (entry->running) {
+        entry->dirty = true;
+        return;
+    }
+    if (entry->queued) {
+        return;
+    }
+    entry->queued = true;
+    ready_.push(Ready{entry->priority, seq_++, entry});
+    cond_.notify_one();
+}
+
+void ConditionEvaluator::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (ready_.empty()) {
+            if (std::atomic_load(&graph_)->polled.empty()) {
+                cond_.wait(lock);
+            } else {
+                cond_.wait_until(lock, next_poll_);
+            }
+            if (stopping_) {
+                break;
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_poll_) {
+            next_poll_ = now + poll_interval_;
+            for (const auto& entry : std::atomic_load(&graph_)->polled) {
+                enqueueLocked(entry);
+            }
+        }
+        if (ready_.empty()) {
+            continue;
+        }
+
+        EntryPtr entry = ready_.top().entry;
+        ready_.pop();
+        entry->queued = false;
+        if (entry->removed) {
+            continue;
+        }
+        entry->running = true;
+        entry->dirty = false;
+        lock.unlock();
+
+        try {
+            entry->trigger->proc();
+        } catch (const std::exception& e) {
+            AD_ERROR(ConditionEvaluator, "Trigger [%s] proc failed: %s", entry->triggerId.c_str(), e.what());
+        }
+        evaluations_.fetch_add(1, std::memory_order_relaxed);
+
+        lock.lock();
+        entry->running = false;
+        if (entry->dirty) {
+            entry->dirty = false;
+            enqueueLocked(entry);
+        }
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+//
+// Created by xucong on 25-9-25.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CONDITION_EVALUATOR_H
+#define CONDITION_EVALUATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "trigger/trigger_base.h"
+#include "condition_program.h"
+
+namespace dcp::trigger
+{
+
+/**
+ * @brief 事件驱动的trigger求值。
+ *
+ * 维护 变量槽位 -> trigger 的依赖图：信号生产者通过update()写槽位，值变化时
+ * 只把依赖该槽位的trigger标记为dirty，由固定数量的工作线程按优先级执行proc()。
+ * 没有信号变化就没有求值，CPU开销随信号变化率而不是trigger数量增长，
+ * 触发延迟取决于信号到达而不是轮询周期。
+ *
+ * 变量值来自getter（拉取式，无变化通知）的trigger标记为polled，
+ * 仍按pollIntervalMs周期求值，由空闲工作线程在等待超时时投递。
+ *
+ * 同一个trigger不会被两个线程同时执行：执行期间再次变脏只记录标志，
+ * 执行完成后重新入队一次。
+ */
+class ConditionEvaluator {
+public:
+    ConditionEvaluator(std::shared_ptr<SignalSlots> slots, size_t workers = 2, int pollIntervalMs = 100);
+    ~ConditionEvaluator();
+    ConditionEvaluator(const ConditionEvaluator&) = delete;
+    ConditionEvaluator& operator=(const ConditionEvaluator&) = delete;
+
+    void start();
+    void stop();
+
+    /**
+     * @brief 注册trigger，按variables()建立依赖边；已存在同id时替换
+     * @param priority 数值越小越先执行，与PriorityScheduler一致
+     */
+    void addTrigger(const std::string& triggerId, int priority, const std::shared_ptr<TriggerBase>& trigger);
+    void removeTrigger(const std::string& triggerId);
+
+    // 写槽位并刷新写入时刻，值未变化时不产生求值
+    void update(uint32_t slot, double value);
+    // 槽位已由调用方写入（如批量写入后），只通知依赖方
+    void markDirty(uint32_t slot);
+
+    const std::shared_ptr<SignalSlots>& slots() const { return slots_; }
+    uint64_t evaluations() const { return evaluations_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::string triggerId;
+        int priority = 0;
+        std::shared_ptr<TriggerBase> trigger;
+        std::vector<uint32_t> variables;
+        bool polled = false;
+        // 以下状态受mutex_保护
+        bool queued = false;
+        bool running = false;
+        bool dirty = false;
+        bool removed = false;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    // 依赖图按槽位下标索引，写时复制，update()无锁读取
+    struct Graph {
+        std::vector<std::vector<EntryPtr>> dependents;
+        std::vector<EntryPtr> polled;
+    };
+
+    struct Ready {
+        int priority;
+        uint64_t seq;
+        EntryPtr entry;
+        bool operator<(const Ready& other) const {
+            return priority != other.priority ? priority > other.priority : seq > other.seq;
+        }
+    };
+
+    void rebuildGraph();
+    void enqueueLocked(const EntryPtr& entry);
+    void workerLoop();
+
+    std::shared_ptr<SignalSlots> slots_;
+    const size_t worker_count_;
+    const std::chrono::milliseconds poll_interval_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::priority_queue<Ready> ready_;
+    uint64_t seq_ = 0;
+    std::chrono::steady_clock::time_point next_poll_;
+    std::unordered_map<std::string, EntryPtr> entries_;
+    std::shared_ptr<const Graph> graph_ = std::make_shared<Graph>();
+
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    std::atomic<uint64_t> evaluations_{0};
+};
+
+}
+
+#endif // CONDITION_EVALUATOR_H
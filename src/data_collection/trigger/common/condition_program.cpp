@@ -0,0 +1,607 @@
+//
+// Created by xucong on 25-9-24.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "condition_program.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace dcp::trigger
+{
+
+SignalSlots::SignalSlots()
+    : cells_(new Cell[kMaxSlots]),
+      windowed_(new std::atomic<bool>[kMaxSlots]),
+      slot_windows_(new std::shared_ptr<const WindowList>[kMaxSlots]),
+      windows_(new std::atomic<SlidingWindow*>[kMaxWindows]) {
+    for (uint32_t i = 0; i < kMaxSlots; ++i) {
+        windowed_[i].store(false, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < kMaxWindows; ++i) {
+        windows_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+int64_t SignalSlots::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t SignalSlots::window(uint32_t slot, int64_t windowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (slot >= kMaxSlots) {
+        return kInvalidSlot;
+    }
+    for (uint32_t id = 0; id < window_storage_.size(); ++id) {
+        if (window_storage_[id]->windowUs() != windowUs) {
+            continue;
+        }
+        const auto list = std::atomic_load(&slot_windows_[slot]);
+        if (list && std::find(list->begin(), list->end(), window_storage_[id].get()) != list->end()) {
+            return id;
+        }
+    }
+    if (window_storage_.size() >= kMaxWindows) {
+        return kInvalidSlot;
+    }
+    auto window = std::make_unique<SlidingWindow>(windowUs);
+    // 以当前值作为进入值，注册前的信号状态不丢失
+    window->push(nowUs(), get(slot));
+    const auto id = static_cast<uint32_t>(window_storage_.size());
+    windows_[id].store(window.get(), std::memory_order_release);
+
+    auto list = std::make_shared<WindowList>();
+    if (const auto current = std::atomic_load(&slot_windows_[slot])) {
+        *list = *current;
+    }
+    list->push_back(window.get());
+    std::atomic_store(&slot_windows_[slot], std::shared_ptr<const WindowList>(std::move(list)));
+    windowed_[slot].store(true, std::memory_order_release);
+    window_storage_.push_back(std::move(window));
+    return id;
+}
+
+void SignalSlots::pushWindows(uint32_t slot, double value, int64_t stampUs) {
+    const auto list = std::atomic_load(&slot_windows_[slot]);
+    if (!list) {
+        return;
+    }
+    for (auto* window : *list) {
+        window->push(stampUs, value);
+    }
+}
+
+void SignalSlots::setTap(Tap tap) {
+    std::shared_ptr<const Tap> current = tap ? std::make_shared<const Tap>(std::move(tap)) : nullptr;
+    tapped_.store(current != nullptr, std::memory_order_release);
+    std::atomic_store(&tap_, std::move(current));
+}
+
+void SignalSlots::callTap(uint32_t slot, double value, int64_t stampUs) {
+    if (const auto tap = std::atomic_load(&tap_)) {
+        (*tap)(slot, value, stampUs);
+    }
+}
+
+uint32_t SignalSlots::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= kMaxSlots) {
+        return kInvalidSlot;
+    }
+    const auto slot = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    index_.emplace(name, slot);
+    return slot;
+}
+
+uint32_t SignalSlots::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(name);
+    return it != index_.end() ? it->second : kInvalidSlot;
+}
+
+std::string SignalSlots::name(uint32_t slot) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slot < names_.size() ? names_[slot] : std::string();
+}
+
+size_t SignalSlots::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+// 递归下降：or > and > not > 比较 > 加减 > 乘除 > 一元负号 > 基本项
+class ConditionProgram::Compiler {
+public:
+    Compiler(const std::string& text, SignalSlots& slots, ConditionProgram& program)
+        : text_(text), slots_(slots), program_(program) {}
+
+    bool run() {
+        next();
+        parseOr();
+        if (error_.empty() && token_ != Token::End) {
+            fail("unexpected '" + lexeme_ + "'");
+        }
+        if (!error_.empty()) {
+            program_.last_error_ = error_ + " in: " + text_;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    enum class Token { End, Number, Ident, Op, LParen, RParen, Comma };
+
+    void fail(const std::string& message) {
+        if (error_.empty()) {
+            error_ = message + " at " + std::to_string(token_pos_);
+        }
+    }
+
+    static bool keyword(const std::string& word, const char* kw) {
+        if (word.size() != std::char_traits<char>::length(kw)) return false;
+        for (size_t i = 0; i < word.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(word[i])) != kw[i]) return false;
+        }
+        return true;
+    }
+
+    void next() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        token_pos_ = pos_;
+        if (pos_ >= text_.size()) {
+            token_ = Token::End;
+            lexeme_ = "<end>";
+            return;
+        }
+        const char c = text_[pos_];
+        if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && pos_ + 1 < text_.size() &&
+                                                            std::isdigit(static_cast<unsigned char>(text_[pos_ + 1])))) {
+            char* end = nullptr;
+            number_ = std::strtod(text_.c_str() + pos_, &end);
+            const size_t len = static_cast<size_t>(end - (text_.c_str() + pos_));
+            lexeme_ = text_.substr(pos_, len);
+            pos_ += len;
+            token_ = Token::Number;
+            return;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t end = pos_;
+            while (end < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[end])) || text_[end] == '_')) ++end;
+            lexeme_ = text_.substr(pos_, end - pos_);
+            pos_ = end;
+            token_ = Token::Ident;
+            return;
+        }
+        if (c == ',') {
+            token_ = Token::Comma;
+            lexeme_ = ",";
+            ++pos_;
+            return;
+        }
+        if (c == '(' || c == ')') {
+            token_ = c == '(' ? Token::LParen : Token::RParen;
+            lexeme_ = std::string(1, c);
+            ++pos_;
+            return;
+        }
+        static const char* const kOps[] = {"&&", "||", ">=", "<=", "==", "!=", "<>",
+                                           ">", "<", "=", "!", "+", "-", "*", "/"};
+        for (const char* op : kOps) {
+            const size_t len = std::char_traits<char>::length(op);
+            if (text_.compare(pos_, len, op) == 0) {
+                lexeme_ = op;
+                pos_ += len;
+                token_ = Token::Op;
+                return;
+            }
+        }
+        lexeme_ = std::string(1, c);
+        fail("unknown character '" + lexeme_ + "'");
+        token_ = Token::End;
+    }
+
+    bool acceptOp(const char* op) {
+        if (token_ == Token::Op && lexeme_ == op) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    bool acceptKeyword(const char* kw) {
+        if (token_ == Token::Ident && keyword(lexeme_, kw)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    size_t emit(Op op, uint32_t arg = 0, double imm = 0.0) {
+        program_.code_.push_back(Instr{op, arg, imm});
+        switch (op) {
+            case Op::Const:
+            case Op::Load:
+            case Op::WinMin:
+            case Op::WinMax:
+            case Op::WinAvg:
+            case Op::WinCount:
+            case Op::WinDelta:
+                ++depth_;
+                break;
+            case Op::Neg:
+            case Op::Not:
+            case Op::Truth:
+            case Op::Held:
+            case Op::Rise:
+            case Op::Fall:
+            case Op::AndJump:  // 按完整求值计，不弹出
+            case Op::OrJump:
+                break;
+            default:
+                --depth_;  // 二元运算及AndTail/OrTail
+                break;
+        }
+        if (depth_ > kMaxStack) {
+            fail("expression too deep");
+        }
+        return program_.code_.size() - 1;
+    }
+
+    void patch(const std::vector<size_t>& jumps) {
+        for (size_t at : jumps) {
+            program_.code_[at].arg = static_cast<uint32_t>(program_.code_.size());
+        }
+    }
+
+    void parseOr() {
+        parseAnd();
+        std::vector<size_t> jumps;
+        while (error_.empty() && (acceptKeyword("or") || acceptOp("||"))) {
+            jumps.push_back(emit(Op::OrJump));
+            parseAnd();
+            emit(Op::OrTail);
+        }
+        patch(jumps);
+    }
+
+    void parseAnd() {
+        parseNot();
+        std::vector<size_t> jumps;
+        while (error_.empty() && (acceptKeyword("and") || acceptOp("&&"))) {
+            jumps.push_back(emit(Op::AndJump));
+            parseNot();
+            emit(Op::AndTail);
+        }
+        patch(jumps);
+    }
+
+    void parseNot() {
+        if (acceptKeyword("not") || acceptOp("!")) {
+            parseNot();
+            emit(Op::Not);
+            return;
+        }
+        parseCompare();
+    }
+
+    void parseCompare() {
+        parseSum();
+        while (error_.empty() && token_ == Token::Op) {
+            Op op;
+            if (lexeme_ == "<") op = Op::Lt;
+            else if (lexeme_ == "<=") op = Op::Le;
+            else if (lexeme_ == ">") op = Op::Gt;
+            else if (lexeme_ == ">=") op = Op::Ge;
+            else if (lexeme_ == "==" || lexeme_ == "=") op = Op::Eq;
+            else if (lexeme_ == "!=" || lexeme_ == "<>") op = Op::Ne;
+            else break;
+            next();
+            parseSum();
+            emit(op);
+        }
+    }
+
+    void parseSum() {
+        parseProduct();
+        while (error_.empty() && token_ == Token::Op && (lexeme_ == "+" || lexeme_ == "-")) {
+            const Op op = lexeme_ == "+" ? Op::Add : Op::Sub;
+            next();
+            parseProduct();
+            emit(op);
+        }
+    }
+
+    void parseProduct() {
+        parseUnary();
+        while (error_.empty() && token_ == Token::Op && (lexeme_ == "*" || lexeme_ == "/")) {
+            const Op op = lexeme_ == "*" ? Op::Mul : Op::Div;
+            next();
+            parseUnary();
+            emit(op);
+        }
+    }
+
+    void parseUnary() {
+        if (acceptOp("-")) {
+            parseUnary();
+            emit(Op::Neg);
+            return;
+        }
+        if (acceptOp("+")) {
+            parseUnary();
+            return;
+        }
+        parsePrimary();
+    }
+
+    void parsePrimary() {
+        if (!error_.empty()) return;
+        switch (token_) {
+            case Token::Number:
+                emit(Op::Const, 0, number_);
+                next();
+                return;
+            case Token::Ident: {
+                if (keyword(lexeme_, "true") || keyword(lexeme_, "false")) {
+                    emit(Op::Const, 0, keyword(lexeme_, "true") ? 1.0 : 0.0);
+                    next();
+                    return;
+                }
+                if (keyword(lexeme_, "and") || keyword(lexeme_, "or") || keyword(lexeme_, "not")) {
+                    fail("unexpected '" + lexeme_ + "'");
+                    return;
+                }
+                const std::string name = lexeme_;
+                next();
+                if (token_ == Token::LParen) {
+                    parseCall(name);
+                    return;
+                }
+                const uint32_t slot = variable(name);
+                if (slot != SignalSlots::kInvalidSlot) {
+                    emit(Op::Load, slot);
+                }
+                return;
+            }
+            case Token::LParen:
+                next();
+                parseOr();
+                if (token_ != Token::RParen) {
+                    fail("missing ')'");
+                    return;
+                }
+                next();
+                return;
+            default:
+                fail(token_ == Token::End ? "unexpected end" : "unexpected '" + lexeme_ + "'");
+                return;
+        }
+    }
+
+    uint32_t variable(const std::string& name) {
+        const uint32_t slot = slots_.intern(name);
+        if (slot == SignalSlots::kInvalidSlot) {
+            fail("too many variables");
+            return slot;
+        }
+        if (std::find(program_.variables_.begin(), program_.variables_.end(), slot) == program_.variables_.end()) {
+            program_.variables_.push_back(slot);
+        }
+        return slot;
+    }
+
+    bool expect(Token token, const char* what) {
+        if (token_ != token) {
+            fail(std::string("expected ") + what);
+            return false;
+        }
+        next();
+        return true;
+    }
+
+    // 窗口长度，毫秒，正数
+    bool parseWindowMs(double& ms) {
+        if (!expect(Token::Comma, "','")) return false;
+        if (token_ != Token::Number || number_ <= 0.0) {
+            fail("expected window length in ms");
+            return false;
+        }
+        ms = number_;
+        next();
+        return expect(Token::RParen, "')'");
+    }
+
+    uint32_t newState() {
+        program_.states_.emplace_back();
+        return static_cast<uint32_t>(program_.states_.size() - 1);
+    }
+
+    void parseCall(const std::string& fn) {
+        next();  // '('
+        static const std::pair<const char*, Op> kWindowOps[] = {
+            {"min", Op::WinMin}, {"max", Op::WinMax}, {"avg", Op::WinAvg},
+            {"count", Op::WinCount}, {"delta", Op::WinDelta},
+        };
+        for (const auto& [name, op] : kWindowOps) {
+            if (!keyword(fn, name)) continue;
+            if (token_ != Token::Ident) {
+                fail(fn + "() expects a signal name");
+                return;
+            }
+            const uint32_t slot = variable(lexeme_);
+            next();
+            double ms = 0.0;
+            if (slot == SignalSlots::kInvalidSlot || !parseWindowMs(ms)) return;
+            const uint32_t window = slots_.window(slot, static_cast<int64_t>(ms * 1000.0));
+            if (window == SignalSlots::kInvalidSlot) {
+                fail("too many windows");
+                return;
+            }
+            emit(op, window);
+            program_.time_dependent_ = true;
+            return;
+        }
+        if (keyword(fn, "held")) {
+            parseOr();
+            double ms = 0.0;
+            if (!error_.empty() || !parseWindowMs(ms)) return;
+            emit(Op::Held, newState(), ms * 1000.0);
+            program_.eager_ = true;
+            program_.time_dependent_ = true;
+            return;
+        }
+        if (keyword(fn, "rise") || keyword(fn, "fall")) {
+            parseOr();
+            if (!error_.empty() || !expect(Token::RParen, "')'")) return;
+            emit(keyword(fn, "rise") ? Op::Rise : Op::Fall, newState());
+            program_.eager_ = true;
+            return;
+        }
+        fail("unknown function '" + fn + "'");
+    }
+
+    const std::string& text_;
+    SignalSlots& slots_;
+    ConditionProgram& program_;
+    size_t pos_ = 0;
+    size_t token_pos_ = 0;
+    Token token_ = Token::End;
+    std::string lexeme_;
+    double number_ = 0.0;
+    int depth_ = 0;
+    std::string error_;
+};
+
+bool ConditionProgram::compile(const std::string& condition, SignalSlots& slots) {
+    code_.clear();
+    variables_.clear();
+    states_.clear();
+    eager_ = false;
+    time_dependent_ = false;
+    last_error_.clear();
+    if (!Compiler(condition, slots, *this).run()) {
+        code_.clear();
+        variables_.clear();
+        states_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ConditionProgram::evaluate(const SignalSlots& slots) const {
+    if (code_.empty()) {
+        return false;
+    }
+    double stack[kMaxStack];
+    int top = -1;
+    const int64_t now = time_dependent_ ? SignalSlots::nowUs() : 0;
+    const size_t n = code_.size();
+    for (size_t pc = 0; pc < n; ++pc) {
+        const Instr& in = code_[pc];
+        switch (in.op) {
+            case Op::Const: stack[++top] = in.imm; break;
+            case Op::Load: stack[++top] = slots.get(in.arg); break;
+            case Op::Add: --top; stack[top] += stack[top + 1]; break;
+            case Op::Sub: --top; stack[top] -= stack[top + 1]; break;
+            case Op::Mul: --top; stack[top] *= stack[top + 1]; break;
+            case Op::Div: --top; stack[top] /= stack[top + 1]; break;
+            case Op::Neg: stack[top] = -stack[top]; break;
+            case Op::Lt: --top; stack[top] = stack[top] < stack[top + 1] ? 1.0 : 0.0; break;
+            case Op::Le: --top; stack[top] = stack[top] <= stack[top + 1] ? 1.0 : 0.0; break;
+            case Op::Gt: --top; stack[top] = stack[top] > stack[top + 1] ? 1.0 : 0.0; break;
+            case Op::Ge: --top; stack[top] = stack[top] >= stack[top + 1] ? 1.0 : 0.0; break;
+            case Op::Eq:
+            case Op::Ne: {
+                // 与exprtk一致的相对误差比较
+                --top;
+                const double a = stack[top];
+                const double b = stack[top + 1];
+                const double scale = std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+                const bool equal = std::fabs(a - b) <= scale * 1e-10;
+                stack[top] = (equal == (in.op == Op::Eq)) ? 1.0 : 0.0;
+                break;
+            }
+            case Op::Not: stack[top] = stack[top] == 0.0 ? 1.0 : 0.0; break;
+            case Op::Truth: stack[top] = stack[top] != 0.0 ? 1.0 : 0.0; break;
+            case Op::AndTail:
+                if (eager_) {
+                    --top;
+                    stack[top] = (stack[top] != 0.0 && stack[top + 1] != 0.0) ? 1.0 : 0.0;
+                } else {
+                    stack[top] = stack[top] != 0.0 ? 1.0 : 0.0;
+                }
+                break;
+            case Op::OrTail:
+                if (eager_) {
+                    --top;
+                    stack[top] = (stack[top] != 0.0 || stack[top + 1] != 0.0) ? 1.0 : 0.0;
+                } else {
+                    stack[top] = stack[top] != 0.0 ? 1.0 : 0.0;
+                }
+                break;
+            case Op::WinMin: stack[++top] = slots.windowAt(in.arg).min(now); break;
+            case Op::WinMax: stack[++top] = slots.windowAt(in.arg).max(now); break;
+            case Op::WinAvg: stack[++top] = slots.windowAt(in.arg).avg(now); break;
+            case Op::WinCount: stack[++top] = slots.windowAt(in.arg).count(now); break;
+            case Op::WinDelta: stack[++top] = slots.windowAt(in.arg).delta(now); break;
+            case Op::Held: {
+                State& state = states_[in.arg];
+                if (stack[top] != 0.0) {
+                    if (state.sinceUs < 0) {
+                        state.sinceUs = now;
+                    }
+                    stack[top] = static_cast<double>(now - state.sinceUs) >= in.imm ? 1.0 : 0.0;
+                } else {
+                    state.sinceUs = -1;
+                    stack[top] = 0.0;
+                }
+                break;
+            }
+            case Op::Rise:
+            case Op::Fall: {
+                State& state = states_[in.arg];
+                const int8_t value = stack[top] != 0.0 ? 1 : 0;
+                const int8_t edge_from = in.op == Op::Rise ? 0 : 1;
+                stack[top] = (state.last == edge_from && value != edge_from) ? 1.0 : 0.0;
+                state.last = value;
+                break;
+            }
+            case Op::AndJump:
+                if (eager_) {
+                    break;
+                }
+                if (stack[top] == 0.0) {
+                    stack[top] = 0.0;
+                    pc = in.arg - 1;
+                } else {
+                    --top;
+                }
+                break;
+            case Op::OrJump:
+                if (eager_) {
+                    break;
+                }
+                if (stack[top] != 0.0) {
+                    stack[top] = 1.0;
+                    pc = in.arg - 1;
+                } else {
+                    --top;
+                }
+                break;
+        }
+    }
+    return top == 0 && stack[0] != 0.0;
+}
+
+}
@@ -0,0 +1,199 @@
+//
+// Created by xucong on 25-9-24.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CONDITION_PROGRAM_H
+#define CONDITION_PROGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sliding_window.h"
+
+namespace dcp::trigger
+{
+
+/**
+ * @brief 条件变量的槽位表，变量名在编译条件时映射为固定下标。
+ *
+ * 数值存放在预分配的定长数组中，下标在整个进程生命周期内不变，
+ * 信号生产者intern一次后按下标写入，求值时按下标读取，不涉及字符串。
+ * 条件中用到窗口聚合的槽位挂有滑动窗口，写入时顺带更新；没有窗口的槽位只多一次原子读。
+ *
+ * 每个槽位同时记录最近写入时刻和写入序号，按seqlock写入：get()只读数值，单次原子读；
+ * sample()读取一致的 {值, 时刻, 序号}，写入进行中时重试。trigger据此判断信号是否过期，
+ * 规划和状态机等模块也可直接读取同一张表。
+ */
+class SignalSlots {
+public:
+    static constexpr uint32_t kMaxSlots = 4096;
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+    static constexpr uint32_t kMaxWindows = 1024;
+
+    // 槽位的一致快照；seq为累计写入次数，0表示从未写入
+    struct Sample {
+        double value = 0.0;
+        int64_t stampUs = 0;
+        uint64_t seq = 0;
+    };
+
+    SignalSlots();
+
+    // 已存在返回原下标，槽位用尽返回kInvalidSlot
+    uint32_t intern(const std::string& name);
+    uint32_t find(const std::string& name) const;
+    std::string name(uint32_t slot) const;
+    size_t size() const;
+
+    void set(uint32_t slot, double value) { set(slot, value, nowUs()); }
+    // stampUs为nowUs()时钟下的采样时刻
+    void set(uint32_t slot, double value, int64_t stampUs) {
+        Cell& cell = cells_[slot];
+        // 同一槽位可能有多个写者（消息解析、getter刷新），先把序号从偶数抢到奇数
+        uint64_t seq = cell.seq.load(std::memory_order_relaxed);
+        do {
+            while (seq & 1) {
+                seq = cell.seq.load(std::memory_order_relaxed);
+            }
+        } while (!cell.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+        cell.value.store(value, std::memory_order_relaxed);
+        cell.stampUs.store(stampUs, std::memory_order_relaxed);
+        cell.seq.store(seq + 2, std::memory_order_release);
+        if (windowed_[slot].load(std::memory_order_acquire)) {
+            pushWindows(slot, value, stampUs);
+        }
+        if (tapped_.load(std::memory_order_acquire)) {
+            callTap(slot, value, stampUs);
+        }
+    }
+    double get(uint32_t slot) const { return cells_[slot].value.load(std::memory_order_relaxed); }
+
+    Sample sample(uint32_t slot) const {
+        const Cell& cell = cells_[slot];
+        Sample sample;
+        for (;;) {
+            const uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            sample.value = cell.value.load(std::memory_order_relaxed);
+            sample.stampUs = cell.stampUs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (cell.seq.load(std::memory_order_relaxed) == seq) {
+                sample.seq = seq >> 1;
+                return sample;
+            }
+        }
+    }
+
+    // 为槽位注册滑动窗口，同一槽位同一长度共享一个；用尽返回kInvalidSlot
+    uint32_t window(uint32_t slot, int64_t windowUs);
+    SlidingWindow& windowAt(uint32_t id) const { return *windows_[id].load(std::memory_order_acquire); }
+
+    // 窗口和时间算子使用的单调时钟
+    static int64_t nowUs();
+
+    // 每次写入后在写者线程回调，供录制模块记录信号历史；只有一个，nullptr取消
+    using Tap = std::function<void(uint32_t slot, double value, int64_t stampUs)>;
+    void setTap(Tap tap);
+
+private:
+    using WindowList = std::vector<SlidingWindow*>;
+
+    // 32字节对齐，一个槽位不跨缓存行
+    struct alignas(32) Cell {
+        std::atomic<uint64_t> seq{0};  // 奇数表示正在写入
+        std::atomic<double> value{0.0};
+        std::atomic<int64_t> stampUs{0};
+    };
+
+    void pushWindows(uint32_t slot, double value, int64_t stampUs);
+    void callTap(uint32_t slot, double value, int64_t stampUs);
+
+    std::unique_ptr<Cell[]> cells_;
+    std::unique_ptr<std::atomic<bool>[]> windowed_;
+    std::unique_ptr<std::shared_ptr<const WindowList>[]> slot_windows_;
+    std::unique_ptr<std::atomic<SlidingWindow*>[]> windows_;
+    std::vector<std::unique_ptr<SlidingWindow>> window_storage_;
+    std::atomic<bool> tapped_{false};
+    std::shared_ptr<const Tap> tap_;  // 只通过std::atomic_load/atomic_store访问
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<std::string> names_;
+};
+
+/**
+ * @brief 触发条件编译后的字节码。
+ *
+ * 支持 and/or/not（及 && || !）、比较运算、四则运算、括号、数字和 true/false，
+ * 与原exprtk表达式写法兼容；and/or短路求值。编译时变量替换为槽位下标，
+ * 求值是一段定长栈上的顺序执行，不分配内存，可被多个线程同时调用。
+ *
+ * 时间算子（ms为窗口长度，毫秒）：
+ *  - min(x, ms) max(x, ms) avg(x, ms) count(x, ms) delta(x, ms)：信号x的窗口聚合，
+ *    avg按每个值的保持时长加权，如 "max(speed, 1000) - speed > 3" 表示1s内降速超过3m/s；
+ *  - held(cond, ms)：cond连续成立至少ms；
+ *  - rise(cond) fall(cond)：cond相对上次求值由假变真/由真变假，首次求值为假。
+ * 带held/rise/fall的程序保存求值状态，只能由一个线程按时间顺序求值，此时and/or
+ * 改为完整求值，保证每次都更新状态。
+ */
+class ConditionProgram {
+public:
+    bool compile(const std::string& condition, SignalSlots& slots);
+    bool evaluate(const SignalSlots& slots) const;
+
+    bool valid() const { return !code_.empty(); }
+    // 结果会随时间变化（窗口过期、held计时），信号不变时也需要周期求值
+    bool timeDependent() const { return time_dependent_; }
+    // 条件中引用的变量槽位，去重
+    const std::vector<uint32_t>& variables() const { return variables_; }
+    const std::string& lastError() const { return last_error_; }
+
+private:
+    enum class Op : uint8_t {
+        Const, Load,
+        Add, Sub, Mul, Div, Neg,
+        Lt, Le, Gt, Ge, Eq, Ne,
+        Not, Truth,
+        AndJump, OrJump,  // 栈顶已能决定结果时跳转，否则弹出继续；完整求值时不动作
+        AndTail, OrTail,  // 右操作数之后：短路时同Truth，完整求值时合并两个操作数
+        WinMin, WinMax, WinAvg, WinCount, WinDelta,
+        Held, Rise, Fall,
+    };
+
+    struct State {
+        int8_t last = -1;      // rise/fall上次的值，-1未知
+        int64_t sinceUs = -1;  // held开始成立的时刻
+    };
+
+    struct Instr {
+        Op op;
+        uint32_t arg;  // 槽位、窗口、状态下标或跳转目标
+        double imm;
+    };
+
+    static constexpr int kMaxStack = 64;
+
+    class Compiler;
+
+    std::vector<Instr> code_;
+    std::vector<uint32_t> variables_;
+    mutable std::vector<State> states_;
+    bool eager_ = false;
+    bool time_dependent_ = false;
+    std::string last_error_;
+};
+
+}
+
+#endif // CONDITION_PROGRAM_H
@@ -0,0 +1,104 @@
+//
+// Created by xucong on 25-9-27.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "sliding_window.h"
+
+#include <algorithm>
+
+namespace dcp::trigger
+{
+
+void SlidingWindow::push(int64_t nowUs, double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!samples_.empty()) {
+        area_ += samples_.back().second * static_cast<double>(nowUs - samples_.back().first);
+    }
+    samples_.emplace_back(nowUs, value);
+    while (!min_queue_.empty() && min_queue_.back().second >= value) {
+        min_queue_.pop_back();
+    }
+    min_queue_.emplace_back(nowUs, value);
+    while (!max_queue_.empty() && max_queue_.back().second <= value) {
+        max_queue_.pop_back();
+    }
+    max_queue_.emplace_back(nowUs, value);
+    evict(nowUs);
+}
+
+void SlidingWindow::evict(int64_t nowUs) {
+    // 保留窗口起点之前的最后一个样本作为进入值
+    const int64_t start = nowUs - window_us_;
+    while (samples_.size() > 1 && samples_[1].first <= start) {
+        area_ -= samples_.front().second * static_cast<double>(samples_[1].first - samples_.front().first);
+        samples_.pop_front();
+        ++evicted_;
+    }
+    if (samples_.empty()) {
+        return;
+    }
+    if (evicted_ >= samples_.size()) {
+        evicted_ = 0;
+        area_ = 0.0;
+        for (size_t i = 1; i < samples_.size(); ++i) {
+            area_ += samples_[i - 1].second * static_cast<double>(samples_[i].first - samples_[i - 1].first);
+        }
+    }
+    const int64_t oldest = samples_.front().first;
+    while (!min_queue_.empty() && min_queue_.front().first < oldest) {
+        min_queue_.pop_front();
+    }
+    while (!max_queue_.empty() && max_queue_.front().first < oldest) {
+        max_queue_.pop_front();
+    }
+}
+
+double SlidingWindow::min(int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(nowUs);
+    return min_queue_.empty() ? 0.0 : min_queue_.front().second;
+}
+
+double SlidingWindow::max(int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(nowUs);
+    return max_queue_.empty() ? 0.0 : max_queue_.front().second;
+}
+
+double SlidingWindow::avg(int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(nowUs);
+    if (samples_.empty()) {
+        return 0.0;
+    }
+    const Sample& first = samples_.front();
+    const Sample& last = samples_.back();
+    // 进入值只计窗口起点之后的部分
+    const int64_t begin = std::max(nowUs - window_us_, first.first);
+    if (nowUs <= begin || nowUs < last.first) {
+        return last.second;
+    }
+    const double area = area_ + last.second * static_cast<double>(nowUs - last.first) -
+                        first.second * static_cast<double>(begin - first.first);
+    return area / static_cast<double>(nowUs - begin);
+}
+
+double SlidingWindow::count(int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(nowUs);
+    if (samples_.empty()) {
+        return 0.0;
+    }
+    const bool carried = samples_.front().first <= nowUs - window_us_;
+    return static_cast<double>(samples_.size() - (carried ? 1 : 0));
+}
+
+double SlidingWindow::delta(int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(nowUs);
+    return samples_.empty() ? 0.0 : samples_.back().second - samples_.front().second;
+}
+
+}
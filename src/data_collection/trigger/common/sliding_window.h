@@ -0,0 +1,60 @@
+//
+// Created by xucong on 25-9-27.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef SLIDING_WINDOW_H
+#define SLIDING_WINDOW_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace dcp::trigger
+{
+
+/**
+ * @brief 单个信号在固定时间窗口内的增量聚合。
+ *
+ * 信号按阶梯函数处理：窗口起点之前的最后一个样本（进入值）仍参与min/max/avg，
+ * 信号长时间不变时窗口内的值就是它的当前值。avg按时间加权，每个值以保持到下一个
+ * 样本（或当前时刻）的时长为权重，采样不均匀时不偏向密集的一段；窗口内第一个
+ * 样本之前没有数据的部分不计入。min/max用单调队列，avg用滑动的面积和，每次写入
+ * 和查询均摊O(1)。
+ */
+class SlidingWindow {
+public:
+    explicit SlidingWindow(int64_t windowUs) : window_us_(windowUs) {}
+
+    void push(int64_t nowUs, double value);
+
+    // 窗口内无任何样本时返回0
+    double min(int64_t nowUs);
+    double max(int64_t nowUs);
+    double avg(int64_t nowUs);
+    // 窗口内的写入次数，不含进入值
+    double count(int64_t nowUs);
+    // 当前值减去窗口起点时刻的值
+    double delta(int64_t nowUs);
+
+    int64_t windowUs() const { return window_us_; }
+
+private:
+    using Sample = std::pair<int64_t, double>;
+
+    void evict(int64_t nowUs);
+
+    const int64_t window_us_;
+    std::mutex mutex_;
+    std::deque<Sample> samples_;
+    std::deque<Sample> min_queue_;  // 值单调递增
+    std::deque<Sample> max_queue_;  // 值单调递减
+    double area_ = 0.0;   // 首个到最后一个样本之间阶梯函数的积分，值×微秒
+    size_t evicted_ = 0;  // 每淘汰一轮样本重算一次area_，消除浮点累积误差
+};
+
+}
+
+#endif // SLIDING_WINDOW_H
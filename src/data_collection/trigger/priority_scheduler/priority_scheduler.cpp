@@ -25,10 +25,32 @@ PriorityScheduler::~PriorityScheduler() {
 
 void PriorityScheduler::AddTask(TriggerTask task) {
     std::lock_guard<std::mutex> lock(queue_mutex_);
+    stop_flags_[task.triggerId] = std::make_shared<std::atomic<bool>>(false);
     trigger_queue_.emplace(std::move(task));
     condition_.notify_one();
 }
 
+void PriorityScheduler::RemoveTask(const std::string& triggerId) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    auto it = stop_flags_.find(triggerId);
+    if (it != stop_flags_.end()) {
+        it->second->store(true);
+        stop_flags_.erase(it);
+    }
+
+    // 还未调度的任务直接从队列中剔除
+    TaskPriorityQueue remaining;
+    while (!trigger_queue_.empty()) {
+        auto task = std::move(const_cast<TriggerTask&>(trigger_queue_.top()));
+        trigger_queue_.pop();
+        if (task.triggerId != triggerId) {
+            remaining.emplace(std::move(task));
+        }
+    }
+    trigger_queue_ = std::move(remaining);
+    AD_INFO(PriorityScheduler, "Task [%s] removed.", triggerId.c_str());
+}
+
 void PriorityScheduler::StartScheduling() {
     std::lock_guard<std::mutex> lock(queue_mutex_);
 
@@ -51,6 +73,7 @@ void PriorityScheduler::ScheduleTasks() {
 void PriorityScheduler::ProcessOneTriggerQueue() {
     while (!stop_scheduling_.load()) {
         std::unique_ptr<TriggerTask> highest_priority_task;
+        std::shared_ptr<std::atomic<bool>> stop;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             condition_.wait_for(lock, std::chrono::milliseconds(100), [this] {
@@ -65,14 +88,19 @@ void PriorityScheduler::ProcessOneTriggerQueue() {
             std::cout << "[PriorityScheduler] Processing for " << highest_priority_task->triggerId << " with priority("
                 << static_cast<int>(highest_priority_task->priority) << ").\n";
             trigger_queue_.pop();
+            auto& flag = stop_flags_[highest_priority_task->triggerId];
+            if (!flag) {
+                flag = std::make_shared<std::atomic<bool>>(false);
+            }
+            stop = flag;
         }
 
         if (highest_priority_task && !highest_priority_task->cancelled) {
-            thread_pool_->enqueue([this, task = std::move(*highest_priority_task)]() {
+            thread_pool_->enqueue([this, stop, task = std::move(*highest_priority_task)]() {
                 // std::cout << "[PriorityScheduler] Processing for " << task.trigger_name << " with priority("
                 //           << static_cast<int>(task.priority) << ").\n";
                 // task.trigger->Proc();
-                while (!task.cancelled) {
+                while (!task.cancelled && !stop->load()) {
                     task.trigger->proc();
                     std::this_thread::sleep_for(std::chrono::milliseconds(100));
                 }
@@ -21,6 +21,7 @@ public:
     PriorityScheduler(std::shared_ptr<ThreadPool> threadPool);
     ~PriorityScheduler() override;
     void AddTask(TriggerTask task) override;
+    void RemoveTask(const std::string& triggerId) override;
     void StartScheduling() override;
 
 private:
@@ -37,6 +38,8 @@ private:
     std::condition_variable condition_;
     std::thread scheduling_thread_;
     std::atomic<bool> stop_scheduling_{ false};
+    // 每个trigger一个停止标志，线程池中的轮询循环据此退出，受queue_mutex_保护
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>> stop_flags_;
 
     //
     TaskPriorityQueue waiting_queue_;
@@ -7,6 +7,7 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include "../trigger_base.h"
@@ -19,6 +20,7 @@ enum class TaskState { WAITING, RUNNING, PAUSED, FINISHED };
 struct TriggerTask {
     std::string triggerId;
     int8_t priority;
+    std::chrono::milliseconds period{100}; // 周期调度的求值间隔
     std::shared_ptr<TriggerBase> trigger;
     StrategyConfig strategyConfig;
     bool cancelled = false;
@@ -33,6 +35,8 @@ class Scheduler {
 public:
     virtual ~Scheduler() = default;
     virtual void AddTask(TriggerTask task) = 0;
+    // 停止并移除trigger的任务，策略热更新时使用
+    virtual void RemoveTask(const std::string& triggerId) = 0;
     virtual void StartScheduling() = 0;
 };
 
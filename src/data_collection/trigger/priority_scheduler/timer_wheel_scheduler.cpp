@@ -0,0 +1,375 @@
+//
+// Created by xucong on 25-9-26.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "timer_wheel_scheduler.h"
+
+#include <algorithm>
+
+#include "common/log/logger.h"
+#include "common/metrics/metrics_registry.h"
+
+namespace dcp::trigger
+{
+
+TimerWheelScheduler::TimerWheelScheduler(size_t workers, int tickMs, const std::string& name)
+    : name_(name),
+      worker_count_(std::max<size_t>(2, workers)),
+      max_once_running_(worker_count_ - 1),
+      tick_(std::max(1, tickMs)),
+      origin_(std::chrono::steady_clock::now()) {}
+
+TimerWheelScheduler::~TimerWheelScheduler() {
+    Stop();
+}
+
+void TimerWheelScheduler::StartScheduling() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timer_thread_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    timer_thread_ = std::thread(&TimerWheelScheduler::TimerLoop, this);
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back(&TimerWheelScheduler::WorkerLoop, this);
+    }
+    AD_INFO(TimerWheelScheduler, "Started with %d workers, tick %d ms, %d jobs.",
+            static_cast<int>(worker_count_), static_cast<int>(tick_.count()), static_cast<int>(jobs_.size()));
+}
+
+void TimerWheelScheduler::Stop() {
+    std::thread timer;
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        timer.swap(timer_thread_);
+        workers.swap(workers_);
+        for (const auto& job : running_) {
+            job->preempted.store(true);
+        }
+    }
+    timer_cond_.notify_all();
+    worker_cond_.notify_all();
+    if (timer.joinable()) {
+        timer.join();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TimerWheelScheduler::AddTask(TriggerTask task) {
+    auto job = std::make_shared<Job>();
+    job->name = task.triggerId;
+    job->priority = task.priority;
+    // 周期取整到tick，期限落在tick边界上，抖动只反映调度延迟
+    const int64_t period_ticks = std::max<int64_t>(1, task.period / tick_);
+    job->period = tick_ * period_ticks;
+    job->periodic = [trigger = task.trigger]() {
+        trigger->proc();
+    };
+    // 按id错开首次期限，避免几百个同周期trigger挤在同一个tick
+    const auto offset = std::hash<std::string>{}(task.triggerId) % static_cast<size_t>(period_ticks);
+    BindMetrics(*job);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    job->deadline = origin_ + tick_ * (TickOf(std::chrono::steady_clock::now()) + offset);
+    auto it = trigger_jobs_.find(task.triggerId);
+    if (it != trigger_jobs_.end()) {
+        if (auto old = jobs_.find(it->second); old != jobs_.end()) {
+            old->second->cancelled = true;
+            jobs_.erase(old);
+        }
+    }
+    job->id = next_id_++;
+    jobs_[job->id] = job;
+    trigger_jobs_[task.triggerId] = job->id;
+    InsertLocked(job);
+}
+
+void TimerWheelScheduler::RemoveTask(const std::string& triggerId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = trigger_jobs_.find(triggerId);
+    if (it == trigger_jobs_.end()) {
+        return;
+    }
+    // 时间轮和就绪队列中的条目惰性丢弃，正在执行的本次结束后不再重新挂入
+    if (auto job = jobs_.find(it->second); job != jobs_.end()) {
+        job->second->cancelled = true;
+        jobs_.erase(job);
+    }
+    trigger_jobs_.erase(it);
+    AD_INFO(TimerWheelScheduler, "Task [%s] removed.", triggerId.c_str());
+}
+
+TimerWheelScheduler::JobId TimerWheelScheduler::ScheduleOnce(const std::string& name, int8_t priority,
+                                                             std::chrono::milliseconds delay, PreemptibleJob job) {
+    if (!job) {
+        return 0;
+    }
+    auto entry = std::make_shared<Job>();
+    entry->name = name;
+    entry->priority = priority;
+    entry->once = std::move(job);
+    entry->deadline = std::chrono::steady_clock::now() + delay;
+    BindMetrics(*entry);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->id = next_id_++;
+    jobs_[entry->id] = entry;
+    InsertLocked(entry);
+    return entry->id;
+}
+
+void TimerWheelScheduler::BindMetrics(Job& job) const {
+    // 同名任务共用一组指标，查找只在加入任务时发生
+    auto& registry = common::MetricsRegistry::getInstance();
+    const common::MetricLabels labels = {{"scheduler", name_}, {"job", job.name}};
+    job.lateness = registry.GetHistogram("dcp_scheduler_lateness_seconds",
+                                         "Delay between a job's deadline and its start.", labels);
+    job.overruns = registry.GetCounter("dcp_scheduler_overruns_total",
+                                       "Periods skipped because a job was still running or started too late.", labels);
+    job.preemptions = registry.GetCounter("dcp_scheduler_preemptions_total",
+                                          "Times a one-shot job yielded to a higher-priority job.", labels);
+}
+
+void TimerWheelScheduler::AddOverrunsLocked(Job& job, uint64_t count) {
+    job.stats.overruns += count;
+    job.overruns->Add(count);
+}
+
+uint64_t TimerWheelScheduler::TickOf(std::chrono::steady_clock::time_point tp) const {
+    if (tp <= origin_) {
+        return 0;
+    }
+    // 向上取整：在期限之后的第一个tick到期
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(tp - origin_).count();
+    const auto tick_us = std::chrono::duration_cast<std::chrono::microseconds>(tick_).count();
+    return static_cast<uint64_t>((elapsed + tick_us - 1) / tick_us);
+}
+
+void TimerWheelScheduler::InsertLocked(const JobPtr& job) {
+    uint64_t expiry = TickOf(job->deadline);
+    if (expiry <= current_tick_) {
+        MakeReadyLocked(job);
+        return;
+    }
+    constexpr uint64_t kMaxDelta = (1ull << (kSlotBits * kLevels)) - 1;
+    uint64_t delta = expiry - current_tick_;
+    if (delta > kMaxDelta) {
+        // 超出时间轮范围的挂在最高层，级联时按真实期限重新计算位置
+        delta = kMaxDelta;
+        expiry = current_tick_ + delta;
+    }
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    const uint64_t slot = (expiry >> (kSlotBits * level)) & (kSlots - 1);
+    wheel_[level][slot].push_back(job);
+}
+
+void TimerWheelScheduler::MakeReadyLocked(const JobPtr& job) {
+    if (job->once) {
+        once_ready_.push(Ready{job->priority, seq_++, job});
+        if (!OnceSlotFreeLocked()) {
+            PreemptLocked(job->priority);
+        }
+    } else {
+        ready_.push(Ready{job->priority, seq_++, job});
+    }
+    worker_cond_.notify_one();
+}
+
+bool TimerWheelScheduler::OnceSlotFreeLocked() const {
+    return once_running_ - once_yielding_ < max_once_running_;
+}
+
+bool TimerWheelScheduler::HasRunnableLocked() const {
+    return !ready_.empty() || (!once_ready_.empty() && OnceSlotFreeLocked());
+}
+
+TimerWheelScheduler::JobPtr TimerWheelScheduler::PopRunnableLocked() {
+    const bool once_allowed = !once_ready_.empty() && OnceSlotFreeLocked();
+    auto& queue = (once_allowed && (ready_.empty() || once_ready_.top().priority < ready_.top().priority))
+                  ? once_ready_ : ready_;
+    JobPtr job = queue.top().job;
+    queue.pop();
+    return job;
+}
+
+void TimerWheelScheduler::PreemptLocked(int8_t priority) {
+    Job* victim = nullptr;
+    for (const auto& job : running_) {
+        if (job->once && job->priority > priority && !job->yielding && !job->preempted.load() &&
+            (!victim || job->priority > victim->priority)) {
+            victim = job.get();
+        }
+    }
+    if (victim) {
+        victim->yielding = true;
+        ++once_yielding_;
+        victim->preempted.store(true);
+        AD_INFO(TimerWheelScheduler, "Preempt [%s] (priority %d) for priority %d.",
+                victim->name.c_str(), victim->priority, priority);
+    }
+}
+
+void TimerWheelScheduler::AdvanceLocked(uint64_t target_tick) {
+    while (current_tick_ < target_tick) {
+        ++current_tick_;
+        // 低层转完一圈时，把高层对应槽位的任务重新分配到低层
+        for (int level = 1; level < kLevels; ++level) {
+            const uint64_t mask = (1ull << (kSlotBits * level)) - 1;
+            if ((current_tick_ & mask) != 0) {
+                break;
+            }
+            const uint64_t slot = (current_tick_ >> (kSlotBits * level)) & (kSlots - 1);
+            std::vector<JobPtr> jobs;
+            jobs.swap(wheel_[level][slot]);
+            for (const auto& job : jobs) {
+                if (!job->cancelled) {
+                    InsertLocked(job);
+                }
+            }
+        }
+
+        std::vector<JobPtr> due;
+        due.swap(wheel_[0][current_tick_ & (kSlots - 1)]);
+        for (const auto& job : due) {
+            if (job->cancelled) {
+                continue;
+            }
+            if (TickOf(job->deadline) > current_tick_) {
+                InsertLocked(job);
+            } else {
+                MakeReadyLocked(job);
+            }
+        }
+    }
+}
+
+void TimerWheelScheduler::TimerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto next_stats = std::chrono::steady_clock::now() + std::chrono::seconds(kStatsLogIntervalSec);
+    while (!stopping_) {
+        timer_cond_.wait_until(lock, origin_ + tick_ * (current_tick_ + 1));
+        if (stopping_) {
+            break;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        AdvanceLocked(static_cast<uint64_t>((now - origin_) / tick_));
+        if (now >= next_stats) {
+            next_stats = now + std::chrono::seconds(kStatsLogIntervalSec);
+            LogStatsLocked();
+        }
+    }
+}
+
+void TimerWheelScheduler::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        worker_cond_.wait(lock, [this] { return stopping_ || HasRunnableLocked(); });
+        if (stopping_) {
+            break;
+        }
+        JobPtr job = PopRunnableLocked();
+        if (job->cancelled) {
+            continue;
+        }
+        if (job->running) {
+            AddOverrunsLocked(*job, 1);
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool resumed = job->once && job->stats.preemptions > 0;
+        if (!resumed) {
+            RecordLocked(*job, start);
+        }
+        job->running = true;
+        job->preempted.store(false);
+        running_.push_back(job);
+        if (job->once) {
+            ++once_running_;
+        }
+        lock.unlock();
+
+        bool done = true;
+        try {
+            if (job->once) {
+                done = job->once(job->preempted);
+            } else {
+                job->periodic();
+            }
+        } catch (const std::exception& e) {
+            AD_ERROR(TimerWheelScheduler, "Job [%s] failed: %s", job->name.c_str(), e.what());
+        }
+
+        lock.lock();
+        job->running = false;
+        if (job->once) {
+            --once_running_;
+            if (job->yielding) {
+                job->yielding = false;
+                --once_yielding_;
+            }
+            // 释放的名额可能正有一次性任务在等待
+            worker_cond_.notify_one();
+        }
+        running_.erase(std::find(running_.begin(), running_.end(), job));
+        if (job->cancelled) {
+            continue;
+        }
+        if (job->period.count() > 0) {
+            // 固定频率：下次期限=本次期限+周期，已错过的周期跳过并计数
+            auto next = job->deadline + job->period;
+            const auto now = std::chrono::steady_clock::now();
+            if (next <= now) {
+                const auto missed = (now - next) / job->period + 1;
+                AddOverrunsLocked(*job, static_cast<uint64_t>(missed));
+                next += job->period * missed;
+            }
+            job->deadline = next;
+            InsertLocked(job);
+        } else if (done) {
+            jobs_.erase(job->id);
+        } else {
+            ++job->stats.preemptions;
+            job->preemptions->Add();
+            MakeReadyLocked(job);
+        }
+    }
+}
+
+void TimerWheelScheduler::RecordLocked(Job& job, std::chrono::steady_clock::time_point start) {
+    const auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(start - job.deadline).count();
+    auto& stats = job.stats;
+    ++stats.runs;
+    job.latenessSumUs += static_cast<double>(lateness);
+    stats.meanLatenessUs = job.latenessSumUs / static_cast<double>(stats.runs);
+    stats.maxLatenessUs = std::max<int64_t>(stats.maxLatenessUs, lateness);
+    job.lateness->Record(static_cast<uint64_t>(std::max<int64_t>(0, lateness)));
+}
+
+void TimerWheelScheduler::LogStatsLocked() {
+    if (jobs_.empty()) {
+        return;
+    }
+    const Job* worst = nullptr;
+    uint64_t overruns = 0;
+    for (const auto& [id, job] : jobs_) {
+        overruns += job->stats.overruns;
+        if (!worst || job->stats.maxLatenessUs > worst->stats.maxLatenessUs) {
+            worst = job.get();
+        }
+    }
+    AD_INFO(TimerWheelScheduler, "%d jobs, overruns: %llu, worst jitter [%s] mean %.0f us, max %lld us",
+            static_cast<int>(jobs_.size()), static_cast<unsigned long long>(overruns), worst->name.c_str(),
+            worst->stats.meanLatenessUs, static_cast<long long>(worst->stats.maxLatenessUs));
+}
+
+}
@@ -0,0 +1,152 @@
+//
+// Created by xucong on 25-9-26.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef TIMER_WHEEL_SCHEDULER_H
+#define TIMER_WHEEL_SCHEDULER_H
+
+#include "scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dcp::common {
+class Counter;
+class Histogram;
+}
+
+namespace dcp::trigger
+{
+
+/**
+ * @brief 分层时间轮调度器，少量固定线程承载大量周期trigger和超时任务。
+ *
+ * 一个时间轮线程按tick推进4层×64槽的时间轮，到期任务按优先级进入就绪队列，
+ * 由workers个工作线程执行；线程数与trigger数量无关。
+ *  - 周期任务（trigger求值）执行完成后按 上次期限+周期 重新挂入时间轮，
+ *    同一任务不会重叠执行，错过的周期计为overrun并跳过；
+ *  - 一次性任务（如片段处理）最多占用workers-1个线程，留一个线程给周期求值，
+ *    workers至少为2；名额占满且有更高优先级的一次性任务就绪时，置位最低优先级
+ *    运行任务的preempted标志，任务返回false后重新排队继续。被置位、正在让出的
+ *    任务不再占名额，抢占者可借保留线程与它同时运行，不必等它走到让出点；
+ *  - 每个任务统计实际开始时间相对期限的延迟（抖动），按scheduler和job标签导出到
+ *    MetricsRegistry：dcp_scheduler_lateness_seconds、dcp_scheduler_overruns_total、
+ *    dcp_scheduler_preemptions_total。一次性任务的job名应取有限集合（如trigger id），
+ *    不要带时间戳或序号。
+ * 优先级数值越小越优先，与PriorityScheduler一致。
+ */
+class TimerWheelScheduler : public Scheduler {
+public:
+    using JobId = uint64_t;
+    // preempted置位时应尽快返回；返回false表示未完成，之后重新排队继续执行
+    using PreemptibleJob = std::function<bool(const std::atomic<bool>& preempted)>;
+
+    // name作为指标的scheduler标签
+    explicit TimerWheelScheduler(size_t workers = 2, int tickMs = 10, const std::string& name = "trigger");
+    ~TimerWheelScheduler() override;
+
+    void AddTask(TriggerTask task) override;
+    void RemoveTask(const std::string& triggerId) override;
+    void StartScheduling() override;
+    void Stop();
+
+    JobId ScheduleOnce(const std::string& name, int8_t priority, std::chrono::milliseconds delay,
+                       PreemptibleJob job);
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr uint64_t kSlots = 1u << kSlotBits;
+    static constexpr int kStatsLogIntervalSec = 60;
+
+    struct JitterStats {
+        uint64_t runs = 0;
+        uint64_t overruns = 0;     // 上次执行未完成或执行太慢而跳过的周期
+        uint64_t preemptions = 0;
+        double meanLatenessUs = 0.0;
+        int64_t maxLatenessUs = 0;
+    };
+
+    struct Job {
+        JobId id = 0;
+        std::string name;
+        int8_t priority = 0;
+        std::chrono::milliseconds period{0};     // 0为一次性任务
+        std::function<void()> periodic;
+        PreemptibleJob once;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<bool> preempted{false};
+        common::Histogram* lateness = nullptr;
+        common::Counter* overruns = nullptr;
+        common::Counter* preemptions = nullptr;
+        // 以下受mutex_保护
+        bool cancelled = false;
+        bool running = false;
+        bool yielding = false;  // 被抢占，尚未返回
+        JitterStats stats;
+        double latenessSumUs = 0.0;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    struct Ready {
+        int8_t priority;
+        uint64_t seq;
+        JobPtr job;
+        bool operator<(const Ready& other) const {
+            return priority != other.priority ? priority > other.priority : seq > other.seq;
+        }
+    };
+
+    void BindMetrics(Job& job) const;
+    void AddOverrunsLocked(Job& job, uint64_t count);
+    uint64_t TickOf(std::chrono::steady_clock::time_point tp) const;
+    void InsertLocked(const JobPtr& job);
+    void MakeReadyLocked(const JobPtr& job);
+    void PreemptLocked(int8_t priority);
+    bool OnceSlotFreeLocked() const;
+    bool HasRunnableLocked() const;
+    JobPtr PopRunnableLocked();
+    void AdvanceLocked(uint64_t target_tick);
+    void TimerLoop();
+    void WorkerLoop();
+    void RecordLocked(Job& job, std::chrono::steady_clock::time_point start);
+    void LogStatsLocked();
+
+    const std::string name_;
+    const size_t worker_count_;
+    const size_t max_once_running_;
+    const std::chrono::milliseconds tick_;
+    std::chrono::steady_clock::time_point origin_;
+    uint64_t current_tick_ = 0;
+    std::vector<JobPtr> wheel_[kLevels][kSlots];
+
+    mutable std::mutex mutex_;
+    std::condition_variable timer_cond_;
+    std::condition_variable worker_cond_;
+    std::priority_queue<Ready> ready_;       // 周期任务
+    std::priority_queue<Ready> once_ready_;  // 一次性任务
+    size_t once_running_ = 0;
+    size_t once_yielding_ = 0;
+    uint64_t seq_ = 0;
+    JobId next_id_ = 1;
+    std::unordered_map<JobId, JobPtr> jobs_;
+    std::unordered_map<std::string, JobId> trigger_jobs_;
+    std::vector<JobPtr> running_;
+
+    std::thread timer_thread_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+}
+
+#endif // TIMER_WHEEL_SCHEDULER_H
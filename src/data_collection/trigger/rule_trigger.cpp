@@ -5,12 +5,62 @@
 
 #include "rule_trigger.h"
 #include "common/utils/utils.h"
+#include "common/config/app_config.h"
+#include "common/metrics/metrics_registry.h"
 
 namespace dcp::trigger
 {
 
-RuleTrigger::RuleTrigger()
-    : current_state_(SystemState::IDLE) {
+RuleTrigger::RuleTrigger(std::shared_ptr<SignalSlots> slots)
+    : slots_(slots ? std::move(slots) : std::make_shared<SignalSlots>()),
+      current_state_(SystemState::IDLE) {
+}
+
+bool RuleTrigger::init(const std::string& triggerId, const StrategyConfig& strategyConfig) {
+    if (!TriggerBase::init(triggerId, strategyConfig)) {
+        return false;
+    }
+    if (!program_.compile(trigger_obj_->triggerCondition, *slots_)) {
+        AD_ERROR(RuleTrigger, "Failed to compile condition of %s: %s",
+                 triggerId.c_str(), program_.lastError().c_str());
+        return false;
+    }
+    const int stale_ms = trigger_obj_->staleMs >= 0
+        ? trigger_obj_->staleMs
+        : common::AppConfig::getInstance().Snapshot()->trigger.signalStaleMs;
+    stale_us_ = static_cast<int64_t>(stale_ms) * 1000;
+    bindGetters();
+    return true;
+}
+
+void RuleTrigger::bindGetters() {
+    bound_getters_.clear();
+    produced_slots_.clear();
+    for (uint32_t slot : program_.variables()) {
+        auto it = variable_getters_.find(slots_->name(slot));
+        if (it != variable_getters_.end()) {
+            bound_getters_.emplace_back(slot, it->second);
+        } else {
+            produced_slots_.push_back(slot);
+        }
+    }
+}
+
+bool RuleTrigger::signalsFresh() const {
+    if (stale_us_ <= 0) {
+        return true;
+    }
+    const int64_t now = SignalSlots::nowUs();
+    for (uint32_t slot : produced_slots_) {
+        const auto sample = slots_->sample(slot);
+        if (sample.seq == 0 || now - sample.stampUs > stale_us_) {
+            AD_WARN_EVERY_MS(RuleTrigger, 5000, "Trigger %s: signal %s is stale (%s), condition treated as not met",
+                             trigger_obj_->triggerId.c_str(), slots_->name(slot).c_str(),
+                             sample.seq == 0 ? "never written" : "no update");
+            return false;
+        }
+    }
+    return true;
 }
 
 bool RuleTrigger::proc() {
@@ -19,7 +69,13 @@ bool RuleTrigger::proc() {
         return true;
     }
 
-    bool condition_met = checkCondition();
+    static const auto& stage = common::MetricsRegistry::getInstance().GetStage("trigger");
+    bool condition_met = false;
+    {
+        common::ScopedLatency latency(stage.duration);
+        condition_met = checkCondition();
+    }
+    stage.total->Add();
     if (!condition_met) {
         // 条件不满足，重置状态为未触发
         if (current_state_ != SystemState::UNTRIGGERED) {
@@ -37,45 +93,51 @@ bool RuleTrigger::proc() {
     // context.businessType = trigger_obj_->businessType;
     // context.triggerState = SystemState::TRIGGERED;
 
+    // 触发不频繁，每次查一次注册表即可
+    common::MetricsRegistry::getInstance()
+        .GetCounter("dcp_trigger_fired_total", "Times a trigger condition became true.",
+                    {{"trigger", trigger_obj_->triggerId}})
+        ->Add();
+
     // 更新内部状态
     current_state_ = SystemState::TRIGGERED;
     return true;
 }
 
 bool RuleTrigger::checkCondition() {
-    // 解析触发条件表达式
-    if (!trigger_checker_.parse(trigger_obj_->triggerCondition)) {
-        AD_ERROR(RuleTrigger, "Failed to parse condition: %s",
-                 trigger_checker_.lastError().c_str());
+    if (!program_.valid()) {
         return false;
     }
-    current_variables_.clear();
 
-    // 获取所有需要的变量值
-    for (const auto& [var_name, getter] : variable_getters_) {
+    // 只刷新条件用到的、由getter提供的变量，其余变量由信号生产者直接写槽位
+    for (const auto& [slot, getter] : bound_getters_) {
         try {
-            current_variables_[var_name] = getter();
+            slots_->set(slot, std::visit([](auto value) { return static_cast<double>(value); }, getter()));
         } catch (const std::exception& e) {
             AD_ERROR(RuleTrigger, "Failed to get variable '%s': %s",
-                     var_name.c_str(), e.what());
+                     slots_->name(slot).c_str(), e.what());
             return false;
         }
     }
 
-    // 检查条件
-    bool result = trigger_checker_.executeCheck(current_variables_);
-
-    return result;
+    // topic断流时旧值不再可信，不能让条件停留在最后一次的结果上
+    if (!signalsFresh()) {
+        return false;
+    }
+    return program_.evaluate(*slots_);
 }
 
 void RuleTrigger::registerVariableGetter(const std::string& var_name,
                                          std::function<TriggerChecker::Value()> getter) {
     variable_getters_[var_name] = std::move(getter);
+    if (program_.valid()) {
+        bindGetters();
+    }
 }
 
 void RuleTrigger::OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& subject)
 {
-    AD_INFO(RuleTrigger, "Received message on topic %s", topic.c_str());
+    AD_INFO_EVERY_N(RuleTrigger, 100, "Received message on topic %s", topic.c_str());
 }
 
 }
@@ -7,6 +7,7 @@
 
 #include "trigger_base.h"
 #include "trigger/common/trigger_checker.h"
+#include "trigger/common/condition_program.h"
 #include "state_machine/state_machine.h"
 
 #include <unordered_map>
@@ -19,21 +20,36 @@ namespace dcp::trigger
 
 class RuleTrigger : public TriggerBase {
 public:
-    RuleTrigger();
+    // slots为空时使用私有槽位表；TriggerManager传入共享表，信号按槽位写入一次即可
+    explicit RuleTrigger(std::shared_ptr<SignalSlots> slots = nullptr);
     ~RuleTrigger() override = default;
 
+    // 初始化时编译触发条件，之后每次求值只读槽位
+    bool init(const std::string& triggerId, const StrategyConfig& strategyConfig) override;
     bool proc() override;
     bool checkCondition() override;
     void registerVariableGetter(const std::string& var_name,
                                 std::function<TriggerChecker::Value()> getter) override;
+    std::vector<uint32_t> variables() const override { return program_.variables(); }
+    // getter提供的变量没有变化通知、窗口和held随时间变化，需周期求值；其余只在信号变化时求值。
+    // 过期检查只会让条件不成立，信号停更后无需轮询
+    bool needsPolling() const override { return !bound_getters_.empty() || program_.timeDependent(); }
     void OnMessageReceived(const std::string& topic, const rclcpp::SerializedMessage& subject) override;
 
 private:
-    TriggerChecker trigger_checker_;
+    void bindGetters();
+    // 由信号生产者写入的变量超过stale_us_未更新时返回false
+    bool signalsFresh() const;
+
+    std::shared_ptr<SignalSlots> slots_;
+    ConditionProgram program_;
     SystemState current_state_;
     std::unordered_map<std::string, std::function<TriggerChecker::Value()>> variable_getters_;
-
-    mutable std::unordered_map<std::string, TriggerChecker::Value> current_variables_;
+    // 条件用到且注册了getter的变量，求值前按槽位刷新
+    std::vector<std::pair<uint32_t, std::function<TriggerChecker::Value()>>> bound_getters_;
+    // 不由getter刷新的变量，求值前检查是否过期
+    std::vector<uint32_t> produced_slots_;
+    int64_t stale_us_ = 0;
 };
 
 }
@@ -0,0 +1,121 @@
+//
+// Created by xucong on 25-10-1.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "strategy_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <unordered_map>
+
+#include "trigger/common/condition_program.h"
+
+namespace dcp::trigger {
+
+namespace {
+
+constexpr double kRecordQueueSec = 0.5;
+constexpr double kSignalQueueSec = 0.1;
+constexpr size_t kRecordMinDepth = 10;
+constexpr size_t kSignalMinDepth = 2;
+constexpr size_t kMaxDepth = 1000;
+
+size_t DepthFor(int rateHz, double seconds, size_t minDepth) {
+    if (rateHz <= 0) {
+        return std::max<size_t>(minDepth, 10);
+    }
+    const auto depth = static_cast<size_t>(std::ceil(rateHz * seconds));
+    return std::clamp(depth, minDepth, kMaxDepth);
+}
+
+void AddUnique(std::vector<std::string>& list, const std::string& value) {
+    if (std::find(list.begin(), list.end(), value) == list.end()) {
+        list.push_back(value);
+    }
+}
+
+}
+
+size_t StrategyAnalyzer::RecordQueueDepth(int rateHz) {
+    return DepthFor(rateHz, kRecordQueueSec, kRecordMinDepth);
+}
+
+size_t StrategyAnalyzer::SignalQueueDepth(int rateHz) {
+    return DepthFor(rateHz, kSignalQueueSec, kSignalMinDepth);
+}
+
+StrategyAnalysis StrategyAnalyzer::Analyze(const StrategyConfig& config) {
+    StrategyAnalysis analysis;
+
+    std::unordered_map<std::string, const SignalSource*> signal_by_name;
+    for (const auto& signal : config.signals) {
+        signal_by_name.emplace(signal.name, &signal);
+    }
+    // 频率和类型以channels中的声明为准，disabled策略的声明也可作为信号topic的参考
+    std::unordered_map<std::string, const Channel*> channel_by_topic;
+    for (const auto& strategy : config.strategies) {
+        for (const auto& channel : strategy.dds.channels) {
+            channel_by_topic.emplace(channel.topic, &channel);
+        }
+    }
+
+    // 只用于解析变量名，不参与运行时求值
+    SignalSlots slots;
+    std::set<std::string> used_signals;
+    for (const auto& strategy : config.strategies) {
+        if (!strategy.trigger.enabled) {
+            continue;
+        }
+        StrategyRequirement requirement;
+        requirement.triggerId = strategy.trigger.triggerId;
+
+        for (const auto& channel : strategy.dds.channels) {
+            AddUnique(requirement.recordTopics, channel.topic);
+            auto& topic = analysis.topics[channel.topic];
+            topic.topic = channel.topic;
+            topic.type = channel.type;
+            topic.record = true;
+            topic.rateHz = std::max(topic.rateHz, channel.originalFrameRate);
+            topic.recordRateHz = std::max(topic.recordRateHz, channel.capturedFrameRate);
+        }
+
+        ConditionProgram program;
+        if (!program.compile(strategy.trigger.triggerCondition, slots)) {
+            requirement.conditionValid = false;
+        }
+        for (uint32_t slot : program.variables()) {
+            const std::string name = slots.name(slot);
+            auto it = signal_by_name.find(name);
+            if (it == signal_by_name.end()) {
+                AddUnique(requirement.unresolvedVariables, name);
+                continue;
+            }
+            const SignalSource& signal = *it->second;
+            AddUnique(requirement.signalTopics, signal.topic);
+            auto& topic = analysis.topics[signal.topic];
+            topic.topic = signal.topic;
+            topic.signal = true;
+            if (topic.type.empty()) {
+                topic.type = signal.type;
+            }
+            auto channel = channel_by_topic.find(signal.topic);
+            if (channel != channel_by_topic.end()) {
+                topic.rateHz = std::max(topic.rateHz, channel->second->originalFrameRate);
+            }
+            if (used_signals.insert(signal.name).second) {
+                analysis.signals.push_back(signal);
+            }
+        }
+        analysis.strategies.push_back(std::move(requirement));
+    }
+
+    for (auto& [name, topic] : analysis.topics) {
+        topic.qosDepth = topic.record ? RecordQueueDepth(topic.rateHz) : SignalQueueDepth(topic.rateHz);
+    }
+    return analysis;
+}
+
+}
@@ -0,0 +1,69 @@
+//
+// Created by xucong on 25-10-1.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef STRATEGY_ANALYZER_H
+#define STRATEGY_ANALYZER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "strategy_config.h"
+
+namespace dcp::trigger {
+
+// 单个topic的订阅需求，由所有enabled策略合并而来
+struct TopicRequirement {
+    std::string topic;
+    std::string type;
+    bool record = false;      // 有策略录制该topic
+    bool signal = false;      // 有trigger条件读取该topic上的信号
+    int rateHz = 0;           // 发布频率（originalFrameRate），未知为0
+    int recordRateHz = 0;     // 录制频率（capturedFrameRate）的最大值
+    size_t qosDepth = 10;     // 订阅队列深度
+};
+
+// 单个enabled策略的需求
+struct StrategyRequirement {
+    std::string triggerId;
+    std::vector<std::string> recordTopics;
+    std::vector<std::string> signalTopics;
+    // 条件中引用、但没有signals定义的变量，只能由getter提供
+    std::vector<std::string> unresolvedVariables;
+    bool conditionValid = true;
+};
+
+struct StrategyAnalysis {
+    std::vector<StrategyRequirement> strategies;
+    std::map<std::string, TopicRequirement> topics;
+    // enabled策略条件实际引用的信号，未引用的不建读取计划
+    std::vector<SignalSource> signals;
+
+    const TopicRequirement* find(const std::string& topic) const {
+        auto it = topics.find(topic);
+        return it != topics.end() ? &it->second : nullptr;
+    }
+};
+
+/**
+ * @brief 策略配置的静态分析：编译每个enabled策略的触发条件，得出其录制所需topic、
+ *        仅用于条件求值的信号topic及其频率，据此确定订阅集合和QoS深度。
+ *        disabled策略不产生任何订阅、信号和读取计划。
+ */
+class StrategyAnalyzer {
+public:
+    static StrategyAnalysis Analyze(const StrategyConfig& config);
+
+    // 录制topic按0.5s的发布量设队列深度，保留原先的10作为下限
+    static size_t RecordQueueDepth(int rateHz);
+    // 信号topic只关心最新值，队列只需吸收回调调度的抖动（约100ms）
+    static size_t SignalQueueDepth(int rateHz);
+};
+
+}
+
+#endif // STRATEGY_ANALYZER_H
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <vector>
 #include <unordered_map>
 
@@ -20,6 +21,8 @@ struct Trigger {
     bool enabled;
     std::string triggerCondition;
     std::string triggerDesc;
+    int periodMs = 100; // 周期求值间隔，事件驱动时只用于依赖getter的条件
+    int staleMs = -1;   // 变量过期时长，-1使用app_config中的trigger.signalStaleMs，0不检查
 };
 
 struct CacheMode {
@@ -31,6 +34,7 @@ struct CacheMode {
 struct Mode {
     int triggerMode;
     CacheMode cacheMode;
+    bool streamingUpload = false; // 关键触发边录边传，不等待落盘压缩
 };
 
 struct Channel {
@@ -53,10 +57,38 @@ struct Strategy {
     std::unordered_map<std::string, std::string> upload;
 };
 
+// 触发条件使用的信号：从topic的消息字段中按CDR偏移直接读取
+struct SignalSource {
+    std::string name;       // 条件表达式中的变量名
+    std::string topic;
+    std::string fieldPath;  // 消息内字段路径，如 "chassis.speed_mps"、"position[0]"
+    std::string type;       // 消息类型，如 "data_collection/msg/JointCommand"
+    // 可选平滑："ema" "sma" "kalman" "median"，空为原值；同一topic上参数相同的信号一起更新
+    std::string filter;
+    int periodMs = 10;      // 采样周期，即topic的消息间隔
+    int responseMs = 100;   // 期望响应时间，median为窗口时长
+};
+
 struct StrategyConfig {
     std::string configId;
     int strategyId;
     std::vector<Strategy> strategies;
+    std::vector<SignalSource> signals;
+};
+
+// 新旧策略配置的差异，只统计enabled的策略，热更新时据此增删订阅和trigger
+struct StrategyDiff {
+    std::vector<std::string> addedTopics;
+    std::vector<std::string> removedTopics;
+    std::vector<std::string> addedTriggers;
+    std::vector<std::string> removedTriggers;
+    std::vector<std::string> changedTriggers; // 条件、优先级、周期、模式或录制channel变化，需重建
+    bool signalsChanged = false;              // 信号定义变化，需重建字段读取计划
+
+    bool empty() const {
+        return addedTopics.empty() && removedTopics.empty() && addedTriggers.empty() &&
+               removedTriggers.empty() && changedTriggers.empty() && !signalsChanged;
+    }
 };
 
 }
@@ -5,6 +5,12 @@
 //
 
 #include "strategy_parser.h"
+#include "strategy_analyzer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
 
 namespace dcp::trigger {
 
@@ -23,12 +29,88 @@ bool StrategyParser::LoadConfigFromFile(const std::string &file_path, StrategyCo
         return false;
     }
 
-    nlohmann::json jsonData = nlohmann::json::parse(jsonString);
-    ParseJsonConfig(jsonData, conf);
+    try {
+        nlohmann::json jsonData = nlohmann::json::parse(jsonString);
+        ParseJsonConfig(jsonData, conf);
+    } catch (const std::exception& e) {
+        // 字段类型错误时json抛异常，热更新时不能让监听线程退出
+        std::cerr << "Parse JSON config failed: " << e.what() << std::endl;
+        return false;
+    }
 
     return true;
 }
 
+StrategyDiff StrategyParser::Diff(const StrategyConfig& current, const StrategyConfig& next) {
+    // topic取静态分析的结果：录制的channel加上条件实际引用的信号topic
+    auto collect = [](const StrategyConfig& config, const StrategyAnalysis& analysis,
+                      std::map<std::string, const Strategy*>& triggers, std::set<std::string>& topics) {
+        for (const auto& st : config.strategies) {
+            if (!st.trigger.enabled) continue;
+            triggers[st.trigger.triggerId] = &st;
+        }
+        for (const auto& [topic, requirement] : analysis.topics) {
+            topics.insert(topic);
+        }
+    };
+    auto same = [](const Strategy& a, const Strategy& b) {
+        return a.trigger.priority == b.trigger.priority &&
+               a.trigger.periodMs == b.trigger.periodMs &&
+               a.trigger.staleMs == b.trigger.staleMs &&
+               a.trigger.triggerCondition == b.trigger.triggerCondition &&
+               a.trigger.triggerDesc == b.trigger.triggerDesc &&
+               a.businessType == b.businessType &&
+               a.mode.triggerMode == b.mode.triggerMode &&
+               a.mode.cacheMode.forwardCaptureDurationSec == b.mode.cacheMode.forwardCaptureDurationSec &&
+               a.mode.cacheMode.backwardCaptureDurationSec == b.mode.cacheMode.backwardCaptureDurationSec &&
+               a.mode.cacheMode.cooldownDurationSec == b.mode.cacheMode.cooldownDurationSec &&
+               a.mode.streamingUpload == b.mode.streamingUpload &&
+               a.enableMasking == b.enableMasking &&
+               a.dds.channels.size() == b.dds.channels.size() &&
+               std::equal(a.dds.channels.begin(), a.dds.channels.end(), b.dds.channels.begin(),
+                          [](const Channel& x, const Channel& y) {
+                              return x.topic == y.topic && x.type == y.type &&
+                                     x.originalFrameRate == y.originalFrameRate &&
+                                     x.capturedFrameRate == y.capturedFrameRate;
+                          });
+    };
+
+    std::map<std::string, const Strategy*> current_triggers, next_triggers;
+    std::set<std::string> current_topics, next_topics;
+    const auto current_analysis = StrategyAnalyzer::Analyze(current);
+    const auto next_analysis = StrategyAnalyzer::Analyze(next);
+    collect(current, current_analysis, current_triggers, current_topics);
+    collect(next, next_analysis, next_triggers, next_topics);
+
+    StrategyDiff diff;
+    const auto& current_signals = current_analysis.signals;
+    const auto& next_signals = next_analysis.signals;
+    diff.signalsChanged = current_signals.size() != next_signals.size() ||
+        !std::equal(current_signals.begin(), current_signals.end(), next_signals.begin(),
+                    [](const SignalSource& a, const SignalSource& b) {
+                        return a.name == b.name && a.topic == b.topic && a.fieldPath == b.fieldPath && a.type == b.type &&
+                               a.filter == b.filter && a.periodMs == b.periodMs && a.responseMs == b.responseMs;
+                    });
+    std::set_difference(next_topics.begin(), next_topics.end(), current_topics.begin(), current_topics.end(),
+                        std::back_inserter(diff.addedTopics));
+    std::set_difference(current_topics.begin(), current_topics.end(), next_topics.begin(), next_topics.end(),
+                        std::back_inserter(diff.removedTopics));
+    for (const auto& [id, st] : next_triggers) {
+        auto it = current_triggers.find(id);
+        if (it == current_triggers.end()) {
+            diff.addedTriggers.push_back(id);
+        } else if (!same(*it->second, *st)) {
+            diff.changedTriggers.push_back(id);
+        }
+    }
+    for (const auto& [id, st] : current_triggers) {
+        if (next_triggers.find(id) == next_triggers.end()) {
+            diff.removedTriggers.push_back(id);
+        }
+    }
+    return diff;
+}
+
 void StrategyParser::ParseJsonConfig(const nlohmann::json &jsonData, StrategyConfig &config) {
     config.configId = jsonData["configId"];
     config.strategyId = jsonData["strategyId"];
@@ -41,12 +123,15 @@ void StrategyParser::ParseJsonConfig(const nlohmann::json &jsonData, StrategyCon
         st.trigger.enabled = strategyJson["trigger"]["enabled"];
         st.trigger.triggerCondition =  strategyJson["trigger"] ["triggerCondition"];
         st.trigger.triggerDesc = strategyJson["trigger"]["triggerDesc"];
+        st.trigger.periodMs = strategyJson["trigger"].value("periodMs", 100);
+        st.trigger.staleMs = strategyJson["trigger"].value("staleMs", -1);
 
         // parse mode
         st.mode.triggerMode = strategyJson["mode"]["triggerMode"];
         st.mode.cacheMode.forwardCaptureDurationSec =  strategyJson["mode"] ["cacheMode" ]["forwardCaptureDurationSec"];
         st.mode.cacheMode.backwardCaptureDurationSec = strategyJson["mode"] ["cacheMode" ]["backwardCaptureDurationSec"];
         st.mode.cacheMode.cooldownDurationSec = strategyJson["mode"] ["cacheMode" ]["cooldownDurationSec"];
+        st.mode.streamingUpload = strategyJson["mode"].value("streamingUpload", false);
 
         //
         st.enableMasking = strategyJson["enableMasking"];
@@ -63,6 +148,35 @@ void StrategyParser::ParseJsonConfig(const nlohmann::json &jsonData, StrategyCon
 
         config.strategies.push_back(st);
     }
+
+    // signals可选："source"为 topic.字段路径，topic取最后一个'/'之后第一个'.'之前的部分；
+    // type缺省时使用channels中同名topic的类型；filter/periodMs/responseMs可选，见SignalSource
+    if (jsonData.contains("signals")) {
+        for (const auto& signalJson : jsonData["signals"]) {
+            SignalSource signal;
+            signal.name = signalJson["name"];
+            const std::string source = signalJson["source"];
+            const size_t dot = source.find('.', source.rfind('/') == std::string::npos ? 0 : source.rfind('/'));
+            if (dot == std::string::npos) {
+                std::cerr << "Signal " << signal.name << " has no field path: " << source << std::endl;
+                continue;
+            }
+            signal.topic = source.substr(0, dot);
+            signal.fieldPath = source.substr(dot + 1);
+            signal.type = signalJson.value("type", std::string());
+            signal.filter = signalJson.value("filter", std::string());
+            signal.periodMs = signalJson.value("periodMs", signal.periodMs);
+            signal.responseMs = signalJson.value("responseMs", signal.responseMs);
+            for (const auto& st : config.strategies) {
+                for (const auto& channel : st.dds.channels) {
+                    if (signal.type.empty() && channel.topic == signal.topic) {
+                        signal.type = channel.type;
+                    }
+                }
+            }
+            config.signals.push_back(signal);
+        }
+    }
 }
 
 bool StrategyParser::CheckValid(const std::string &jsonString) {
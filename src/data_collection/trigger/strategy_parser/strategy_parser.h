@@ -17,6 +17,14 @@ class StrategyParser {
 public:
     bool LoadConfigFromFile(const std::string& file_path, StrategyConfig& conf);
 
+    /**
+    * @brief 比较运行中的配置和新配置
+    * @param current 当前生效的配置
+    * @param next 新加载的配置
+    * @return 需要新增/删除的topic和trigger，两边都有但定义变化的trigger记入changedTriggers
+    */
+    static StrategyDiff Diff(const StrategyConfig& current, const StrategyConfig& next);
+
     /**
     * @brief 获取支持的trigger类型
     * @param trigger_vec trigger类型列表。
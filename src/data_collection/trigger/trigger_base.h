@@ -9,6 +9,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "common/log/logger.h"
 #include "strategy_parser/strategy_config.h"
@@ -32,6 +33,11 @@ public:
     virtual void registerVariableGetter(const std::string& var_name,
                                         std::function<TriggerChecker::Value()> getter) = 0;
 
+    // 条件依赖的变量槽位，事件驱动求值据此建立依赖图
+    virtual std::vector<uint32_t> variables() const { return {}; }
+    // 变量没有变化通知（如getter拉取）时需要周期求值
+    virtual bool needsPolling() const { return true; }
+
 protected:
     std::unique_ptr<Trigger> trigger_obj_ = nullptr;
 
@@ -4,46 +4,51 @@
 //
 
 #include "trigger_manager.h"
+#include "rule_trigger.h"
 #include "common/log/logger.h"
+#include "common/config/app_config.h"
 
 namespace dcp::trigger {
 
-bool TriggerManager::initialize() {
+bool TriggerManager::initialize(const StrategyConfig& strategy_config) {
     // if (!initTriggerChecker(std::make_shared<TriggerBase>())) {
     //     AD_ERROR(TriggerManager, "Trigger checker initialization failed.");
     //     return false;
     // }
 
-    if (!initScheduler(strategy_config_, scheduler_)) {
+    const auto app_config = common::AppConfig::getInstance().Snapshot();
+    const auto& trigger_config = app_config->trigger;
+    if (trigger_config.eventDriven && !evaluator_) {
+        evaluator_ = std::make_shared<ConditionEvaluator>(
+            signal_slots_, static_cast<size_t>(trigger_config.evaluationWorkers), trigger_config.pollIntervalMs);
+    }
+    if (!evaluator_ && !scheduler_) {
+        scheduler_ = std::make_shared<TimerWheelScheduler>(
+            static_cast<size_t>(trigger_config.schedulerWorkers), trigger_config.tickMs);
+    }
+
+    if (!initScheduler(strategy_config, scheduler_)) {
         AD_ERROR(TriggerManager, "Scheduler initialization failed.");
         return false;
     }
-    return true;
+    return processScheduler();
 }
 
 bool TriggerManager::initTriggerChecker(std::shared_ptr<TriggerBase> trigger) {
     if (!trigger) return false;
-    trigger->registerVariableGetter("speed", [this]() -> TriggerChecker::Value {
-        // return message_provider_->getChassisVehicleMps(); // m/s
-    });
-
-    trigger->registerVariableGetter("automode", [this]() -> TriggerChecker::Value {
-        // return message_provider_->getAutoModeEnable();
-    });
-
-    trigger->registerVariableGetter("gear", [this]() -> TriggerChecker::Value {
-        // return message_provider_->getGear();
-    });
-
-    trigger->registerVariableGetter("aeb_decel_req", [this]() -> TriggerChecker::Value {
-        // return message_provider_->getAebDecelReq();
-    });
+    // speed/automode/gear/aeb_decel_req 等车辆信号由MessageProvider按signals配置写入signal_slots_，
+    // 带写入时刻和序号，trigger直接读槽位并做过期检查，不再注册逐次调用的getter。
+    // registerVariableGetter仅保留给无法从消息中读取的派生量
+    return true;
 }
 
 std::shared_ptr<TriggerBase> TriggerManager::createTrigger(const std::string& trigger_id) {
     std::unique_lock lock(mutex_);
-    auto it = triggers_.find(trigger_id);
-    return (it != triggers_.end()) ? it->second : nullptr;
+    auto& trigger = triggers_[trigger_id];
+    if (!trigger) {
+        trigger = std::make_shared<RuleTrigger>(signal_slots_);
+    }
+    return trigger;
 }
 
 std::shared_ptr<TriggerBase> TriggerManager::getTrigger(const std::string& trigger_id) const {
@@ -55,12 +60,12 @@ std::shared_ptr<TriggerBase> TriggerManager::getTrigger(const std::string& trigg
 bool TriggerManager::initScheduler(const StrategyConfig& strategy_config, const std::shared_ptr<Scheduler>& scheduler) {
     strategy_config_ = strategy_config;
     scheduler_ = scheduler;
-    if (!scheduler_) {
+    if (!scheduler_ && !evaluator_) {
         AD_ERROR(TriggerManager, "Scheduler is not initialized.");
         return false;
     }
 
-    std::vector<std::pair<std::string, int>> enabled_triggers;
+    std::vector<std::tuple<std::string, int, int>> enabled_triggers;
     int trigger_priority = std::numeric_limits<int>::max();
 
     if (enabled_triggers.empty())
@@ -74,42 +79,114 @@ bool TriggerManager::initScheduler(const StrategyConfig& strategy_config, const
             if (s.trigger.enabled) {
                 enabled_triggers.emplace_back(
                     s.trigger.triggerId,
-                    s.trigger.priority
+                    s.trigger.priority,
+                    s.trigger.periodMs
                 );
             }
         }
     }
 
     bool success = true;
-    for (const auto& [id, priority] : enabled_triggers)
+    for (const auto& [id, priority, period_ms] : enabled_triggers)
     {
-        auto trigger = createTrigger(id);
-        if (!trigger) {
-            AD_ERROR(TriggerManager, "Trigger not found for %s", id.c_str());
-            success = false;
-            continue;
-        }
-
-        success = trigger->init(id, strategy_config_);
+        success = startTrigger(id, priority, period_ms);
         CHECK_AND_RETURN(success, TriggerManager, "Trigger init failed", false);
+    }
+
+    return success;
+}
+
+bool TriggerManager::processScheduler() {
+    if (evaluator_) {
+        evaluator_->start();
+    }
+    if (scheduler_) {
+        scheduler_->StartScheduling();
+    }
+    return true;
+}
+
+bool TriggerManager::startTrigger(const std::string& trigger_id, int priority, int period_ms) {
+    auto trigger = createTrigger(trigger_id);
+    if (!trigger) {
+        AD_ERROR(TriggerManager, "Trigger not found for %s", trigger_id.c_str());
+        return false;
+    }
+    if (!trigger->init(trigger_id, strategy_config_)) {
+        return false;
+    }
 
+    if (evaluator_) {
+        evaluator_->addTrigger(trigger_id, priority, trigger);
+    } else {
         TriggerTask task;
-        task.triggerId = id;
+        task.triggerId = trigger_id;
         task.priority = priority;
-        task.trigger = std::move(trigger);
+        task.period = std::chrono::milliseconds(period_ms);
+        task.trigger = trigger;
         task.strategyConfig = strategy_config_;
         scheduler_->AddTask(task);
-
-        trigger_instances_[id] = std::dynamic_pointer_cast<TriggerBase>(task.trigger);
     }
 
-    return success;
+    std::unique_lock lock(mutex_);
+    trigger_instances_[trigger_id] = std::move(trigger);
+    return true;
 }
 
-bool TriggerManager::processScheduler() {
+void TriggerManager::stopTrigger(const std::string& trigger_id) {
+    if (evaluator_) {
+        evaluator_->removeTrigger(trigger_id);
+    }
     if (scheduler_) {
-        scheduler_->StartScheduling();
+        scheduler_->RemoveTask(trigger_id);
     }
-    return true;
+    std::unique_lock lock(mutex_);
+    triggers_.erase(trigger_id);
+    trigger_instances_.erase(trigger_id);
 }
+
+bool TriggerManager::reload(const StrategyConfig& strategy_config, const StrategyDiff& diff) {
+    if (!scheduler_ && !evaluator_) {
+        AD_ERROR(TriggerManager, "Scheduler is not initialized.");
+        return false;
+    }
+
+    // 变化的trigger按删除+新增处理，新对象用新配置初始化，观察者由ChannelManager按对象替换
+    for (const auto& id : diff.removedTriggers) {
+        stopTrigger(id);
+    }
+    for (const auto& id : diff.changedTriggers) {
+        stopTrigger(id);
+    }
+    // 上次重载部分失败后重试时，新增的trigger可能已经启动过
+    for (const auto& id : diff.addedTriggers) {
+        stopTrigger(id);
+    }
+    strategy_config_ = strategy_config;
+
+    bool success = true;
+    auto start = [&](const std::string& id) {
+        for (const auto& s : strategy_config_.strategies) {
+            if (s.trigger.enabled && s.trigger.triggerId == id) {
+                if (!startTrigger(id, s.trigger.priority, s.trigger.periodMs)) {
+                    AD_ERROR(TriggerManager, "Start trigger %s failed.", id.c_str());
+                    success = false;
+                }
+                return;
+            }
+        }
+    };
+    for (const auto& id : diff.changedTriggers) {
+        start(id);
+    }
+    for (const auto& id : diff.addedTriggers) {
+        start(id);
+    }
+
+    AD_INFO(TriggerManager, "Reload done, added: %d, removed: %d, changed: %d",
+            static_cast<int>(diff.addedTriggers.size()), static_cast<int>(diff.removedTriggers.size()),
+            static_cast<int>(diff.changedTriggers.size()));
+    return success;
+}
+
 }
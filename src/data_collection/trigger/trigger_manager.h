@@ -9,7 +9,10 @@
 #include "channel/message_provider.h"
 #include "trigger/strategy_parser/strategy_parser.h"
 #include "trigger_base.h"
+#include "trigger/common/condition_program.h"
+#include "trigger/common/condition_evaluator.h"
 #include "priority_scheduler/priority_scheduler.h"
+#include "priority_scheduler/timer_wheel_scheduler.h"
 
 namespace dcp::trigger{
 
@@ -21,17 +24,36 @@ public:
     bool initTriggerChecker(std::shared_ptr<TriggerBase> trigger);
     bool initScheduler(const StrategyConfig& strategy_config, const std::shared_ptr<Scheduler>& scheduler);
 
-    bool initialize();
+    /**
+     * @brief 按app_config中trigger.eventDriven选择求值方式：事件驱动时由ConditionEvaluator
+     *        在信号变化时求值，否则按各trigger的periodMs周期求值，未注入Scheduler时
+     *        使用时间轮调度器，少量线程承载全部trigger
+     */
+    bool initialize(const StrategyConfig& strategy_config);
     bool shouldTrigger(const Point& position) { return true; }
     bool isInSparseArea(const Point& position) { return true; }
     double getDistanceToNearestSparseArea(const Point& position) {return 0.0; }
 
     std::shared_ptr<TriggerBase> createTrigger(const std::string& trigger_id);
+
+    // 所有trigger共享的条件变量槽位表，信号生产者intern后按槽位写入
+    std::shared_ptr<SignalSlots> signalSlots() const { return signal_slots_; }
+    // 事件驱动求值器，未启用时为空；信号生产者通过它写槽位以唤醒依赖的trigger
+    std::shared_ptr<ConditionEvaluator> evaluator() const { return evaluator_; }
     std::shared_ptr<TriggerBase> getTrigger(const std::string& trigger_id) const;
 
     bool processScheduler();
 
+    /**
+     * @brief 策略热更新：停止删除和变化的trigger，按新配置创建新增和变化的trigger，
+     *        未变化的trigger继续运行，状态不受影响
+     */
+    bool reload(const StrategyConfig& strategy_config, const StrategyDiff& diff);
+
 private:
+    bool startTrigger(const std::string& trigger_id, int priority, int period_ms);
+    void stopTrigger(const std::string& trigger_id);
+
     // StrategyConfig config_;
     std::unordered_map<std::string,
                        std::function<std::function<TriggerChecker::Value()>()>> variable_getter_factories_;
@@ -40,6 +62,8 @@ private:
     std::shared_ptr<channel::MessageProvider> message_provider_;
     std::unordered_map<std::string, std::shared_ptr<TriggerBase>> trigger_instances_;
     std::shared_ptr<Scheduler> scheduler_;
+    std::shared_ptr<SignalSlots> signal_slots_ = std::make_shared<SignalSlots>();
+    std::shared_ptr<ConditionEvaluator> evaluator_;
     StrategyConfig strategy_config_;
     mutable std::shared_mutex mutex_;
 };
@@ -0,0 +1,122 @@
+//
+// Created by xucong on 25-9-10.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "clip_summary_channel.h"
+
+#include "common/log/logger.h"
+#include "common/utils/utils.h"
+
+namespace dcp::uploader
+{
+
+ClipSummaryChannel::~ClipSummaryChannel() {
+    Stop();
+}
+
+bool ClipSummaryChannel::Init(const common::AppConfigData& config, RequestHandler handler) {
+    config_ = config;
+    handler_ = std::move(handler);
+
+    const auto& mqtt = config_.dataProto.mqtt;
+    // 与指令通道使用不同的clientId，避免互相踢下线
+    const std::string client_id = "shadow_clip_" + config_.dataProto.vin;
+    mqtt_wrapper_ = std::make_unique<MqttWrapper>();
+    MqttWrapper::ErrorCode ret;
+    if (config_.debug.closeMqttSsl) {
+        ret = mqtt_wrapper_->Init(mqtt.broker, client_id, mqtt.username, mqtt.password);
+    } else {
+        ret = mqtt_wrapper_->Init(mqtt.broker_ssl, client_id, mqtt.username, mqtt.password,
+                                  config_.dataUpload.caCertPath, config_.dataUpload.clientCertPath,
+                                  config_.dataUpload.clientKeyPath);
+    }
+    if (ret != MqttWrapper::ErrorCode::SUCCESS) {
+        AD_ERROR(ClipSummaryChannel, "MqttInit failed, ret: %d", static_cast<int>(ret));
+        return false;
+    }
+    mqtt_wrapper_->SetMessageCallback([this](const std::string& topic, const std::string& payload) {
+        OnMessage(topic, payload);
+    });
+
+    // 连接失败不影响初始化，发布摘要时重连
+    Connect();
+    return true;
+}
+
+bool ClipSummaryChannel::Connect() {
+    if (connected_) {
+        return true;
+    }
+    if (mqtt_wrapper_->Connect() != MqttWrapper::ErrorCode::SUCCESS) {
+        AD_WARN(ClipSummaryChannel, "Connect failed.");
+        return false;
+    }
+    if (mqtt_wrapper_->Subscribe(config_.dataProto.mqtt.downTopic, 1) != MqttWrapper::ErrorCode::SUCCESS) {
+        AD_WARN(ClipSummaryChannel, "Subscribe %s failed.", config_.dataProto.mqtt.downTopic.c_str());
+        mqtt_wrapper_->Disconnect();
+        return false;
+    }
+    connected_ = true;
+    AD_INFO(ClipSummaryChannel, "Connected, subscribed to %s", config_.dataProto.mqtt.downTopic.c_str());
+    return true;
+}
+
+void ClipSummaryChannel::Stop() {
+    if (mqtt_wrapper_ && connected_) {
+        mqtt_wrapper_->Disconnect();
+    }
+    connected_ = false;
+}
+
+bool ClipSummaryChannel::PublishSummary(const common::ClipSummary& summary) {
+    if (!mqtt_wrapper_ || !Connect()) {
+        return false;
+    }
+    common::json data = summary;
+    data.erase("published");
+    common::json j = common::json{
+        {"cmd", "clipSummary"},
+        {"vin", config_.dataProto.vin},
+        {"data", data},
+    };
+    auto ret = mqtt_wrapper_->Publish(config_.dataProto.mqtt.upTopic, j.dump(), 1);
+    if (ret != MqttWrapper::ErrorCode::SUCCESS) {
+        AD_WARN(ClipSummaryChannel, "Publish summary of %s failed, ret: %d", summary.clip_id.c_str(),
+                static_cast<int>(ret));
+        return false;
+    }
+    AD_INFO(ClipSummaryChannel, "Published summary of %s, %d bytes.", summary.clip_id.c_str(),
+            static_cast<int>(j.dump().size()));
+    return true;
+}
+
+void ClipSummaryChannel::OnMessage(const std::string& topic, const std::string& payload) {
+    common::json j;
+    try {
+        j = common::json::parse(payload);
+    } catch (const std::exception& e) {
+        AD_WARN(ClipSummaryChannel, "Invalid payload on %s: %s", topic.c_str(), e.what());
+        return;
+    }
+    if (j.value("cmd", "") != "clipRequest" || !j.contains("data")) {
+        return;
+    }
+
+    common::ClipRequest request;
+    try {
+        request = j.at("data").get<common::ClipRequest>();
+    } catch (const std::exception& e) {
+        AD_WARN(ClipSummaryChannel, "Invalid clip request: %s", e.what());
+        return;
+    }
+    AD_INFO(ClipSummaryChannel, "Clip request %s for %s, topics: %d, range: [%llu, %llu]",
+            request.request_id.c_str(), request.clip_id.c_str(), static_cast<int>(request.topics.size()),
+            request.start_time, request.end_time);
+    if (handler_) {
+        handler_(request);
+    }
+}
+
+}
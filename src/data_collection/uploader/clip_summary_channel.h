@@ -0,0 +1,50 @@
+//
+// Created by xucong on 25-9-10.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef CLIP_SUMMARY_CHANNEL_H
+#define CLIP_SUMMARY_CHANNEL_H
+
+#include <string>
+#include <memory>
+#include <functional>
+
+#include "protocol/mqtt_wrapper.h"
+#include "common/data.h"
+#include "common/config/app_config.h"
+
+namespace dcp::uploader
+{
+
+/**
+ * 两阶段上传的mqtt通道：
+ *   上行 upTopic   {"cmd": "clipSummary", "vin": ..., "data": ClipSummary}
+ *   下行 downTopic {"cmd": "clipRequest", "data": {"clipId", "requestId", "topics", "startTime", "endTime"}}
+ * 下行中其他cmd忽略，由原有指令通道处理。
+ */
+class ClipSummaryChannel {
+public:
+  using RequestHandler = std::function<void(const common::ClipRequest&)>;
+
+  ClipSummaryChannel() = default;
+  ~ClipSummaryChannel();
+
+  bool Init(const common::AppConfigData& config, RequestHandler handler);
+  bool PublishSummary(const common::ClipSummary& summary);
+  void Stop();
+
+private:
+  bool Connect();
+  void OnMessage(const std::string& topic, const std::string& payload);
+
+  common::AppConfigData config_;
+  std::unique_ptr<MqttWrapper> mqtt_wrapper_;
+  RequestHandler handler_;
+  bool connected_ = false;
+};
+
+}
+
+#endif //CLIP_SUMMARY_CHANNEL_H
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <openssl/evp.h>
+#include "common/log/logger.h"
+
+namespace dcp::uploader
+{
+
+//按内容定义分块（FastCDC，gear滚动哈希 + 归一化分块）：
+//块边界只取决于附近的数据内容，相邻片段重叠或连续录制重复的数据会切出相同的块，
+//块以sha256标识，服务端已有的块无需重复上传
+class ContentChunker {
+public:
+    enum ErrorCode {
+        SUCCESS = 0,      // 成功
+        FILE_OPEN_FAILED, // 文件打开失败
+        INVALID_CHUNK,    // 块序号无效
+        FILE_SEEK_FAILED, // 文件定位失败
+        FILE_READ_FAILED, // 文件读取失败
+        HASH_FAILED       // 计算hash失败
+    };
+
+    struct Chunk {
+        uint64_t offset = 0;
+        uint32_t length = 0;
+        std::string hash; // sha256 hex
+    };
+
+    //块大小参数单位KB，avg取不小于它的2的幂
+    ContentChunker(const std::string& filePath_, size_t minKb, size_t avgKb, size_t maxKb)
+        : filePath(filePath_) {
+        minSize = minKb * 1024;
+        maxSize = std::max(maxKb * 1024, minSize + 1);
+        int bits = 0;
+        while ((1ULL << bits) < avgKb * 1024 && bits < 40) {
+            ++bits;
+        }
+        avgSize = std::min(std::max(static_cast<size_t>(1ULL << bits), minSize), maxSize);
+        // 未到平均大小时用更严格的掩码，超过后放宽，使块大小集中在平均值附近
+        maskS = MakeMask(bits + 2);
+        maskL = MakeMask(bits > 2 ? bits - 2 : 1);
+        errorCode = Scan();
+    }
+
+    ErrorCode getErrorCode() const {
+        return errorCode;
+    }
+
+    const std::vector<Chunk>& getChunks() const {
+        return chunks;
+    }
+
+    size_t getFileSize() const {
+        return fileSize;
+    }
+
+    // 根据块序号（从0开始）读取块数据
+    ErrorCode getChunkData(size_t index, std::vector<char>& chunkData) const {
+        if (index >= chunks.size()) {
+            AD_ERROR(ContentChunker, "Invalid chunk index %d", static_cast<int>(index));
+            return INVALID_CHUNK;
+        }
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file) {
+            AD_ERROR(ContentChunker, "File %s open failed.", filePath.c_str());
+            return FILE_OPEN_FAILED;
+        }
+        file.seekg(static_cast<std::streamoff>(chunks[index].offset), std::ios::beg);
+        if (!file) {
+            return FILE_SEEK_FAILED;
+        }
+        chunkData.resize(chunks[index].length);
+        file.read(chunkData.data(), chunks[index].length);
+        if (file.gcount() != static_cast<std::streamsize>(chunks[index].length)) {
+            return FILE_READ_FAILED;
+        }
+        return SUCCESS;
+    }
+
+private:
+    static uint64_t MakeMask(int bits) {
+        bits = std::min(bits, 63);
+        return ((1ULL << bits) - 1) << (64 - bits);
+    }
+
+    // 固定种子生成gear表，所有车端必须一致，否则同样的数据切不出同样的块
+    static const std::array<uint64_t, 256>& GearTable() {
+        static const std::array<uint64_t, 256> table = [] {
+            std::array<uint64_t, 256> t{};
+            uint64_t seed = 0x9E3779B97F4A7C15ULL;
+            for (auto& v : t) {
+                uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                v = z ^ (z >> 31);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    static std::string HexDigest(EVP_MD_CTX* ctx) {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLen = 0;
+        if (EVP_DigestFinal_ex(ctx, digest, &digestLen) != 1) {
+            return "";
+        }
+        std::ostringstream oss;
+        for (unsigned int i = 0; i < digestLen; ++i) {
+            oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(digest[i]);
+        }
+        return oss.str();
+    }
+
+    //单次顺序读文件，同时确定块边界和计算块hash
+    ErrorCode Scan() {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file) {
+            AD_ERROR(ContentChunker, "File %s open failed.", filePath.c_str());
+            return FILE_OPEN_FAILED;
+        }
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1) {
+            return HASH_FAILED;
+        }
+
+        const auto& gear = GearTable();
+        std::vector<char> buffer(kReadBufferSize);
+        uint64_t hash = 0;
+        uint64_t chunkStart = 0;
+        size_t chunkLen = 0;
+        fileSize = 0;
+
+        auto cut = [&]() -> bool {
+            Chunk chunk;
+            chunk.offset = chunkStart;
+            chunk.length = static_cast<uint32_t>(chunkLen);
+            chunk.hash = HexDigest(ctx.get());
+            if (chunk.hash.empty() || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1) {
+                return false;
+            }
+            chunks.emplace_back(std::move(chunk));
+            chunkStart += chunkLen;
+            chunkLen = 0;
+            hash = 0;
+            return true;
+        };
+
+        while (file) {
+            file.read(buffer.data(), buffer.size());
+            const size_t n = static_cast<size_t>(file.gcount());
+            if (n == 0) {
+                break;
+            }
+            size_t segmentStart = 0;
+            for (size_t i = 0; i < n; ++i) {
+                ++chunkLen;
+                if (chunkLen <= minSize) {
+                    continue; // 下限内不判断边界
+                }
+                hash = (hash << 1) + gear[static_cast<unsigned char>(buffer[i])];
+                const uint64_t mask = chunkLen < avgSize ? maskS : maskL;
+                if ((hash & mask) == 0 || chunkLen >= maxSize) {
+                    EVP_DigestUpdate(ctx.get(), buffer.data() + segmentStart, i + 1 - segmentStart);
+                    segmentStart = i + 1;
+                    if (!cut()) {
+                        return HASH_FAILED;
+                    }
+                }
+            }
+            EVP_DigestUpdate(ctx.get(), buffer.data() + segmentStart, n - segmentStart);
+            fileSize += n;
+        }
+        if (chunkLen > 0 && !cut()) {
+            return HASH_FAILED;
+        }
+        AD_INFO(ContentChunker, "fileSize:%d chunkCount:%d avgChunkSize:%d", static_cast<int>(fileSize),
+                static_cast<int>(chunks.size()), static_cast<int>(avgSize));
+        return SUCCESS;
+    }
+
+    static constexpr size_t kReadBufferSize = 1024 * 1024;
+
+    std::string filePath;
+    size_t minSize = 0;
+    size_t avgSize = 0;
+    size_t maxSize = 0;
+    uint64_t maskS = 0;
+    uint64_t maskL = 0;
+    size_t fileSize = 0;
+    std::vector<Chunk> chunks;
+    ErrorCode errorCode = SUCCESS;
+};
+
+}
@@ -38,6 +38,17 @@ bool FileStatusManager::UpdateFileStartChunk(const std::string& file_path, int s
     return SaveToFile();
 }
 
+//每上传成功一个分片就落盘一次，断电重启后可据此与服务端已上传分片比对
+bool FileStatusManager::UpdateUploadedPart(const std::string& file_path, int part_number, const std::string& etag) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!data_.contains(file_path)) {
+        AD_INFO(FileStatusManager, "File %s has no record.", file_path.c_str());
+        return false;
+    }
+    data_[file_path]["uploaded_url_map"][std::to_string(part_number)] = etag;
+    return SaveToFile();
+}
+
 std::optional<common::FileUploadRecord> FileStatusManager::GetFileRecord(const std::string& file_path) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!data_.contains(file_path)) {
@@ -53,6 +64,12 @@ std::optional<common::FileUploadRecord> FileStatusManager::GetFileRecord(const s
         for (const auto& [slice_id, url] : data_[file_path]["upload_url_map"].get<std::map<std::string, std::string>>()) {
             record.upload_url_map[std::stoi(slice_id)] = url;
         }
+        if (data_[file_path].contains("uploaded_url_map")) {
+            for (const auto& [slice_id, etag] : data_[file_path]["uploaded_url_map"].get<std::map<std::string, std::string>>()) {
+                record.uploaded_url_map[std::stoi(slice_id)] = etag;
+            }
+        }
+        record.create_time_ms = data_[file_path].value("create_time_ms", static_cast<uint64_t>(0));
         // record.upload_url_map = data_[file_path]["upload_url_map"].get<std::map<int, std::string>>();
     } catch (const std::exception& e) {
         AD_ERROR(FileStatusManager, "Parse json error: %d", e.what());
@@ -90,6 +107,11 @@ json FileStatusManager::ConvertFileRecordToJson(const common::FileUploadRecord&
     for (const auto& [slice_id, url] : record.upload_url_map) {
         j["upload_url_map"][std::to_string(slice_id)] = url;
     }
+    j["uploaded_url_map"] = json::object();
+    for (const auto& [slice_id, etag] : record.uploaded_url_map) {
+        j["uploaded_url_map"][std::to_string(slice_id)] = etag;
+    }
+    j["create_time_ms"] = record.create_time_ms;
 
     return j;
 }
@@ -34,6 +34,7 @@ public:
     bool AddFileRecord(const std::string& file_path, const common::FileUploadRecord& record);
     bool DeleteFileRecord(const std::string& file_path);
     bool UpdateFileStartChunk(const std::string& file_path, int start_chunk);
+    bool UpdateUploadedPart(const std::string& file_path, int part_number, const std::string& etag);
     std::optional<common::FileUploadRecord> GetFileRecord(const std::string& file_path);
 
 private:
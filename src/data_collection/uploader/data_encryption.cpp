@@ -10,6 +10,8 @@
 #include <iomanip>
 
 #include "common/log/logger.h"
+#include "common/metrics/metrics_registry.h"
+#include "common/metrics/span_tracer.h"
 #include "common/utils/utils.h"
 #include "common/utils/sRegex.h"
 
@@ -135,7 +137,19 @@ void DataEncryption::ProcessQueue() {
         // std::string encrypted_file = current_file + ".enc";
         std::cout  << "Encrypting file:   " << encrypted_file << std::endl;
 
-        auto success = EncryptFileWithEnvelope(current_file, encrypted_file);
+        static const auto& stage = common::MetricsRegistry::getInstance().GetStage("encrypt");
+        std::error_code size_ec;
+        const auto plain_size = std::filesystem::file_size(current_file, size_ec);
+        int success = 0;
+        {
+            common::ScopedLatency latency(stage.duration);
+            success = EncryptFileWithEnvelope(current_file, encrypted_file);
+        }
+        stage.total->Add();
+        stage.bytes->Add(size_ec ? 0 : plain_size);
+        if (success != 0) {
+            stage.errors->Add();
+        }
         AD_INFO(DataEncryption, "success: %d", success);
 
         if (success == 0) {
@@ -351,6 +365,7 @@ int DataEncryption::rsa_chunk_encrypt(std::ifstream& in_file, std::ofstream& out
 }
 
 int DataEncryption::EncryptFileWithEnvelope(const std::string &plainfile, const std::string &cipherfile) {
+    common::TraceSpan trace_span("encrypt", plainfile);
     //1.读取文件内容
     std::ifstream in_file(plainfile, std::ios::binary);
     if (!in_file) {
@@ -455,6 +470,7 @@ int DataEncryption::DecryptFileWithEnvelope(const std::string& cipherfile, const
 }
 
 int DataEncryption::EncryptChunkFileWithEnvelope(const std::string &plainfile, const std::string &cipherfile) {
+    common::TraceSpan trace_span("encrypt", plainfile);
     //1.读取文件内容
     std::ifstream in_file(plainfile, std::ios::binary);
     if (!in_file) {
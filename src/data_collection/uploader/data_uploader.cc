@@ -5,12 +5,18 @@
 #include <map>
 #include <chrono>
 #include <iomanip>
+#include <sstream>
+#include <cctype>
+#include <sys/stat.h>
 #include <nlohmann/json.hpp>
 
 #include "common/file_splitter.hpp"
+#include "common/content_chunker.hpp"
 #include "common/utils/utils.h"
 #include "common/utils/sRegex.h"
 #include "common/log/logger.h"
+#include "common/metrics/metrics_registry.h"
+#include "common/metrics/span_tracer.h"
 #include "common/data.h"
 
 using json = nlohmann::json;
@@ -18,6 +24,48 @@ using json = nlohmann::json;
 namespace dcp::uploader
 {
 
+namespace {
+
+// 服务端返回的 etag 可能带引号或为大写，统一后再比较
+std::string NormalizeEtag(const std::string& etag) {
+    std::string out;
+    out.reserve(etag.size());
+    for (char c : etag) {
+        if (c == '"' || c == ' ') {
+            continue;
+        }
+        out.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+    return out;
+}
+
+// 单段上传的 etag 即分片内容的 md5
+std::string ChunkMd5Hex(const std::vector<char>& buffer) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (EVP_Digest(buffer.data(), buffer.size(), digest, &digest_len, EVP_md5(), nullptr) != 1) {
+        return "";
+    }
+    std::ostringstream oss;
+    for (unsigned int i = 0; i < digest_len; ++i) {
+        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(digest[i]);
+    }
+    return oss.str();
+}
+
+// 压缩包落盘（mtime）到开始上传之间在上传目录中排队的时间
+void TraceUploadQueue(const std::string& path) {
+    auto& tracer = common::SpanTracer::getInstance();
+    struct stat st;
+    if (!tracer.IsEnabled() || stat(path.c_str(), &st) != 0) {
+        return;
+    }
+    const uint64_t ready_us = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000ULL + st.st_mtim.tv_nsec / 1000;
+    tracer.Record("upload_queue", path, ready_us, common::GetCurrentTimestamp());
+}
+
+}
+
 bool DataUploader::Init(const common::AppConfigData::DataUpload& config) {
     config_ = config;
     stop_flag_ = false;
@@ -30,9 +78,12 @@ bool DataUploader::Init(const common::AppConfigData::DataUpload& config) {
 
     AD_INFO(DataUploader, "encryptorInit success!");
 
+    part_metrics_ = common::MetricsRecorder::getInstance().RegisterSeries(
+        "uploader_part", {"part", "bytes", "attempt", "duration_ms", "ok"});
+
     file_status_manager_ = std::make_unique<FileStatusManager>(config_.fileRecordPath);
-    auto ret = data_proto_->Init(config_.clientCertPath, config_.clientKeyPath, config_.caCertPath);
-    return ret == CURLE_OK;
+    data_proto_ = std::make_shared<DataProto>();
+    return data_proto_->Init(config_.gateway, config_.clientCertPath, config_.clientKeyPath, config_.caCertPath);
 }
 
 DataUploader::~DataUploader() {
@@ -49,89 +100,128 @@ bool DataUploader::Start()
     return true;
 }
 
-//record用于存储文件上传信息   
-//检查文件是否有上传记录，获取文件的上传状态并根据需要返回相关的上传信息。
-//如果文件没有上传记录，则发起请求来获取上传的 URL 和相关信息
-ErrorCode DataUploader::GetUploadInfo(const std::string& full_path, common::UploadType upload_type, int chunk_count, common::FileUploadRecord& record) {
-    record.uploaded_url_map.clear();
-    //检查是否已有文件上传记录
-    if (file_status_manager_->GetFileRecord(full_path)) {
-        record = file_status_manager_->GetFileRecord(full_path).value();
-        record.start_chunk = 0;//从文件起始位置开始上传
-        common::UploadStatusResp resp;
-        auto ret = data_proto_->GetUploadStatus(record.file_uuid, resp);
-        if (ret != ErrorCode::SUCCESS) {
-            AD_ERROR(DataUploader, "Failed to get upload status.");
-            return ret;
+//record用于存储文件上传信息
+//检查文件是否有上传记录：有则与服务端已上传分片对账，只保留服务端确认且etag一致的分片；
+//记录与文件不匹配、会话过期或服务端已丢弃会话时，删除本地记录并重新申请上传地址
+ErrorCode DataUploader::GetUploadInfo(const std::string& full_path, common::UploadType upload_type, const FileSplitter& splitter, common::FileUploadRecord& record) {
+    const int chunk_count = splitter.getChunkCount();
+    auto local_record = file_status_manager_->GetFileRecord(full_path);
+    if (local_record) {
+        record = local_record.value();
+        if (record.chunk_count != chunk_count || record.upload_url_map.empty()) {
+            AD_WARN(DataUploader, "Record of %s does not match file, restart upload.", full_path.c_str());
+        } else if (IsSessionExpired(record)) {
+            AD_WARN(DataUploader, "Upload session %s expired, restart upload.", record.file_uuid.c_str());
+        } else {
+            auto ret = ReconcileUploadStatus(splitter, record);
+            if (ret == ErrorCode::SUCCESS) {
+                file_status_manager_->AddFileRecord(full_path, record);
+                return ret;
+            }
+            if (ret != ErrorCode::SESSION_EXPIRED) {
+                // 网络异常时保留本地记录，下次再对账
+                AD_ERROR(DataUploader, "Failed to get upload status.");
+                return ret;
+            }
+            AD_WARN(DataUploader, "Upload session %s dropped by server, restart upload.", record.file_uuid.c_str());
         }
-        // json j = common::ParseJsonFromString(resp);
-        // std::cout << j << std::endl;
-        // if (!j.contains("statusCode") || !j.contains("data") || !j["data"].contains("uploadStatus") || !j["data"].contains("uploadedPartList")) {
-        //     AD_ERROR("Invalid URL response.");
-        //     return ErrorCode::INVALID_RESPONSE;
-        // }
-        // if (j["statusCode"] != "0") {
-        //     AD_ERROR("Status code is abnormal.");
-        //     return ErrorCode::INVALID_RESPONSE;
-        // }
-        // if (j["data"]["uploadStatus"] == 3) {
-        //     record.start_chunk = chunk_count+1;
-        //     return ErrorCode::SUCCESS;
-        // }
-        // if (j["data"]["uploadedPartList"].is_array()) {
-        //     // record.start_chunk = j["data"]["uploadedPartList"].size();
-        //     for (const auto& uploadedPart: j["data"]["uploadedPartList"]) {
-        //         record.uploaded_url_map.emplace(uploadedPart["partNumber"].get<int>(),uploadedPart["etag"]);
-        //     }
-        //     return ErrorCode::SUCCESS;
-        // }
-    } else {
-        common::UploadUrlReq upload_req;
-        upload_req.type = common::UploadType::ActivelyReport;
-        upload_req.part_number = chunk_count;
-        upload_req.filename = fs::path(full_path).filename().string();
-        upload_req.vin = common::Vin();
-        
-        //模拟上传URL的获取过程，并将结果存入record.uploadedUrlMap中。 
-        // for(int i=0; i<chunk_count; i++){
-        //     record.upload_url_map.emplace(i+1, "http:");
-        // }  
-        // record.file_uuid ="sss";
-        // record.upload_id = "123456789";
-        // record.chunk_count = chunk_count;
-        // record.start_chunk = 0;
-        // file_status_manager_->AddFileRecord(full_path, record);
-        // return ErrorCode::SUCCESS;
-
-        // std::string resp;
-        common::UploadUrlResp resp;
-        auto ret = data_proto_->GetUploadUrl(upload_req, resp);
-        if (ret != ErrorCode::SUCCESS) {
-            AD_ERROR(DataUploader, "Failed to get upload url.");
-            return ret;
+        file_status_manager_->DeleteFileRecord(full_path);
+    }
+    return CreateUploadSession(full_path, upload_type, chunk_count, record);
+}
+
+//申请分段上传地址，并立即落盘，保证中断后可以续传
+ErrorCode DataUploader::CreateUploadSession(const std::string& full_path, common::UploadType upload_type, int chunk_count, common::FileUploadRecord& record) {
+    common::UploadUrlReq upload_req;
+    upload_req.type = common::UploadType::ActivelyReport;
+    upload_req.part_number = chunk_count;
+    upload_req.filename = fs::path(full_path).filename().string();
+    upload_req.vin = common::Vin();
+    upload_req.expire_minutes = config_.multipartExpireMinutes;
+
+    common::UploadUrlResp resp;
+    auto ret = data_proto_->GetUploadUrl(upload_req, resp);
+    if (ret != ErrorCode::SUCCESS) {
+        AD_ERROR(DataUploader, "Failed to get upload url.");
+        return ret;
+    }
+    if (resp.status_code != "0" || resp.data.upload_url_map.empty()) {
+        AD_ERROR(DataUploader, "Status code is abnormal: %s", resp.status_code.c_str());
+        return ErrorCode::INVALID_RESPONSE;
+    }
+
+    record = common::FileUploadRecord{};
+    try {
+        for (const auto& [slice_id, url] : resp.data.upload_url_map) {
+            record.upload_url_map[std::stoi(slice_id)] = url;
         }
-        // json j = common::ParseJsonFromString(resp);
-        // if (!j.contains("statusCode") || !j.contains("data") || !j["data"].contains("partPresignUploadUrlMap") ||
-        //     !j["data"].contains("fileUuid") || !j["data"].contains("uploadId")) {
-        //     AD_ERROR("Invalid URL response.");
-        //     return ErrorCode::INVALID_RESPONSE;
-        // }
-        // if (j["statusCode"] != "0") {
-        //     AD_ERROR("Status code is abnormal.");
-        //     return ErrorCode::INVALID_RESPONSE;
-        // }
-        // for (const auto& [slice_id, url] : j["data"]["partPresignUploadUrlMap"].get<std::map<std::string, std::string>>()) {
-        //     record.upload_url_map[std::stoi(slice_id)] = url;
-        // }
-        // record.upload_url_map = j["data"]["partPresignUploadUrlMap"].get<std::map<std::string, std::string>>();
-        // record.upload_url_map = resp.data.upload_url_map;
-        record.file_uuid = resp.data.file_uuid;
-        record.upload_id = resp.data.upload_id;
-        record.chunk_count = chunk_count;
-        record.start_chunk = 0;
+    } catch (const std::exception& e) {
+        AD_ERROR(DataUploader, "Invalid part number in url map: %s", e.what());
+        return ErrorCode::INVALID_RESPONSE;
+    }
+    record.file_uuid = resp.data.file_uuid;
+    record.upload_id = resp.data.upload_id;
+    record.chunk_count = chunk_count;
+    record.start_chunk = 0;
+    record.create_time_ms = common::GetCurrentTimestampMs();
+    file_status_manager_->AddFileRecord(full_path, record);
+    return ErrorCode::SUCCESS;
+}
+
+//以服务端已上传分片列表为准修正本地记录：本地有而服务端没有的分片重传，etag不一致的分片重传
+ErrorCode DataUploader::ReconcileUploadStatus(const FileSplitter& splitter, common::FileUploadRecord& record) {
+    common::UploadStatusResp resp;
+    auto ret = data_proto_->GetUploadStatus(record.file_uuid, resp);
+    if (ret != ErrorCode::SUCCESS) {
+        return ret;
+    }
+    if (resp.status_code != "0" || resp.data.upload_status == common::UploadStatus::Failed) {
+        return ErrorCode::SESSION_EXPIRED;
+    }
+    if (resp.data.upload_status == common::UploadStatus::Uploaded) {
+        record.start_chunk = record.chunk_count + 1;
         return ErrorCode::SUCCESS;
     }
-    return ErrorCode::UNKNOWN_ERROR;
+
+    std::map<int, std::string> confirmed;
+    for (const auto& part : resp.data.uploaded_part_list) {
+        if (record.upload_url_map.count(part.part_number) == 0) {
+            continue;
+        }
+        std::string local_etag;
+        auto it = record.uploaded_url_map.find(part.part_number);
+        if (it != record.uploaded_url_map.end()) {
+            local_etag = NormalizeEtag(it->second);
+        } else {
+            // 分片已传完但本地未来得及落盘，用分片内容的md5校验
+            std::vector<char> buffer;
+            if (splitter.getChunkData(part.part_number, buffer) != FileSplitter::SUCCESS) {
+                continue;
+            }
+            local_etag = ChunkMd5Hex(buffer);
+        }
+        auto server_etag = NormalizeEtag(part.etag);
+        if (server_etag.empty() || server_etag != local_etag) {
+            AD_WARN(DataUploader, "Part %d etag mismatch, local: %s, server: %s",
+                    part.part_number, local_etag.c_str(), server_etag.c_str());
+            continue;
+        }
+        confirmed[part.part_number] = server_etag;
+    }
+    AD_INFO(DataUploader, "Upload session %s: %d/%d parts confirmed by server.",
+            record.file_uuid.c_str(), static_cast<int>(confirmed.size()), static_cast<int>(record.chunk_count));
+    record.uploaded_url_map.swap(confirmed);
+    record.start_chunk = 0;
+    return ErrorCode::SUCCESS;
+}
+
+bool DataUploader::IsSessionExpired(const common::FileUploadRecord& record) const {
+    // 旧版本记录没有创建时间，交给服务端状态判断
+    if (record.create_time_ms == 0 || config_.multipartExpireMinutes <= 0) {
+        return false;
+    }
+    const uint64_t expire_ms = static_cast<uint64_t>(config_.multipartExpireMinutes) * 60 * 1000;
+    return common::GetCurrentTimestampMs() > record.create_time_ms + expire_ms;
 }
 
 void DataUploader::GetUploadBagInfo(dcp::common::FileUploadProgress& upload_progress) {
@@ -159,8 +249,94 @@ void DataUploader::GetUploadBagInfo(dcp::common::FileUploadProgress& upload_prog
     // data_reporter_->addUploadBagInfo(bag_distance, upload_progress.dataSize);
 }
 
+//按内容分块去重上传：先查询服务端缺失的块，只上传缺失块，再按块顺序通知服务端合成文件。
+//服务端记录的是块而非会话，中断后重新查询即可续传，不需要本地记录
+ErrorCode DataUploader::UploadFileDedup(const std::string& full_path, common::UploadType upload_type) {
+    ContentChunker chunker(full_path, config_.dedup.minChunkKb, config_.dedup.avgChunkKb, config_.dedup.maxChunkKb);
+    if (chunker.getErrorCode() != ContentChunker::SUCCESS) {
+        AD_ERROR(DataUploader, "Chunk File Failed.");
+        return ErrorCode::FILE_CHUNK_ERROR;
+    }
+    const auto& chunks = chunker.getChunks();
+
+    common::ChunkQueryReq query_req;
+    query_req.vin = common::Vin();
+    for (const auto& chunk : chunks) {
+        query_req.chunk_hash_list.push_back(chunk.hash);
+    }
+    common::ChunkQueryResp query_resp;
+    auto ret = data_proto_->QueryMissingChunks(query_req, query_resp);
+    if (ret != ErrorCode::SUCCESS) {
+        return ret;
+    }
+    if (query_resp.status_code != "0") {
+        AD_ERROR(DataUploader, "Chunk query status code is abnormal: %s", query_resp.status_code.c_str());
+        return ErrorCode::INVALID_RESPONSE;
+    }
+
+    auto& missing = query_resp.data.missing_chunk_url_map;
+    uint64_t uploaded_bytes = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto it = missing.find(chunks[i].hash);
+        if (it == missing.end()) {
+            continue;
+        }
+        std::vector<char> buffer;
+        if (chunker.getChunkData(i, buffer) != ContentChunker::SUCCESS) {
+            AD_ERROR(DataUploader, "Get chunk data failed.");
+            return ErrorCode::FILE_CHUNK_ERROR;
+        }
+        bool chunk_ok = false;
+        for (int retry = 0; retry < config_.retryCount && !stop_flag_; ++retry) {
+            if (retry > 0) {
+                std::this_thread::sleep_for(std::chrono::seconds(config_.retryIntervalSec));
+                AD_INFO(DataUploader, "Retry to upload chunk: %s", chunks[i].hash.c_str());
+            }
+            std::string etag;
+            if (data_proto_->UploadFileChunk(buffer, it->second, etag) == ErrorCode::SUCCESS) {
+                chunk_ok = true;
+                break;
+            }
+        }
+        if (!chunk_ok) {
+            AD_ERROR(DataUploader, "Chunk upload failed: %s", chunks[i].hash.c_str());
+            return ErrorCode::UPLOAD_INCOMPLETE;
+        }
+        uploaded_bytes += buffer.size();
+        // 同一文件内重复的块只传一次
+        missing.erase(it);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config_.uploadFileSliceIntervalMs));
+    }
+
+    common::ChunkCommitReq commit_req;
+    commit_req.vin = common::Vin();
+    commit_req.type = upload_type;
+    commit_req.filename = fs::path(full_path).filename().string();
+    commit_req.file_size = chunker.getFileSize();
+    commit_req.chunk_hash_list = std::move(query_req.chunk_hash_list);
+    common::CompleteUploadResp commit_resp;
+    ret = data_proto_->CommitChunks(commit_req, commit_resp);
+    if (ret != ErrorCode::SUCCESS || commit_resp.status_code != "0") {
+        AD_ERROR(DataUploader, "Commit chunks failed.");
+        return ErrorCode::UPLOAD_INCOMPLETE;
+    }
+    AD_INFO(DataUploader, "%s was uploaded with dedup, %d chunks, sent %.2f/%.2f MB.", full_path.c_str(),
+            static_cast<int>(chunks.size()), static_cast<double>(uploaded_bytes) / 1024 / 1024,
+            static_cast<double>(chunker.getFileSize()) / 1024 / 1024);
+    return ErrorCode::SUCCESS;
+}
+
 //将大文件切割成小分片，通过http put将分片上传到服务器，上传过程中提供重试机制，并在上传完成后通知服务器上传成功
 ErrorCode DataUploader::UploadFile(const std::string& full_path, common::UploadType upload_type) {
+    if (config_.dedup.enabled) {
+        auto ret = UploadFileDedup(full_path, upload_type);
+        // 网关不支持按块上传时退回分段上传
+        if (ret != ErrorCode::INVALID_RESPONSE) {
+            return ret;
+        }
+        AD_WARN(DataUploader, "Dedup upload not supported by gateway, fall back to multipart upload.");
+    }
+
     //分割切片
     FileSplitter splitter(full_path, config_.uploadFileSliceSizeMb);
     if (splitter.getErrorCode() != FileSplitter::SUCCESS) {
@@ -170,8 +346,7 @@ ErrorCode DataUploader::UploadFile(const std::string& full_path, common::UploadT
 
     //获取文件上传信息
     common::FileUploadRecord record;
-    // DataUploader::ErrorCode ret;
-    auto ret = GetUploadInfo(full_path, upload_type, splitter.getChunkCount(), record);
+    auto ret = GetUploadInfo(full_path, upload_type, splitter, record);
     if (ret != ErrorCode::SUCCESS) {
         AD_ERROR(DataUploader, "Get Upload Info Failed.");
         return ret;
@@ -183,7 +358,6 @@ ErrorCode DataUploader::UploadFile(const std::string& full_path, common::UploadT
         return ErrorCode::SUCCESS;
     }
 
-    int complete_chunk = 0;
     common::CompleteUploadReq complete_req;
     complete_req.upload_status = common::UploadStatus::Uploaded;
     common::FileUploadProgress upload_progress;
@@ -192,20 +366,19 @@ ErrorCode DataUploader::UploadFile(const std::string& full_path, common::UploadT
     upload_progress.dataSize = static_cast<double>(splitter.getFileSize())/1024/1024; 
     upload_progress.uploadStatus = 0;
     for (const auto& [cur_id, url] : record.upload_url_map) {
-        AD_INFO(DataUploader, "slice_id: %d", cur_id);
-        auto slice_id = std::to_string(cur_id + 1);
-        
-        // auto cur_id = std::stoi(slice_id);
-        if (record.uploaded_url_map.count(cur_id) > 0) {
+        auto slice_id = std::to_string(cur_id);
+        auto uploaded = record.uploaded_url_map.find(cur_id);
+        if (uploaded != record.uploaded_url_map.end()) {
             AD_INFO(DataUploader, "slice_id: %d has been uploaded", cur_id);
+            complete_req.etag_map[slice_id] = uploaded->second;
             continue;
         }
         std::vector<char> buffer;
-        // splitter.getChunkData(cur_id, buffer);
         if (splitter.getChunkData(cur_id, buffer) != FileSplitter::ErrorCode::SUCCESS) {
             AD_ERROR(DataUploader, "Get chunk data failed.");
             return ErrorCode::FILE_CHUNK_ERROR;
         }
+        bool part_ok = false;
         for (int i = 0; i < config_.retryCount; ++i) {
             if (i > 0) {
                 std::this_thread::sleep_for(std::chrono::seconds(config_.retryIntervalSec));
@@ -213,62 +386,46 @@ ErrorCode DataUploader::UploadFile(const std::string& full_path, common::UploadT
             }
 
             std::string resp;
+            const auto part_start = std::chrono::steady_clock::now();
             auto ret = data_proto_->UploadFileChunk(buffer, url, resp);
+            common::MetricsRecorder::getInstance().Record(part_metrics_, {
+                static_cast<double>(cur_id), static_cast<double>(buffer.size()), static_cast<double>(i),
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - part_start).count(),
+                ret == ErrorCode::SUCCESS ? 1.0 : 0.0});
             if (ret == ErrorCode::SUCCESS) {
                 AD_INFO(DataUploader, "Upload chunk %s succeeded.", slice_id.c_str());
-                complete_chunk = cur_id;
                 complete_req.etag_map[slice_id] = resp;
+                record.uploaded_url_map[cur_id] = resp;
+                file_status_manager_->UpdateUploadedPart(full_path, cur_id, resp);
+                part_ok = true;
                 break;
             }
-            complete_req.upload_status = common::UploadStatus::Failed;
-
-            // AD_INFO("buffer size: %d", buffer.size());
-            // auto ret = curl_wrapper_.HttpPut(
-            //     url, buffer, resp, {"Content-Type:"});
-            // //模拟HTTP PUT请求，返回CURLE_OK表示成功。
-            // // auto ret = CURLE_OK;
-            // // resp = "aaa";
-            //
-            // AD_INFO("HttpPut resp tag: %s", resp.c_str());
-            // if (resp.length() > 0) {
-            //     complete_req.etag_map[std::to_string(cur_id)] = resp;
-            // }
-            // AD_INFO("HttpPut ret: %d", ret);
-            // std::cout << "ret == CURLE_OK:" << (ret == CURLE_OK) << (resp.length() > 0) << std::endl;
-            // if (ret == CURLE_OK && resp.length() > 0) {
-            //     std::cout << "upload succeeded" << std::endl;
-            //     AD_INFO("Chunk upload succeeded: %d", cur_id);
-            //     upload_progress.uploadUrl = url;
-            //     upload_progress.progress = static_cast<float>(cur_id)/static_cast<float>(record.chunk_count);
-            //     std::this_thread::sleep_for(std::chrono::milliseconds(config_.uploadFileSliceIntervalMs));
-            //     if(cur_id < record.chunk_count){
-            //         // data_reporter_->publishUploadMessage(upload_progress);
-            //     }
-            //     break;
-            // }
-            // complete_req.upload_status = common::UploadStatus::Failed;
-            // // break;
         }
-        if (complete_req.upload_status == common::UploadStatus::Failed) {
+        if (!part_ok) {
+            complete_req.upload_status = common::UploadStatus::Failed;
             AD_ERROR(DataUploader, "Chunk upload failed: %d", cur_id);
             break;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(config_.uploadFileSliceIntervalMs));
     }
 
+    //分片未传完时不通知服务端失败，保留会话以便下次续传
+    if (complete_req.upload_status != common::UploadStatus::Uploaded) {
+        AD_ERROR(DataUploader, "Upload of %s interrupted, %d/%d parts uploaded.", full_path.c_str(),
+                 static_cast<int>(record.uploaded_url_map.size()), static_cast<int>(record.chunk_count));
+        return ErrorCode::UPLOAD_INCOMPLETE;
+    }
+
     complete_req.type = common::UploadType::ActivelyReport;
     complete_req.file_uuid = record.file_uuid;
     complete_req.upload_id = record.upload_id;
     complete_req.task_id = "";
     complete_req.vin = common::Vin();
-    // std::string complete_resp;
     common::CompleteUploadResp complete_resp;
     ret = data_proto_->CompleteUpload(complete_req, complete_resp);
 
     AD_INFO(DataUploader, "Download url: %s", complete_resp.data.presign_download_url.c_str());
-    if (ret != ErrorCode::SUCCESS || complete_req.upload_status != common::UploadStatus::Uploaded) {
-        record.start_chunk = complete_chunk + 1;
-        file_status_manager_->AddFileRecord(full_path, record);
+    if (ret != ErrorCode::SUCCESS || complete_resp.status_code != "0") {
         AD_ERROR(DataUploader, "Complete upload failed.");
         return ErrorCode::UPLOAD_INCOMPLETE;
     }
@@ -303,6 +460,10 @@ void DataUploader::LoadFileList() {
         for (const auto& entry : fs::directory_iterator(upload_dir_today)) {
             // std::cout << "Path: " << entry.path().string() << std::endl;   
             if (entry.is_regular_file() && common::IsMatch(entry.path().filename().string(), config_.filenameRegex)) {
+                // 关键触发已流式上传完成
+                if (fs::exists(entry.path().string() + ".streamed")) {
+                    continue;
+                }
                 upload_queue.Push({entry.path().string(), common::UploadType::ActivelyReport});
                 std::cout << "Path push: " << entry.path().string() << std::endl;   
             }
@@ -330,18 +491,40 @@ bool DataUploader::Stop() {
     return true;
 }
 
+//上传节奏可热更新，每个文件开始前从最新配置快照刷新，只在上传线程内读写
+void DataUploader::RefreshPacing() {
+    const auto app_config = common::AppConfig::getInstance().Snapshot();
+    const auto& upload = app_config->dataUpload;
+    if (upload.retryCount <= 0) {
+        return; // 未加载配置文件，沿用Init传入的参数
+    }
+    if (upload.uploadFileSliceIntervalMs != config_.uploadFileSliceIntervalMs ||
+        upload.uploadFileIntervalMs != config_.uploadFileIntervalMs ||
+        upload.retryCount != config_.retryCount || upload.retryIntervalSec != config_.retryIntervalSec) {
+        AD_INFO(DataUploader, "Upload pacing updated, slice interval: %lldms, file interval: %lldms, retry: %d",
+                upload.uploadFileSliceIntervalMs, upload.uploadFileIntervalMs, upload.retryCount);
+    }
+    config_.uploadFileSliceIntervalMs = upload.uploadFileSliceIntervalMs;
+    config_.uploadFileIntervalMs = upload.uploadFileIntervalMs;
+    config_.retryCount = upload.retryCount;
+    config_.retryIntervalSec = upload.retryIntervalSec;
+}
+
 //从队列中抽出文件进行上传，成功则删除文件，失败则重试上传
 void DataUploader::ProcessQueue() {
     auto& upload_queue = common::UploadQueue::GetInstance();
-    const auto& debug_config = common::AppConfig::getInstance().GetConfig().debug;
+    const auto app_config = common::AppConfig::getInstance().Snapshot();
+    const auto& debug_config = app_config->debug;
     while (!stop_flag_) {
         if (upload_queue.Empty()) {
             AD_INFO(DataUploader, "No files in queue.");
             break;
         }
+        RefreshPacing();
 
         common::UploadItem current_file = upload_queue.Front().value();
         AD_INFO(DataUploader, "begin upload file %s.", current_file.file_path.c_str());
+        TraceUploadQueue(current_file.file_path);
 
         std::filesystem::path current_file_path(current_file.file_path);
         std::string encrypted_file = encryptor_->enc_dir_ + "/" + current_file_path.filename().string() + ".enc";
@@ -351,7 +534,19 @@ void DataUploader::ProcessQueue() {
             std::string decrypted_file = encryptor_->enc_dir_ + "/" + current_file_path.filename().string() + ".dec";
             if (!debug_config.closeDataEnc)
             {
-                auto success_enc = encryptor_->EncryptChunkFileWithEnvelope(current_file.file_path, encrypted_file);
+                static const auto& encrypt_stage = common::MetricsRegistry::getInstance().GetStage("encrypt");
+                std::error_code size_ec;
+                const auto plain_size = std::filesystem::file_size(current_file.file_path, size_ec);
+                int success_enc = 0;
+                {
+                    common::ScopedLatency latency(encrypt_stage.duration);
+                    success_enc = encryptor_->EncryptChunkFileWithEnvelope(current_file.file_path, encrypted_file);
+                }
+                encrypt_stage.total->Add();
+                encrypt_stage.bytes->Add(size_ec ? 0 : plain_size);
+                if (success_enc != 0) {
+                    encrypt_stage.errors->Add();
+                }
                 // auto success_enc = encryptor_->EncryptFileWithEnvelope(current_file, encrypted_file);
                 // encrypted_file = "/home/nvidia/userdata/data_collection/readme.lz4.enc";
                 // decrypted_file = "/home/nvidia/userdata/data_collection/readme.zip";
@@ -370,7 +565,21 @@ void DataUploader::ProcessQueue() {
             AD_INFO(DataUploader, "file: %s already encrypted.", current_file.file_path.c_str());
         }
        
-        auto success_upload = UploadFile(encrypted_file, current_file.upload_type);
+        static const auto& upload_stage = common::MetricsRegistry::getInstance().GetStage("upload");
+        std::error_code size_ec;
+        const auto upload_size = std::filesystem::file_size(encrypted_file, size_ec);
+        ErrorCode success_upload;
+        {
+            common::ScopedLatency latency(upload_stage.duration);
+            common::TraceSpan trace_span("upload", encrypted_file);
+            success_upload = UploadFile(encrypted_file, current_file.upload_type);
+        }
+        upload_stage.total->Add();
+        if (success_upload == ErrorCode::SUCCESS) {
+            upload_stage.bytes->Add(size_ec ? 0 : upload_size);
+        } else {
+            upload_stage.errors->Add();
+        }
         
         AD_INFO(DataUploader, "upload success: %d", success_upload);
 
@@ -18,6 +18,7 @@
 #include "common/config/app_config.h"
 #include "data_encryption.h"
 #include "common/upload_queue.hpp"
+#include "common/metrics/metrics_recorder.h"
 
 
 namespace dcp::uploader
@@ -25,6 +26,8 @@ namespace dcp::uploader
 
 namespace fs = std::filesystem;
 
+class FileSplitter;
+
 class DataUploader {
 public:
   DataUploader() = default;
@@ -36,10 +39,15 @@ public:
   ErrorCode UploadFile(const std::string& full_path, common::UploadType upload_type);
 
 private:
-  ErrorCode GetUploadInfo(const std::string& full_path, common::UploadType upload_type, int chunk_count, common::FileUploadRecord& record);
+  ErrorCode UploadFileDedup(const std::string& full_path, common::UploadType upload_type);
+  ErrorCode GetUploadInfo(const std::string& full_path, common::UploadType upload_type, const FileSplitter& splitter, common::FileUploadRecord& record);
+  ErrorCode CreateUploadSession(const std::string& full_path, common::UploadType upload_type, int chunk_count, common::FileUploadRecord& record);
+  ErrorCode ReconcileUploadStatus(const FileSplitter& splitter, common::FileUploadRecord& record);
+  bool IsSessionExpired(const common::FileUploadRecord& record) const;
   void Run();
   void LoadFileList();
   void ProcessQueue();
+  void RefreshPacing();
   void GetUploadBagInfo(dcp::common::FileUploadProgress& upload_progress);
 
   std::unique_ptr<FileStatusManager> file_status_manager_;
@@ -51,6 +59,7 @@ private:
   std::atomic<bool> stop_flag_;
   std::unique_ptr<DataEncryption> encryptor_;
   std::shared_ptr<DataProto> data_proto_;
+  common::MetricSeries* part_metrics_ = nullptr;
 
 };
 
@@ -40,8 +40,15 @@ bool DataProto::Init(const std::string& gateway,
     return ret == CURLE_OK && mqtt_wrapper_ != nullptr;
 }
 
+std::string DataProto::BaseUrl() const {
+    if (gateway_.find("://") != std::string::npos) {
+        return gateway_;
+    }
+    return "https://" + gateway_;
+}
+
 ErrorCode DataProto::GetQueryTask(const std::string& vin, common::QueryTaskResp& resp) {
-    url_ = "https://" + gateway_ + "/feedback/driving/queryTask?vin=" + vin;
+    url_ = BaseUrl() + "/feedback/driving/queryTask?vin=" + vin;
     std::string resp_str;
     auto ret = curl_wrapper_.HttpGet(url_, resp_str, {"Accept: application/json"});
     AD_WARN(DataProto, "Response: %s", resp_str.c_str());
@@ -54,20 +61,20 @@ ErrorCode DataProto::GetQueryTask(const std::string& vin, common::QueryTaskResp&
 
 ErrorCode DataProto::SendUploadMqttCmd(std::atomic<bool>& stop_flag) {
     // 读取mqtt配置文件
-    const auto& app_config = common::AppConfig::getInstance().GetConfig();
+    const auto app_config = common::AppConfig::getInstance().Snapshot();
 
     // mqtt
-    std::string mqtt_broker_ssl = app_config.dataProto.mqtt.broker_ssl;
-    std::string mqtt_username = app_config.dataProto.mqtt.username;
-    std::string mqtt_password = app_config.dataProto.mqtt.password;
+    std::string mqtt_broker_ssl = app_config->dataProto.mqtt.broker_ssl;
+    std::string mqtt_username = app_config->dataProto.mqtt.username;
+    std::string mqtt_password = app_config->dataProto.mqtt.password;
 
-    std::string ca_cert = app_config.dataUpload.caCertPath;
-    std::string client_cert = app_config.dataUpload.clientCertPath;
-    std::string client_key = app_config.dataUpload.clientKeyPath;
+    std::string ca_cert = app_config->dataUpload.caCertPath;
+    std::string client_cert = app_config->dataUpload.clientCertPath;
+    std::string client_key = app_config->dataUpload.clientKeyPath;
 
     mqtt_wrapper_ = std::make_shared<MqttWrapper>();
-    if (!app_config.debug.closeMqttSsl) {
-        mqtt_wrapper_->Init(mqtt_broker_ssl, "shadow_tbox_" + app_config.dataProto.vin,
+    if (!app_config->debug.closeMqttSsl) {
+        mqtt_wrapper_->Init(mqtt_broker_ssl, "shadow_tbox_" + app_config->dataProto.vin,
                             mqtt_username, mqtt_password, ca_cert, client_cert, client_key);
     }
 
@@ -91,8 +98,8 @@ ErrorCode DataProto::SendUploadMqttCmd(std::atomic<bool>& stop_flag) {
     AD_INFO(DataProto, "MqttInit, Connect success");
 
     // Subscribe to topic
-    AD_INFO(DataProto, "MqttInit, Subscribing to topic: %s", app_config.dataProto.mqtt.downTopic.c_str());
-    mqtt_wrapper_->Subscribe(app_config.dataProto.mqtt.downTopic, 1);
+    AD_INFO(DataProto, "MqttInit, Subscribing to topic: %s", app_config->dataProto.mqtt.downTopic.c_str());
+    mqtt_wrapper_->Subscribe(app_config->dataProto.mqtt.downTopic, 1);
 
     // 保持连接直到收到停止信号
     while (!stop_flag.load(std::memory_order_acquire)) {
@@ -113,15 +120,16 @@ ErrorCode DataProto::GetUploadUrl(const common::UploadUrlReq& req, common::Uploa
         {"fileName", req.filename},
         {"vin", req.vin},
         // {"taskId", req.task_id},
-        // {"expireMinutes", req.expire_minutes},
     };
+    if (req.expire_minutes > 0) {
+        j["expireMinutes"] = req.expire_minutes;
+    }
 
-    url_ = "https://" + gateway_ + "/msinfofeedback/common/file/uploadurl";
+    url_ = BaseUrl() + "/msinfofeedback/common/file/uploadurl";
     std::string resp_str;
     auto ret = curl_wrapper_.HttpPost(
         url_, j.dump(), resp_str, {"Content-Type: application/json", "Accept: application/json"});
     AD_WARN(DataProto, "Response: %s", resp_str.c_str());
-    auto parsed = json::parse(resp_str);
     bool success = response_parser(resp_str, resp);
     if (!success) {
         return ErrorCode::INVALID_RESPONSE;
@@ -134,23 +142,29 @@ ErrorCode DataProto::UploadFileChunk(const std::vector<char>& buffer, const std:
     std::string resp_str;
     auto ret = curl_wrapper_.HttpPut(
         upload_url, buffer, resp_str, {"Content-Type:"});
-    AD_INFO(DataProto, "HttpPut resp tag: %s", resp.c_str());
-    std::istringstream header_stream(resp_str);
     AD_INFO(DataProto, "HttpPut ret: %d", ret);
+    if (ret != CURLE_OK) {
+        return CurlErrorMapping(ret);
+    }
 
+    // HttpPut 的 header 回调已经把 ETag 取出，这里兼容返回完整 header 的情况
+    std::istringstream header_stream(resp_str);
     std::string line;
     while (std::getline(header_stream, line)) {
         if (line.size() >= 40 && line.substr(0, 5) == "ETag:") {
             resp = line.substr(7, 32);
-            AD_WARN(DataProto, "ETag: %s", resp.c_str());
             break;
         }
     }
+    if (resp.empty() && resp_str.size() == 32) {
+        resp = resp_str;
+    }
+    AD_INFO(DataProto, "ETag: %s", resp.c_str());
     return resp.empty() ? ErrorCode::INVALID_RESPONSE : ErrorCode::SUCCESS;
 }
 
 ErrorCode DataProto::CompleteUpload(const common::CompleteUploadReq& req, common::CompleteUploadResp& resp) {
-    url_ = "https://" + gateway_ + "/msinfofeedback/common/file/completeupload";
+    url_ = BaseUrl() + "/msinfofeedback/common/file/completeupload";
     // json j = req;
     json j = json{
         {"vin", req.vin},
@@ -159,7 +173,7 @@ ErrorCode DataProto::CompleteUpload(const common::CompleteUploadReq& req, common
         {"uploadStatus", static_cast<int>(req.upload_status)},
         {"uploadId", req.upload_id},
         // {"taskId", req.task_id},
-        {"etagMap", json::object()},
+        {"etagMap", req.etag_map},
     };
 
     std::string resp_str;
@@ -175,7 +189,7 @@ ErrorCode DataProto::CompleteUpload(const common::CompleteUploadReq& req, common
 
 ErrorCode DataProto::GetUploadStatus(const std::string& file_uuid, common::UploadStatusResp& resp) {
     std::string resp_str;
-    url_ = "https://" + gateway_ + "/msinfofeedback/common/file/uploadstatus";
+    url_ = BaseUrl() + "/msinfofeedback/common/file/uploadstatus";
     json j = json{{"fileUuid", file_uuid}};
     auto ret = curl_wrapper_.HttpPost(
         url_, j.dump(), resp_str, {"Content-Type: application/json", "Accept: application/json"});
@@ -187,4 +201,32 @@ ErrorCode DataProto::GetUploadStatus(const std::string& file_uuid, common::Uploa
     return CurlErrorMapping(ret);
 }
 
+ErrorCode DataProto::QueryMissingChunks(const common::ChunkQueryReq& req, common::ChunkQueryResp& resp) {
+    url_ = BaseUrl() + "/msinfofeedback/common/file/chunkquery";
+    json j = req;
+    std::string resp_str;
+    auto ret = curl_wrapper_.HttpPost(
+        url_, j.dump(), resp_str, {"Content-Type: application/json", "Accept: application/json"});
+    AD_INFO(DataProto, "Chunk query response size: %d", static_cast<int>(resp_str.size()));
+    bool success = response_parser(resp_str, resp);
+    if (!success) {
+        return ErrorCode::INVALID_RESPONSE;
+    }
+    return CurlErrorMapping(ret);
+}
+
+ErrorCode DataProto::CommitChunks(const common::ChunkCommitReq& req, common::CompleteUploadResp& resp) {
+    url_ = BaseUrl() + "/msinfofeedback/common/file/chunkcommit";
+    json j = req;
+    std::string resp_str;
+    auto ret = curl_wrapper_.HttpPost(
+        url_, j.dump(), resp_str, {"Content-Type: application/json", "Accept: application/json"});
+    AD_WARN(DataProto, "Response: %s", resp_str.c_str());
+    bool success = response_parser(resp_str, resp);
+    if (!success) {
+        return ErrorCode::INVALID_RESPONSE;
+    }
+    return CurlErrorMapping(ret);
+}
+
 }
@@ -27,6 +27,7 @@ enum ErrorCode {
     INVALID_RESPONSE = 6,
     UPLOAD_INCOMPLETE = 7,
     UNKNOWN_ERROR = 8,
+    SESSION_EXPIRED = 9,
 };
 
 namespace dcp::uploader
@@ -50,8 +51,13 @@ public:
     ErrorCode UploadFileChunk(const std::vector<char>& buffer, const std::string& , std::string& resp);
     ErrorCode CompleteUpload(const common::CompleteUploadReq& req, common::CompleteUploadResp& resp);
     ErrorCode GetUploadStatus(const std::string& file_uuid, common::UploadStatusResp& resp);
+    ErrorCode QueryMissingChunks(const common::ChunkQueryReq& req, common::ChunkQueryResp& resp);
+    ErrorCode CommitChunks(const common::ChunkCommitReq& req, common::CompleteUploadResp& resp);
 
 private:
+    // gateway 配置带协议头（如 http://127.0.0.1:8080）时直接使用，便于接入本地模拟网关
+    std::string BaseUrl() const;
+
     CurlWrapper curl_wrapper_;
     std::string url_;
     std::string gateway_;
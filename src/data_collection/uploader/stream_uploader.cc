@@ -0,0 +1,288 @@
+//
+// Created by xucong on 25-9-3.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#include "stream_uploader.h"
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <chrono>
+
+#include "common/log/logger.h"
+#include "common/utils/utils.h"
+
+namespace dcp::uploader
+{
+
+namespace {
+
+void PutU16(std::vector<char>& buf, uint16_t v) {
+    uint16_t be = htons(v);
+    buf.insert(buf.end(), reinterpret_cast<char*>(&be), reinterpret_cast<char*>(&be) + sizeof(be));
+}
+
+void PutU32(std::vector<char>& buf, uint32_t v) {
+    uint32_t be = htonl(v);
+    buf.insert(buf.end(), reinterpret_cast<char*>(&be), reinterpret_cast<char*>(&be) + sizeof(be));
+}
+
+void PutU64(std::vector<char>& buf, uint64_t v) {
+    PutU32(buf, static_cast<uint32_t>(v >> 32));
+    PutU32(buf, static_cast<uint32_t>(v & 0xFFFFFFFFULL));
+}
+
+}
+
+StreamUploader::~StreamUploader() {
+    stop_flag_ = true;
+    cv_.notify_all();
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+}
+
+bool StreamUploader::Init(const common::AppConfigData::DataUpload& config) {
+    config_ = config;
+    auto& stream = config_.stream;
+    stream.minPartKb = std::max(stream.minPartKb, 0);
+    if (stream.segmentMaxKb < stream.minPartKb) {
+        // 按上限切出的分片小于后端下限时CompleteUpload会被拒绝
+        AD_WARN(StreamUploader, "segmentMaxKb %d is below minPartKb %d, raised to %d.",
+                stream.segmentMaxKb, stream.minPartKb, stream.minPartKb);
+        stream.segmentMaxKb = stream.minPartKb;
+    }
+
+    encryptor_ = std::make_unique<DataEncryption>();
+    if (!encryptor_->Init(config_.rsa_pub_key_path, config_.watch_dir, config_.enc_dir)) {
+        AD_ERROR(StreamUploader, "Encryptor init failed !");
+        return false;
+    }
+
+    data_proto_ = std::make_unique<DataProto>();
+    if (!data_proto_->Init(config_.gateway, config_.clientCertPath, config_.clientKeyPath, config_.caCertPath)) {
+        AD_ERROR(StreamUploader, "DataProto init failed !");
+        return false;
+    }
+
+    worker_thread_ = std::thread(&StreamUploader::Run, this);
+    AD_INFO(StreamUploader, "Init success, segment interval: %dms, part size: %d-%dKB, max parts: %d",
+            config_.stream.segmentIntervalMs, config_.stream.minPartKb, config_.stream.segmentMaxKb,
+            config_.stream.maxParts);
+    return true;
+}
+
+bool StreamUploader::Open(const std::string& file_name) {
+    if (opened_) {
+        AD_WARN(StreamUploader, "Stream %s still opened, drop it.", file_uuid_.c_str());
+        Reset();
+    }
+
+    // 流式会话结束前不知道分片总数，按上限申请，完成时只提交实际上传的分片
+    common::UploadUrlReq upload_req;
+    upload_req.type = common::UploadType::ActivelyReport;
+    upload_req.part_number = config_.stream.maxParts;
+    upload_req.filename = file_name;
+    upload_req.vin = common::Vin();
+    upload_req.expire_minutes = config_.multipartExpireMinutes;
+
+    common::UploadUrlResp resp;
+    auto ret = data_proto_->GetUploadUrl(upload_req, resp);
+    if (ret != ErrorCode::SUCCESS || resp.status_code != "0") {
+        AD_ERROR(StreamUploader, "Failed to get upload url for %s, ret: %d", file_name.c_str(), ret);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    upload_url_map_.clear();
+    try {
+        for (const auto& [slice_id, url] : resp.data.upload_url_map) {
+            upload_url_map_[std::stoi(slice_id)] = url;
+        }
+    } catch (const std::exception& e) {
+        AD_ERROR(StreamUploader, "Invalid part number in url map: %s", e.what());
+        return false;
+    }
+    file_uuid_ = resp.data.file_uuid;
+    upload_id_ = resp.data.upload_id;
+    etag_map_.clear();
+    segment_.clear();
+    segment_.reserve(static_cast<size_t>(config_.stream.segmentMaxKb) * 1024);
+    next_part_ = 1;
+    broken_ = false;
+    opened_ = true;
+    AD_INFO(StreamUploader, "Stream %s opened, file uuid: %s", file_name.c_str(), file_uuid_.c_str());
+    return true;
+}
+
+bool StreamUploader::Append(RecordKind kind, const std::string& topic, uint64_t timestamp, const void* data, size_t len) {
+    if (!opened_ || broken_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        segment_.push_back(static_cast<char>(kind));
+        PutU16(segment_, static_cast<uint16_t>(topic.size()));
+        segment_.insert(segment_.end(), topic.begin(), topic.end());
+        PutU64(segment_, timestamp);
+        PutU32(segment_, static_cast<uint32_t>(len));
+        const char* bytes = static_cast<const char*>(data);
+        segment_.insert(segment_.end(), bytes, bytes + len);
+        if (segment_.size() < static_cast<size_t>(config_.stream.segmentMaxKb) * 1024) {
+            return true;
+        }
+    }
+    return Flush();
+}
+
+bool StreamUploader::Flush() {
+    return Cut(false);
+}
+
+bool StreamUploader::Cut(bool last) {
+    if (!opened_ || broken_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (segment_.empty()) {
+            return true;
+        }
+        if (!last && segment_.size() < static_cast<size_t>(config_.stream.minPartKb) * 1024) {
+            return true;
+        }
+        if (next_part_ > config_.stream.maxParts || upload_url_map_.count(next_part_) == 0) {
+            AD_ERROR(StreamUploader, "Stream %s exceeds %d parts.", file_uuid_.c_str(), config_.stream.maxParts);
+            broken_ = true;
+            return false;
+        }
+        pending_.emplace_back(next_part_++, std::move(segment_));
+        segment_.clear();
+    }
+    cv_.notify_all();
+    return true;
+}
+
+bool StreamUploader::Finalize() {
+    if (!opened_) {
+        return false;
+    }
+    Cut(true);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return (pending_.empty() && !uploading_) || stop_flag_; });
+    }
+
+    if (broken_ || etag_map_.empty()) {
+        AD_ERROR(StreamUploader, "Stream %s broken, fall back to normal upload.", file_uuid_.c_str());
+        Reset();
+        return false;
+    }
+
+    common::CompleteUploadReq complete_req;
+    complete_req.type = common::UploadType::ActivelyReport;
+    complete_req.file_uuid = file_uuid_;
+    complete_req.upload_id = upload_id_;
+    complete_req.upload_status = common::UploadStatus::Uploaded;
+    complete_req.task_id = "";
+    complete_req.vin = common::Vin();
+    complete_req.etag_map = etag_map_;
+
+    common::CompleteUploadResp complete_resp;
+    auto ret = data_proto_->CompleteUpload(complete_req, complete_resp);
+    bool success = ret == ErrorCode::SUCCESS && complete_resp.status_code == "0";
+    if (success) {
+        AD_INFO(StreamUploader, "Stream %s completed with %d parts.", file_uuid_.c_str(),
+                static_cast<int>(etag_map_.size()));
+    } else {
+        AD_ERROR(StreamUploader, "Complete stream %s failed, ret: %d", file_uuid_.c_str(), ret);
+    }
+    Reset();
+    return success;
+}
+
+void StreamUploader::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+    segment_.clear();
+    etag_map_.clear();
+    upload_url_map_.clear();
+    next_part_ = 1;
+    opened_ = false;
+}
+
+void StreamUploader::Run() {
+    AD_INFO(StreamUploader, "Run.");
+    while (!stop_flag_) {
+        std::pair<int, std::vector<char>> part;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !pending_.empty() || stop_flag_; });
+            if (stop_flag_) {
+                break;
+            }
+            part = std::move(pending_.front());
+            pending_.pop_front();
+            uploading_ = true;
+        }
+
+        if (!broken_) {
+            std::string etag;
+            auto ret = UploadPart(part.first, part.second, etag);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ret == ErrorCode::SUCCESS) {
+                etag_map_[std::to_string(part.first)] = etag;
+            } else {
+                AD_ERROR(StreamUploader, "Upload part %d failed, ret: %d", part.first, ret);
+                broken_ = true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uploading_ = false;
+        }
+        cv_.notify_all();
+    }
+}
+
+ErrorCode StreamUploader::UploadPart(int part_number, const std::vector<char>& segment, std::string& etag) {
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        url = upload_url_map_[part_number];
+    }
+
+    std::vector<char> payload;
+    if (common::AppConfig::getInstance().Snapshot()->debug.closeDataEnc) {
+        payload = segment;
+    } else {
+        std::string ciphertext;
+        if (encryptor_->EncryptDataWithEnvelope(std::string(segment.begin(), segment.end()), ciphertext) != 0) {
+            AD_ERROR(StreamUploader, "Encrypt part %d failed: %s", part_number, encryptor_->last_error().c_str());
+            return ErrorCode::UNKNOWN_ERROR;
+        }
+        payload.reserve(ciphertext.size() + sizeof(uint32_t));
+        PutU32(payload, static_cast<uint32_t>(ciphertext.size()));
+        payload.insert(payload.end(), ciphertext.begin(), ciphertext.end());
+    }
+
+    ErrorCode ret = ErrorCode::UNKNOWN_ERROR;
+    for (int i = 0; i < config_.retryCount && !stop_flag_; ++i) {
+        if (i > 0) {
+            // 流式上传对时延敏感，重试间隔不超过一个片段周期
+            std::this_thread::sleep_for(std::chrono::milliseconds(config_.stream.segmentIntervalMs));
+            AD_INFO(StreamUploader, "Retry to upload part: %d", part_number);
+        }
+        ret = data_proto_->UploadFileChunk(payload, url, etag);
+        if (ret == ErrorCode::SUCCESS) {
+            AD_INFO(StreamUploader, "Upload part %d succeeded, size: %d", part_number, static_cast<int>(payload.size()));
+            break;
+        }
+    }
+    return ret;
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Created by xucong on 25-9-3.
+// Copyright (c) 2025 T3CAIC. All rights reserved.
+// Tsung Xu<xucong@t3caic.com>
+//
+
+#ifndef STREAM_UPLOADER_H
+#define STREAM_UPLOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+
+#include "protocol/data_protocol.h"
+#include "common/config/app_config.h"
+#include "data_encryption.h"
+
+namespace dcp::uploader
+{
+
+/**
+ * 关键触发的流式上传：录制过程中按片段加密并作为分段上传的分片立即发送，
+ * 录制结束后 CompleteUpload 合成一个文件，不再等待落盘、压缩和轮询上传。
+ *
+ * 上传的文件由各分片顺序拼接而成，每个分片：
+ *   [envelope length (4 bytes)][EncryptDataWithEnvelope 输出]
+ * 解密后的明文为连续的记录：
+ *   [kind (1 byte)][topic length (2 bytes)][topic][timestamp (8 bytes)][data length (4 bytes)][data]
+ * 多字节整数均为网络字节序；关闭加密时分片内直接为明文记录。
+ * 后端（S3/OSS等预签名分段上传）要求除最后一片外每片不小于minPartKb，
+ * 片段按segmentIntervalMs检查，不足下限时继续累积，延迟随数据率降低而增加。
+ * 记录按追加顺序排列：会话打开前的前向数据补发时可能与实时到达的后向数据交错，
+ * 解析方按时间戳还原顺序。
+ */
+class StreamUploader {
+public:
+  enum class RecordKind : uint8_t {
+    Message = 0, // 序列化消息（CDR）
+    Meta = 1,    // 元数据 json，topic 为空
+  };
+
+  StreamUploader() = default;
+  ~StreamUploader();
+
+  bool Init(const common::AppConfigData::DataUpload& config);
+
+  // 申请分段上传地址，开始一个流式会话
+  bool Open(const std::string& file_name);
+
+  // 追加一条记录到当前片段，片段超过上限时自动切片
+  bool Append(RecordKind kind, const std::string& topic, uint64_t timestamp, const void* data, size_t len);
+
+  // 当前片段达到minPartKb时交给后台线程加密上传，不足时继续累积
+  bool Flush();
+
+  // 等待所有分片上传完成并通知服务端合并，失败时返回false，由常规上传兜底
+  bool Finalize();
+
+  bool IsOpened() const { return opened_; }
+  int SegmentIntervalMs() const { return config_.stream.segmentIntervalMs; }
+
+private:
+  // last为true时不受分片下限约束，只用于最后一个分片
+  bool Cut(bool last);
+  void Run();
+  ErrorCode UploadPart(int part_number, const std::vector<char>& segment, std::string& etag);
+  void Reset();
+
+  common::AppConfigData::DataUpload config_;
+  std::unique_ptr<DataProto> data_proto_;
+  std::unique_ptr<DataEncryption> encryptor_;
+
+  std::string file_uuid_;
+  std::string upload_id_;
+  std::map<int, std::string> upload_url_map_;
+  std::map<std::string, std::string> etag_map_;
+  std::vector<char> segment_;
+  std::deque<std::pair<int, std::vector<char>>> pending_;
+  int next_part_ = 1;
+  bool uploading_ = false;
+
+  std::atomic<bool> opened_{false};
+  std::atomic<bool> broken_{false};
+  std::atomic<bool> stop_flag_{false};
+  std::thread worker_thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}
+
+#endif //STREAM_UPLOADER_H
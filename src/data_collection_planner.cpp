@@ -5,8 +5,37 @@
 #include <random>
 #include <yaml-cpp/yaml.h>
 #include "data_collection/common/log/logger.h"
+#include "data_collection/common/memory/message_pool.h"
+#include "data_collection/channel/topic_profiler.h"
+#include "data_collection/common/metrics/metrics_registry.h"
+#include "data_collection/common/metrics/metrics_server.h"
+#include "data_collection/common/metrics/span_tracer.h"
 
 namespace dcp {
+
+namespace {
+int ParseLogLevel(const std::string& level) {
+    if (level == "fatal") return LOG_LEVEL_FATAL;
+    if (level == "error") return LOG_LEVEL_ERROR;
+    if (level == "warn" || level == "warning") return LOG_LEVEL_WARNING;
+    if (level == "debug") return LOG_LEVEL_DEBUG1;
+    return LOG_LEVEL_INFO;
+}
+
+void ApplyLogConfig(const common::AppConfigData& config) {
+    auto* logger = common::Logger::instance();
+    if (!config.log.logLevel.empty()) {
+        logger->SetLevel(ParseLogLevel(config.log.logLevel));
+    }
+    // 限频日志按tag覆盖默认限制，便于现场放开或收紧热点日志
+    logger->ResetRateLimits();
+    for (const auto& [tag, limit] : config.log.rateLimits) {
+        logger->SetRateLimit(tag.c_str(), static_cast<uint32_t>(std::max(limit.everyN, 0)),
+                             static_cast<uint32_t>(std::max(limit.intervalMs, 0)));
+    }
+}
+}
+
 DataCollectionPlanner::DataCollectionPlanner(const std::string& model_file, const std::string& config_file) : Node("DataCollectionPlanner") {
     AD_INFO(DataCollectionPlanner, "Creating DataCollectionPlanner with model_file: %s, config_file: %s", 
             model_file.c_str(), config_file.c_str());
@@ -14,8 +43,9 @@ DataCollectionPlanner::DataCollectionPlanner(const std::string& model_file, cons
     rl_planner_ = std::make_unique<planner::RLPlanner>(model_file, config_file);
     data_storage_ = std::make_unique<recorder::DataStorage>();
     // data_uploader_ = std::make_unique<uploader::DataUploader>();
-    trigger_ = std::make_unique<trigger::TriggerManager>();
-    // strategy_parser_ = std::make_unique<trigger::StrategyParser>();
+    trigger_ = std::make_shared<trigger::TriggerManager>();
+    strategy_parser_ = std::make_unique<trigger::StrategyParser>();
+    strategy_file_ = "/home/xucong/caicAD/01dataengine/Aurora/ad_edgeinsight/config/default_strategy_config.json";
     mission_area_ = MissionArea(Point(50.0, 50.0), 10.0); // Default mission area - based on PRD 20x20 grid
     AD_INFO(DataCollectionPlanner, "DataCollectionPlanner constructor completed");
 }
@@ -24,12 +54,80 @@ bool DataCollectionPlanner::initialize() {
     AD_INFO(DataCollectionPlanner, "Initializing Data Collection as Planning");
 
     // Load strategy configuration
-    trigger::StrategyConfig config_;
-    if (!strategy_parser_->LoadConfigFromFile("/home/xucong/caicAD/01dataengine/Aurora/ad_edgeinsight/config/default_strategy_config.json", config_)) {
+    if (!strategy_parser_->LoadConfigFromFile(strategy_file_, strategy_config_)) {
         AD_ERROR(DataCollectionPlanner, "Failed to load strategy configuration, using defaults");
     }
 
-    const auto& data_upload_config = common::AppConfig::getInstance().GetConfig().dataUpload;
+    const auto app_config = common::AppConfig::getInstance().Snapshot();
+    const auto& data_upload_config = app_config->dataUpload;
+
+    // 内部指标采样，需在各模块注册序列之前初始化
+    const auto& metrics_config = app_config->metrics;
+    if (metrics_config.enabled &&
+        !common::MetricsRecorder::getInstance().Init(metrics_config.path, metrics_config.flushIntervalMs,
+                                                     metrics_config.capacityRows, metrics_config.maxFileMb)) {
+        AD_WARN(DataCollectionPlanner, "MetricsRecorder init failed, metrics disabled.");
+    }
+    waypoint_metrics_ = common::MetricsRecorder::getInstance().RegisterSeries(
+        "planner_waypoint", {"x", "y", "distance_to_target", "distance_to_sparse", "reward"});
+
+    // 消息内存池需在创建订阅之前初始化
+    const auto& pool_config = app_config->messagePool;
+    auto& message_pool = common::MessagePool::getInstance();
+    message_pool.Init(pool_config.enabled, static_cast<size_t>(std::max(pool_config.threadCacheKb, 0)) * 1024,
+                      static_cast<size_t>(std::max(pool_config.slabKb, 0)) * 1024);
+    common::MetricsRecorder::getInstance().RegisterSampler(
+        "message_pool", {"allocations", "frees", "cache_misses", "large_allocations", "bytes_in_use", "slab_bytes",
+                         "thread_caches"},
+        [&message_pool](double* values) {
+            const auto stats = message_pool.GetStats();
+            values[0] = static_cast<double>(stats.allocations);
+            values[1] = static_cast<double>(stats.frees);
+            values[2] = static_cast<double>(stats.cacheMisses);
+            values[3] = static_cast<double>(stats.largeAllocations);
+            values[4] = static_cast<double>(stats.bytesInUse);
+            values[5] = static_cast<double>(stats.slabBytes);
+            values[6] = static_cast<double>(stats.threadCaches);
+        });
+
+    // 运行时计数器和耗时直方图，Prometheus文本格式导出，车上curl即可查看
+    auto& registry = common::MetricsRegistry::getInstance();
+    auto* pool_in_use = registry.GetGauge("dcp_message_pool_bytes_in_use", "Bytes of pool blocks in use.");
+    auto* pool_slabs = registry.GetGauge("dcp_message_pool_slab_bytes", "Bytes of slabs taken from the system.");
+    auto* pool_misses = registry.GetGauge("dcp_message_pool_cache_misses", "Thread cache misses since start.");
+    registry.AddCollector([&message_pool, pool_in_use, pool_slabs, pool_misses] {
+        const auto stats = message_pool.GetStats();
+        pool_in_use->Set(static_cast<double>(stats.bytesInUse));
+        pool_slabs->Set(static_cast<double>(stats.slabBytes));
+        pool_misses->Set(static_cast<double>(stats.cacheMisses));
+    });
+    const auto& exporter_config = metrics_config.exporter;
+    if (exporter_config.enabled &&
+        !common::MetricsServer::getInstance().Init(exporter_config.unixSocket, exporter_config.port)) {
+        AD_WARN(DataCollectionPlanner, "MetricsServer init failed, metrics not exported.");
+    }
+
+    // 片段生命周期各阶段的span
+    const auto& trace_config = app_config->trace;
+    common::SpanTracer::getInstance().Init(trace_config.enabled, static_cast<size_t>(std::max(trace_config.capacity, 0)),
+                                           trace_config.dumpPath);
+
+    // topic实测统计，订阅时注册
+    channel::TopicProfiler::getInstance().Configure(app_config->profiler.enabled, app_config->profiler.windowMs);
+
+    // 回调线程拓扑需在创建订阅之前建立
+    executor_topology_ = std::make_shared<channel::ExecutorTopology>();
+    if (!executor_topology_->Init(shared_from_this(), app_config->executor)) {
+        AD_ERROR(DataCollectionPlanner, "Failed to initialize executor topology");
+        return false;
+    }
+
+    // 日志级别和限频配置随配置文件热更新
+    ApplyLogConfig(*app_config);
+    common::AppConfig::getInstance().Subscribe([](const common::AppConfigPtr&, const common::AppConfigPtr& config) {
+        ApplyLogConfig(*config);
+    });
+    common::AppConfig::getInstance().StartWatch();
     
     // Cast to concrete type for initialization
     // auto* rl_planner = dynamic_cast<planner::RLPlanner*>(baseline_planner_.get());
@@ -49,15 +147,73 @@ bool DataCollectionPlanner::initialize() {
         return false;
     }
     
-    if (!trigger_->initialize()) {
+    if (!trigger_->initialize(strategy_config_)) {
         AD_ERROR(DataCollectionPlanner, "Failed to initialize trigger manager");
         return false;
     }
+    // 片段摘要的信号统计取自trigger共用的信号槽位
+    data_storage_->SetSignalSource(trigger_->signalSlots());
+
+    // 订阅按回调线程拓扑分组，信号写入trigger槽位，trigger作为观察者接收录制topic
+    channel_manager_ = std::make_shared<channel::ChannelManager>();
+    if (!channel_manager_->Init(shared_from_this(), strategy_config_, trigger_, executor_topology_)) {
+        AD_ERROR(DataCollectionPlanner, "Failed to initialize channel manager");
+        return false;
+    }
+
+    // 策略文件更新后增量生效，不重启、不清空缓冲区
+    strategy_watcher_.Start(strategy_file_, [this] { reloadStrategy(); });
     
     AD_INFO(DataCollectionPlanner, "Data Collection as Planning initialized successfully");
     return true;
 }
 
+bool DataCollectionPlanner::reloadStrategy() {
+    std::lock_guard<std::mutex> lock(strategy_mutex_);
+    trigger::StrategyConfig config;
+    if (!strategy_parser_->LoadConfigFromFile(strategy_file_, config)) {
+        AD_ERROR(DataCollectionPlanner, "Reload strategy %s failed, keep config %s.",
+                 strategy_file_.c_str(), strategy_config_.configId.c_str());
+        return false;
+    }
+
+    const auto diff = trigger::StrategyParser::Diff(strategy_config_, config);
+    AD_INFO(DataCollectionPlanner, "Strategy %s -> %s, topics +%d/-%d, triggers +%d/-%d/~%d",
+            strategy_config_.configId.c_str(), config.configId.c_str(),
+            static_cast<int>(diff.addedTopics.size()), static_cast<int>(diff.removedTopics.size()),
+            static_cast<int>(diff.addedTriggers.size()), static_cast<int>(diff.removedTriggers.size()),
+            static_cast<int>(diff.changedTriggers.size()));
+
+    // 先调整录制缓冲区再切换trigger，新trigger触发时对应topic已在缓存
+    bool ok = true;
+    if (!diff.empty()) {
+        ok = data_storage_->UpdateStrategy(config) && ok;
+        ok = trigger_->reload(config, diff) && ok;
+        // 订阅和观察者在trigger重建之后切换
+        if (channel_manager_) {
+            ok = channel_manager_->Reload(config, diff) && ok;
+        }
+    }
+    if (!ok) {
+        // 保留旧配置作为比较基准，下次重载（包括同一文件）重新得到完整差异并重试
+        AD_ERROR(DataCollectionPlanner, "Apply strategy %s failed, keep config %s for retry.",
+                 config.configId.c_str(), strategy_config_.configId.c_str());
+        return false;
+    }
+    strategy_config_ = std::move(config);
+    return true;
+}
+
+void DataCollectionPlanner::spin() {
+    if (!executor_topology_) {
+        rclcpp::spin(shared_from_this());
+    } else {
+        executor_topology_->Spin();
+    }
+    // 退出时写出最近的span，现场日志带回即可分析
+    common::SpanTracer::getInstance().Uninit();
+}
+
 void DataCollectionPlanner::setMissionArea(const MissionArea& area) {
     AD_INFO(DataCollectionPlanner, "Setting mission area");
     
@@ -78,6 +234,9 @@ void DataCollectionPlanner::setMissionArea(const MissionArea& area) {
 // 返回一个路径点集合(optimized_waypoints)
 std::vector<Point> DataCollectionPlanner::planDataCollectionMission() {
     AD_INFO(DataCollectionPlanner, "Planning data collection mission");
+    static const auto& stage = common::MetricsRegistry::getInstance().GetStage("planner");
+    common::ScopedLatency latency(stage.duration);
+    stage.total->Add();
     
     // Cast to concrete type to access specific methods
     // auto* rl_planner = dynamic_cast<planner::RLPlanner*>(baseline_planner_.get());
@@ -193,6 +352,8 @@ void DataCollectionPlanner::executeDataCollection(const std::vector<Point>& path
             // In a real implementation, we would track previous state to compute reward
             StateInfo prev_state;
             double reward = rl_planner_->computeStateReward(prev_state, current_state);
+            common::MetricsRecorder::getInstance().Record(waypoint_metrics_, {
+                waypoint.x, waypoint.y, current_state.distance_to_target, current_state.distance_to_sparse, reward});
             AD_INFO(DataCollectionPlanner, "Waypoint %s reward: %s", std::to_string(i).c_str(), std::to_string(reward).c_str());
         }
     }
@@ -10,6 +10,10 @@
 #include "trigger/trigger_manager.h"
 #include "recorder/data_storage.h"
 #include "uploader/data_uploader.h"
+#include "data_collection/common/metrics/metrics_recorder.h"
+#include "data_collection/common/utils/file_watcher.h"
+#include "data_collection/channel/executor_topology.h"
+#include "data_collection/channel/channel_manager.h"
 
 namespace dcp {
 
@@ -36,11 +40,19 @@ private:
 
 
     std::unique_ptr<trigger::StrategyParser> strategy_parser_;
-    std::unique_ptr<trigger::TriggerManager> trigger_;
+    std::shared_ptr<trigger::TriggerManager> trigger_;
     std::unique_ptr<recorder::DataStorage> data_storage_;
     std::unique_ptr<uploader::DataUploader> data_uploader_;
+    std::shared_ptr<channel::ExecutorTopology> executor_topology_;
+    std::shared_ptr<channel::ChannelManager> channel_manager_;
+
+    std::string strategy_file_;
+    trigger::StrategyConfig strategy_config_;
+    std::mutex strategy_mutex_;
+    common::FileWatcher strategy_watcher_;
 
     std::vector<DataPoint> data_collection_points_;
+    common::MetricSeries* waypoint_metrics_ = nullptr;
     MissionArea mission_area_;
 
 public:
@@ -54,6 +66,20 @@ public:
      * @return true if initialization successful, false otherwise
      */
     bool initialize();
+
+    /**
+     * @brief Reload the strategy file and apply only what changed
+     * Buffers and triggers untouched by the new strategy keep running, so a
+     * rollout does not interrupt capture. An invalid file keeps the current strategy.
+     * @return true if the new strategy is in effect, false otherwise
+     */
+    bool reloadStrategy();
+
+    /**
+     * @brief Spin the node with the configured executor topology
+     * Topic groups run on their own pinned threads; blocks until shutdown.
+     */
+    void spin();
     
     /**
      * @brief Set the mission area for data collection
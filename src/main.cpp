@@ -1,6 +1,7 @@
 // main.cpp - Main entry point for AD Data Closed Loop System
 #include "data_collection_planner.h"
 
+#include "common/config/app_config.h"
 #include "common/log/logger.h"
 #include "auth_manager/auth_manager.h"
 #include <iostream>
@@ -11,6 +12,8 @@
 
 using namespace dcp;
 
+static const char* const kAppConfigFile = "/home/xucong/caicAD/01dataengine/Aurora/ad_edgeinsight/config/app_config.json";
+
 // 安全获取密码输入
 std::string getPasswordInput(const std::string& prompt) {
     std::cout << prompt;
@@ -72,9 +75,20 @@ int main(int argc, char** argv) {
 
         std::cout << "Authorization successful!" << std::endl;
 
+        // 日志输出方式在启动时确定，需先加载应用配置
+        if (!common::AppConfig::getInstance().Init(kAppConfigFile)) {
+            std::cout << "Failed to load app config: " << kAppConfigFile << std::endl;
+            return -1;
+        }
+
         // Initialize logging
-        common::Logger::instance()->Init(dcp::common::LOG_TO_CONSOLE | dcp::common::LOG_TO_FILE, LOG_LEVEL_INFO,
-                               "/tmp/ad_data_closed_loop.log", "/tmp/ad_data_closed_loop.csv");
+        // 二进制日志的调用点只记录参数，格式化留给离线解码，不再输出控制台
+        const bool binary_log = common::AppConfig::getInstance().Snapshot()->log.binary;
+        const uint8_t log_mode = binary_log ? dcp::common::LOG_TO_BINARY_FILE
+                                            : (dcp::common::LOG_TO_CONSOLE | dcp::common::LOG_TO_FILE);
+        common::Logger::instance()->Init(log_mode, LOG_LEVEL_INFO,
+                               binary_log ? "/tmp/ad_data_closed_loop.bin" : "/tmp/ad_data_closed_loop.log",
+                               "/tmp/ad_data_closed_loop.csv");
 
         AD_INFO(Main, "Starting Data Collection as Planning (DCP) System");
 #if 1
@@ -112,7 +126,7 @@ int main(int argc, char** argv) {
         // Upload collected data
         ct->uploadCollectedData();
 
-        rclcpp::spin(ct);
+        ct->spin();
         rclcpp::shutdown();
 
         AD_INFO(Main, "Data Collection Mission Completed");
@@ -120,7 +134,7 @@ int main(int argc, char** argv) {
         return 0;
 
     } catch (const std::exception& e) {
-        AD_ERROR(Main, "Exception occurred: " + std::string(e.what()));
+        AD_ERROR(Main, "Exception occurred: %s", e.what());
         // dcp::common::Logger::instance()->Uninit();
         return -1;
     }
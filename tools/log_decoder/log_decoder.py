@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+二进制日志解码工具，将 LOG_TO_BINARY_FILE 模式写出的日志还原为文本日志。
+
+二进制日志由帧组成，数值为车端主机字节序（默认小端，可用 --big-endian 切换）：
+  H  "DCPBLOG" + u8 版本                       文件头，调用点定义从此处重新开始
+  S  u32 id, i8 level, u32 line, tag, file, fmt 调用点定义，每个文件中首次出现时写入
+  R  u32 id, i64 timeNs, u32 tid, u16 len, args 一条日志，args 为 [类型][值] 序列
+  T  i8 level, i64 timeNs, u32 tid, u32 line, file, text  未经格式化的文本日志
+字符串均为 u16 长度 + 内容；参数类型 i=int64, u=uint64, d=double, p=指针, s=字符串。
+
+输出格式与文本日志一致：
+  [I]20250910 12:00:00.123 1234 [file.cpp:42] message
+
+用法：
+  python3 log_decoder.py dcp.log                 解码到标准输出
+  python3 log_decoder.py dcp.log.1 dcp.log -o out.txt
+  python3 log_decoder.py dcp.log --level W       只输出 WARN 及以上
+"""
+
+import argparse
+import re
+import struct
+import sys
+import time
+
+MAGIC = b"DCPBLOG"
+VERSION = 1
+
+LEVEL_NAMES = {-3: "F", -2: "E", -1: "W", 0: "I"}
+
+# printf 转换说明：flags、width、precision、长度修饰符、转换符
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGaAcspn%])")
+
+
+class DecodeError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data, endian):
+        self.data = data
+        self.pos = 0
+        self.endian = endian
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise DecodeError("truncated frame at offset %d" % self.pos)
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def unpack(self, fmt):
+        fmt = self.endian + fmt
+        return struct.unpack(fmt, self.take(struct.calcsize(fmt)))[0]
+
+    def string(self):
+        return self.take(self.unpack("H")).decode("utf-8", errors="replace")
+
+
+def decode_args(raw, endian):
+    reader = Reader(raw, endian)
+    args = []
+    while not reader.eof():
+        kind = reader.take(1)
+        if kind == b"i":
+            args.append(reader.unpack("q"))
+        elif kind in (b"u", b"p"):
+            value = reader.unpack("Q")
+            args.append(("p", value) if kind == b"p" else value)
+        elif kind == b"d":
+            args.append(reader.unpack("d"))
+        elif kind == b"s":
+            args.append(reader.string())
+        else:
+            break
+    return args
+
+
+def format_message(fmt, args):
+    """按 printf 语义格式化，忽略长度修饰符，参数不足时原样输出转换说明。"""
+    args = list(args)
+    out = []
+    pos = 0
+
+    def next_arg():
+        return args.pop(0) if args else None
+
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(next_arg() or 0)
+        if precision == "*":
+            precision = str(next_arg() or 0)
+        arg = next_arg()
+        if arg is None:
+            out.append(m.group(0))
+            continue
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        if isinstance(arg, tuple):
+            arg = arg[1]
+            if conv == "p":
+                out.append("0x%x" % arg)
+                continue
+        try:
+            if conv in "di":
+                out.append(arg if isinstance(arg, str) else (spec + "d") % int(arg))
+            elif conv in "ouxX":
+                out.append(arg if isinstance(arg, str) else (spec + ("d" if conv == "u" else conv)) % int(arg))
+            elif conv in "eEfFgG":
+                out.append(arg if isinstance(arg, str) else (spec + conv) % float(arg))
+            elif conv in "aA":
+                out.append(arg if isinstance(arg, str) else float(arg).hex())
+            elif conv == "c":
+                out.append((spec + "c") % (arg[:1] or " " if isinstance(arg, str) else chr(int(arg) & 0xFF)))
+            elif conv == "p":
+                out.append("0x%x" % int(arg))
+            else:
+                text = arg if isinstance(arg, str) else str(arg)
+                out.append((spec + "s") % text)
+        except (TypeError, ValueError, OverflowError):
+            out.append(str(arg))
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def format_line(level, time_ns, tid, file_name, line, text):
+    if not file_name:
+        return text  # 与文本日志一致，无前缀的日志只输出内容
+    level_name = LEVEL_NAMES.get(level, "D")
+    sec, ns = divmod(time_ns, 1000000000)
+    stamp = time.strftime("%Y%m%d %H:%M:%S", time.localtime(sec))
+    return "[%s]%s.%03d %d [%s:%d] %s" % (level_name, stamp, ns // 1000000, tid, file_name, line, text)
+
+
+def decode(data, endian, min_level, output):
+    reader = Reader(data, endian)
+    sites = {}
+    while not reader.eof():
+        frame = reader.take(1)
+        if frame == b"H":
+            if reader.take(len(MAGIC)) != MAGIC:
+                raise DecodeError("bad magic at offset %d" % reader.pos)
+            version = reader.unpack("B")
+            if version != VERSION:
+                raise DecodeError("unsupported version %d" % version)
+            sites.clear()
+        elif frame == b"S":
+            site_id = reader.unpack("I")
+            level = reader.unpack("b")
+            line = reader.unpack("I")
+            tag = reader.string()
+            file_name = reader.string()
+            fmt = reader.string()
+            sites[site_id] = (level, line, tag, file_name, fmt)
+        elif frame == b"R":
+            site_id = reader.unpack("I")
+            time_ns = reader.unpack("q")
+            tid = reader.unpack("I")
+            raw = reader.take(reader.unpack("H"))
+            site = sites.get(site_id)
+            if site is None:
+                output.write("<unknown site %d>\n" % site_id)
+                continue
+            level, line, _, file_name, fmt = site
+            if level > min_level:
+                continue
+            text = format_message(fmt, decode_args(raw, endian))
+            output.write(format_line(level, time_ns, tid, file_name, line, text) + "\n")
+        elif frame == b"T":
+            level = reader.unpack("b")
+            time_ns = reader.unpack("q")
+            tid = reader.unpack("I")
+            line = reader.unpack("I")
+            file_name = reader.string()
+            text = reader.string()
+            if level > min_level:
+                continue
+            output.write(format_line(level, time_ns, tid, file_name, line, text) + "\n")
+        else:
+            raise DecodeError("unknown frame %r at offset %d" % (frame, reader.pos - 1))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary dcp logs into text.")
+    parser.add_argument("files", nargs="+", help="binary log files, decoded in the given order")
+    parser.add_argument("-o", "--output", help="output file, default stdout")
+    parser.add_argument("--level", default="9", help="max level to print: F/E/W/I or a number (default all)")
+    parser.add_argument("--big-endian", action="store_true", help="log written on a big-endian host")
+    args = parser.parse_args()
+
+    names = {"F": -3, "E": -2, "W": -1, "I": 0}
+    min_level = names.get(args.level.upper(), None)
+    if min_level is None:
+        min_level = int(args.level)
+    endian = ">" if args.big_endian else "<"
+
+    output = open(args.output, "w", encoding="utf-8") if args.output else sys.stdout
+    status = 0
+    try:
+        for path in args.files:
+            with open(path, "rb") as f:
+                try:
+                    decode(f.read(), endian, min_level, output)
+                except DecodeError as e:
+                    # 断电等情况下文件末尾可能是半帧，已解码的部分照常输出
+                    sys.stderr.write("%s: %s\n" % (path, e))
+                    status = 1
+    finally:
+        if output is not sys.stdout:
+            output.close()
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+本地模拟上传网关，用于联调 DataUploader 的分段上传与断点续传。
+
+实现了车端用到的接口：
+  POST /msinfofeedback/common/file/uploadurl      申请分段上传地址
+  PUT  /upload/<fileUuid>/<partNumber>             分片上传（预签名地址），返回 ETag(md5)
+  POST /msinfofeedback/common/file/uploadstatus    查询已上传分片及 etag
+  POST /msinfofeedback/common/file/completeupload  校验 etagMap 并合并文件
+按内容分块去重上传（dataUpload.dedup）：
+  POST /msinfofeedback/common/file/chunkquery      返回 chunkHashList 中缺失块的上传地址
+  PUT  /chunk/<sha256>                             块上传，校验内容 sha256 与地址一致
+  POST /msinfofeedback/common/file/chunkcommit     按 chunkHashList 顺序合成文件，缺块或大小不符返回 409
+块在所有文件间共享，保存在 <store>/chunks 下，重启后仍然有效。
+
+用法：
+  python3 mock_gateway.py --port 8080 --store /tmp/mock_gateway
+  然后将 app_config.json 中 dataUpload.gateway 配置为 "http://127.0.0.1:8080"
+
+故障注入：
+  --fail-after N      每个会话收到 N 个分片后断开一次连接，模拟熄火/断网
+  --corrupt-part N    uploadstatus 中第 N 片返回错误 etag，验证 etag 不一致时重传
+  --expire-sec S      会话创建 S 秒后 uploadstatus 返回失败，验证过期会话重新申请
+  --no-dedup          不提供按块上传接口（chunkquery 返回 404），验证车端退回分段上传
+  --min-part-kb K     与 S3/OSS 一致，除最后一片外分片小于 K KB 时 completeupload 返回 400（默认 5120，0 不检查）
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import threading
+import time
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+UPLOADING = 1
+UPLOADED = 3
+FAILED = 4
+
+
+class GatewayState:
+    def __init__(self, store, fail_after, corrupt_part, expire_sec, dedup=True, min_part_kb=5120):
+        self.store = store
+        self.min_part_bytes = min_part_kb * 1024
+        self.fail_after = fail_after
+        self.corrupt_part = corrupt_part
+        self.expire_sec = expire_sec
+        self.dedup = dedup
+        self.sessions = {}
+        self.lock = threading.Lock()
+        os.makedirs(store, exist_ok=True)
+        os.makedirs(os.path.join(store, "chunks"), exist_ok=True)
+
+    def chunk_path(self, chunk_hash):
+        return os.path.join(self.store, "chunks", chunk_hash)
+
+    def part_path(self, file_uuid, part):
+        return os.path.join(self.store, file_uuid, "part_%d" % part)
+
+    def session_status(self, session):
+        if self.expire_sec > 0 and time.time() - session["create_time"] > self.expire_sec:
+            return FAILED
+        return session["status"]
+
+
+def make_handler(state, base_url):
+    class Handler(BaseHTTPRequestHandler):
+        def log_message(self, fmt, *args):
+            print("[mock_gateway] " + fmt % args)
+
+        def reply(self, data, status_code="0", message="success"):
+            body = json.dumps({"statusCode": status_code, "statusMessage": message, "data": data}).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def read_body(self):
+            length = int(self.headers.get("Content-Length", 0))
+            return self.rfile.read(length) if length > 0 else b""
+
+        def do_POST(self):
+            try:
+                req = json.loads(self.read_body() or b"{}")
+            except ValueError:
+                self.reply(None, "400", "invalid json")
+                return
+            if self.path.endswith("/file/uploadurl"):
+                self.upload_url(req)
+            elif self.path.endswith("/file/uploadstatus"):
+                self.upload_status(req)
+            elif self.path.endswith("/file/completeupload"):
+                self.complete_upload(req)
+            elif self.path.endswith("/file/chunkquery") and state.dedup:
+                self.chunk_query(req)
+            elif self.path.endswith("/file/chunkcommit") and state.dedup:
+                self.chunk_commit(req)
+            else:
+                self.send_error(404)
+
+        def upload_url(self, req):
+            file_uuid = uuid.uuid4().hex
+            parts = int(req.get("partNumber", 0))
+            with state.lock:
+                state.sessions[file_uuid] = {
+                    "file_name": req.get("fileName", file_uuid),
+                    "upload_id": uuid.uuid4().hex,
+                    "parts": parts,
+                    "etags": {},
+                    "status": UPLOADING,
+                    "create_time": time.time(),
+                }
+                upload_id = state.sessions[file_uuid]["upload_id"]
+            os.makedirs(os.path.join(state.store, file_uuid), exist_ok=True)
+            url_map = {str(i): "%s/upload/%s/%d" % (base_url, file_uuid, i) for i in range(1, parts + 1)}
+            self.reply({"fileUuid": file_uuid, "uploadId": upload_id,
+                        "partPresignUploadUrlMap": url_map, "fileName": req.get("fileName", "")})
+
+        def upload_status(self, req):
+            with state.lock:
+                session = state.sessions.get(req.get("fileUuid", ""))
+                if session is None:
+                    self.reply(None, "404", "session not found")
+                    return
+                status = state.session_status(session)
+                part_list = []
+                if status == UPLOADING:
+                    for part, etag in sorted(session["etags"].items()):
+                        if part == state.corrupt_part:
+                            etag = "0" * 32
+                        part_list.append({"partNumber": part, "etag": '"%s"' % etag})
+            self.reply({"uploadStatus": status, "uploadedPartList": part_list})
+
+        def complete_upload(self, req):
+            with state.lock:
+                file_uuid = req.get("fileUuid", "")
+                session = state.sessions.get(file_uuid)
+                if session is None or state.session_status(session) == FAILED:
+                    self.reply(None, "404", "session not found")
+                    return
+                etag_map = {int(k): v.strip('"').lower() for k, v in req.get("etagMap", {}).items()}
+                # 流式上传按上限申请分片，只提交实际上传的前 N 片
+                parts = len(etag_map)
+                expected = {i: session["etags"].get(i) for i in range(1, parts + 1)}
+                if parts == 0 or etag_map != expected:
+                    self.reply(None, "409", "etag map mismatch")
+                    return
+                small = [i for i in range(1, parts)
+                         if os.path.getsize(state.part_path(file_uuid, i)) < state.min_part_bytes]
+                if small:
+                    self.reply(None, "400", "EntityTooSmall: part %d below %d bytes" % (small[0], state.min_part_bytes))
+                    return
+                out_path = os.path.join(state.store, session["file_name"])
+                with open(out_path, "wb") as out:
+                    for i in range(1, parts + 1):
+                        with open(state.part_path(file_uuid, i), "rb") as f:
+                            out.write(f.read())
+                session["status"] = UPLOADED
+            self.reply({"pubDownloadUrl": "", "presignDownloadUrl": "%s/download/%s" % (base_url, file_uuid)})
+
+        def chunk_query(self, req):
+            hashes = [str(h).lower() for h in req.get("chunkHashList", [])]
+            missing = {h: "%s/chunk/%s" % (base_url, h) for h in hashes
+                       if not os.path.exists(state.chunk_path(h))}
+            print("[mock_gateway] chunk query: %d chunks, %d missing" % (len(set(hashes)), len(missing)))
+            self.reply({"missingChunkUrlMap": missing})
+
+        def chunk_commit(self, req):
+            hashes = [str(h).lower() for h in req.get("chunkHashList", [])]
+            absent = [h for h in hashes if not os.path.exists(state.chunk_path(h))]
+            if not hashes or absent:
+                self.reply({"missingChunkHashList": absent}, "409", "chunks missing")
+                return
+            file_name = os.path.basename(req.get("fileName", "")) or uuid.uuid4().hex
+            out_path = os.path.join(state.store, file_name)
+            size = 0
+            with open(out_path, "wb") as out:
+                for h in hashes:
+                    with open(state.chunk_path(h), "rb") as f:
+                        data = f.read()
+                    size += len(data)
+                    out.write(data)
+            if size != int(req.get("fileSize", size)):
+                os.remove(out_path)
+                self.reply(None, "409", "file size mismatch")
+                return
+            self.reply({"pubDownloadUrl": "", "presignDownloadUrl": "%s/download/%s" % (base_url, file_name)})
+
+        def put_chunk(self, chunk_hash):
+            chunk_hash = chunk_hash.lower()
+            data = self.read_body()
+            if hashlib.sha256(data).hexdigest() != chunk_hash:
+                self.send_error(400, "chunk hash mismatch")
+                return
+            # 先写临时文件再改名，避免中断留下不完整的块被当作已存在
+            tmp_path = state.chunk_path(chunk_hash) + ".tmp.%d" % threading.get_ident()
+            with open(tmp_path, "wb") as f:
+                f.write(data)
+            os.replace(tmp_path, state.chunk_path(chunk_hash))
+            self.send_response(200)
+            self.send_header("ETag", '"%s"' % hashlib.md5(data).hexdigest())
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+
+        def do_PUT(self):
+            fields = self.path.strip("/").split("/")
+            if len(fields) == 2 and fields[0] == "chunk" and state.dedup:
+                self.put_chunk(fields[1])
+                return
+            if len(fields) != 3 or fields[0] != "upload":
+                self.send_error(404)
+                return
+            file_uuid, part = fields[1], int(fields[2])
+            data = self.read_body()
+            with state.lock:
+                session = state.sessions.get(file_uuid)
+                if session is None or part < 1 or part > session["parts"]:
+                    self.send_error(404)
+                    return
+                if (not session.get("interrupted") and 0 < state.fail_after <= len(session["etags"])
+                        and part not in session["etags"]):
+                    # 每个会话只中断一次，之后的续传正常接收
+                    session["interrupted"] = True
+                    self.close_connection = True
+                    return
+                etag = hashlib.md5(data).hexdigest()
+                with open(state.part_path(file_uuid, part), "wb") as f:
+                    f.write(data)
+                session["etags"][part] = etag
+            self.send_response(200)
+            self.send_header("ETag", '"%s"' % etag)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local stand-in for the upload gateway.")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--store", default="/tmp/mock_gateway")
+    parser.add_argument("--fail-after", type=int, default=0)
+    parser.add_argument("--corrupt-part", type=int, default=0)
+    parser.add_argument("--expire-sec", type=int, default=0)
+    parser.add_argument("--no-dedup", action="store_true")
+    parser.add_argument("--min-part-kb", type=int, default=5120)
+    args = parser.parse_args()
+
+    state = GatewayState(args.store, args.fail_after, args.corrupt_part, args.expire_sec, not args.no_dedup,
+                         args.min_part_kb)
+    base_url = "http://%s:%d" % (args.host, args.port)
+    server = ThreadingHTTPServer((args.host, args.port), make_handler(state, base_url))
+    print("[mock_gateway] listening on %s, store: %s" % (base_url, args.store))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()